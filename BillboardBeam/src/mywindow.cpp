@@ -120,6 +120,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "../common/assets/fonts/test.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 0.5f);
         text->SetSmoothness(1.0f);
     }
     //
@@ -262,7 +263,8 @@ void MyWindow::OnRender()
 
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 0.5f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
@@ -8,6 +8,7 @@
 #include "../../common/render/texture.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 #include "billboard_beam.h"
 
 class MyWindow final : public common::Window
@@ -19,6 +20,7 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
 
 public:
@@ -46,6 +48,7 @@ private:
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     BillboardBeam bb;
     float theta;
 
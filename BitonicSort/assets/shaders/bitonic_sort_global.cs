@@ -0,0 +1,38 @@
+#version 430
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) buffer Keys
+{
+    uint keys[];
+};
+
+layout(std430, binding = 1) buffer Values
+{
+    uint values[];
+};
+
+uniform uint u_seq_size;
+uniform uint u_offset;      // At least the block size of the local sort.
+
+void main(void)
+{
+    // Each thread takes the pair whose lower element has the offset bit clear.
+    uint t = gl_GlobalInvocationID.x;
+    uint i = 2u * t - (t & (u_offset - 1u));
+    uint j = i + u_offset;
+
+    bool ascending = (i & u_seq_size) == 0u;
+
+    uint key_i = keys[i];
+    uint key_j = keys[j];
+    if(ascending ? (key_j < key_i) : (key_i < key_j))
+    {
+        keys[i] = key_j;
+        keys[j] = key_i;
+
+        uint value = values[i];
+        values[i] = values[j];
+        values[j] = value;
+    }
+}
@@ -0,0 +1,80 @@
+#version 430
+
+// Must match the block size in mywindow.cpp.
+#define BLOCK_SIZE 1024
+
+layout(local_size_x = BLOCK_SIZE / 2) in;
+
+layout(std430, binding = 0) buffer Keys
+{
+    uint keys[];
+};
+
+layout(std430, binding = 1) buffer Values
+{
+    uint values[];
+};
+
+uniform uint u_seq_size;    // 0 sorts the blocks from scratch, otherwise runs the stages below the block size of that step.
+
+shared uint s_keys[BLOCK_SIZE];
+shared uint s_values[BLOCK_SIZE];
+
+void compare_exchange(uint seq_size, uint offset)
+{
+    // Each thread takes the pair whose lower element has the offset bit clear.
+    uint t = gl_LocalInvocationID.x;
+    uint i = 2u * t - (t & (offset - 1u));
+    uint j = i + offset;
+
+    bool ascending = ((gl_WorkGroupID.x * BLOCK_SIZE + i) & seq_size) == 0u;
+
+    uint key_i = s_keys[i];
+    uint key_j = s_keys[j];
+    if(ascending ? (key_j < key_i) : (key_i < key_j))
+    {
+        s_keys[i] = key_j;
+        s_keys[j] = key_i;
+
+        uint value = s_values[i];
+        s_values[i] = s_values[j];
+        s_values[j] = value;
+    }
+}
+
+void main(void)
+{
+    uint t = gl_LocalInvocationID.x;
+    uint base = gl_WorkGroupID.x * BLOCK_SIZE;
+
+    s_keys[t] = keys[base + t];
+    s_values[t] = values[base + t];
+    s_keys[t + BLOCK_SIZE / 2] = keys[base + t + BLOCK_SIZE / 2];
+    s_values[t + BLOCK_SIZE / 2] = values[base + t + BLOCK_SIZE / 2];
+    barrier();
+
+    if(u_seq_size == 0u)
+    {
+        for(uint seq_size = 2u; seq_size <= BLOCK_SIZE; seq_size <<= 1)
+        {
+            for(uint offset = seq_size >> 1; offset > 0u; offset >>= 1)
+            {
+                compare_exchange(seq_size, offset);
+                barrier();
+            }
+        }
+    }
+    else
+    {
+        for(uint offset = BLOCK_SIZE >> 1; offset > 0u; offset >>= 1)
+        {
+            compare_exchange(u_seq_size, offset);
+            barrier();
+        }
+    }
+
+    keys[base + t] = s_keys[t];
+    values[base + t] = s_values[t];
+    keys[base + t + BLOCK_SIZE / 2] = s_keys[t + BLOCK_SIZE / 2];
+    values[base + t + BLOCK_SIZE / 2] = s_values[t + BLOCK_SIZE / 2];
+}
@@ -0,0 +1,22 @@
+#version 430
+
+out vec4 o_color;
+
+layout(std430, binding = 1) readonly buffer Values
+{
+    uint values[];
+};
+
+uniform sampler2D u_tex0;   // The image the keys were encoded from, as large as the output.
+
+void main(void)
+{
+    uint width = uint(textureSize(u_tex0, 0).x);
+    uvec2 adr2d = uvec2(gl_FragCoord.xy);
+
+    // The payload of the n-th smallest key is the address of its pixel.
+    uint src_adr1d = values[adr2d.y * width + adr2d.x];
+    ivec2 src_adr2d = ivec2(src_adr1d % width, src_adr1d / width);
+
+    o_color = vec4(texelFetch(u_tex0, src_adr2d, 0).rgb, 1.0);
+}
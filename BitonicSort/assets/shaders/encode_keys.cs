@@ -0,0 +1,34 @@
+#version 430
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) writeonly buffer Keys
+{
+    uint keys[];
+};
+
+layout(std430, binding = 1) writeonly buffer Values
+{
+    uint values[];
+};
+
+uniform sampler2D u_tex0;
+uniform uint u_num_elements;
+
+void main(void)
+{
+    uint i = gl_GlobalInvocationID.x;
+    if(i >= u_num_elements)
+        return;
+
+    ivec2 size = textureSize(u_tex0, 0);
+    uint width = uint(size.x);
+
+    // Non-negative floats order as their bits do, the elements past the image sort last.
+    uint key = 0xFFFFFFFFu;
+    if(i < width * uint(size.y))
+        key = floatBitsToUint(max(texelFetch(u_tex0, ivec2(i % width, i / width), 0).r, 0.0));
+
+    keys[i] = key;
+    values[i] = i;
+}
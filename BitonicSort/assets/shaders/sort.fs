@@ -3,42 +3,56 @@
 out vec4 o_color;
 
 uniform sampler2D u_tex0;
-uniform vec2 u_resolution;
-uniform float u_seq_size;
-uniform float u_offset;
-uniform float u_range;
+uniform int u_seq_size;
+uniform int u_offset;       // The largest offset of the stages in this pass.
+uniform int u_num_stages;   // The offsets halve from stage to stage.
 
-float address(vec2 address2d, vec2 resolution)
-{
-    vec2 temp = floor(address2d);
-    return temp.y * resolution.x + temp.x;
-}
+const int MAX_STAGES = 4;
+const int MAX_ELEMENTS = 1 << MAX_STAGES;
 
-vec2 address(float address1d, vec2 resolution)
+ivec2 address(int address1d, int width)
 {
-    vec2 temp;
-    temp.x = mod(address1d, resolution.x);
-    temp.y = address1d / resolution.x;
-    return floor(temp) + 0.5;
+    return ivec2(address1d % width, address1d / width);
 }
 
 void main(void)
 {
-    float own_adr1d = address(gl_FragCoord.xy, u_resolution);
-
-    float fetch_dir = (mod(own_adr1d, u_range) < u_offset)? 1 : -1;
-    float sort_dir = (mod(floor(own_adr1d / u_seq_size), 2.0) <= 0.5)? 1 : -1;
-
-    float partner_adr1d = own_adr1d + fetch_dir * u_offset;
-    vec2 partner_adr2d = address(partner_adr1d, u_resolution);
-
-    vec3 own_color = texture(u_tex0, gl_FragCoord.xy / u_resolution).rgb;
-    vec3 partner_color = texture(u_tex0, partner_adr2d / u_resolution).rgb;
-
-    vec3 min_color = (own_color.x < partner_color.x)? own_color : partner_color;
-    vec3 max_color = (own_color.x < partner_color.x)? partner_color : own_color;
-
-    vec3 color = (fetch_dir == sort_dir)? min_color : max_color;
-
-    o_color = vec4(color, 1.0);
+    int width = textureSize(u_tex0, 0).x;
+    ivec2 own_adr2d = ivec2(gl_FragCoord.xy);
+    int own_adr1d = own_adr2d.y * width + own_adr2d.x;
+
+    // The stages only exchange elements whose addresses differ in the bits of their offsets,
+    // so the group of those elements is read once and sorted in registers.
+    int num_stages = min(u_num_stages, MAX_STAGES);
+    int num_elements = 1 << num_stages;
+    int lowest_offset = u_offset >> (num_stages - 1);
+    int group_mask = (num_elements - 1) * lowest_offset;
+    int base_adr1d = own_adr1d & ~group_mask;
+    int own_index = (own_adr1d & group_mask) / lowest_offset;
+
+    vec3 colors[MAX_ELEMENTS];
+    for(int i = 0; i < num_elements; i++)
+        colors[i] = texelFetch(u_tex0, address(base_adr1d + i * lowest_offset, width), 0).rgb;
+
+    // All of the group lies in the same sequence.
+    bool ascending = ((own_adr1d / u_seq_size) & 1) == 0;
+
+    for(int offset = num_elements >> 1; offset > 0; offset >>= 1)
+    {
+        for(int i = 0; i < num_elements; i++)
+        {
+            if((i & offset) != 0)
+                continue;
+
+            vec3 a = colors[i];
+            vec3 b = colors[i + offset];
+            if(ascending ? (b.x < a.x) : (a.x < b.x))
+            {
+                colors[i] = b;
+                colors[i + offset] = a;
+            }
+        }
+    }
+
+    o_color = vec4(colors[own_index], 1.0);
 }
\ No newline at end of file
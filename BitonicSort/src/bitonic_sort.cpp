@@ -1,61 +1,53 @@
-#include <iterator>
-#include <cstdlib>
 #include <cassert>
-#include <array>
-#include <cmath>
-#include <vector>
-#include <numeric>
-#include <random>
+#include <cstdint>
 #include <algorithm>
+#include <thread>
+// The widest lanes the target has, BITONIC_SORT_SCALAR forces the scalar network so that it can be tested too.
+#if !defined(BITONIC_SORT_SCALAR) && defined(__AVX2__)
+#define BITONIC_SORT_AVX2
+#include <immintrin.h>
+#elif !defined(BITONIC_SORT_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+#define BITONIC_SORT_SSE2
+#include <emmintrin.h>
+#endif
+#include "../../common/parallel_for.h"
 #include "bitonic_sort.h"
 
 namespace bitonic_sort
 {
 
-static int solve_quadratic_equation(double a, double b, double c, std::array<double, 2> & roots)
+static int log2_floor(std::uint32_t x)
 {
-    double d = b * b - 4.0 * a * c;
-    if(d < 0.0)
-        return 0;   // equation has imaginary roots.
+    int n = 0;
+    while(x >>= 1)
+        n++;
+    return n;
+}
 
-    double x = (std::abs(b) + std::sqrt(d)) / (2.0 * a);
-    if(d > 0.0)
+static int isqrt(std::uint32_t x)
+{
+    std::uint32_t root = 0;
+    for(std::uint32_t bit = 1u << 30; bit > 0; bit >>= 2)
     {
-        // equation has 2 roots.
-        if(b < 0.0) // negative sign
+        if(x >= root + bit)
         {
-            // x1 = (- b - sqrt(D)) / 2a = (- (-|b|) - sqrt(D)) / 2a = (|b| - sqrt(D)) / 2a ... When b is larger, There is a possibility to underflow.
-            // x2 = (- b + sqrt(D)) / 2a = (- (-|b|) + sqrt(D)) / 2a = (|b| + sqrt(D)) / 2a
-            roots[0] = c / (a * x);	// rationalize the numerator
-            roots[1] = x;
+            x -= root + bit;
+            root = (root >> 1) + bit;
         }
-        else        // positive sign
+        else
         {
-            // x1 = (- b - sqrt(D)) / 2a = (- (+|b|) - sqrt(D)) / 2a = (-|b| - sqrt(D)) / 2a = -(|b| + sqrt(D)) / 2a
-            // x2 = (- b + sqrt(D)) / 2a = (- (+|b|) + sqrt(D)) / 2a = (-|b| + sqrt(D)) / 2a = -(|b| - sqrt(D)) / 2a ... When b is larger, There is a possibility to underflow.
-            roots[0] = -x;
-            roots[1] = -(c / (a * x));	// rationalize the numerator
+            root >>= 1;
         }
-        return 2;
     }
-
-    // equation has 1 root
-    roots[0] = roots[1] = (b < 0.0) ? x : -x;
-    return 1;
+    return static_cast<int>(root);
 }
 
 static int pass_to_step(int pass)
 {
-    // ax^2 + bx + c = 0
-    double a = 1.0;
-    double b = 1.0;
-    double c = -2.0 * static_cast<double>(pass);
-    std::array<double, 2> roots;
-    auto ret = solve_quadratic_equation(a, b, c, roots);
-    assert(ret > 0);
-    auto root = std::max(roots[0], roots[1]);
-
-    return static_cast<int>(std::ceil(root));
+    // The step is the smallest s with s(s + 1) / 2 >= pass.
+    assert(pass > 0);
+    auto step = (isqrt(8u * static_cast<std::uint32_t>(pass) + 1u) - 1) / 2;
+    return (step * (step + 1) / 2 < pass) ? step + 1 : step;
 }
 
 static int pass_to_stage(int pass, int step)
@@ -66,22 +58,30 @@ static int pass_to_stage(int pass, int step)
 
 static int stage_to_offset(int stage)
 {
-    return std::pow(2.0, stage - 1);
+    return 1 << (stage - 1);
 }
 
-double next_lower_power_of_two(double x)
+int next_lower_power_of_two(int x)
 {
-    return std::pow(2.0, std::floor(std::log2(x)));
+    assert(x > 0);
+    return 1 << log2_floor(static_cast<std::uint32_t>(x));
 }
 
-double next_higher_power_of_two(double x)
+int next_higher_power_of_two(int x)
 {
-    return std::pow(2.0, std::ceil(std::log2(x)));
+    assert(x > 0);
+    auto v = static_cast<std::uint32_t>(x) - 1u;
+    v |= v >> 1;
+    v |= v >> 2;
+    v |= v >> 4;
+    v |= v >> 8;
+    v |= v >> 16;
+    return static_cast<int>(v + 1u);
 }
 
 int get_num_passes(int N)
 {
-    auto n = static_cast<int>(std::log2(N));
+    auto n = log2_floor(static_cast<std::uint32_t>(N));
     return n * (n + 1) / 2;
 }
 
@@ -89,11 +89,229 @@ params get_params(int pass)
 {
     auto step = pass_to_step(pass);
     auto stage = pass_to_stage(pass, step);
-    auto seq_size = static_cast<int>(std::pow(2.0, step));
+    auto seq_size = 1 << step;
     auto offset = stage_to_offset(stage);
     auto range = offset * 2;
 
     return std::make_tuple(step, stage, seq_size, offset, range);
 }
 
+schedule make_schedule(int N, int max_stages_per_pass)
+{
+    assert((N > 0) && ((N & (N - 1)) == 0));
+    assert(max_stages_per_pass > 0);
+
+    // Step s has the stages s to 1, they are split into passes from the largest offset down.
+    // The passes go from log2(N)(log2(N) + 1) / 2 down to the sum of ceil(s / max_stages_per_pass).
+    const auto n = log2_floor(static_cast<std::uint32_t>(N));
+
+    schedule result;
+    for(int step = 1; step <= n; step++)
+    {
+        for(int stage = step; stage > 0; )
+        {
+            auto num_stages = std::min(stage, max_stages_per_pass);
+            result.push_back({ step, 1 << step, stage_to_offset(stage), num_stages });
+            stage -= num_stages;
+        }
+    }
+    return result;
+}
+
+// Registers of 32-bit lanes. The keys are biased by the sign bit so that signed compares order them as unsigned.
+#if defined(BITONIC_SORT_AVX2)
+
+using lanes = __m256i;
+static constexpr std::size_t num_lanes = 8;
+
+static lanes load(const std::uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+static void store(std::uint32_t* p, lanes v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+static lanes broadcast(std::uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+static lanes lane_indices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+static lanes bitwise_and(lanes a, lanes b) { return _mm256_and_si256(a, b); }
+static lanes add(lanes a, lanes b) { return _mm256_add_epi32(a, b); }
+static lanes equal(lanes a, lanes b) { return _mm256_cmpeq_epi32(a, b); }
+static lanes greater(lanes a, lanes b) { return _mm256_cmpgt_epi32(a, b); }
+static lanes blend(lanes a, lanes b, lanes mask) { return _mm256_blendv_epi8(a, b, mask); }
+
+// The lane at the offset within the register, the offset being below num_lanes.
+static lanes partner(lanes v, std::size_t offset)
+{
+    if(offset == 4)
+        return _mm256_permute2x128_si256(v, v, 0x01);
+    if(offset == 2)
+        return _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+#elif defined(BITONIC_SORT_SSE2)
+
+using lanes = __m128i;
+static constexpr std::size_t num_lanes = 4;
+
+static lanes load(const std::uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+static void store(std::uint32_t* p, lanes v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+static lanes broadcast(std::uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+static lanes lane_indices() { return _mm_setr_epi32(0, 1, 2, 3); }
+static lanes bitwise_and(lanes a, lanes b) { return _mm_and_si128(a, b); }
+static lanes add(lanes a, lanes b) { return _mm_add_epi32(a, b); }
+static lanes equal(lanes a, lanes b) { return _mm_cmpeq_epi32(a, b); }
+static lanes greater(lanes a, lanes b) { return _mm_cmpgt_epi32(a, b); }
+static lanes blend(lanes a, lanes b, lanes mask) { return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a)); }
+
+static lanes partner(lanes v, std::size_t offset)
+{
+    if(offset == 2)
+        return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+#else
+
+// A single lane, every offset is then exchanged between registers.
+using lanes = std::int32_t;
+static constexpr std::size_t num_lanes = 1;
+
+static lanes load(const std::uint32_t* p) { return static_cast<lanes>(*p); }
+static void store(std::uint32_t* p, lanes v) { *p = static_cast<std::uint32_t>(v); }
+static lanes broadcast(std::uint32_t x) { return static_cast<lanes>(x); }
+static lanes greater(lanes a, lanes b) { return (a > b) ? -1 : 0; }
+static lanes blend(lanes a, lanes b, lanes mask) { return (mask != 0) ? b : a; }
+
+#endif
+
+// Elements sorted by all the stages below this offset at once, while they stay in the cache.
+static constexpr std::size_t block_size = 1 << 12;
+static constexpr std::size_t min_parallel_size = 1 << 16;
+
+// Exchanges num_lanes pairs at once, the offset being num_lanes or more.
+static void compare_exchange(std::uint32_t* keys, std::uint32_t* values, std::size_t i, std::size_t offset, bool ascending)
+{
+    const auto j = i + offset;
+    const auto key_i = load(keys + i);
+    const auto key_j = load(keys + j);
+    const auto value_i = load(values + i);
+    const auto value_j = load(values + j);
+
+    const auto mask = ascending ? greater(key_i, key_j) : greater(key_j, key_i);
+    store(keys + i, blend(key_i, key_j, mask));
+    store(keys + j, blend(key_j, key_i, mask));
+    store(values + i, blend(value_i, value_j, mask));
+    store(values + j, blend(value_j, value_i, mask));
+}
+
+#if defined(BITONIC_SORT_AVX2) || defined(BITONIC_SORT_SSE2)
+
+// Exchanges the pairs within a register, the offset being below num_lanes.
+static void compare_exchange_lanes(std::uint32_t* keys, std::uint32_t* values, std::size_t i, std::size_t offset, std::size_t seq_size)
+{
+    const auto indices = add(broadcast(static_cast<std::uint32_t>(i)), lane_indices());
+    const auto zero = broadcast(0);
+    const auto is_lower = equal(bitwise_and(lane_indices(), broadcast(static_cast<std::uint32_t>(offset))), zero);
+    const auto is_ascending = equal(bitwise_and(indices, broadcast(static_cast<std::uint32_t>(seq_size))), zero);
+    // The lower lane of an ascending pair and the upper lane of a descending one keep the smaller key.
+    const auto keeps_min = equal(is_lower, is_ascending);
+
+    const auto key = load(keys + i);
+    const auto value = load(values + i);
+    const auto key_partner = partner(key, offset);
+    const auto value_partner = partner(value, offset);
+
+    const auto mask = blend(greater(key_partner, key), greater(key, key_partner), keeps_min);
+    store(keys + i, blend(key, key_partner, mask));
+    store(values + i, blend(value, value_partner, mask));
+}
+
+#endif
+
+// Runs the stages of a step from the offset down within the block.
+static void sort_block(std::uint32_t* keys, std::uint32_t* values, std::size_t first, std::size_t size, std::size_t seq_size, std::size_t offset)
+{
+    for(; offset >= num_lanes; offset >>= 1)
+    {
+        for(auto i = first; i < first + size; i += offset * 2)
+        {
+            const auto ascending = (i & seq_size) == 0;
+            for(auto j = i; j < i + offset; j += num_lanes)
+                compare_exchange(keys, values, j, offset, ascending);
+        }
+    }
+#if defined(BITONIC_SORT_AVX2) || defined(BITONIC_SORT_SSE2)
+    for(; offset > 0; offset >>= 1)
+    {
+        for(auto i = first; i < first + size; i += num_lanes)
+            compare_exchange_lanes(keys, values, i, offset, seq_size);
+    }
+#endif
+}
+
+void sort(std::uint32_t* keys, std::uint32_t* values, std::size_t N, unsigned int num_of_threads)
+{
+    assert((N & (N - 1)) == 0);
+    if(N <= 1)
+        return;
+
+    if(num_of_threads == 0)
+        num_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    if(N < min_parallel_size)
+        num_of_threads = 1;
+
+    // Too few elements to fill a register, the same network runs a pair at a time.
+    if(N < num_lanes)
+    {
+        for(std::size_t seq_size = 2; seq_size <= N; seq_size <<= 1)
+        {
+            for(auto offset = seq_size / 2; offset > 0; offset >>= 1)
+            {
+                for(std::size_t i = 0; i < N; i++)
+                {
+                    const auto j = i + offset;
+                    if((i & offset) || !(((i & seq_size) == 0) ? (keys[j] < keys[i]) : (keys[i] < keys[j])))
+                        continue;
+                    std::swap(keys[i], keys[j]);
+                    std::swap(values[i], values[j]);
+                }
+            }
+        }
+        return;
+    }
+
+    const auto block = std::min(N, block_size);
+    const auto num_blocks = N / block;
+
+    for(std::size_t i = 0; i < N; i++)
+        keys[i] ^= 0x80000000u;
+
+    // 1) sort each block, with the same steps as the whole sequence.
+    common::parallel_for(num_blocks, num_of_threads, [&](std::size_t b)
+    {
+        for(std::size_t seq_size = 2; seq_size <= block; seq_size <<= 1)
+            sort_block(keys, values, b * block, block, seq_size, seq_size / 2);
+    });
+
+    // 2) merge. Only the offsets of a block or more are exchanged between blocks, a stage at a time.
+    for(auto seq_size = block * 2; seq_size <= N; seq_size <<= 1)
+    {
+        for(auto offset = seq_size / 2; offset >= block; offset >>= 1)
+        {
+            common::parallel_for(num_blocks, num_of_threads, [&](std::size_t b)
+            {
+                const auto first = b * block;
+                if(first & offset)
+                    return;
+                const auto ascending = (first & seq_size) == 0;
+                for(auto i = first; i < first + block; i += num_lanes)
+                    compare_exchange(keys, values, i, offset, ascending);
+            });
+        }
+        common::parallel_for(num_blocks, num_of_threads, [&](std::size_t b)
+        {
+            sort_block(keys, values, b * block, block, seq_size, block / 2);
+        });
+    }
+
+    for(std::size_t i = 0; i < N; i++)
+        keys[i] ^= 0x80000000u;
+}
+
 }
\ No newline at end of file
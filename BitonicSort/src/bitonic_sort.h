@@ -1,13 +1,41 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
 
 namespace bitonic_sort
 {
 
 using params = std::tuple<int, int, int, int, int>;
 
-double next_lower_power_of_two(double x);
-double next_higher_power_of_two(double x);
+/*!
+ * A pass runs `num_stages` consecutive stages of a step, their offsets halving from `offset`.
+ * The stages only exchange elements whose addresses differ in the bits of their offsets, so each group of
+ * 2^num_stages such elements is sorted in registers without writing the intermediate results.
+ */
+struct pass
+{
+    int step;
+    int seq_size;
+    int offset;
+    int num_stages;
+};
+
+using schedule = std::vector<pass>;
+
+int next_lower_power_of_two(int x);
+int next_higher_power_of_two(int x);
 int get_num_passes(int N);
 params get_params(int pass);
 
+//! Plans the passes sorting N elements, N being a power of two, with up to `max_stages_per_pass` stages each.
+schedule make_schedule(int N, int max_stages_per_pass = 1);
+
+/*!
+ * Sorts the keys with their values in place on the CPU, N being a power of two.
+ * It runs the network of the compute sort and never exchanges equal keys, so both results match bit for bit.
+ */
+void sort(std::uint32_t* keys, std::uint32_t* values, std::size_t N, unsigned int num_of_threads = 0);
+
 }
\ No newline at end of file
@@ -1,13 +1,21 @@
 ﻿#include <iomanip>
 #include <sstream>
 #include <map>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#if __has_include(<execution>)
+#include <execution>
+#endif
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "../../common/logger.h"
-#include "bitonic_sort.h"
 #include "mywindow.h"
 
+// The elements sorted in shared memory by one work group, must match BLOCK_SIZE in bitonic_sort_local.cs.
+constexpr GLuint local_sort_size = 1024;
+
 MyWindow::MyWindow()
 {
     LOG_D(__func__);
@@ -69,6 +77,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "../common/assets/fonts/test.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 0.5f);
         text->SetSmoothness(1.0f);
     }
 
@@ -90,6 +99,8 @@ void MyWindow::Setup()
     glSamplerParameteri(linear_sampler, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     glSamplerParameteri(linear_sampler, GL_TEXTURE_LOD_BIAS, 0.0f);
 
+    key_buffer = 0;
+    value_buffer = 0;
     RecreateResources(width, height);
 
     auto& rm = System::GetMutableInstance().GetResourceManager();
@@ -118,7 +129,40 @@ void MyWindow::Setup()
             rm.GetResource<Program>("assets/shaders/apply.fs")})
             );
 
+    pipeline_encode_keys = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/encode_keys.cs")})
+            );
+
+    pipeline_local_sort = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/bitonic_sort_local.cs")})
+            );
+
+    pipeline_global_sort = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/bitonic_sort_global.cs")})
+            );
+
+    pipeline_decode_keys = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/decode.vs"),
+            rm.GetResource<Program>("assets/shaders/decode_keys.fs")})
+            );
+
+    fragment_timer = std::make_unique<GpuTimer>();
+    compute_timer = std::make_unique<GpuTimer>();
+    radix_timer = std::make_unique<GpuTimer>();
+
+    gpu_sort = std::make_unique<GpuSort>(num_image_elements);
+
     state = State::Idle;
+    max_stages_per_pass = 3;
+    is_animated = false;
+    implementation = Implementation::Fragment;
+    is_benchmarking = false;
+    num_dispatches = 0;
+    is_verification_requested = false;
 }
 
 void MyWindow::Cleanup()
@@ -127,6 +171,10 @@ void MyWindow::Cleanup()
         glDeleteSamplers(1, &nearest_sampler);
     if(glIsSampler(linear_sampler))
         glDeleteSamplers(1, &linear_sampler);
+    if(glIsBuffer(key_buffer))
+        glDeleteBuffers(1, &key_buffer);
+    if(glIsBuffer(value_buffer))
+        glDeleteBuffers(1, &value_buffer);
 }
 
 void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -160,6 +208,46 @@ void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int
             state = State::Ready;
         }
     }
+    if(key == GLFW_KEY_F1 && action == GLFW_PRESS)
+    {
+        if(state != State::Working)
+        {
+            max_stages_per_pass += (mods == GLFW_MOD_SHIFT) ? -1 : 1;
+            if(max_stages_per_pass < 1)
+                max_stages_per_pass = 4;
+            else
+            if(max_stages_per_pass > 4)
+                max_stages_per_pass = 1;
+        }
+    }
+    if(key == GLFW_KEY_F2 && action == GLFW_PRESS)
+    {
+        is_animated = !is_animated;
+    }
+    if(key == GLFW_KEY_F3 && action == GLFW_PRESS)
+    {
+        if(state != State::Working)
+        {
+            if(implementation == Implementation::Fragment)
+                implementation = Implementation::Compute;
+            else if(implementation == Implementation::Compute)
+                implementation = Implementation::Radix;
+            else
+                implementation = Implementation::Fragment;
+        }
+    }
+    if(key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        is_benchmarking = !is_benchmarking;
+    }
+    if(key == GLFW_KEY_F5 && action == GLFW_PRESS)
+    {
+        is_verification_requested = true;
+    }
+    if(key == GLFW_KEY_F6 && action == GLFW_PRESS)
+    {
+        BenchmarkCpuSorts();
+    }
 }
 
 void MyWindow::OnMouseMove(GLFWwindow* window, double xpos, double ypos)
@@ -250,9 +338,51 @@ void MyWindow::OnRender()
             oss << "Stopped (Change the state with the space key)";
         oss << "\n";
 
+        oss << "Stages per pass:" << max_stages_per_pass << " ([Shift +] F1)";
+        oss << "\n";
+
+        oss << "Animation:" << (is_animated ? "On" : "Off") << " (F2)";
+        oss << "\n";
+
+        oss << "Implementation:";
+        if(implementation == Implementation::Fragment)
+            oss << "Fragment";
+        else if(implementation == Implementation::Compute)
+            oss << "Compute";
+        else if(implementation == Implementation::Radix)
+            oss << "Radix";
+        oss << " (F3)";
+        oss << "\n";
+
+        oss << "Benchmark:" << (is_benchmarking ? "On" : "Off") << " (F4, runs once stopped)";
+        oss << "\n";
+
+        if(state == State::Working || state == State::Stopped)
+        {
+            if(implementation == Implementation::Compute)
+                oss << "Dispatches:" << num_dispatches;
+            else if(implementation == Implementation::Fragment)
+                oss << "Passes:" << pass << "/" << schedule.size();
+            oss << "\n";
+        }
+        if(is_benchmarking && state == State::Stopped)
+        {
+            oss << "Fragment:" << fragment_timer->GetElapsedTime() << "ms";
+            oss << " Compute:" << compute_timer->GetElapsedTime() << "ms";
+            oss << " Radix:" << radix_timer->GetElapsedTime() << "ms";
+            oss << "\n";
+        }
+
+        oss << "Compute sorts against the CPU:" << (verification_result.empty() ? "-" : verification_result) << " (F5)";
+        oss << "\n";
+
+        oss << "CPU sorts:" << (cpu_benchmark_result.empty() ? "-" : cpu_benchmark_result) << " (F6)";
+        oss << "\n";
+
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 0.5f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
@@ -301,6 +431,21 @@ void MyWindow::RecreateResources(int width, int height)
         ss.clear(std::stringstream::goodbit);
 
         sort_rts = { std::move(sort_rt_0), std::move(sort_rt_1) };
+
+        num_sort_elements = width2 * height2;
+        num_image_elements = static_cast<GLuint>(width * height);
+        num_buffer_elements = std::max(static_cast<GLuint>(num_sort_elements), local_sort_size);
+
+        if(glIsBuffer(key_buffer))
+            glDeleteBuffers(1, &key_buffer);
+        if(glIsBuffer(value_buffer))
+            glDeleteBuffers(1, &value_buffer);
+
+        const auto size = static_cast<GLsizeiptr>(num_buffer_elements * sizeof(GLuint));
+        glCreateBuffers(1, &key_buffer);
+        glNamedBufferStorage(key_buffer, size, nullptr, 0);
+        glCreateBuffers(1, &value_buffer);
+        glNamedBufferStorage(value_buffer, size, nullptr, 0);
     }
     {
         const auto name = std::string("output_rt_color");
@@ -407,14 +552,21 @@ void MyWindow::PassSort(FrameBuffer* output)
     }
     else if(state == State::Ready)
     {
-        GLint viewport[4];
-        sort_rts[0]->Bind();
-        glGetIntegerv(GL_VIEWPORT, viewport);
-        sort_rts[0]->Unbind();
+        schedule = bitonic_sort::make_schedule(num_sort_elements, max_stages_per_pass);
+        pass = 0;
 
-        auto N = viewport[2] * viewport[3];
-        num_passes = bitonic_sort::get_num_passes(N);
-        pass = 1;
+        if(implementation != Implementation::Fragment)
+        {
+            // The compute sorts always run to the end in one frame.
+            PassEncodeKeys(input_rt.get());
+            if(implementation == Implementation::Compute)
+                PassComputeSort();
+            else
+                PassRadixSort();
+            PassDecodeKeys(input_rt.get(), output);
+            state = State::Stopped;
+            return;
+        }
 
         PassEncode(input_rt.get(), sort_rts[0].get());
         PassDecode(sort_rts[0].get(), output);
@@ -422,38 +574,63 @@ void MyWindow::PassSort(FrameBuffer* output)
     }
     else if(state == State::Working)
     {
-        if(pass <= num_passes)
+        // The whole schedule is run at once unless it is animated.
+        const auto last = is_animated ? std::min(pass + 1, schedule.size()) : schedule.size();
+        for(; pass < last; pass++)
         {
-            auto params = bitonic_sort::get_params(pass);
-            auto current = (pass - 1) % 2;
-            auto src = sort_rts[current].get();
-            auto dst = sort_rts[1 - current].get();
+            auto current = pass % 2;
+            PassSort(sort_rts[current].get(), sort_rts[1 - current].get(), schedule[pass]);
+        }
+        PassDecode(sort_rts[pass % 2].get(), output);
 
-            PassSort(src, dst, std::get<2>(params), std::get<3>(params), std::get<4>(params));
-            PassDecode(dst, output);
+        if(pass >= schedule.size())
+            state = State::Stopped;
+    }
+    else if(state == State::Stopped && is_verification_requested)
+    {
+        verification_result = std::string("Bitonic ") + (VerifyComputeSort(input_rt.get()) ? "Passed" : "Failed");
+        verification_result += std::string(", Radix ") + (VerifyRadixSort(input_rt.get()) ? "Passed" : "Failed");
+        is_verification_requested = false;
+    }
+    else if(state == State::Stopped && is_benchmarking)
+    {
+        // Every implementation sorts the same image every frame, so their timings can be compared.
+        schedule = bitonic_sort::make_schedule(num_sort_elements, max_stages_per_pass);
+        pass = schedule.size();
 
-            pass++;
-        }
+        fragment_timer->Begin();
+        PassEncode(input_rt.get(), sort_rts[0].get());
+        for(std::size_t i = 0; i < schedule.size(); i++)
+            PassSort(sort_rts[i % 2].get(), sort_rts[1 - i % 2].get(), schedule[i]);
+        fragment_timer->End();
+
+        compute_timer->Begin();
+        PassEncodeKeys(input_rt.get());
+        PassComputeSort();
+        compute_timer->End();
+
+        // The radix sort goes last, so that its result is the one in the buffers.
+        radix_timer->Begin();
+        PassEncodeKeys(input_rt.get());
+        PassRadixSort();
+        radix_timer->End();
+
+        if(implementation == Implementation::Fragment)
+            PassDecode(sort_rts[schedule.size() % 2].get(), output);
         else
-        {
-            state = State::Stopped;
-        }
+            PassDecodeKeys(input_rt.get(), output);
     }
 }
 
-void MyWindow::PassSort(FrameBuffer* input, FrameBuffer* output, int seq_size, int offset, int range)
+void MyWindow::PassSort(FrameBuffer* input, FrameBuffer* output, const bitonic_sort::pass& sort_pass)
 {
     output->Bind();
     {
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
-
         auto& uniform = pipeline_sort->GetPipelineUniform();
         uniform.Set("u_tex0", 0);
-        uniform.Set("u_resolution", glm::vec2(static_cast<float>(viewport[2]), static_cast<float>(viewport[3])));
-        uniform.Set("u_seq_size", static_cast<float>(seq_size));
-        uniform.Set("u_offset", static_cast<float>(offset));
-        uniform.Set("u_range", static_cast<float>(range));
+        uniform.Set("u_seq_size", sort_pass.seq_size);
+        uniform.Set("u_offset", sort_pass.offset);
+        uniform.Set("u_num_stages", sort_pass.num_stages);
 
         pipeline_sort->Bind();
         {
@@ -471,6 +648,156 @@ void MyWindow::PassSort(FrameBuffer* input, FrameBuffer* output, int seq_size, i
     output->Unbind();
 }
 
+void MyWindow::PassEncodeKeys(FrameBuffer* input)
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, key_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, value_buffer);
+
+    // The red channels become 32-bit keys, with the pixel addresses as payloads.
+    {
+        auto& uniform = pipeline_encode_keys->GetPipelineUniform();
+        uniform.Set("u_tex0", 0);
+        uniform.Set("u_num_elements", num_buffer_elements);
+
+        pipeline_encode_keys->Bind();
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
+
+            glDispatchCompute((num_buffer_elements + 255) / 256, 1, 1);
+
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        pipeline_encode_keys->Unbind();
+    }
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+}
+
+void MyWindow::PassComputeSort()
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, key_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, value_buffer);
+    num_dispatches = 0;
+
+    // The stages with an offset below the block size run in shared memory, one dispatch per step.
+    // Only the larger offsets need a dispatch of their own.
+    auto sort_locally = [this](GLuint seq_size)
+    {
+        pipeline_local_sort->GetPipelineUniform().Set("u_seq_size", seq_size);
+        pipeline_local_sort->Bind();
+        glDispatchCompute(num_buffer_elements / local_sort_size, 1, 1);
+        pipeline_local_sort->Unbind();
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        num_dispatches++;
+    };
+
+    sort_locally(0);
+    for(GLuint seq_size = local_sort_size * 2; seq_size <= num_buffer_elements; seq_size <<= 1)
+    {
+        for(GLuint offset = seq_size / 2; offset >= local_sort_size; offset >>= 1)
+        {
+            auto& uniform = pipeline_global_sort->GetPipelineUniform();
+            uniform.Set("u_seq_size", seq_size);
+            uniform.Set("u_offset", offset);
+
+            pipeline_global_sort->Bind();
+            glDispatchCompute(num_buffer_elements / 2 / 256, 1, 1);
+            pipeline_global_sort->Unbind();
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            num_dispatches++;
+        }
+        sort_locally(seq_size);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+}
+
+void MyWindow::PassRadixSort()
+{
+    // The keys are non-negative floats.
+    gpu_sort->SortPairs(key_buffer, value_buffer, num_image_elements, GpuSort::KeyType::Float);
+}
+
+bool MyWindow::VerifyComputeSort(FrameBuffer* input)
+{
+    const auto size = static_cast<GLsizeiptr>(num_buffer_elements * sizeof(GLuint));
+    std::vector<std::uint32_t> keys(num_buffer_elements);
+    std::vector<std::uint32_t> values(num_buffer_elements);
+
+    PassEncodeKeys(input);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(key_buffer, 0, size, keys.data());
+    glGetNamedBufferSubData(value_buffer, 0, size, values.data());
+    // The same network, so even the payloads of equal keys end up in the same places.
+    bitonic_sort::sort(keys.data(), values.data(), keys.size());
+
+    PassComputeSort();
+    std::vector<std::uint32_t> gpu_keys(num_buffer_elements);
+    std::vector<std::uint32_t> gpu_values(num_buffer_elements);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(key_buffer, 0, size, gpu_keys.data());
+    glGetNamedBufferSubData(value_buffer, 0, size, gpu_values.data());
+
+    const auto is_equal = (keys == gpu_keys) && (values == gpu_values);
+    LOG_I("Bitonic sort of " << num_buffer_elements << " elements " << (is_equal ? "matches" : "differs from") << " the CPU network.");
+    return is_equal;
+}
+
+bool MyWindow::VerifyRadixSort(FrameBuffer* input)
+{
+    const auto size = static_cast<GLsizeiptr>(num_image_elements * sizeof(GLuint));
+    std::vector<std::uint32_t> keys(num_image_elements);
+    std::vector<std::uint32_t> values(num_image_elements);
+
+    PassEncodeKeys(input);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(key_buffer, 0, size, keys.data());
+    glGetNamedBufferSubData(value_buffer, 0, size, values.data());
+    GpuSort::SortPairs(keys, values, GpuSort::KeyType::Float);
+
+    PassRadixSort();
+    std::vector<std::uint32_t> gpu_keys(num_image_elements);
+    std::vector<std::uint32_t> gpu_values(num_image_elements);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(key_buffer, 0, size, gpu_keys.data());
+    glGetNamedBufferSubData(value_buffer, 0, size, gpu_values.data());
+
+    const auto is_equal = (keys == gpu_keys) && (values == gpu_values);
+    LOG_I("Radix sort of " << num_image_elements << " elements " << (is_equal ? "matches" : "differs from") << " the CPU reference.");
+    return is_equal;
+}
+
+void MyWindow::PassDecodeKeys(FrameBuffer* input, FrameBuffer* output)
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, value_buffer);
+
+    output->Bind();
+    {
+        auto& uniform = pipeline_decode_keys->GetPipelineUniform();
+        uniform.Set("u_tex0", 0);
+
+        pipeline_decode_keys->Bind();
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
+            glBindSampler(0, nearest_sampler);
+
+            fs_quad->Draw();
+
+            glBindSampler(0, 0);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        pipeline_decode_keys->Unbind();
+    }
+    output->Unbind();
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+}
+
 void MyWindow::PassApply(FrameBuffer* input, FrameBuffer* output)
 {
     if(output != nullptr)
@@ -498,4 +825,43 @@ void MyWindow::PassApply(FrameBuffer* input, FrameBuffer* output)
 
     if(output != nullptr)
         output->Unbind();
+}
+
+void MyWindow::BenchmarkCpuSorts()
+{
+    // Pairs of random keys and indices, as many as the fragment sort has.
+    const auto count = static_cast<std::size_t>(num_sort_elements);
+    std::vector<std::uint32_t> keys(count);
+    std::vector<std::uint32_t> values(count);
+    std::mt19937 engine(0);
+    for(std::size_t i = 0; i < count; i++)
+    {
+        keys[i] = engine();
+        values[i] = static_cast<std::uint32_t>(i);
+    }
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs(count);
+    for(std::size_t i = 0; i < count; i++)
+        pairs[i] = std::make_pair(keys[i], values[i]);
+
+    auto measure = [](auto&& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto by_key = [](const auto& a, const auto& b){ return a.first < b.first; };
+
+    std::ostringstream result;
+    result << std::fixed << std::setprecision(2);
+
+    auto temp = pairs;
+    result << "std::sort " << measure([&](){ std::sort(temp.begin(), temp.end(), by_key); }) << "ms";
+#if defined(__cpp_lib_parallel_algorithm)
+    temp = pairs;
+    result << ", std::sort(par) " << measure([&](){ std::sort(std::execution::par, temp.begin(), temp.end(), by_key); }) << "ms";
+#endif
+    result << ", bitonic " << measure([&](){ bitonic_sort::sort(keys.data(), values.data(), count); }) << "ms";
+
+    cpu_benchmark_result = result.str();
+    LOG_I("Sorting " << count << " pairs on the CPU: " << cpu_benchmark_result);
 }
\ No newline at end of file
@@ -10,8 +10,12 @@
 #include "../../common/render/texture.h"
 #include "../../common/render/framebuffer.h"
 #include "../../common/render/fullscreen_quad.h"
+#include "../../common/render/gpu_sort.h"
+#include "../../common/render/gpu_timer.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
+#include "bitonic_sort.h"
 
 class MyWindow final : public common::Window
 {
@@ -23,8 +27,11 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
     using FullScreenQuad = common::render::FullScreenQuad;
+    using GpuSort = common::render::GpuSort;
+    using GpuTimer = common::render::GpuTimer;
 
 public:
     MyWindow();
@@ -50,11 +57,19 @@ private:
     void PassEncode(FrameBuffer* input, FrameBuffer* output);
     void PassDecode(FrameBuffer* input, FrameBuffer* output);
     void PassSort(FrameBuffer* output);
-    void PassSort(FrameBuffer* input, FrameBuffer* output, int seq_size, int offset, int range);
+    void PassSort(FrameBuffer* input, FrameBuffer* output, const bitonic_sort::pass& sort_pass);
+    void PassEncodeKeys(FrameBuffer* input);
+    void PassComputeSort();
+    void PassRadixSort();
+    bool VerifyComputeSort(FrameBuffer* input);
+    bool VerifyRadixSort(FrameBuffer* input);
+    void BenchmarkCpuSorts();
+    void PassDecodeKeys(FrameBuffer* input, FrameBuffer* output);
     void PassApply(FrameBuffer* input, FrameBuffer* output = nullptr);
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     std::unique_ptr<FullScreenQuad> fs_quad;
     GLuint nearest_sampler;
     GLuint linear_sampler;
@@ -63,11 +78,28 @@ private:
     std::unique_ptr<ProgramPipeline> pipeline_decode;
     std::unique_ptr<ProgramPipeline> pipeline_sort;
     std::unique_ptr<ProgramPipeline> pipeline_apply;
+    std::unique_ptr<ProgramPipeline> pipeline_encode_keys;
+    std::unique_ptr<ProgramPipeline> pipeline_local_sort;
+    std::unique_ptr<ProgramPipeline> pipeline_global_sort;
+    std::unique_ptr<ProgramPipeline> pipeline_decode_keys;
 
     std::unique_ptr<FrameBuffer> input_rt;
     std::array<std::unique_ptr<FrameBuffer>, 2> sort_rts;
     std::unique_ptr<FrameBuffer> output_rt;
 
+    // Keys and payloads of the compute sort, padded to a power of two of at least one block.
+    GLuint key_buffer;
+    GLuint value_buffer;
+    GLuint num_buffer_elements;
+    int num_sort_elements;
+    GLuint num_image_elements;  // The radix sort needs no padding.
+
+    std::unique_ptr<GpuSort> gpu_sort;
+
+    std::unique_ptr<GpuTimer> fragment_timer;
+    std::unique_ptr<GpuTimer> compute_timer;
+    std::unique_ptr<GpuTimer> radix_timer;
+
     enum class State
     {
         Idle,
@@ -77,6 +109,21 @@ private:
     };
 
     State state;
-    int num_passes;
-    int pass;
+    bitonic_sort::schedule schedule;
+    std::size_t pass;
+    int max_stages_per_pass;
+    bool is_animated;   // Runs a pass per frame rather than the whole sort.
+    enum class Implementation
+    {
+        Fragment,   // Bitonic sort of a texture.
+        Compute,    // Bitonic sort of storage buffers.
+        Radix       // GpuSort.
+    };
+
+    Implementation implementation;
+    bool is_benchmarking;   // Sorts with both implementations every frame once stopped.
+    int num_dispatches;
+    bool is_verification_requested;
+    std::string verification_result;
+    std::string cpu_benchmark_result;
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
-﻿#include <iomanip>
+﻿#include <algorithm>
+#include <iomanip>
 #include <sstream>
 #include <memory>
 #include <unordered_map>
@@ -6,6 +7,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "../../common/logger.h"
+#include "../../common/render/blur_tuner.h"
 #include "mywindow.h"
 
 const std::unordered_map <std::string, std::vector<int>> shader_kernel =
@@ -20,6 +22,10 @@ const std::unordered_map <std::string, std::vector<int>> shader_kernel =
     {"test",                {0, 1, 2}},
 };
 
+// The bloom is built from these levels of the high luminance region, 1/8 to 1/128 of the screen.
+constexpr GLsizei bloom_first_level = 2;
+constexpr GLsizei bloom_num_of_levels = 5;
+
 MyWindow::MyWindow()
 {
     LOG_D(__func__);
@@ -82,6 +88,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "../common/assets/fonts/test.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 0.5f);
         text->SetSmoothness(1.0f);
     }
     //
@@ -90,6 +97,9 @@ void MyWindow::Setup()
     texture = rm.GetResource<Texture>("assets/textures/testimg_1920x1080.png")->GetTexture();
 
     fs_quad = std::make_unique<FullScreenQuad>();
+    downsampler = std::make_unique<SinglePassDownsampler>(GL_RGBA16F);
+    gaussian_blur = std::make_unique<GaussianBlur>(*fs_quad, GL_RGBA16F);
+    timer = std::make_unique<GpuTimer>();
 
     glGenSamplers(1, &sampler);
 
@@ -141,6 +151,8 @@ void MyWindow::Setup()
     shader_kernel_name = "gaussian_7x7";
 
     is_filter_enabled = false;
+    is_gaussian_enabled = false;
+    path = ImagePass::Path::Fragment;
 }
 
 void MyWindow::Cleanup()
@@ -172,6 +184,14 @@ void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int
     {
         is_filter_enabled = !is_filter_enabled;
     }
+    if(key == GLFW_KEY_G && action == GLFW_PRESS)
+    {
+        is_gaussian_enabled = !is_gaussian_enabled;
+    }
+    if(key == GLFW_KEY_C && action == GLFW_PRESS)
+    {
+        path = (path == ImagePass::Path::Fragment) ? ImagePass::Path::Compute : ImagePass::Path::Fragment;
+    }
     if(key == GLFW_KEY_1 && action == GLFW_PRESS)
     {
         if(is_filter_enabled)
@@ -295,12 +315,23 @@ void MyWindow::OnRender()
         oss << "MultiSample:" << ((ms == GL_TRUE) ? "On" : "Off") << "(Toggle MultiSample: m)";
         oss << "\n";
 
-        oss << "Kawase blur:" << ((is_filter_enabled == GL_TRUE) ? "On" : "Off") << "(Toggle Kawase blur: b)" << " " << shader_kernel_name;
+        oss << "Bloom:" << ((is_filter_enabled == GL_TRUE) ? "On" : "Off") << "(Toggle Bloom: b)" << " " << shader_kernel_name;
+        oss << "\n";
+
+        oss << "Blur:" << (is_gaussian_enabled ? "Gaussian" : "Kawase") << "(Toggle blur: g)";
+        if(is_gaussian_enabled)
+        {
+            oss << " sigma=" << gaussian_blur->GetSigma() << " radius=" << gaussian_blur->GetRadius();
+            oss << " Path:" << ((path == ImagePass::Path::Compute) ? "Compute" : "Fragment") << "(Toggle path: c)";
+        }
+        if(is_filter_enabled)
+            oss << " " << timer->GetElapsedTime() << "ms";
         oss << "\n";
 
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 0.5f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
@@ -327,6 +358,19 @@ void MyWindow::RecreateResources(int width, int height)
 
         return std::make_unique<FrameBuffer>(texture, 0, 0);
     };
+    auto recreate_view_fb = [](const std::string& name, const std::string& origin_name, GLuint level)
+    {
+        auto& rm = System::GetMutableInstance().GetResourceManager();
+
+        rm.RemoveResource<Texture>(name);
+
+        auto p = std::make_unique<Texture>(*rm.GetResource<Texture>(origin_name), level);
+        auto texture = p->GetTexture();
+
+        rm.AddResource<Texture>(name, std::move(p));
+
+        return std::make_unique<FrameBuffer>(texture, 0, 0);
+    };
 
     // for scene.
     {
@@ -334,44 +378,49 @@ void MyWindow::RecreateResources(int width, int height)
         scene_rt = recreate_fb(name, 1, GL_RGBA16F, width, height);
     }
     // for high luminance region.
+    // The mip chain is generated in a single pass and each level is rendered to through a view.
+    GLsizei num_of_levels;
     {
-        auto ds_width = width / 2;
-        auto ds_height = height / 2;
+        auto ds_width = std::max(1, width / 2);
+        auto ds_height = std::max(1, height / 2);
+        num_of_levels = std::min(bloom_first_level + bloom_num_of_levels, Texture::CalcNumOfMipmapLevels(ds_width, ds_height));
         const auto name = std::string("luminance_rt_color");
-        high_luminance_region_rt = recreate_fb(name, 1, GL_RGBA16F, ds_width, ds_height);
+        high_luminance_region_rt = recreate_fb(name, num_of_levels, GL_RGBA16F, ds_width, ds_height);
     }
+    // for bloom.
+    // Blur passes ping-pong between a level of the high luminance region and the same size level of this chain.
+    // A window too small to have the first bloom level gets no chain, and bloom is skipped.
     {
         std::stringstream ss;
 
-        auto ds_width = width / 4;
-        auto ds_height = height / 4;
+        const auto ds_width = std::max(1, (width / 2) >> bloom_first_level);
+        const auto ds_height = std::max(1, (height / 2) >> bloom_first_level);
+        const auto num_of_bloom_levels = std::max(0, num_of_levels - bloom_first_level);
 
         downsampled_rts.clear();
-
-        for(auto i = 0; i < 5; i++)
         {
-            ds_width /= 2;
-            ds_height /= 2;
+            auto& rm = System::GetMutableInstance().GetResourceManager();
+            const auto name = std::string("blur_rt_color");
+            rm.RemoveResource<Texture>(name);
+            if(num_of_bloom_levels > 0)
+                rm.AddResource<Texture>(name, std::make_unique<Texture>(num_of_bloom_levels, GL_RGBA16F, ds_width, ds_height));
+        }
 
+        for(auto i = 0; i < num_of_bloom_levels; i++)
+        {
             ss << "downsampled_rt_color_" << i << "_" << 0;
-            auto downsampled_rt_0 = recreate_fb(ss.str(), 1, GL_RGBA16F, ds_width, ds_height);
+            auto downsampled_rt_0 = recreate_view_fb(ss.str(), "luminance_rt_color", bloom_first_level + i);
             ss.str("");
             ss.clear(std::stringstream::goodbit);
 
             ss << "downsampled_rt_color_" << i << "_" << 1;
-            auto downsampled_rt_1 = recreate_fb(ss.str(), 1, GL_RGBA16F, ds_width, ds_height);
-            ss.str("");
-            ss.clear(std::stringstream::goodbit);
-
-            ss << "downsampled_rt_color_" << i << "_" << 2;
-            auto downsampled_rt_2 = recreate_fb(ss.str(), 1, GL_RGBA16F, ds_width, ds_height);
+            auto downsampled_rt_1 = recreate_view_fb(ss.str(), "blur_rt_color", i);
             ss.str("");
             ss.clear(std::stringstream::goodbit);
 
             downsampled_rts.push_back({
                 std::move(downsampled_rt_0),
-                std::move(downsampled_rt_1),
-                std::move(downsampled_rt_2)
+                std::move(downsampled_rt_1)
                 });
         }
     }
@@ -500,50 +549,56 @@ void MyWindow::PassKawaseBlur(FrameBuffer* input, FrameBuffer* output, int itera
 
 void MyWindow::PassBloom(FrameBuffer* input, FrameBuffer* output)
 {
+    if(downsampled_rts.empty())
+        return;
+
     // 1) ダウンサンプリング
-    {
-        auto last_rt = input;
-        auto size = downsampled_rts.size();
-        for(decltype(size) i = 0; i < size; i++)
-        {
-            auto src_rt = last_rt;
-            auto dst_rt = downsampled_rts[i][0].get();
-            PassDownsampling2x2(src_rt, dst_rt);
-            last_rt = dst_rt;
-        }
-    }
+    downsampler->Generate(input->GetColorTexture(), bloom_first_level + static_cast<GLint>(downsampled_rts.size()) - 1);
+
     // 2) 各レベルにピンポンブラー
+    // The Gaussian blur is given the sigma of the Kawase kernel, so both are compared at the same blur width.
+    std::vector<FrameBuffer*> blurred_rts;
+    timer->Begin();
     {
         auto it = shader_kernel.find(shader_kernel_name);
         assert(it != shader_kernel.cend());
         auto kernel = it->second;
         const auto num_of_passes = kernel.size();
 
+        gaussian_blur->SetSigma(common::render::BlurTuner::CalcKawaseSigma(kernel));
+
         for(auto& downsampled_rt : downsampled_rts)
         {
+            if(is_gaussian_enabled)
+            {
+                gaussian_blur->Execute(path, downsampled_rt[0]->GetColorTexture(), 0, sampler, downsampled_rt[1].get(), downsampled_rt[0].get());
+                blurred_rts.push_back(downsampled_rt[0].get());
+                continue;
+            }
             auto last_rt = downsampled_rt[0].get();
             for(std::remove_const<decltype(num_of_passes)>::type i = 0; i < num_of_passes; i++)
             {
                 FrameBuffer* src_rt = last_rt;
-                FrameBuffer* dst_rt = ((i % 2) == 0) ? downsampled_rt[1].get() : downsampled_rt[2].get();
+                FrameBuffer* dst_rt = ((i % 2) == 0) ? downsampled_rt[1].get() : downsampled_rt[0].get();
                 PassKawaseBlur(src_rt, dst_rt, kernel[i]);
                 last_rt = dst_rt;
             }
-            PassApply(last_rt, downsampled_rt[0].get());
+            blurred_rts.push_back(last_rt);
         }
     }
+    timer->End();
     // 3) 各フィルタを合成
     {
         glDepthMask(GL_FALSE);
         glEnable(GL_BLEND);
         glBlendFunc(GL_ONE, GL_ONE);
-        auto size = downsampled_rts.size();
+        auto size = blurred_rts.size();
 
-        for(decltype(size) i = size - 1; i > i - 1; i--)
+        for(decltype(size) i = size - 1; i > 0; i--)
         {
-            PassApply(downsampled_rts[i][0].get(), downsampled_rts[i - 1][0].get());
+            PassApply(blurred_rts[i], blurred_rts[i - 1]);
         }
-        PassApply(downsampled_rts[0][0].get(), output);
+        PassApply(blurred_rts[0], output);
 
         glDisable(GL_BLEND);
         glDepthMask(GL_TRUE);
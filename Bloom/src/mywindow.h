@@ -7,8 +7,13 @@
 #include "../../common/render/texture.h"
 #include "../../common/render/framebuffer.h"
 #include "../../common/render/fullscreen_quad.h"
+#include "../../common/render/gaussian_blur.h"
+#include "../../common/render/gpu_timer.h"
+#include "../../common/render/image_pass.h"
+#include "../../common/render/single_pass_downsampler.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 
 class MyWindow final : public common::Window
 {
@@ -20,8 +25,13 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
     using FullScreenQuad = common::render::FullScreenQuad;
+    using SinglePassDownsampler = common::render::SinglePassDownsampler;
+    using GaussianBlur = common::render::GaussianBlur;
+    using GpuTimer = common::render::GpuTimer;
+    using ImagePass = common::render::ImagePass;
 
 public:
     MyWindow();
@@ -53,7 +63,11 @@ private:
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     std::unique_ptr<FullScreenQuad> fs_quad;
+    std::unique_ptr<SinglePassDownsampler> downsampler;
+    std::unique_ptr<GaussianBlur> gaussian_blur;
+    std::unique_ptr<GpuTimer> timer;
     GLuint sampler;
     GLuint texture;
 
@@ -66,9 +80,11 @@ private:
 
     std::unique_ptr<FrameBuffer> scene_rt;
     std::unique_ptr<FrameBuffer> high_luminance_region_rt;
-    std::vector<std::array<std::unique_ptr<FrameBuffer>, 3>> downsampled_rts;
+    std::vector<std::array<std::unique_ptr<FrameBuffer>, 2>> downsampled_rts;
 
     std::string shader_kernel_name;
 
     bool is_filter_enabled;
+    bool is_gaussian_enabled;
+    ImagePass::Path path;
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#version 430
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) buffer Histogram
+{
+    uint histogram[256];
+};
+
+layout(std430, binding = 1) buffer Exposure
+{
+    float exposure;
+    float average_luminance;
+};
+
+uniform float u_min_log_luminance;
+uniform float u_log_luminance_range;
+uniform float u_low_percentile;
+uniform float u_high_percentile;
+uniform float u_key_value;
+uniform float u_adaptation;
+
+shared uint prefix[256];
+shared float weighted_sum[256];
+shared float weight[256];
+
+void main(void)
+{
+    uint i = gl_LocalInvocationIndex;
+    uint count = histogram[i];
+    histogram[i] = 0u;   // Ready for the next frame.
+
+    // Inclusive prefix sum of the bins.
+    prefix[i] = count;
+    barrier();
+    for(uint offset = 1u; offset < 256u; offset <<= 1)
+    {
+        uint v = (i >= offset) ? prefix[i - offset] : 0u;
+        barrier();
+        prefix[i] += v;
+        barrier();
+    }
+
+    // Only the part of the bin between the percentiles counts, which rejects small very dark or very bright areas.
+    float total = float(prefix[255]);
+    float lower = clamp(float(prefix[i] - count), total * u_low_percentile, total * u_high_percentile);
+    float upper = clamp(float(prefix[i]), total * u_low_percentile, total * u_high_percentile);
+    float log_luminance = u_min_log_luminance + (max(float(i), 1.0) - 0.5) / 254.0 * u_log_luminance_range;
+    weight[i] = upper - lower;
+    weighted_sum[i] = (upper - lower) * log_luminance;
+    barrier();
+
+    for(uint stride = 128u; stride > 0u; stride >>= 1)
+    {
+        if(i < stride)
+        {
+            weight[i] += weight[i + stride];
+            weighted_sum[i] += weighted_sum[i + stride];
+        }
+        barrier();
+    }
+
+    if(i == 0u)
+    {
+        float luminance = (weight[0] > 0.0) ? exp2(weighted_sum[0] / weight[0]) : average_luminance;
+        float target = u_key_value / max(luminance, 0.00001);
+        average_luminance = luminance;
+        exposure += (target - exposure) * u_adaptation;
+    }
+}
\ No newline at end of file
@@ -4,7 +4,11 @@ out vec4 o_color;
 
 uniform sampler2D u_tex0;
 uniform vec2 u_pixel_size;
-uniform float u_exposure;
+layout(std430, binding = 1) readonly buffer Exposure
+{
+    float exposure;
+    float average_luminance;
+};
 uniform float u_threshold;
 uniform float u_soft_threshold;
 
@@ -45,6 +49,6 @@ void main(void)
     vec3 color = (color0 + color1 + color2 + color3) * 0.25;
 #endif
 
-    o_color.rgb = prefilter(u_exposure * color, u_threshold, u_soft_threshold);
+    o_color.rgb = prefilter(exposure * color, u_threshold, u_soft_threshold);
     o_color.a = 1.0;
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#version 430
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(std430, binding = 0) buffer Histogram
+{
+    uint histogram[256];
+};
+
+uniform sampler2D u_tex0;
+uniform float u_min_log_luminance;
+uniform float u_inv_log_luminance_range;
+
+shared uint bins[256];
+
+float get_luminance(vec3 color)
+{
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Bin 0 holds the texels too dark to be measured, the others cover the log2 luminance range.
+uint get_bin(vec3 color)
+{
+    float luminance = get_luminance(color);
+    if(luminance < 0.001)
+        return 0u;
+
+    float t = clamp((log2(luminance) - u_min_log_luminance) * u_inv_log_luminance_range, 0.0, 1.0);
+    return uint(t * 254.0 + 1.0);
+}
+
+void main(void)
+{
+    bins[gl_LocalInvocationIndex] = 0u;
+    barrier();
+
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    if(all(lessThan(p, textureSize(u_tex0, 0))))
+        atomicAdd(bins[get_bin(texelFetch(u_tex0, p, 0).rgb)], 1u);
+    barrier();
+
+    // One global atomic per bin and group instead of one per texel.
+    uint count = bins[gl_LocalInvocationIndex];
+    if(count > 0u)
+        atomicAdd(histogram[gl_LocalInvocationIndex], count);
+}
\ No newline at end of file
@@ -1,15 +1,19 @@
-﻿#include <iomanip>
+﻿#include <algorithm>
+#include <cmath>
+#include <iomanip>
 #include <sstream>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <hasenpfote/fp_conversion.h>
 #if defined(USE_IMGUI)
 #include "../../external/imgui/imgui.h"
 #endif
 #include "../../common/logger.h"
 #include "mywindow.h"
 
+// The bloom is built from the first levels of the high luminance region, 1/4 to 1/64 of the screen.
+constexpr GLsizei bloom_num_of_levels = 5;
+
 MyWindow::MyWindow()
 {
     LOG_D(__func__);
@@ -71,6 +75,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "../common/assets/fonts/test.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 0.5f);
         text->SetSmoothness(1.0f);
     }
     //
@@ -92,6 +97,10 @@ void MyWindow::Setup()
     }
 
     fs_quad = std::make_unique<FullScreenQuad>();
+    downsampler = std::make_unique<SinglePassDownsampler>(GL_RGBA16F);
+    post_effect = std::make_unique<FusedPostEffect>(*fs_quad);
+    color_lut = std::make_unique<ColorLut>(32);
+    post_effect->SetLut(color_lut.get());
 
     glGenSamplers(1, &nearest_sampler);
     glSamplerParameteri(nearest_sampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -119,10 +128,14 @@ void MyWindow::Setup()
             rm.GetResource<Program>("assets/shaders/fullscreen_quad.fs")})
             );
 
-    pipeline_log_luminance = std::make_unique<ProgramPipeline>(
+    pipeline_luminance_histogram = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/luminance_histogram.cs")})
+            );
+
+    pipeline_average_luminance = std::make_unique<ProgramPipeline>(
         ProgramPipeline::ProgramPtrSet({
-            rm.GetResource<Program>("assets/shaders/log_luminance.vs"),
-            rm.GetResource<Program>("assets/shaders/log_luminance.fs")})
+            rm.GetResource<Program>("assets/shaders/average_luminance.cs")})
             );
 
     pipeline_high_luminance_region_extraction = std::make_unique<ProgramPipeline>(
@@ -155,12 +168,6 @@ void MyWindow::Setup()
             rm.GetResource<Program>("assets/shaders/streak.fs")})
             );
 
-    pipeline_tonemapping = std::make_unique<ProgramPipeline>(
-        ProgramPipeline::ProgramPtrSet({
-            rm.GetResource<Program>("assets/shaders/tonemapping.vs"),
-            rm.GetResource<Program>("assets/shaders/tonemapping.fs")})
-            );
-
     pipeline_apply = std::make_unique<ProgramPipeline>(
         ProgramPipeline::ProgramPtrSet({
             rm.GetResource<Program>("assets/shaders/apply.vs"),
@@ -171,19 +178,42 @@ void MyWindow::Setup()
     lum_soft_threshold = 0.5f;
     lum_hard_threshold = 1.0f;
     average_luminance = 0.0f;
+    low_percentile = 0.1f;
+    high_percentile = 0.9f;
     is_bloom_enabled = false;
     is_streak_enabled = false;
     is_debug_enabled = false;
     is_tonemapping_enabled = true;
+    is_clipping_enabled = false;
+    is_lut_enabled = true;
     is_auto_exposure_enabled = true;
+
+    // The histogram is cleared by the pass that consumes it.
+    {
+        const std::array<GLuint, 256> bins = {};
+        glCreateBuffers(1, &histogram_buffer);
+        glNamedBufferStorage(histogram_buffer, sizeof(bins), bins.data(), 0);
+    }
+    {
+        const GLfloat values[] = { exposure, average_luminance };
+        glCreateBuffers(1, &exposure_buffer);
+        glNamedBufferStorage(exposure_buffer, sizeof(values), values, GL_DYNAMIC_STORAGE_BIT);
+    }
 }
 
 void MyWindow::Cleanup()
 {
+    // The pending reads refer to this window.
+    System::GetMutableInstance().GetReadback().Finish();
+
     if(glIsSampler(nearest_sampler))
         glDeleteSamplers(1, &nearest_sampler);
     if(glIsSampler(linear_sampler))
         glDeleteSamplers(1, &linear_sampler);
+    if(glIsBuffer(histogram_buffer))
+        glDeleteBuffers(1, &histogram_buffer);
+    if(glIsBuffer(exposure_buffer))
+        glDeleteBuffers(1, &exposure_buffer);
 }
 
 void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -228,14 +258,6 @@ void MyWindow::OnResizeWindow(GLFWwindow* window, int width, int height)
 void MyWindow::OnUpdate(double dt)
 {
     System::GetMutableInstance().GetCamera().Update(dt);
-
-    // Determine an exposure value automatically.
-    if(is_auto_exposure_enabled)
-    {
-        const float key_value = 0.18f;
-        auto target_exposure = key_value / std::max(average_luminance, 0.00001f);
-        exposure += (target_exposure - exposure) * 0.1f;
-    }
 }
 
 void MyWindow::OnRender()
@@ -251,6 +273,12 @@ void MyWindow::OnRender()
     glViewport(0, 0, width, height);
     //
 
+    // The exposure is adapted on the GPU unless it is set from the UI.
+    // Both the extraction and the tone mapping read it from this binding.
+    if(!is_auto_exposure_enabled)
+        glNamedBufferSubData(exposure_buffer, 0, sizeof(exposure), &exposure);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, exposure_buffer);
+
     // 1) Render scene to texture.
     auto& rm = System::GetConstInstance().GetResourceManager();
     auto& filepath = selectable_textures[selected_texture_index];
@@ -284,19 +312,11 @@ void MyWindow::OnRender()
         PassStreak(high_luminance_region_rt.get(), output_rt);
 
     // 5) Mesure an average luminance of the scene for automatic exposure.
-    average_luminance = ComputeAverageLuminance(output_rt);
+    if(is_auto_exposure_enabled)
+        PassAutoExposure(output_rt);
 
-    // 6) Render HDR to LDR using tone mapping.
-    if(is_tonemapping_enabled)
-    {
-        PassTonemapping(output_rt);
-    }
-    else
-    {
-        glEnable(GL_FRAMEBUFFER_SRGB);
-        PassApply(output_rt);   // Render HDR to LDR directly.
-        glDisable(GL_FRAMEBUFFER_SRGB);
-    }
+    // 6) Render HDR to LDR using tone mapping, or directly when it is disabled.
+    PassPostEffect(output_rt);
 
     // Display debug information.
     {
@@ -310,7 +330,8 @@ void MyWindow::OnRender()
 
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 0.5f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
@@ -337,17 +358,25 @@ void MyWindow::RecreateResources(int width, int height)
 
         return std::make_unique<FrameBuffer>(texture, 0, 0);
     };
+    auto recreate_view_fb = [](const std::string& name, const std::string& origin_name, GLuint level)
+    {
+        auto& rm = System::GetMutableInstance().GetResourceManager();
+
+        rm.RemoveResource<Texture>(name);
+
+        auto p = std::make_unique<Texture>(*rm.GetResource<Texture>(origin_name), level);
+        auto texture = p->GetTexture();
+
+        rm.AddResource<Texture>(name, std::move(p));
+
+        return std::make_unique<FrameBuffer>(texture, 0, 0);
+    };
 
     // for scene.
     {
         const auto name = std::string("scene_rt_color");
         scene_rt = recreate_fb(name, 1, GL_RGBA16F, width, height);
     }
-    // for luminance.
-    {
-        const auto name = std::string("luminance_rt_color");
-        luminance_rt = recreate_fb(name, 0, GL_R16F, width, height);
-    }
     // for debug.
     {
         const auto name = std::string("debug_rt_color");
@@ -355,36 +384,50 @@ void MyWindow::RecreateResources(int width, int height)
     }
 
     // for high luminance region.
+    // The mip chain is generated in a single pass and each level is rendered to through a view.
+    GLsizei num_of_levels;
     {
         auto ds_width = width / 4;
         auto ds_height = height / 4;
+        num_of_levels = std::min(bloom_num_of_levels, Texture::CalcNumOfMipmapLevels(ds_width, ds_height));
 
         const auto name = std::string("high_luminance_region_rt_color");
-        high_luminance_region_rt = recreate_fb(name, 1, GL_RGBA16F, ds_width, ds_height);
+        high_luminance_region_rt = recreate_fb(name, num_of_levels, GL_RGBA16F, ds_width, ds_height);
     }
     // for bloom.
+    // Blur passes ping-pong between two chains, the high luminance region is still read by the streak.
     {
         std::stringstream ss;
 
         auto ds_width = width / 4;
         auto ds_height = height / 4;
 
+        for(auto i = 0; i < 2; i++)
+        {
+            auto& rm = System::GetMutableInstance().GetResourceManager();
+            ss << "bloom_blur_rt_color_" << i;
+            rm.RemoveResource<Texture>(ss.str());
+            rm.AddResource<Texture>(ss.str(), std::make_unique<Texture>(num_of_levels, GL_RGBA16F, ds_width, ds_height));
+            ss.str("");
+            ss.clear(std::stringstream::goodbit);
+        }
+
         bloom_rts.clear();
 
-        for(auto i = 0; i < 5; i++)
+        for(auto i = 0; i < num_of_levels; i++)
         {
             ss << "bloom_rts_color_" << i << "_" << 0;
-            auto bloom_rt_0 = recreate_fb(ss.str(), 1, GL_RGBA16F, ds_width, ds_height);
+            auto bloom_rt_0 = recreate_view_fb(ss.str(), "high_luminance_region_rt_color", i);
             ss.str("");
             ss.clear(std::stringstream::goodbit);
 
             ss << "bloom_rts_color_" << i << "_" << 1;
-            auto bloom_rt_1 = recreate_fb(ss.str(), 1, GL_RGBA16F, ds_width, ds_height);
+            auto bloom_rt_1 = recreate_view_fb(ss.str(), "bloom_blur_rt_color_0", i);
             ss.str("");
             ss.clear(std::stringstream::goodbit);
 
             ss << "bloom_rts_color_" << i << "_" << 2;
-            auto bloom_rt_2 = recreate_fb(ss.str(), 1, GL_RGBA16F, ds_width, ds_height);
+            auto bloom_rt_2 = recreate_view_fb(ss.str(), "bloom_blur_rt_color_1", i);
             ss.str("");
             ss.clear(std::stringstream::goodbit);
 
@@ -393,9 +436,6 @@ void MyWindow::RecreateResources(int width, int height)
                 std::move(bloom_rt_1),
                 std::move(bloom_rt_2)
                 });
-
-            ds_width /= 2;
-            ds_height /= 2;
         }
     }
     // for streak.
@@ -442,60 +482,72 @@ void MyWindow::DrawFullScreenQuad(GLuint texture)
     pipeline_fullscreen_quad->Unbind();
 }
 
-float MyWindow::ComputeAverageLuminance(FrameBuffer* input)
+void MyWindow::PassAutoExposure(FrameBuffer* input)
 {
-    PassLogLuminance(input, luminance_rt.get());
-    luminance_rt->UpdateAllMipmapLevels();
+    // log2 luminance range covered by the histogram.
+    constexpr float min_log_luminance = -10.0f;
+    constexpr float max_log_luminance = 10.0f;
+    constexpr float key_value = 0.18f;
+    // Close to the former adaptation of 10% per 1/120 sec update.
+    constexpr double adaptation_speed = 12.6;
 
-    float result = 0.0f;
+    auto texture = input->GetColorTexture();
+    GLint width, height;
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
 
-    auto texture = luminance_rt->GetColorTexture();
-    if(!glIsTexture(texture))
-        return result;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, histogram_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, exposure_buffer);
 
-    GLint prev_texture;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
-
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    GLint max_level;
-    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &max_level);
-
-    GLushort pixel;
-    glGetTexImage(GL_TEXTURE_2D, max_level, GL_RED, GL_HALF_FLOAT, &pixel);
-    result = hasenpfote::ConvertHalfToSingle(pixel);
-    result = std::exp(result);
-
-    glBindTexture(GL_TEXTURE_2D, prev_texture);
-
-    return result;
-}
-
-void MyWindow::PassLogLuminance(FrameBuffer* input, FrameBuffer* output)
-{
-    output->Bind();
+    // 1) Build a histogram of the log luminance.
     {
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
-
-        auto& uniform = pipeline_log_luminance->GetPipelineUniform();
+        auto& uniform = pipeline_luminance_histogram->GetPipelineUniform();
         uniform.Set("u_tex0", 0);
-        uniform.Set("u_pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
+        uniform.Set("u_min_log_luminance", min_log_luminance);
+        uniform.Set("u_inv_log_luminance_range", 1.0f / (max_log_luminance - min_log_luminance));
 
-        pipeline_log_luminance->Bind();
+        pipeline_luminance_histogram->Bind();
         {
             glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
-            glBindSampler(0, linear_sampler);
+            glBindTexture(GL_TEXTURE_2D, texture);
 
-            fs_quad->Draw();
+            glDispatchCompute(static_cast<GLuint>(width + 15) / 16, static_cast<GLuint>(height + 15) / 16, 1);
 
-            glBindSampler(0, 0);
             glBindTexture(GL_TEXTURE_2D, 0);
         }
-        pipeline_log_luminance->Unbind();
+        pipeline_luminance_histogram->Unbind();
     }
-    output->Unbind();
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 2) Average the bins between the percentiles and adapt the exposure toward it.
+    {
+        const auto dt = 1.0 / std::max(GetFPS(), 1.0);
+
+        auto& uniform = pipeline_average_luminance->GetPipelineUniform();
+        uniform.Set("u_min_log_luminance", min_log_luminance);
+        uniform.Set("u_log_luminance_range", max_log_luminance - min_log_luminance);
+        uniform.Set("u_low_percentile", low_percentile);
+        uniform.Set("u_high_percentile", high_percentile);
+        uniform.Set("u_key_value", key_value);
+        uniform.Set("u_adaptation", static_cast<float>(1.0 - std::exp(-dt * adaptation_speed)));
+
+        pipeline_average_luminance->Bind();
+        glDispatchCompute(1, 1, 1);
+        pipeline_average_luminance->Unbind();
+    }
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+
+    // Only shown in the UI, so a few frames of latency do not matter.
+    auto& readback = System::GetMutableInstance().GetReadback();
+    readback.Read(exposure_buffer, 0, sizeof(GLfloat) * 2, [this](const void* data, GLsizeiptr)
+    {
+        const auto values = static_cast<const GLfloat*>(data);
+        if(is_auto_exposure_enabled)
+            exposure = values[0];
+        average_luminance = values[1];
+    });
 }
 
 void MyWindow::PassHighLuminanceRegionExtraction(FrameBuffer* input, FrameBuffer* output)
@@ -508,7 +560,6 @@ void MyWindow::PassHighLuminanceRegionExtraction(FrameBuffer* input, FrameBuffer
         auto& uniform = pipeline_high_luminance_region_extraction->GetPipelineUniform();
         uniform.Set("u_tex0", 0);
         uniform.Set("u_pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
-        uniform.Set("u_exposure", exposure);
         uniform.Set("u_threshold", lum_hard_threshold);
         uniform.Set("u_soft_threshold", lum_soft_threshold);
 
@@ -613,20 +664,10 @@ void MyWindow::PassKawaseBlur(FrameBuffer* input, FrameBuffer* output, int itera
 void MyWindow::PassBloom(FrameBuffer* input, FrameBuffer* output)
 {
     // 1) ダウンサンプリング
-    {
-        auto last_rt = bloom_rts[0][0].get();
-        PassApply(input, last_rt);
+    downsampler->Generate(input->GetColorTexture(), static_cast<GLint>(bloom_rts.size()) - 1);
 
-        auto size = bloom_rts.size();
-        for(auto i = 1; i < size; i++)
-        {
-            auto src_rt = last_rt;
-            auto dst_rt = bloom_rts[i][0].get();
-            PassDownsampling2x2(src_rt, dst_rt);
-            last_rt = dst_rt;
-        }
-    }
     // 2) 各レベルにピンポンブラー
+    std::vector<FrameBuffer*> blurred_rts;
     {
         std::vector<int> kernel = { 0, 0 };
         const auto num_of_passes = kernel.size();
@@ -641,7 +682,7 @@ void MyWindow::PassBloom(FrameBuffer* input, FrameBuffer* output)
                 PassKawaseBlur(src_rt, dst_rt, kernel[i]);
                 last_rt = dst_rt;
             }
-            PassApply(last_rt, bloom_rt[0].get());
+            blurred_rts.push_back(last_rt);
         }
     }
     // 3) 各フィルタを合成
@@ -649,13 +690,13 @@ void MyWindow::PassBloom(FrameBuffer* input, FrameBuffer* output)
         glDepthMask(GL_FALSE);
         glEnable(GL_BLEND);
         glBlendFunc(GL_ONE, GL_ONE);
-        auto size = bloom_rts.size();
+        auto size = blurred_rts.size();
 
-        for(auto i = size - 1; i > i - 1; i--)
+        for(auto i = size - 1; i > 0; i--)
         {
-            PassApply(bloom_rts[i][0].get(), bloom_rts[i-1][0].get());
+            PassApply(blurred_rts[i], blurred_rts[i - 1]);
         }
-        PassApply(bloom_rts[0][0].get(), output);
+        PassApply(blurred_rts[0], output);
 
         glDisable(GL_BLEND);
         glDepthMask(GL_TRUE);
@@ -737,34 +778,24 @@ void MyWindow::PassStreak(FrameBuffer* input, FrameBuffer* output, float dx, flo
     output->Unbind();
 }
 
-void MyWindow::PassTonemapping(FrameBuffer* input, FrameBuffer* output)
+void MyWindow::PassPostEffect(FrameBuffer* input, FrameBuffer* output)
 {
-    if(output != nullptr)
-        output->Bind();
-
-    GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
-
-    auto& uniform = pipeline_tonemapping->GetPipelineUniform();
-    uniform.Set("u_tex0", 0);
-    uniform.Set("u_pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
-    uniform.Set("u_exposure", exposure);
-
-    pipeline_tonemapping->Bind();
-    {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
-        glBindSampler(0, linear_sampler);
-
-        fs_quad->Draw();
-
-        glBindSampler(0, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-    pipeline_tonemapping->Unbind();
+    // A grade changed from the UI is baked in the background, the previous LUT is used until then.
+    color_lut->SetGrade(grade);
+    color_lut->Update();
+
+    // The stages run as one pass, so the HDR image is read once and the output written once.
+    FusedPostEffect::Stages stages;
+    if(!is_tonemapping_enabled)
+        stages = FusedPostEffect::SRGBEncode;
+    else if(is_lut_enabled)
+        stages = FusedPostEffect::ExposureBuffer | FusedPostEffect::Lut;
+    else
+        stages = FusedPostEffect::ExposureBuffer | FusedPostEffect::ACES | FusedPostEffect::SRGBEncode;
+    if(is_clipping_enabled)
+        stages |= FusedPostEffect::ClippingOverlay;
 
-    if(output != nullptr)
-        output->Unbind();
+    post_effect->Execute(stages, input->GetColorTexture(), linear_sampler, 0, output);
 }
 
 void MyWindow::PassApply(FrameBuffer* input, FrameBuffer* output)
@@ -902,6 +933,8 @@ void MyWindow::OnGUI()
             {
                 ImGui::Text(oss2s(std::ostringstream() << "average_luminance: " << average_luminance).c_str());
                 ImGui::Text(oss2s(std::ostringstream() << "exposure: " << exposure).c_str());
+                ImGui::SliderFloat("low_percentile", &low_percentile, 0.0f, high_percentile);
+                ImGui::SliderFloat("high_percentile", &high_percentile, low_percentile, 1.0f);
             }
             else
             {
@@ -913,6 +946,20 @@ void MyWindow::OnGUI()
             ImGui::Checkbox("streak", &is_streak_enabled);
             ImGui::Checkbox("debug", &is_debug_enabled);
             ImGui::Checkbox("tonemapping", &is_tonemapping_enabled);
+            if(is_tonemapping_enabled)
+            {
+                // The grade is only applied through the LUT.
+                ImGui::Checkbox("lut", &is_lut_enabled);
+                if(is_lut_enabled)
+                {
+                    ImGui::SliderFloat("contrast", &grade.contrast, 0.5f, 2.0f);
+                    ImGui::SliderFloat("saturation", &grade.saturation, 0.0f, 2.0f);
+                    ImGui::ColorEdit3("gain", &grade.gain.x);
+                    ImGui::Text(color_lut->IsBaking() ? "lut: baking" : "lut: ready");
+                }
+            }
+            ImGui::Checkbox("clipping", &is_clipping_enabled);
+            ImGui::Text(oss2s(std::ostringstream() << "post_effect_permutations: " << post_effect->GetNumOfPermutations()).c_str());
         }
     }
     ImGui::End();
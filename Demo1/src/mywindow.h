@@ -7,9 +7,13 @@
 #include "../../common/system.h"
 #include "../../common/render/texture.h"
 #include "../../common/render/framebuffer.h"
+#include "../../common/render/color_lut.h"
 #include "../../common/render/fullscreen_quad.h"
+#include "../../common/render/fused_post_effect.h"
+#include "../../common/render/single_pass_downsampler.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 
 class MyWindow final : public common::Window
 {
@@ -21,8 +25,13 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
     using FullScreenQuad = common::render::FullScreenQuad;
+    using SinglePassDownsampler = common::render::SinglePassDownsampler;
+    using FusedPostEffect = common::render::FusedPostEffect;
+    using ColorLut = common::render::ColorLut;
+    using Readback = common::render::Readback;
 
 public:
     MyWindow();
@@ -47,8 +56,7 @@ private:
 
     void DrawFullScreenQuad(GLuint texture);
 
-    float ComputeAverageLuminance(FrameBuffer* input);
-    void PassLogLuminance(FrameBuffer* input, FrameBuffer* output);
+    void PassAutoExposure(FrameBuffer* input);
     void PassHighLuminanceRegionExtraction(FrameBuffer* input, FrameBuffer* output);
     void PassDownsampling2x2(FrameBuffer* input, FrameBuffer* output);
     void PassDownsampling4x4(FrameBuffer* input, FrameBuffer* output);
@@ -56,42 +64,52 @@ private:
     void PassBloom(FrameBuffer* input, FrameBuffer* output);
     void PassStreak(FrameBuffer* input, FrameBuffer* output);
     void PassStreak(FrameBuffer* input, FrameBuffer* output, float dx, float dy, float attenuation, int pass);
-    void PassTonemapping(FrameBuffer* input, FrameBuffer* output = nullptr);
+    void PassPostEffect(FrameBuffer* input, FrameBuffer* output = nullptr);
     void PassApply(FrameBuffer* input, FrameBuffer* output = nullptr);
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     std::unique_ptr<FullScreenQuad> fs_quad;
+    std::unique_ptr<SinglePassDownsampler> downsampler;
+    std::unique_ptr<FusedPostEffect> post_effect;
+    std::unique_ptr<ColorLut> color_lut;
     GLuint nearest_sampler;
     GLuint linear_sampler;
+    GLuint histogram_buffer;
+    GLuint exposure_buffer;
 
     std::vector<std::filesystem::path> selectable_textures;
     int selected_texture_index;
 
     std::unique_ptr<ProgramPipeline> pipeline_fullscreen_quad;
-    std::unique_ptr<ProgramPipeline> pipeline_log_luminance;
+    std::unique_ptr<ProgramPipeline> pipeline_luminance_histogram;
+    std::unique_ptr<ProgramPipeline> pipeline_average_luminance;
     std::unique_ptr<ProgramPipeline> pipeline_high_luminance_region_extraction;
     std::unique_ptr<ProgramPipeline> pipeline_downsampling_2x2;
     std::unique_ptr<ProgramPipeline> pipeline_downsampling_4x4;
     std::unique_ptr<ProgramPipeline> pipeline_kawase_blur;
     std::unique_ptr<ProgramPipeline> pipeline_streak;
-    std::unique_ptr<ProgramPipeline> pipeline_tonemapping;
     std::unique_ptr<ProgramPipeline> pipeline_apply;
 
     std::unique_ptr<FrameBuffer> scene_rt;
-    std::unique_ptr<FrameBuffer> luminance_rt;
     std::unique_ptr<FrameBuffer> debug_rt;
     std::unique_ptr<FrameBuffer> high_luminance_region_rt;
     std::vector<std::array<std::unique_ptr<FrameBuffer>, 3>> bloom_rts;
     std::array<std::unique_ptr<FrameBuffer>, 3> streak_rts;
 
     float exposure;
+    ColorLut::Grade grade;
     float lum_soft_threshold;
     float lum_hard_threshold;
     float average_luminance;
+    float low_percentile;
+    float high_percentile;
     bool is_bloom_enabled;
     bool is_streak_enabled;
     bool is_debug_enabled;
     bool is_tonemapping_enabled;
+    bool is_clipping_enabled;
+    bool is_lut_enabled;
     bool is_auto_exposure_enabled;
 };
\ No newline at end of file
@@ -1,6 +1,9 @@
 ﻿#include <iomanip>
 #include <sstream>
 #include <map>
+#include <chrono>
+#include <algorithm>
+#include <thread>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -20,6 +23,16 @@ const std::vector<std::tuple<std::string, std::size_t>> dither_settings =
     std::make_tuple<std::string, std::size_t>("bayer_256x256", 8),
 };
 
+// Names, sizes and numbers of layers of the blue noise masks, generated on the first run and cached as textures.
+// Generating them takes seconds, so it runs in the background and each mask becomes selectable once it is ready.
+const std::vector<std::tuple<std::string, std::size_t, std::size_t>> blue_noise_settings =
+{
+    std::make_tuple<std::string, std::size_t, std::size_t>("blue_noise_64x64", 64, 1),
+    std::make_tuple<std::string, std::size_t, std::size_t>("blue_noise_128x128", 128, 1),
+    std::make_tuple<std::string, std::size_t, std::size_t>("blue_noise_256x256", 256, 1),
+    std::make_tuple<std::string, std::size_t, std::size_t>("blue_noise_64x64x16", 64, 16),
+};
+
 MyWindow::MyWindow()
 {
     LOG_D(__func__);
@@ -81,6 +94,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "../common/assets/fonts/test.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 0.5f);
         text->SetSmoothness(1.0f);
     }
     //
@@ -123,11 +137,30 @@ void MyWindow::Setup()
             glBindTexture(GL_TEXTURE_2D, texture);
             glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, dim, dim, GL_RED, GL_UNSIGNED_BYTE, temp.data());
             glBindTexture(GL_TEXTURE_2D, 0);
+
+            selectable_dithers.emplace_back(name, 1);
+        }
+
+        // The masks are generated side by side, so each one gets a share of the threads rather than all of them.
+        const auto num_of_threads = std::max(1u, std::thread::hardware_concurrency() / static_cast<unsigned int>(blue_noise_settings.size()));
+        for(const auto& [name, dim, depth] : blue_noise_settings)
+        {
+            const auto filepath = std::filesystem::path("assets/textures/blue_noise") / (name + ".png");
+            auto pixels = std::async(
+                std::launch::async,
+                [filepath, dim = dim, depth = depth, num_of_threads]()
+                {
+                    BlueNoiseGenerator generator(1.5f, 1.0f, num_of_threads);
+                    return generator.LoadOrGenerate(filepath, dim, dim, depth);
+                }
+            );
+            pending_blue_noise_masks.emplace_back(name, dim, depth, std::move(pixels));
         }
         selected_dither_setting_index = 0;
     }
 
     fs_quad = std::make_unique<FullScreenQuad>();
+    post_effect = std::make_unique<FusedPostEffect>(*fs_quad);
 
     glGenSamplers(1, &nearest_sampler);
     glSamplerParameteri(nearest_sampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -155,24 +188,17 @@ void MyWindow::Setup()
             rm.GetResource<Program>("assets/shaders/fullscreen_quad.fs")})
             );
 
-    pipeline_dithering = std::make_unique<ProgramPipeline>(
-        ProgramPipeline::ProgramPtrSet({
-            rm.GetResource<Program>("assets/shaders/dithering.vs"),
-            rm.GetResource<Program>("assets/shaders/dithering.fs")})
-            );
-
-    pipeline_apply = std::make_unique<ProgramPipeline>(
-        ProgramPipeline::ProgramPtrSet({
-            rm.GetResource<Program>("assets/shaders/apply.vs"),
-            rm.GetResource<Program>("assets/shaders/apply.fs")})
-            );
-
     is_dithering_enabled = false;
     dithering_mode = 0;
+    quantization_bits = 1;
+    frame = 0;
 }
 
 void MyWindow::Cleanup()
 {
+    // Waits for the masks still being generated.
+    pending_blue_noise_masks.clear();
+
     if(glIsSampler(nearest_sampler))
         glDeleteSamplers(1, &nearest_sampler);
     if(glIsSampler(linear_sampler))
@@ -216,13 +242,13 @@ void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int
     }
     if(key == GLFW_KEY_F2 && action == GLFW_PRESS)
     {
-        if(is_dithering_enabled && !dither_settings.empty())
+        if(is_dithering_enabled && !selectable_dithers.empty())
         {
             selected_dither_setting_index += (mods == GLFW_MOD_SHIFT) ? -1 : 1;
             if(selected_dither_setting_index < 0)
-                selected_dither_setting_index = dither_settings.size() - 1;
+                selected_dither_setting_index = selectable_dithers.size() - 1;
             else
-            if(selected_dither_setting_index >= dither_settings.size())
+            if(selected_dither_setting_index >= selectable_dithers.size())
                 selected_dither_setting_index = 0;
         }
     }
@@ -238,6 +264,18 @@ void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int
                 dithering_mode = 0;
         }
     }
+    if(key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        if(is_dithering_enabled)
+        {
+            quantization_bits += (mods == GLFW_MOD_SHIFT) ? -1 : 1;
+            if(quantization_bits < 1)
+                quantization_bits = 8;
+            else
+            if(quantization_bits > 8)
+                quantization_bits = 1;
+        }
+    }
 }
 
 void MyWindow::OnMouseMove(GLFWwindow* window, double xpos, double ypos)
@@ -280,6 +318,8 @@ void MyWindow::OnUpdate(double dt)
 
 void MyWindow::OnRender()
 {
+    AddFinishedBlueNoiseMasks();
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     auto& camera = System::GetConstInstance().GetCamera();
@@ -300,10 +340,7 @@ void MyWindow::OnRender()
     // 2) Dithering
     glEnable(GL_FRAMEBUFFER_SRGB);
 
-    if(is_dithering_enabled)
-        PassDithering(scene_rt.get());
-    else
-        PassApply(scene_rt.get());
+    PassDithering(scene_rt.get());
 
     glDisable(GL_FRAMEBUFFER_SRGB);
 
@@ -332,16 +369,22 @@ void MyWindow::OnRender()
         oss << "Dithering:" << ((is_dithering_enabled) ? "On" : "Off") << "(Toggle Dithering: t)";
         oss << "\n";
 
-        const auto& dither_setting = dither_settings[selected_dither_setting_index];
+        const auto& dither_setting = selectable_dithers[selected_dither_setting_index];
         oss << "Dithering Setting:" << selected_dither_setting_index << " - " << std::get<0>(dither_setting) << " ([Shift +] F2)";
+        if(!pending_blue_noise_masks.empty())
+            oss << " Generating " << pending_blue_noise_masks.size() << " blue noise masks...";
         oss << "\n";
 
         oss << "Dithering Mode:" << dithering_mode << " ([Shift +] F3)";
         oss << "\n";
 
+        oss << "Quantization:" << quantization_bits << "bit ([Shift +] F4)";
+        oss << "\n";
+
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 0.5f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
@@ -376,99 +419,69 @@ void MyWindow::RecreateResources(int width, int height)
     }
 }
 
-void MyWindow::DrawFullScreenQuad(GLuint texture)
+void MyWindow::AddFinishedBlueNoiseMasks()
 {
-    pipeline_fullscreen_quad->GetPipelineUniform().Set("u_tex0", 0);
+    auto& rm = System::GetMutableInstance().GetResourceManager();
 
-    pipeline_fullscreen_quad->Bind();
+    auto it = pending_blue_noise_masks.begin();
+    while(it != pending_blue_noise_masks.end())
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glBindSampler(0, linear_sampler);
+        auto& [name, dim, depth, pixels] = *it;
+        if(pixels.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
 
-        fs_quad->Draw();
+        const auto data = pixels.get();
+        const auto w = static_cast<GLsizei>(dim);
+        const auto h = static_cast<GLsizei>(dim * depth);
+        auto p = std::make_unique<Texture>(GL_R8, w, h);
+        glTextureSubImage2D(p->GetTexture(), 0, 0, 0, w, h, GL_RED, GL_UNSIGNED_BYTE, data.data());
+        rm.AddResource<Texture>(name, std::move(p));
 
-        glBindSampler(0, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        selectable_dithers.emplace_back(name, static_cast<GLint>(depth));
+        it = pending_blue_noise_masks.erase(it);
     }
-    pipeline_fullscreen_quad->Unbind();
 }
 
-void MyWindow::PassDithering(FrameBuffer* input, FrameBuffer* output)
+void MyWindow::DrawFullScreenQuad(GLuint texture)
 {
-    if(output != nullptr)
-        output->Bind();
-
-    GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
+    pipeline_fullscreen_quad->GetPipelineUniform().Set("u_tex0", 0);
 
-    //
-    //dither_setting_index
-    const auto& dither_setting = dither_settings[selected_dither_setting_index];
-    const auto& name = std::get<0>(dither_setting);
-    const auto level = std::get<1>(dither_setting);
-    const auto dim = static_cast<std::size_t>(std::pow(2.0f, level));
-
-    auto& rm = System::GetConstInstance().GetResourceManager();
-    const auto dither_texture = rm.GetResource<Texture>(name)->GetTexture();
-
-    auto& uniform = pipeline_dithering->GetPipelineUniform();
-    uniform.Set("u_tex0", 0);
-    uniform.Set("u_tex1", 1);
-    uniform.Set("u_pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
-    uniform.Set("u_dimension", static_cast<float>(dim));
-    uniform.Set("u_mode", dithering_mode);
-
-    pipeline_dithering->Bind();
+    pipeline_fullscreen_quad->Bind();
     {
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, dither_texture);
-        glBindSampler(0, nearest_sampler);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
-        glBindSampler(1, linear_sampler);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindSampler(0, linear_sampler);
 
         fs_quad->Draw();
 
-        glBindSampler(1, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-
-        glActiveTexture(GL_TEXTURE0);
         glBindSampler(0, 0);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
-    pipeline_dithering->Unbind();
-
-    if(output != nullptr)
-        output->Unbind();
+    pipeline_fullscreen_quad->Unbind();
 }
 
-void MyWindow::PassApply(FrameBuffer* input, FrameBuffer* output)
+void MyWindow::PassDithering(FrameBuffer* input, FrameBuffer* output)
 {
-    if(output != nullptr)
-        output->Bind();
-
-    GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
-
-    auto& uniform = pipeline_apply->GetPipelineUniform();
-    uniform.Set("u_tex0", 0);
-    uniform.Set("u_pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
-
-    pipeline_apply->Bind();
+    // Without dithering no stage is enabled and the input is copied as is.
+    FusedPostEffect::Stages stages = 0;
+    GLuint dither_texture = 0;
+    if(is_dithering_enabled)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
-        glBindSampler(0, linear_sampler);
+        const auto& [name, num_of_layers] = selectable_dithers[selected_dither_setting_index];
+        auto& rm = System::GetConstInstance().GetResourceManager();
+        dither_texture = rm.GetResource<Texture>(name)->GetTexture();
 
-        fs_quad->Draw();
+        // A spatio-temporal mask moves on to its next layer every frame.
+        post_effect->SetDitherLayer(frame++ % num_of_layers, num_of_layers);
+        post_effect->SetQuantizationLevels(static_cast<float>((1 << quantization_bits) - 1));
 
-        glBindSampler(0, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        stages |= FusedPostEffect::Dither;
+        if(dithering_mode == 1)
+            stages |= FusedPostEffect::Luminance;
     }
-    pipeline_apply->Unbind();
 
-    if(output != nullptr)
-        output->Unbind();
+    post_effect->Execute(stages, input->GetColorTexture(), linear_sampler, dither_texture, output);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <memory>
 #include <filesystem>
+#include <future>
 #include <vector>
 #include <array>
 #include <tuple>
@@ -10,8 +11,11 @@
 #include "../../common/render/texture.h"
 #include "../../common/render/framebuffer.h"
 #include "../../common/render/fullscreen_quad.h"
+#include "../../common/render/fused_post_effect.h"
+#include "../../common/render/blue_noise_generator.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 
 class MyWindow final : public common::Window
 {
@@ -23,8 +27,11 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
     using FullScreenQuad = common::render::FullScreenQuad;
+    using FusedPostEffect = common::render::FusedPostEffect;
+    using BlueNoiseGenerator = common::render::BlueNoiseGenerator;
 
 public:
     MyWindow();
@@ -45,15 +52,17 @@ private:
     void OnRender() override;
 
     void RecreateResources(int width, int height);
+    void AddFinishedBlueNoiseMasks();
 
     void DrawFullScreenQuad(GLuint texture);
 
     void PassDithering(FrameBuffer* input, FrameBuffer* output = nullptr);
-    void PassApply(FrameBuffer* input, FrameBuffer* output = nullptr);
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     std::unique_ptr<FullScreenQuad> fs_quad;
+    std::unique_ptr<FusedPostEffect> post_effect;
     GLuint nearest_sampler;
     GLuint linear_sampler;
 
@@ -61,12 +70,17 @@ private:
     int selected_texture_index;
 
     std::unique_ptr<ProgramPipeline> pipeline_fullscreen_quad;
-    std::unique_ptr<ProgramPipeline> pipeline_dithering;
-    std::unique_ptr<ProgramPipeline> pipeline_apply;
 
     std::unique_ptr<FrameBuffer> scene_rt;
 
+    // Names of the dither textures and their number of layers, the Bayer matrices first.
+    std::vector<std::tuple<std::string, GLint>> selectable_dithers;
+    // Blue noise masks still being loaded or generated off the main thread, with their sizes and numbers of layers.
+    std::vector<std::tuple<std::string, std::size_t, std::size_t, std::future<std::vector<std::uint8_t>>>> pending_blue_noise_masks;
+
     bool is_dithering_enabled;
     int selected_dither_setting_index;
     int dithering_mode;
+    int quantization_bits;
+    GLint frame;
 };
\ No newline at end of file
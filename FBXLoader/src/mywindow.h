@@ -7,6 +7,7 @@
 #include "../../common/render/texture.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 #include "model.h"
 
 class MyWindow final : public common::Window
@@ -18,6 +19,7 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
 
 public:
@@ -40,6 +42,7 @@ private:
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     Model model;
     bool is_draw_joints_enabled = false;
     //ArcBall arcball;
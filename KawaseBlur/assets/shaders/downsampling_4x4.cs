@@ -0,0 +1,25 @@
+#version 430
+
+// Compute version of downsampling_4x4.fs.
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+uniform sampler2D texture0;
+uniform vec2 pixel_size;
+layout(rgba16f) uniform writeonly image2D image0;
+
+void main(void)
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if(any(greaterThanEqual(texel, imageSize(image0))))
+        return;
+
+    vec2 tex_coord = (vec2(texel) + 0.5) * pixel_size;
+
+    vec3 color0 = textureLodOffset(texture0, tex_coord, 0.0, ivec2(-2,  0)).xyz;
+    vec3 color1 = textureLodOffset(texture0, tex_coord, 0.0, ivec2( 2,  0)).xyz;
+    vec3 color2 = textureLodOffset(texture0, tex_coord, 0.0, ivec2( 0, -2)).xyz;
+    vec3 color3 = textureLodOffset(texture0, tex_coord, 0.0, ivec2( 0,  2)).xyz;
+
+    imageStore(image0, texel, vec4((color0 + color1 + color2 + color3) * 0.25, 1.0));
+}
\ No newline at end of file
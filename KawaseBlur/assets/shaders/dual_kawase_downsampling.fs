@@ -0,0 +1,22 @@
+#version 430
+
+out vec4 OutColor;
+
+uniform sampler2D texture0;
+uniform vec2 pixel_size;
+
+// Dual Kawase downsampling, the center and the four diagonal corners of the 2x2 source block.
+void main(void)
+{
+    vec2 tex_coord = gl_FragCoord.xy * pixel_size;
+    vec2 half_pixel_size = pixel_size * 0.5;
+
+    vec3 color = texture(texture0, tex_coord).rgb * 4.0;
+    color += texture(texture0, tex_coord + vec2(-half_pixel_size.x, -half_pixel_size.y)).rgb;
+    color += texture(texture0, tex_coord + vec2( half_pixel_size.x, -half_pixel_size.y)).rgb;
+    color += texture(texture0, tex_coord + vec2(-half_pixel_size.x,  half_pixel_size.y)).rgb;
+    color += texture(texture0, tex_coord + vec2( half_pixel_size.x,  half_pixel_size.y)).rgb;
+
+    OutColor.rgb = color * (1.0 / 8.0);
+    OutColor.a = 1.0;
+}
\ No newline at end of file
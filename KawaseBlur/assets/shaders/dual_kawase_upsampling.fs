@@ -0,0 +1,25 @@
+#version 430
+
+out vec4 OutColor;
+
+uniform sampler2D texture0;
+uniform vec2 pixel_size;
+
+// Dual Kawase upsampling, four taps on the axes and four diagonal taps with twice the weight.
+void main(void)
+{
+    vec2 tex_coord = gl_FragCoord.xy * pixel_size;
+    vec2 half_pixel_size = pixel_size * 0.5;
+
+    vec3 color = texture(texture0, tex_coord + vec2(-pixel_size.x, 0.0)).rgb;
+    color += texture(texture0, tex_coord + vec2( pixel_size.x, 0.0)).rgb;
+    color += texture(texture0, tex_coord + vec2(0.0, -pixel_size.y)).rgb;
+    color += texture(texture0, tex_coord + vec2(0.0,  pixel_size.y)).rgb;
+    color += texture(texture0, tex_coord + vec2(-half_pixel_size.x, -half_pixel_size.y)).rgb * 2.0;
+    color += texture(texture0, tex_coord + vec2( half_pixel_size.x, -half_pixel_size.y)).rgb * 2.0;
+    color += texture(texture0, tex_coord + vec2(-half_pixel_size.x,  half_pixel_size.y)).rgb * 2.0;
+    color += texture(texture0, tex_coord + vec2( half_pixel_size.x,  half_pixel_size.y)).rgb * 2.0;
+
+    OutColor.rgb = color * (1.0 / 12.0);
+    OutColor.a = 1.0;
+}
\ No newline at end of file
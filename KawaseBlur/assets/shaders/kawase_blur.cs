@@ -0,0 +1,94 @@
+#version 430
+
+// Runs up to MAX_ITERATIONS Kawase blur iterations in a single dispatch.
+// Each work group caches its tile and the halo the iterations reach in shared memory, then blurs there.
+// An iteration i averages four bilinear taps at (i + 0.5) texels, i.e. four 2x2 blocks, so after it
+// the valid part of the cached region shrinks by i + 1 texels on every side.
+// Reads are clamped to the image, which matches GL_CLAMP_TO_EDGE on the fragment path.
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+const int TILE_SIZE = 16;
+const int NUM_OF_THREADS = TILE_SIZE * TILE_SIZE;
+const int MAX_HALO = 12;
+const int MAX_REGION_SIZE = TILE_SIZE + MAX_HALO * 2;
+const int MAX_ITERATIONS = 8;
+
+uniform sampler2D texture0;
+layout(rgba16f) uniform writeonly image2D image0;
+uniform int num_of_iterations;
+uniform int iterations[MAX_ITERATIONS];
+
+// RGB in half floats, ping-ponged between iterations.
+shared uvec2 cache[2][MAX_REGION_SIZE * MAX_REGION_SIZE];
+
+int region_size;
+ivec2 region_origin;
+ivec2 image_size;
+
+vec3 load(int buffer, ivec2 texel)
+{
+    ivec2 p = clamp(texel, ivec2(0), image_size - 1) - region_origin;
+    uvec2 v = cache[buffer][p.y * region_size + p.x];
+    return vec3(unpackHalf2x16(v.x), unpackHalf2x16(v.y).x);
+}
+
+void store(int buffer, ivec2 texel, vec3 color)
+{
+    ivec2 p = texel - region_origin;
+    cache[buffer][p.y * region_size + p.x] = uvec2(packHalf2x16(color.rg), packHalf2x16(vec2(color.b, 0.0)));
+}
+
+vec3 block(int buffer, ivec2 texel)
+{
+    return load(buffer, texel) + load(buffer, texel + ivec2(1, 0)) + load(buffer, texel + ivec2(0, 1)) + load(buffer, texel + ivec2(1, 1));
+}
+
+void main(void)
+{
+    int halo = 0;
+    for(int i = 0; i < num_of_iterations; i++)
+        halo += iterations[i] + 1;
+
+    image_size = textureSize(texture0, 0);
+    region_size = TILE_SIZE + halo * 2;
+    region_origin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE - halo;
+    int thread = int(gl_LocalInvocationIndex);
+
+    for(int i = thread; i < region_size * region_size; i += NUM_OF_THREADS)
+    {
+        ivec2 texel = region_origin + ivec2(i % region_size, i / region_size);
+        store(0, texel, texelFetch(texture0, clamp(texel, ivec2(0), image_size - 1), 0).rgb);
+    }
+    memoryBarrierShared();
+    barrier();
+
+    int src = 0;
+    int border = 0;
+    for(int k = 0; k < num_of_iterations; k++)
+    {
+        int iteration = iterations[k];
+        border += iteration + 1;
+        int extent = region_size - border * 2;
+        for(int i = thread; i < extent * extent; i += NUM_OF_THREADS)
+        {
+            // Texels outside the image are never read, the reads are clamped.
+            ivec2 texel = region_origin + border + ivec2(i % extent, i / extent);
+            if(any(lessThan(texel, ivec2(0))) || any(greaterThanEqual(texel, image_size)))
+                continue;
+
+            vec3 color = block(src, texel + ivec2(-iteration - 1, -iteration - 1));
+            color += block(src, texel + ivec2(iteration, -iteration - 1));
+            color += block(src, texel + ivec2(-iteration - 1, iteration));
+            color += block(src, texel + ivec2(iteration, iteration));
+            store(1 - src, texel, color * (1.0 / 16.0));
+        }
+        memoryBarrierShared();
+        barrier();
+        src = 1 - src;
+    }
+
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if(all(lessThan(texel, image_size)))
+        imageStore(image0, texel, vec4(load(src, texel), 1.0));
+}
\ No newline at end of file
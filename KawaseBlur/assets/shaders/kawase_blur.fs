@@ -4,7 +4,7 @@ out vec4 OutColor;
 
 uniform sampler2D texture0;
 uniform vec2 pixel_size;
-uniform vec3 params;
+uniform float iteration;
 
 vec3 kawase_blur_filter(sampler2D tex, vec2 tex_coord, vec2 pixel_size, float iteration)
 {
@@ -41,8 +41,8 @@ vec3 kawase_blur_filter(sampler2D tex, vec2 tex_coord, vec2 pixel_size, float it
 
 void main(void)
 {
-    vec2 tex_coord = gl_FragCoord.xy * params.xy;
-    vec3 color = kawase_blur_filter(texture0, tex_coord, params.xy, params.z);
+    vec2 tex_coord = gl_FragCoord.xy * pixel_size;
+    vec3 color = kawase_blur_filter(texture0, tex_coord, pixel_size, iteration);
     OutColor.rgb = color;
     OutColor.a = 1.0;
 }
\ No newline at end of file
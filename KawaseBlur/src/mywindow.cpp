@@ -1,4 +1,5 @@
-﻿#include <iomanip>
+﻿#include <algorithm>
+#include <iomanip>
 #include <sstream>
 #include <memory>
 #include <unordered_map>
@@ -19,6 +20,33 @@ const std::unordered_map <std::string, std::vector<int>> shader_kernel =
     {"gaussian_127x127",    {0, 1, 2, 3, 4, 5, 7, 8, 9, 10}},
 };
 
+namespace
+{
+
+// Splits the kernel into passes. The fragment shader runs one iteration per pass, the compute shader
+// runs consecutive iterations in one dispatch while their halo fits in its shared memory.
+std::vector<std::vector<int>> split_into_passes(const std::vector<int>& kernel, bool fuse)
+{
+    constexpr int max_halo = 12;                // MAX_HALO in kawase_blur.cs
+    constexpr std::size_t max_iterations = 8;   // MAX_ITERATIONS in kawase_blur.cs
+
+    std::vector<std::vector<int>> passes;
+    int halo = 0;
+    for(auto iteration : kernel)
+    {
+        if(passes.empty() || !fuse || (halo + iteration + 1 > max_halo) || (passes.back().size() == max_iterations))
+        {
+            passes.emplace_back();
+            halo = 0;
+        }
+        passes.back().push_back(iteration);
+        halo += iteration + 1;
+    }
+    return passes;
+}
+
+}
+
 MyWindow::MyWindow()
 {
     LOG_D(__func__);
@@ -80,6 +108,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "../common/assets/fonts/test.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 0.5f);
         text->SetSmoothness(1.0f);
     }
 
@@ -118,21 +147,44 @@ void MyWindow::Setup()
             rm.GetResource<Program>("assets/shaders/downsampling_2x2.fs")})
             );
 
-    pipeline_downsampling_4x4 = std::make_unique<ProgramPipeline>(
-        ProgramPipeline::ProgramPtrSet({
-            rm.GetResource<Program>("assets/shaders/downsampling.vs"),
-            rm.GetResource<Program>("assets/shaders/downsampling_4x4.fs")})
-            );
-
-    pipeline_kawase_blur = std::make_unique<ProgramPipeline>(
-        ProgramPipeline::ProgramPtrSet({
-            rm.GetResource<Program>("assets/shaders/kawase_blur.vs"),
-            rm.GetResource<Program>("assets/shaders/kawase_blur.fs")})
-            );
+    pass_downsampling_4x4 = std::make_unique<ImagePass>(
+        *fs_quad,
+        rm.GetResource<Program>("assets/shaders/downsampling.vs"),
+        rm.GetResource<Program>("assets/shaders/downsampling_4x4.fs"),
+        rm.GetResource<Program>("assets/shaders/downsampling_4x4.cs")
+        );
+
+    pass_kawase_blur = std::make_unique<ImagePass>(
+        *fs_quad,
+        rm.GetResource<Program>("assets/shaders/kawase_blur.vs"),
+        rm.GetResource<Program>("assets/shaders/kawase_blur.fs"),
+        rm.GetResource<Program>("assets/shaders/kawase_blur.cs")
+        );
+
+    pass_dual_kawase_downsampling = std::make_unique<ImagePass>(
+        *fs_quad,
+        rm.GetResource<Program>("assets/shaders/downsampling.vs"),
+        rm.GetResource<Program>("assets/shaders/dual_kawase_downsampling.fs"),
+        nullptr
+        );
+
+    pass_dual_kawase_upsampling = std::make_unique<ImagePass>(
+        *fs_quad,
+        rm.GetResource<Program>("assets/shaders/downsampling.vs"),
+        rm.GetResource<Program>("assets/shaders/dual_kawase_upsampling.fs"),
+        nullptr
+        );
+
+    timer = std::make_unique<GpuTimer>();
+    tuner = std::make_unique<BlurTuner>();
 
     shader_kernel_name = "gaussian_7x7";
+    num_of_dual_kawase_levels = 1;
+    target_sigma = 6.0f;
 
     is_filter_enabled = false;
+    blur_mode = BlurMode::Kawase;
+    path = ImagePass::Path::Fragment;
 }
 
 void MyWindow::Cleanup()
@@ -160,39 +212,49 @@ void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int
             glEnable(GL_MULTISAMPLE);
         }
     }
-    if(key == GLFW_KEY_B && action == GLFW_PRESS)
+    if(key == GLFW_KEY_C && action == GLFW_PRESS)
     {
-        is_filter_enabled = !is_filter_enabled;
+        path = (path == ImagePass::Path::Fragment) ? ImagePass::Path::Compute : ImagePass::Path::Fragment;
     }
-    if(key == GLFW_KEY_1 && action == GLFW_PRESS)
+    if(key == GLFW_KEY_B && action == GLFW_PRESS)
     {
-        if(is_filter_enabled)
-            shader_kernel_name = "gaussian_7x7";
+        is_filter_enabled = !is_filter_enabled;
     }
-    if(key == GLFW_KEY_2 && action == GLFW_PRESS)
+    if(key == GLFW_KEY_K && action == GLFW_PRESS)
     {
-        if(is_filter_enabled)
-            shader_kernel_name = "gaussian_15x15";
+        if(blur_mode == BlurMode::Kawase)
+            blur_mode = BlurMode::DualKawase;
+        else if(blur_mode == BlurMode::DualKawase)
+            blur_mode = BlurMode::Auto;
+        else
+            blur_mode = BlurMode::Kawase;
     }
-    if(key == GLFW_KEY_3 && action == GLFW_PRESS)
+    if(key == GLFW_KEY_MINUS && action == GLFW_PRESS)
     {
         if(is_filter_enabled)
-            shader_kernel_name = "gaussian_23x23";
+            target_sigma = std::max(target_sigma - 0.5f, 0.5f);
     }
-    if(key == GLFW_KEY_4 && action == GLFW_PRESS)
+    if(key == GLFW_KEY_EQUAL && action == GLFW_PRESS)
     {
         if(is_filter_enabled)
-            shader_kernel_name = "gaussian_35x35";
+            target_sigma = std::min(target_sigma + 0.5f, 32.0f);
     }
-    if(key == GLFW_KEY_5 && action == GLFW_PRESS)
+
+    // Kernels for Kawase blur, levels for Dual Kawase blur.
+    static const std::array<std::string, 6> kernel_names =
     {
-        if(is_filter_enabled)
-            shader_kernel_name = "gaussian_63x63";
-    }
-    if(key == GLFW_KEY_6 && action == GLFW_PRESS)
+        "gaussian_7x7", "gaussian_15x15", "gaussian_23x23", "gaussian_35x35", "gaussian_63x63", "gaussian_127x127"
+    };
+    if(key >= GLFW_KEY_1 && key <= GLFW_KEY_6 && action == GLFW_PRESS)
     {
+        const auto index = key - GLFW_KEY_1;
         if(is_filter_enabled)
-            shader_kernel_name = "gaussian_127x127";
+        {
+            if(blur_mode == BlurMode::DualKawase)
+                num_of_dual_kawase_levels = std::min(index + 1, static_cast<int>(dual_kawase_rts.size()));
+            else
+                shader_kernel_name = kernel_names[static_cast<std::size_t>(index)];
+        }
     }
 }
 
@@ -251,6 +313,8 @@ void MyWindow::OnRender()
     DrawFullScreenQuad();
     scene_rt->Unbind();
 
+    timer->Begin();
+
     // 2) 1/4 x 1/4 ダウンサンプルを行う
     auto last_blur_rt = ds_rt_0.get();
     PassDownsampling(scene_rt.get(), last_blur_rt);
@@ -258,20 +322,23 @@ void MyWindow::OnRender()
     // 3) Kawase blur
     if(is_filter_enabled)
     {
-        auto it = shader_kernel.find(shader_kernel_name);
-        if(it != shader_kernel.cend())
+        if(blur_mode == BlurMode::Kawase)
+        {
+            auto it = shader_kernel.find(shader_kernel_name);
+            if(it != shader_kernel.cend())
+                last_blur_rt = PassKawaseBlur(last_blur_rt, it->second, path);
+        }
+        else if(blur_mode == BlurMode::DualKawase)
+        {
+            last_blur_rt = PassDualKawaseBlur(last_blur_rt, num_of_dual_kawase_levels);
+        }
+        else
         {
-            auto kernel = it->second;
-            const auto num_of_passes = kernel.size();
-            for(auto i = 0; i < num_of_passes; i++)
-            {
-                FrameBuffer* src_blur_rt = last_blur_rt;
-                FrameBuffer* dst_blur_rt = ((i % 2) == 0) ? ds_rt_1.get() : ds_rt_0.get();
-                PassKawaseBlur(src_blur_rt, dst_blur_rt, kernel[i]);
-                last_blur_rt = dst_blur_rt;
-            }
+            last_blur_rt = PassAutoBlur(last_blur_rt);
         }
     }
+
+    timer->End();
     // 4) 結果を表示
     glEnable(GL_FRAMEBUFFER_SRGB);
     PassApply(last_blur_rt);
@@ -295,12 +362,33 @@ void MyWindow::OnRender()
         oss << "MultiSample:" << ((ms == GL_TRUE) ? "On" : "Off") << "(Toggle MultiSample: m)";
         oss << "\n";
 
-        oss << "Kawase blur:" << ((is_filter_enabled == GL_TRUE) ? "On" : "Off") << "(Toggle Kawase blur: b)" << " " << shader_kernel_name;
+        oss << "Kawase blur:" << ((is_filter_enabled == GL_TRUE) ? "On" : "Off") << "(Toggle Kawase blur: b)" << " ";
+        if(blur_mode == BlurMode::Kawase)
+        {
+            oss << shader_kernel_name << " sigma=" << BlurTuner::CalcKawaseSigma(shader_kernel.at(shader_kernel_name));
+        }
+        else if(blur_mode == BlurMode::DualKawase)
+        {
+            oss << "dual_kawase_" << num_of_dual_kawase_levels << " sigma=" << BlurTuner::CalcDualKawaseSigma(num_of_dual_kawase_levels);
+        }
+        else
+        {
+            oss << "target sigma=" << target_sigma << "([-] / [=]) ";
+            oss << (tuner->IsTuning() ? std::string("tuning...") : tuned_blur_name);
+        }
+        oss << "\n";
+
+        oss << "Mode:" << ((blur_mode == BlurMode::Kawase) ? "Kawase" : (blur_mode == BlurMode::DualKawase) ? "Dual Kawase" : "Auto") << "(Cycle mode: k)";
+        oss << "\n";
+
+        oss << "Path:" << ((path == ImagePass::Path::Compute) ? "Compute" : "Fragment") << "(Toggle path: c)";
+        oss << " " << timer->GetElapsedTime() << "ms";
         oss << "\n";
 
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 0.5f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
@@ -327,6 +415,19 @@ void MyWindow::RecreateResources(int width, int height)
 
         return std::make_unique<FrameBuffer>(texture, 0, 0);
     };
+    auto recreate_view_fb = [](const std::string& name, const std::string& origin_name, GLuint level)
+    {
+        auto& rm = System::GetMutableInstance().GetResourceManager();
+
+        rm.RemoveResource<Texture>(name);
+
+        auto p = std::make_unique<Texture>(*rm.GetResource<Texture>(origin_name), level);
+        auto texture = p->GetTexture();
+
+        rm.AddResource<Texture>(name, std::move(p));
+
+        return std::make_unique<FrameBuffer>(texture, 0, 0);
+    };
 
     {
         const auto name = std::string("scene_rt_color");
@@ -337,6 +438,16 @@ void MyWindow::RecreateResources(int width, int height)
         auto ds_height = height / 4;
         ds_rt_0 = recreate_fb("ds_rt_0_color", 1, GL_RGBA16F, ds_width, ds_height);
         ds_rt_1 = recreate_fb("ds_rt_1_color", 1, GL_RGBA16F, ds_width, ds_height);
+
+        // The Dual Kawase pyramid starts at half the downsampled size.
+        const auto pyramid_width = std::max(ds_width / 2, 1);
+        const auto pyramid_height = std::max(ds_height / 2, 1);
+        const auto levels = std::min(max_dual_kawase_levels, Texture::CalcNumOfMipmapLevels(pyramid_width, pyramid_height));
+        dual_kawase_rts.clear();
+        recreate_fb("dual_kawase_rt_color", levels, GL_RGBA16F, pyramid_width, pyramid_height);
+        for(auto i = 0; i < levels; i++)
+            dual_kawase_rts.push_back(recreate_view_fb("dual_kawase_rt_color_" + std::to_string(i), "dual_kawase_rt_color", static_cast<GLuint>(i)));
+        num_of_dual_kawase_levels = std::min(num_of_dual_kawase_levels, levels);
     }
 }
 
@@ -359,54 +470,103 @@ void MyWindow::DrawFullScreenQuad()
 
 void MyWindow::PassDownsampling(FrameBuffer* input, FrameBuffer* output)
 {
-    output->Bind();
-    {
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
-
-        auto& uniform = pipeline_downsampling_4x4->GetPipelineUniform();
-        uniform.Set("texture0", 0);
-        uniform.Set("pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
-
-        pipeline_downsampling_4x4->Bind();
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
-            glBindSampler(0, sampler);
-
-            fs_quad->Draw();
+    pass_downsampling_4x4->Execute(path, input->GetColorTexture(), sampler, output);
+}
 
-            glActiveTexture(GL_TEXTURE0);
-        }
-        pipeline_downsampling_4x4->Unbind();
+MyWindow::FrameBuffer* MyWindow::PassKawaseBlur(FrameBuffer* input, const std::vector<int>& kernel, ImagePass::Path blur_path)
+{
+    // Ping-pongs between the downsampled targets, the input is overwritten.
+    auto last_blur_rt = input;
+    const auto passes = split_into_passes(kernel, blur_path == ImagePass::Path::Compute);
+    for(std::size_t i = 0; i < passes.size(); i++)
+    {
+        FrameBuffer* src_blur_rt = last_blur_rt;
+        FrameBuffer* dst_blur_rt = (src_blur_rt == ds_rt_1.get()) ? ds_rt_0.get() : ds_rt_1.get();
+        PassKawaseBlur(src_blur_rt, dst_blur_rt, passes[i], blur_path);
+        last_blur_rt = dst_blur_rt;
     }
-    output->Unbind();
+    return last_blur_rt;
 }
 
-void MyWindow::PassKawaseBlur(FrameBuffer* input, FrameBuffer* output, int iteration)
+void MyWindow::PassKawaseBlur(FrameBuffer* input, FrameBuffer* output, const std::vector<int>& iterations, ImagePass::Path blur_path)
 {
-    output->Bind();
+    if(blur_path == ImagePass::Path::Compute)
+    {
+        std::array<glm::ivec1, 8> values;
+        for(std::size_t i = 0; i < iterations.size(); i++)
+            values[i] = glm::ivec1(iterations[i]);
+        pass_kawase_blur->Set("num_of_iterations", static_cast<GLint>(iterations.size()));
+        pass_kawase_blur->Set("iterations", values.data(), iterations.size());
+    }
+    else
     {
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
+        pass_kawase_blur->Set("iteration", static_cast<float>(iterations.front()));
+    }
+    pass_kawase_blur->Execute(blur_path, input->GetColorTexture(), sampler, output);
+}
 
-        auto& uniform = pipeline_kawase_blur->GetPipelineUniform();
-        uniform.Set("texture0", 0);
-        uniform.Set("params", glm::vec3(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3]), static_cast<float>(iteration)));
+MyWindow::FrameBuffer* MyWindow::PassDualKawaseBlur(FrameBuffer* input, int num_of_levels)
+{
+    assert((num_of_levels > 0) && (static_cast<std::size_t>(num_of_levels) <= dual_kawase_rts.size()));
 
-        pipeline_kawase_blur->Bind();
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
-            glBindSampler(0, sampler);
+    // 1) Downsample through the pyramid.
+    auto last_blur_rt = input;
+    for(auto i = 0; i < num_of_levels; i++)
+    {
+        auto dst_blur_rt = dual_kawase_rts[static_cast<std::size_t>(i)].get();
+        pass_dual_kawase_downsampling->Execute(ImagePass::Path::Fragment, last_blur_rt->GetColorTexture(), sampler, dst_blur_rt);
+        last_blur_rt = dst_blur_rt;
+    }
+    // 2) Upsample back, each level is overwritten once it has been read.
+    for(auto i = num_of_levels - 1; i >= 0; i--)
+    {
+        auto dst_blur_rt = (i > 0) ? dual_kawase_rts[static_cast<std::size_t>(i - 1)].get() : ds_rt_1.get();
+        pass_dual_kawase_upsampling->Execute(ImagePass::Path::Fragment, last_blur_rt->GetColorTexture(), sampler, dst_blur_rt);
+        last_blur_rt = dst_blur_rt;
+    }
+    return last_blur_rt;
+}
 
-            fs_quad->Draw();
+MyWindow::FrameBuffer* MyWindow::PassAutoBlur(FrameBuffer* input)
+{
+    FrameBuffer* last_blur_rt = input;
 
-            glActiveTexture(GL_TEXTURE0);
+    std::vector<BlurTuner::Candidate> candidates;
+    for(const auto& entry : shader_kernel)
+    {
+        const auto& kernel = entry.second;
+        for(auto candidate_path : { ImagePass::Path::Fragment, ImagePass::Path::Compute })
+        {
+            const auto is_compute = candidate_path == ImagePass::Path::Compute;
+            candidates.push_back({
+                entry.first + (is_compute ? "(Compute)" : "(Fragment)"),
+                BlurTuner::CalcKawaseSigma(kernel),
+                [this, input, &kernel, candidate_path, &last_blur_rt]() { last_blur_rt = PassKawaseBlur(input, kernel, candidate_path); }
+                });
         }
-        pipeline_kawase_blur->Unbind();
     }
-    output->Unbind();
+    for(auto i = 1; i <= static_cast<int>(dual_kawase_rts.size()); i++)
+    {
+        candidates.push_back({
+            "dual_kawase_" + std::to_string(i),
+            BlurTuner::CalcDualKawaseSigma(i),
+            [this, input, i, &last_blur_rt]() { last_blur_rt = PassDualKawaseBlur(input, i); }
+            });
+    }
+
+    // The candidates overwrite the input while they are measured.
+    const auto was_tuning = tuner->IsTuning();
+    auto name = tuner->Tune(input->GetWidth(), input->GetHeight(), GL_RGBA16F, target_sigma, candidates);
+    if(!name || was_tuning)
+        PassDownsampling(scene_rt.get(), input);
+    if(!name)
+        return input;
+
+    tuned_blur_name = *name;
+    auto it = std::find_if(candidates.cbegin(), candidates.cend(), [&name](const auto& candidate){ return candidate.name == *name; });
+    assert(it != candidates.cend());
+    it->execute();
+    return last_blur_rt;
 }
 
 void MyWindow::PassApply(FrameBuffer* input, FrameBuffer* output)
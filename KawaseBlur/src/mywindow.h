@@ -1,12 +1,18 @@
 ﻿#pragma once
 #include <iostream>
+#include <array>
+#include <vector>
 #include "../../common/window.h"
 #include "../../common/system.h"
 #include "../../common/render/texture.h"
 #include "../../common/render/framebuffer.h"
 #include "../../common/render/fullscreen_quad.h"
+#include "../../common/render/blur_tuner.h"
+#include "../../common/render/gpu_timer.h"
+#include "../../common/render/image_pass.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 
 class MyWindow final : public common::Window
 {
@@ -18,8 +24,21 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
     using FullScreenQuad = common::render::FullScreenQuad;
+    using ImagePass = common::render::ImagePass;
+    using GpuTimer = common::render::GpuTimer;
+    using BlurTuner = common::render::BlurTuner;
+
+    enum class BlurMode
+    {
+        Kawase,
+        DualKawase,
+        Auto
+    };
+
+    static constexpr int max_dual_kawase_levels = 6;
 
 public:
     MyWindow();
@@ -43,26 +62,40 @@ private:
 
     void DrawFullScreenQuad();
     void PassDownsampling(FrameBuffer* input, FrameBuffer* output);
-    void PassKawaseBlur(FrameBuffer* input, FrameBuffer* output, int iteration);
+    FrameBuffer* PassKawaseBlur(FrameBuffer* input, const std::vector<int>& kernel, ImagePass::Path blur_path);
+    void PassKawaseBlur(FrameBuffer* input, FrameBuffer* output, const std::vector<int>& iterations, ImagePass::Path blur_path);
+    FrameBuffer* PassDualKawaseBlur(FrameBuffer* input, int num_of_levels);
+    FrameBuffer* PassAutoBlur(FrameBuffer* input);
     void PassApply(FrameBuffer* input, FrameBuffer* output = nullptr);
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     std::unique_ptr<FullScreenQuad> fs_quad;
     GLuint sampler;
     GLuint texture;
 
     std::unique_ptr<ProgramPipeline> pipeline_fullscreen_quad;
     std::unique_ptr<ProgramPipeline> pipeline_downsampling_2x2;
-    std::unique_ptr<ProgramPipeline> pipeline_downsampling_4x4;
-    std::unique_ptr<ProgramPipeline> pipeline_kawase_blur;
     std::unique_ptr<ProgramPipeline> pipeline_apply;
+    std::unique_ptr<ImagePass> pass_downsampling_4x4;
+    std::unique_ptr<ImagePass> pass_kawase_blur;
+    std::unique_ptr<ImagePass> pass_dual_kawase_downsampling;
+    std::unique_ptr<ImagePass> pass_dual_kawase_upsampling;
+    std::unique_ptr<GpuTimer> timer;
+    std::unique_ptr<BlurTuner> tuner;
 
     std::unique_ptr<FrameBuffer> scene_rt;
     std::unique_ptr<FrameBuffer> ds_rt_0;
     std::unique_ptr<FrameBuffer> ds_rt_1;
+    std::vector<std::unique_ptr<FrameBuffer>> dual_kawase_rts;
 
     std::string shader_kernel_name;
+    int num_of_dual_kawase_levels;
+    float target_sigma;
+    std::string tuned_blur_name;
 
     bool is_filter_enabled;
+    BlurMode blur_mode;
+    ImagePass::Path path;
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#version 430
+
+#define MAX_STREAKS 6
+#define NUM_SAMPLES 4
+
+// One output per direction, the final pass renders to a single target and only keeps the sum.
+layout(location = 0) out vec4 o_color[MAX_STREAKS];
+
+uniform sampler2D u_streaks[MAX_STREAKS];
+uniform vec2 u_pixel_size;
+uniform vec2 u_directions[MAX_STREAKS];
+uniform vec2 u_params;
+uniform int u_num_of_streaks;
+uniform int u_accumulate;
+
+vec3 steerable_streak_filter(sampler2D tex, vec2 tex_coord, vec2 pixel_size, vec2 dir, float attenuation, int pass)
+{
+    vec2 tex_coord_sample;
+    vec3 color = vec3(0.0, 0.0, 0.0);
+    float b = pow(NUM_SAMPLES, pass);
+    for(int s = 0; s < NUM_SAMPLES; s++)
+    {
+        float weight = clamp(pow(attenuation, b * s), 0.0, 1.0);
+        tex_coord_sample = tex_coord + (dir * b * s * pixel_size);
+        color += weight * texture(tex, tex_coord_sample).xyz;
+    }
+    return clamp(color, vec3(0.0, 0.0, 0.0), vec3(1.0, 1.0, 1.0));
+}
+
+void main(void)
+{
+    vec2 tex_coord = gl_FragCoord.xy * u_pixel_size.xy;
+    vec3 sum = vec3(0.0, 0.0, 0.0);
+    for(int i = 0; i < MAX_STREAKS; i++)
+    {
+        vec3 color = vec3(0.0, 0.0, 0.0);
+        if(i < u_num_of_streaks)
+            color = steerable_streak_filter(u_streaks[i], tex_coord, u_pixel_size, u_directions[i], u_params.x, int(u_params.y));
+        sum += color;
+        o_color[i] = vec4(color, 1.0);
+    }
+    if(u_accumulate != 0)
+        o_color[0] = vec4(sum, 1.0);
+}
\ No newline at end of file
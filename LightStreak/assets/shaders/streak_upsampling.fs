@@ -0,0 +1,42 @@
+#version 430
+
+out vec4 o_color;
+
+uniform sampler2D u_tex0;
+uniform sampler2D u_guide;
+uniform sampler2D u_low_guide;
+uniform vec2 u_pixel_size;
+uniform float u_sharpness;
+
+float luminance(vec3 color)
+{
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Joint bilateral upsampling, the bilinear weights of the low resolution texels are scaled down
+// where their luminance differs from the full resolution guide so that streaks keep the edges of light sources.
+void main(void)
+{
+    vec2 tex_coord = gl_FragCoord.xy * u_pixel_size.xy;
+    ivec2 size = textureSize(u_tex0, 0);
+    vec2 p = tex_coord * vec2(size) - 0.5;
+    ivec2 base = ivec2(floor(p));
+    vec2 f = p - vec2(base);
+
+    float guide = luminance(texture(u_guide, tex_coord).rgb);
+
+    vec3 color = vec3(0.0, 0.0, 0.0);
+    float total = 0.0;
+    for(int i = 0; i < 4; i++)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 q = clamp(base + offset, ivec2(0), size - 1);
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+        float d = abs(luminance(texelFetch(u_low_guide, q, 0).rgb) - guide) / (1.0 + guide);
+        float weight = bilinear.x * bilinear.y * max(exp(-u_sharpness * d), 0.001);
+        color += weight * texelFetch(u_tex0, q, 0).rgb;
+        total += weight;
+    }
+    o_color.rgb = color / total;
+    o_color.a = 1.0;
+}
\ No newline at end of file
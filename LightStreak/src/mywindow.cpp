@@ -79,6 +79,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "../common/assets/fonts/test.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 0.5f);
         text->SetSmoothness(1.0f);
     }
 
@@ -129,6 +130,18 @@ void MyWindow::Setup()
             rm.GetResource<Program>("assets/shaders/streak.fs")})
             );
 
+    pipeline_streak_fused = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/streak.vs"),
+            rm.GetResource<Program>("assets/shaders/streak_fused.fs")})
+            );
+
+    pipeline_streak_upsampling = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/streak.vs"),
+            rm.GetResource<Program>("assets/shaders/streak_upsampling.fs")})
+            );
+
     pipeline_high_luminance_region_extraction = std::make_unique<ProgramPipeline>(
         ProgramPipeline::ProgramPtrSet({
             rm.GetResource<Program>("assets/shaders/high_luminance_region_extraction.vs"),
@@ -138,6 +151,7 @@ void MyWindow::Setup()
     streak_filter_name = "4streaks × 2passes";
 
     is_filter_enabled = false;
+    is_fused_enabled = true;
 }
 
 void MyWindow::Cleanup()
@@ -169,6 +183,10 @@ void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int
     {
         is_filter_enabled = !is_filter_enabled;
     }
+    if(key == GLFW_KEY_F && action == GLFW_PRESS)
+    {
+        is_fused_enabled = !is_fused_enabled;
+    }
     if(key == GLFW_KEY_1 && action == GLFW_PRESS)
     {
         if(is_filter_enabled)
@@ -269,7 +287,12 @@ void MyWindow::OnRender()
 
     // 4) Streak の適用
     if(is_filter_enabled)
-        PassStreak(input_rt.get(), scene_rt.get());
+    {
+        if(is_fused_enabled)
+            PassStreakFused(input_rt.get(), scene_rt.get());
+        else
+            PassStreak(input_rt.get(), scene_rt.get());
+    }
 
     glEnable(GL_FRAMEBUFFER_SRGB);
     PassApply(scene_rt.get());
@@ -296,9 +319,20 @@ void MyWindow::OnRender()
         oss << "Streak:" << ((is_filter_enabled == GL_TRUE) ? "On" : "Off") << "(Toggle Streak: b)" << " " << streak_filter_name;
         oss << "\n";
 
+        {
+            auto it = streak_filter.find(streak_filter_name);
+            assert(it != streak_filter.cend());
+            const auto num_of_streaks = it->second[0];
+            const auto num_of_passes = it->second[1];
+            const auto num_of_draws = is_fused_enabled ? num_of_passes + 1 : num_of_streaks * (num_of_passes + 1) + 1;
+            oss << "Fused:" << (is_fused_enabled ? "On" : "Off") << "(Toggle Fused: f)" << " " << num_of_draws << "draws";
+            oss << "\n";
+        }
+
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 0.5f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
@@ -309,7 +343,7 @@ void MyWindow::OnRender()
 
 void MyWindow::RecreateResources(int width, int height)
 {
-    auto recreate_fb = [](const std::string& name, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
+    auto recreate_texture = [](const std::string& name, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
     {
         auto& rm = System::GetMutableInstance().GetResourceManager();
 
@@ -323,7 +357,11 @@ void MyWindow::RecreateResources(int width, int height)
 
         rm.AddResource<Texture>(name, std::move(p));
 
-        return std::make_unique<FrameBuffer>(texture, 0, 0);
+        return texture;
+    };
+    auto recreate_fb = [&recreate_texture](const std::string& name, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
+    {
+        return std::make_unique<FrameBuffer>(recreate_texture(name, levels, internal_format, width, height), 0, 0);
     };
 
     {
@@ -346,6 +384,18 @@ void MyWindow::RecreateResources(int width, int height)
 
         work_rts[0] = recreate_fb("work_rts_color_0", 1, GL_RGBA16F, ds_width, ds_height);
         work_rts[1] = recreate_fb("work_rts_color_1", 1, GL_RGBA16F, ds_width, ds_height);
+
+        // One attachment per direction.
+        for(std::size_t i = 0; i < fused_work_rts.size(); i++)
+        {
+            auto& textures = fused_work_textures[i];
+            for(std::size_t j = 0; j < textures.size(); j++)
+            {
+                const auto name = "fused_work_rts_color_" + std::to_string(i) + "_" + std::to_string(j);
+                textures[j] = recreate_texture(name, 1, GL_RGBA16F, ds_width, ds_height);
+            }
+            fused_work_rts[i] = std::make_unique<FrameBuffer>(std::vector<GLuint>(textures.cbegin(), textures.cend()));
+        }
     }
 }
 
@@ -522,6 +572,140 @@ void MyWindow::PassStreak(FrameBuffer* input, FrameBuffer* output, float dx, flo
     output->Unbind();
 }
 
+void MyWindow::PassStreakFused(FrameBuffer* input, FrameBuffer* output)
+{
+    // 1) 全方向を同時にピンポンブラー(最終パスで合算)
+    {
+        auto it = streak_filter.find(streak_filter_name);
+        assert(it != streak_filter.cend());
+        auto params = it->second;
+        const auto num_of_streaks = params[0];
+        const auto num_of_passes = params[1];
+        const auto additional_angle = 360.0f / static_cast<float>(num_of_streaks);
+        assert(num_of_streaks <= max_streaks);
+
+        std::array<glm::vec2, max_streaks> directions;
+        directions.fill(glm::vec2(0.0f));
+        float angle = 45.0f;
+        for(auto i = 0; i < num_of_streaks; i++)
+        {
+            auto theta = glm::radians(angle);
+            directions[static_cast<std::size_t>(i)] = glm::vec2(std::cos(theta), std::sin(theta));
+            angle += additional_angle;
+        }
+
+        std::array<GLuint, max_streaks> src_textures;
+        src_textures.fill(input->GetColorTexture());
+        for(auto j = 0; j < num_of_passes; j++)
+        {
+            const auto is_last = j == (num_of_passes - 1);
+            const auto k = static_cast<std::size_t>(j % 2);
+            FrameBuffer* dst_rt = is_last ? output_rt.get() : fused_work_rts[k].get();
+            PassStreakFused(src_textures, dst_rt, directions, num_of_streaks, 0.95f, j, is_last);
+            src_textures = fused_work_textures[k];
+        }
+    }
+    // 2) バイラテラルアップサンプリングしながら合成
+    {
+        glDepthMask(GL_FALSE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+
+        PassStreakUpsampling(output_rt.get(), high_luminance_region_rt.get(), input, output);
+
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+    }
+}
+
+void MyWindow::PassStreakFused(const std::array<GLuint, max_streaks>& inputs, FrameBuffer* output, const std::array<glm::vec2, max_streaks>& directions, int num_of_streaks, float attenuation, int pass, bool accumulate)
+{
+    output->Bind();
+    {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        std::array<glm::ivec1, max_streaks> units;
+        for(auto i = 0; i < max_streaks; i++)
+            units[static_cast<std::size_t>(i)] = glm::ivec1(i);
+
+        auto& uniform = pipeline_streak_fused->GetPipelineUniform();
+        uniform.Set("u_streaks", units.data(), units.size());
+        uniform.Set("u_pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
+        uniform.Set("u_directions", directions.data(), directions.size());
+        uniform.Set("u_params", glm::vec2(attenuation, static_cast<float>(pass)));
+        uniform.Set("u_num_of_streaks", num_of_streaks);
+        uniform.Set("u_accumulate", accumulate ? 1 : 0);
+
+        pipeline_streak_fused->Bind();
+        {
+            for(GLuint i = 0; i < max_streaks; i++)
+            {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D, inputs[i]);
+                glBindSampler(i, sampler);
+            }
+
+            fs_quad->Draw();
+
+            for(GLuint i = max_streaks - 1; i > 0; i--)
+            {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D, 0);
+                glBindSampler(i, 0);
+            }
+            glActiveTexture(GL_TEXTURE0);
+        }
+        pipeline_streak_fused->Unbind();
+    }
+    output->Unbind();
+}
+
+void MyWindow::PassStreakUpsampling(FrameBuffer* input, FrameBuffer* guide, FrameBuffer* low_guide, FrameBuffer* output)
+{
+    output->Bind();
+    {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        auto& uniform = pipeline_streak_upsampling->GetPipelineUniform();
+        uniform.Set("u_tex0", 0);
+        uniform.Set("u_guide", 1);
+        uniform.Set("u_low_guide", 2);
+        uniform.Set("u_pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
+        uniform.Set("u_sharpness", 4.0f);
+
+        pipeline_streak_upsampling->Bind();
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
+            glBindSampler(0, sampler);
+
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, guide->GetColorTexture());
+            glBindSampler(1, sampler);
+
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, low_guide->GetColorTexture());
+            glBindSampler(2, sampler);
+
+            fs_quad->Draw();
+
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindSampler(2, 0);
+
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindSampler(1, 0);
+
+            glActiveTexture(GL_TEXTURE0);
+        }
+        pipeline_streak_upsampling->Unbind();
+    }
+    output->Unbind();
+}
+
 void MyWindow::PassApply(FrameBuffer* input, FrameBuffer* output)
 {
     if(output != nullptr)
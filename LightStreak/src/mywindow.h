@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include <iostream>
 #include <array>
+#include <glm/glm.hpp>
 #include "../../common/window.h"
 #include "../../common/system.h"
 #include "../../common/render/texture.h"
@@ -8,6 +9,7 @@
 #include "../../common/render/fullscreen_quad.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 
 class MyWindow final : public common::Window
 {
@@ -19,9 +21,12 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
     using FullScreenQuad = common::render::FullScreenQuad;
 
+    static constexpr int max_streaks = 6;
+
 public:
     MyWindow();
     ~MyWindow();
@@ -48,10 +53,14 @@ private:
     void PassDownsampling4x4(FrameBuffer* input, FrameBuffer* output);
     void PassStreak(FrameBuffer* input, FrameBuffer* output);
     void PassStreak(FrameBuffer* input, FrameBuffer* output, float dx, float dy, float attenuation, int pass);
+    void PassStreakFused(FrameBuffer* input, FrameBuffer* output);
+    void PassStreakFused(const std::array<GLuint, max_streaks>& inputs, FrameBuffer* output, const std::array<glm::vec2, max_streaks>& directions, int num_of_streaks, float attenuation, int pass, bool accumulate);
+    void PassStreakUpsampling(FrameBuffer* input, FrameBuffer* guide, FrameBuffer* low_guide, FrameBuffer* output);
     void PassApply(FrameBuffer* input, FrameBuffer* output = nullptr);
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     std::unique_ptr<FullScreenQuad> fs_quad;
     GLuint sampler;
     GLuint texture;
@@ -61,6 +70,8 @@ private:
     std::unique_ptr<ProgramPipeline> pipeline_downsampling_2x2;
     std::unique_ptr<ProgramPipeline> pipeline_downsampling_4x4;
     std::unique_ptr<ProgramPipeline> pipeline_streak;
+    std::unique_ptr<ProgramPipeline> pipeline_streak_fused;
+    std::unique_ptr<ProgramPipeline> pipeline_streak_upsampling;
     std::unique_ptr<ProgramPipeline> pipeline_apply;
 
     std::unique_ptr<FrameBuffer> scene_rt;
@@ -68,8 +79,11 @@ private:
     std::unique_ptr<FrameBuffer> input_rt;
     std::unique_ptr<FrameBuffer> output_rt;
     std::array<std::unique_ptr<FrameBuffer>, 2> work_rts;
+    std::array<std::unique_ptr<FrameBuffer>, 2> fused_work_rts;
+    std::array<std::array<GLuint, max_streaks>, 2> fused_work_textures;
 
     std::string streak_filter_name;
 
     bool is_filter_enabled;
+    bool is_fused_enabled;
 };
\ No newline at end of file
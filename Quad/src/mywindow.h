@@ -6,6 +6,7 @@
 #include "../../common/render/texture.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 #include "quad.h"
 
 class MyWindow final : public common::Window
@@ -17,6 +18,7 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
 
 public:
@@ -39,5 +41,6 @@ private:
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     Quad quad;
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#version 430
+
+// One work group per angle, scanning the radius from the origin outward.
+layout(local_size_x = 256) in;
+
+layout(rgba16f, binding = 0) writeonly uniform image2D u_polar;
+
+uniform sampler2D u_tex0;
+uniform vec2 u_pixel_size;
+uniform vec2 u_origin;
+uniform float u_attenuation;
+uniform int u_num_of_radii;
+
+#define PI 3.14159265358979
+
+shared vec4 values[256];
+shared vec4 carry;
+
+void main(void)
+{
+    const int index = int(gl_LocalInvocationIndex);
+    const int row = int(gl_WorkGroupID.x);
+    const int num_of_angles = imageSize(u_polar).y;
+
+    // A radial step is one texel of the source.
+    const float theta = (float(row) + 0.5) / float(num_of_angles) * 2.0 * PI;
+    const vec2 dir = vec2(cos(theta), sin(theta)) * u_pixel_size;
+    const float a = u_attenuation;
+
+    if(index == 0)
+        carry = vec4(0.0);
+
+    // y(r) = x(r) + a * y(r - 1) sums the samples between the texel and the origin,
+    // evaluated as a weighted prefix sum over blocks of 256 radii.
+    for(int base = 0; base < u_num_of_radii; base += 256)
+    {
+        int r = base + index;
+        vec4 v = texture(u_tex0, u_origin + dir * float(r));
+        values[index] = v;
+        barrier();
+
+        float decay = a;
+        for(int offset = 1; offset < 256; offset <<= 1)
+        {
+            vec4 prev = (index >= offset) ? values[index - offset] : vec4(0.0);
+            barrier();
+            v += decay * prev;
+            values[index] = v;
+            barrier();
+            decay *= decay;
+        }
+        v += pow(a, float(index + 1)) * carry;
+
+        // Normalized by the sum of the weights, as the custom filter does.
+        float total_weight = (a < 1.0) ? (1.0 - pow(a, float(r + 1))) / (1.0 - a) : float(r + 1);
+        if(r < u_num_of_radii)
+            imageStore(u_polar, ivec2(r, row), vec4(v.rgb / total_weight, 1.0));
+
+        barrier();
+        if(index == 255)
+            carry = v;
+        barrier();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#version 430
+
+out vec4 o_color;
+
+uniform sampler2D u_tex0;
+uniform vec2 u_pixel_size;
+uniform vec2 u_origin;
+
+#define PI 3.14159265358979
+
+// Samples the blurred polar image, whose angle axis wraps around.
+void main(void)
+{
+    vec2 tex_coord = gl_FragCoord.xy * u_pixel_size;
+    vec2 v = (tex_coord - u_origin) / u_pixel_size;
+    float r = length(v);
+    float theta = atan(v.y, v.x);
+
+    vec2 size = vec2(textureSize(u_tex0, 0));
+    vec2 polar_coord = vec2((r + 0.5) / size.x, theta / (2.0 * PI));
+
+    o_color.rgb = texture(u_tex0, polar_coord).rgb;
+    o_color.a = 1.0;
+}
\ No newline at end of file
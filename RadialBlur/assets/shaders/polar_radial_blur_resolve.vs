@@ -1,4 +1,4 @@
-﻿#version 430
+#version 430
 
 layout(location = 0) in vec3 vs_position;
 
@@ -1,4 +1,6 @@
-﻿#include <iomanip>
+﻿#include <algorithm>
+#include <cmath>
+#include <iomanip>
 #include <sstream>
 #include <map>
 #include <GL/glew.h>
@@ -70,6 +72,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "../common/assets/fonts/test.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 0.5f);
         text->SetSmoothness(1.0f);
     }
 
@@ -112,6 +115,17 @@ void MyWindow::Setup()
     glSamplerParameteri(linear_sampler, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     glSamplerParameteri(linear_sampler, GL_TEXTURE_LOD_BIAS, 0.0f);
 
+    // The angle axis of the polar image wraps around.
+    glGenSamplers(1, &polar_sampler);
+    glSamplerParameteri(polar_sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(polar_sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(polar_sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(polar_sampler, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glSamplerParameteri(polar_sampler, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(polar_sampler, GL_TEXTURE_LOD_BIAS, 0.0f);
+
+    timer = std::make_unique<GpuTimer>();
+
     RecreateResources(width, height);
 
     pipeline_fullscreen_quad = std::make_unique<ProgramPipeline>(
@@ -138,6 +152,17 @@ void MyWindow::Setup()
             rm.GetResource<Program>("assets/shaders/custom_radial_blur.fs")})
             );
 
+    pipeline_polar_radial_blur = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/polar_radial_blur.cs")})
+            );
+
+    pipeline_polar_radial_blur_resolve = std::make_unique<ProgramPipeline>(
+        ProgramPipeline::ProgramPtrSet({
+            rm.GetResource<Program>("assets/shaders/polar_radial_blur_resolve.vs"),
+            rm.GetResource<Program>("assets/shaders/polar_radial_blur_resolve.fs")})
+            );
+
     pipeline_apply = std::make_unique<ProgramPipeline>(
         ProgramPipeline::ProgramPtrSet({
             rm.GetResource<Program>("assets/shaders/apply.vs"),
@@ -147,6 +172,7 @@ void MyWindow::Setup()
     is_debug_enabled = false;
     is_filter_enabled = false;
     radial_blur_mode = 0;
+    is_benchmark_enabled = false;
     attn_coef = 0.95f;
 
     mouse_x = mouse_y = 0;
@@ -158,6 +184,8 @@ void MyWindow::Cleanup()
         glDeleteSamplers(1, &nearest_sampler);
     if(glIsSampler(linear_sampler))
         glDeleteSamplers(1, &linear_sampler);
+    if(glIsSampler(polar_sampler))
+        glDeleteSamplers(1, &polar_sampler);
 }
 
 void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -220,6 +248,21 @@ void MyWindow::OnKey(GLFWwindow* window, int key, int scancode, int action, int
                 attn_coef = 1.0f;
         }
     }
+    if(key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        // Renders offscreen at 4K regardless of the window size.
+        is_benchmark_enabled = !is_benchmark_enabled;
+        if(is_benchmark_enabled)
+        {
+            RecreateResources(3840, 2160);
+        }
+        else
+        {
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            RecreateResources(width, height);
+        }
+    }
 }
 
 void MyWindow::OnMouseMove(GLFWwindow* window, double xpos, double ypos)
@@ -241,7 +284,7 @@ void MyWindow::OnMouseWheel(GLFWwindow* window, double xoffset, double yoffset)
 
 void MyWindow::OnResizeFramebuffer(GLFWwindow* window, int width, int height)
 {
-    if(HasIconified())
+    if(HasIconified() || is_benchmark_enabled)
         return;
     // re-create
     RecreateResources(width, height);
@@ -298,10 +341,9 @@ void MyWindow::OnRender()
     // 3) Radial Blur.
     if(is_filter_enabled)
     {
-        if(radial_blur_mode == 0)
-            PassSimpleRadialBlur(high_luminance_region_rt.get(), output_rt);
-        else
-            PassCustomRadialBlur(high_luminance_region_rt.get(), output_rt);
+        timer->Begin();
+        PassRadialBlur(high_luminance_region_rt.get(), output_rt);
+        timer->End();
     }
 
     glEnable(GL_FRAMEBUFFER_SRGB);
@@ -333,7 +375,13 @@ void MyWindow::OnRender()
         oss << "Radial Blur:" << (is_filter_enabled ? "On" : "Off") << "(Toggle Radial Blur: f)";
         oss << "\n";
 
-        oss << "Radial Blur Mode:" << ((radial_blur_mode == 0) ? "Simple" : "Custom") << " ([Shift +] F2)";
+        static const char* mode_names[] = { "Simple", "Custom", "Polar" };
+        oss << "Radial Blur Mode:" << mode_names[radial_blur_mode] << " ([Shift +] F2)";
+        if(is_filter_enabled)
+            oss << " " << timer->GetElapsedTime() << "ms";
+        oss << "\n";
+
+        oss << "Benchmark:" << (is_benchmark_enabled ? "On(3840x2160)" : "Off") << "(Toggle Benchmark: F4)";
         oss << "\n";
 
         oss << "Attenuation Coefficient:" << attn_coef << " ([Shift +] F3)";
@@ -344,7 +392,8 @@ void MyWindow::OnRender()
 
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 0.5f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
@@ -355,7 +404,7 @@ void MyWindow::OnRender()
 
 void MyWindow::RecreateResources(int width, int height)
 {
-    auto recreate_fb = [](const std::string& name, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
+    auto recreate_texture = [](const std::string& name, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
     {
         auto& rm = System::GetMutableInstance().GetResourceManager();
 
@@ -369,7 +418,11 @@ void MyWindow::RecreateResources(int width, int height)
 
         rm.AddResource<Texture>(name, std::move(p));
 
-        return std::make_unique<FrameBuffer>(texture, 0, 0);
+        return texture;
+    };
+    auto recreate_fb = [&recreate_texture](const std::string& name, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
+    {
+        return std::make_unique<FrameBuffer>(recreate_texture(name, levels, internal_format, width, height), 0, 0);
     };
 
     // for scene.
@@ -391,6 +444,13 @@ void MyWindow::RecreateResources(int width, int height)
         radial_blur_rts[0] = recreate_fb("radial_blur_color_0", 1, GL_RGBA16F, ds_width, ds_height);
         radial_blur_rts[1] = recreate_fb("radial_blur_color_1", 1, GL_RGBA16F, ds_width, ds_height);
         radial_blur_rts[2] = recreate_fb("radial_blur_color_2", 1, GL_RGBA16F, ds_width, ds_height);
+        radial_blur_size = glm::ivec2(ds_width, ds_height);
+
+        // Radii cover the diagonal, angles keep about one texel of arc at the image border.
+        const auto num_of_radii = static_cast<int>(std::ceil(std::hypot(ds_width, ds_height))) + 2;
+        const auto num_of_angles = 2 * (ds_width + ds_height);
+        polar_texture = recreate_texture("polar_radial_blur_color", 1, GL_RGBA16F, num_of_radii, num_of_angles);
+        polar_size = glm::ivec2(num_of_radii, num_of_angles);
     }
 }
 
@@ -442,24 +502,21 @@ void MyWindow::PassHighLuminanceRegionExtraction(FrameBuffer* input, FrameBuffer
     output->Unbind();
 }
 
-void MyWindow::PassSimpleRadialBlur(FrameBuffer* input, FrameBuffer* output)
+void MyWindow::PassRadialBlur(FrameBuffer* input, FrameBuffer* output)
 {
-    auto texture = radial_blur_rts[0]->GetColorTexture();
-    GLint prev_texture, width, height;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
-    glBindTexture(GL_TEXTURE_2D, prev_texture);
-
-    GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
+    if(radial_blur_mode == 0)
+        PassSimpleRadialBlur(input, output);
+    else if(radial_blur_mode == 1)
+        PassCustomRadialBlur(input, output);
+    else
+        PassPolarRadialBlur(input, output);
+}
 
-    auto ox = (static_cast<float>(mouse_x * width / viewport[2]) + 0.5f) / static_cast<float>(width);
-    auto oy = (static_cast<float>(mouse_y * height / viewport[3]) + 0.5f) / static_cast<float>(height);
-    oy = 1.0f - oy;
+void MyWindow::PassSimpleRadialBlur(FrameBuffer* input, FrameBuffer* output)
+{
+    const auto origin = GetRadialBlurOrigin();
 
-    PassSimpleRadialBlur(input, radial_blur_rts[0].get(), ox, oy, attn_coef);
+    PassSimpleRadialBlur(input, radial_blur_rts[0].get(), origin.x, origin.y, attn_coef);
 
     //
     {
@@ -508,20 +565,9 @@ void MyWindow::PassCustomRadialBlur(FrameBuffer* input, FrameBuffer* output)
 {
     const int num_of_passes = 5;
 
-    auto texture = radial_blur_rts[0]->GetColorTexture();
-    GLint prev_texture, width, height;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
-    glBindTexture(GL_TEXTURE_2D, prev_texture);
-
-    GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
-
-    auto ox = (static_cast<float>(mouse_x * width / viewport[2]) + 0.5f) / static_cast<float>(width);
-    auto oy = (static_cast<float>(mouse_y * height / viewport[3]) + 0.5f) / static_cast<float>(height);
-    oy = 1.0f - oy;
+    const auto origin = GetRadialBlurOrigin();
+    const auto ox = origin.x;
+    const auto oy = origin.y;
 
     auto last_rt = input;
 
@@ -576,6 +622,85 @@ void MyWindow::PassCustomRadialBlur(FrameBuffer* input, FrameBuffer* output, flo
     output->Unbind();
 }
 
+void MyWindow::PassPolarRadialBlur(FrameBuffer* input, FrameBuffer* output)
+{
+    const auto origin = GetRadialBlurOrigin();
+
+    PassPolarRadialBlur(input, radial_blur_rts[0].get(), origin.x, origin.y, attn_coef);
+
+    //
+    {
+        glDepthMask(GL_FALSE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+
+        PassApply(radial_blur_rts[0].get(), output);
+
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+    }
+}
+
+void MyWindow::PassPolarRadialBlur(FrameBuffer* input, FrameBuffer* output, float x, float y, float attenuation)
+{
+    const auto size = glm::vec2(radial_blur_size);
+    const auto pixel_size = glm::vec2(1.0f) / size;
+
+    // 1) Resample to polar coordinates and blur along the radius in one dispatch, the cost does not depend on the blur length.
+    {
+        // Only the radii up to the farthest corner are needed.
+        const auto o = glm::vec2(x, y) * size;
+        const auto extent = glm::max(o, size - o);
+        const auto num_of_radii = std::min(static_cast<int>(std::ceil(glm::length(extent))) + 2, polar_size.x);
+
+        auto& uniform = pipeline_polar_radial_blur->GetPipelineUniform();
+        uniform.Set("u_tex0", 0);
+        uniform.Set("u_pixel_size", pixel_size);
+        uniform.Set("u_origin", glm::vec2(x, y));
+        uniform.Set("u_attenuation", attenuation);
+        uniform.Set("u_num_of_radii", num_of_radii);
+
+        pipeline_polar_radial_blur->Bind();
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, input->GetColorTexture());
+            glBindSampler(0, linear_sampler);
+            glBindImageTexture(0, polar_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+            glDispatchCompute(static_cast<GLuint>(polar_size.y), 1, 1);
+
+            glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+            glBindSampler(0, 0);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        pipeline_polar_radial_blur->Unbind();
+    }
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    // 2) Resample back to the cartesian coordinates.
+    output->Bind();
+    {
+        auto& uniform = pipeline_polar_radial_blur_resolve->GetPipelineUniform();
+        uniform.Set("u_tex0", 0);
+        uniform.Set("u_pixel_size", pixel_size);
+        uniform.Set("u_origin", glm::vec2(x, y));
+
+        pipeline_polar_radial_blur_resolve->Bind();
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, polar_texture);
+            glBindSampler(0, polar_sampler);
+
+            fs_quad->Draw();
+
+            glBindSampler(0, 0);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        pipeline_polar_radial_blur_resolve->Unbind();
+    }
+    output->Unbind();
+}
+
 void MyWindow::PassApply(FrameBuffer* input, FrameBuffer* output)
 {
     if(output != nullptr)
@@ -603,4 +728,20 @@ void MyWindow::PassApply(FrameBuffer* input, FrameBuffer* output)
 
     if(output != nullptr)
         output->Unbind();
+}
+
+glm::vec2 MyWindow::GetRadialBlurOrigin() const
+{
+    // The mouse position snapped to the center of a texel of the radial blur targets.
+    const auto width = radial_blur_size.x;
+    const auto height = radial_blur_size.y;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    auto ox = (static_cast<float>(mouse_x * width / viewport[2]) + 0.5f) / static_cast<float>(width);
+    auto oy = (static_cast<float>(mouse_y * height / viewport[3]) + 0.5f) / static_cast<float>(height);
+    oy = 1.0f - oy;
+
+    return glm::vec2(ox, oy);
 }
\ No newline at end of file
@@ -5,13 +5,16 @@
 #include <vector>
 #include <array>
 #include <tuple>
+#include <glm/glm.hpp>
 #include "../../common/window.h"
 #include "../../common/system.h"
 #include "../../common/render/texture.h"
 #include "../../common/render/framebuffer.h"
 #include "../../common/render/fullscreen_quad.h"
+#include "../../common/render/gpu_timer.h"
 #include "../../common/render/shader/shader.h"
 #include "../../common/render/text/sdf_text.h"
+#include "../../common/render/text/text_layout.h"
 
 class MyWindow final : public common::Window
 {
@@ -23,8 +26,10 @@ class MyWindow final : public common::Window
     using Font = common::render::text::Font;
     using SDFText = common::render::text::SDFText;
     using SDFTextRenderer = common::render::text::SDFTextRenderer;
+    using TextLayout = common::render::text::TextLayout;
     using Camera = common::render::SimpleCamera;
     using FullScreenQuad = common::render::FullScreenQuad;
+    using GpuTimer = common::render::GpuTimer;
 
 public:
     MyWindow();
@@ -48,17 +53,23 @@ private:
 
     void DrawFullScreenQuad(GLuint texture);
     void PassHighLuminanceRegionExtraction(FrameBuffer* input, FrameBuffer* output);
+    void PassRadialBlur(FrameBuffer* input, FrameBuffer* output);
     void PassSimpleRadialBlur(FrameBuffer* input, FrameBuffer* output);
     void PassSimpleRadialBlur(FrameBuffer* input, FrameBuffer* output, float x, float y, float attenuation);
     void PassCustomRadialBlur(FrameBuffer* input, FrameBuffer* output);
     void PassCustomRadialBlur(FrameBuffer* input, FrameBuffer* output, float x, float y, float attenuation, int pass, int num_of_passes);
+    void PassPolarRadialBlur(FrameBuffer* input, FrameBuffer* output);
+    void PassPolarRadialBlur(FrameBuffer* input, FrameBuffer* output, float x, float y, float attenuation);
     void PassApply(FrameBuffer* input, FrameBuffer* output = nullptr);
+    glm::vec2 GetRadialBlurOrigin() const;
 
 private:
     std::unique_ptr<SDFText> text;
+    std::unique_ptr<TextLayout> overlay;
     std::unique_ptr<FullScreenQuad> fs_quad;
     GLuint nearest_sampler;
     GLuint linear_sampler;
+    GLuint polar_sampler;
 
     std::vector<std::tuple<GLuint, std::filesystem::path>> selectable_textures;
     int selected_texture_index;
@@ -67,17 +78,25 @@ private:
     std::unique_ptr<ProgramPipeline> pipeline_high_luminance_region_extraction;
     std::unique_ptr<ProgramPipeline> pipeline_simple_radial_blur;
     std::unique_ptr<ProgramPipeline> pipeline_custom_radial_blur;
+    std::unique_ptr<ProgramPipeline> pipeline_polar_radial_blur;
+    std::unique_ptr<ProgramPipeline> pipeline_polar_radial_blur_resolve;
     std::unique_ptr<ProgramPipeline> pipeline_apply;
 
     std::unique_ptr<FrameBuffer> scene_rt;
     std::unique_ptr<FrameBuffer> debug_rt;
     std::unique_ptr<FrameBuffer> high_luminance_region_rt;
     std::array<std::unique_ptr<FrameBuffer>, 3> radial_blur_rts;
+    GLuint polar_texture;
+    glm::ivec2 radial_blur_size;
+    glm::ivec2 polar_size;
+
+    std::unique_ptr<GpuTimer> timer;
 
     int mouse_x, mouse_y;
 
     bool is_debug_enabled;
     bool is_filter_enabled;
     int radial_blur_mode;
+    bool is_benchmark_enabled;
     float attn_coef;    // attenuation coefficient
 };
\ No newline at end of file
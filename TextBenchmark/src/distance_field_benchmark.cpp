@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../../common/logger.h"
+#include "../../common/render/text/glyph_rasterizer.h"
+#include "distance_field_benchmark.h"
+
+namespace
+{
+
+using common::render::text::DistanceFieldType;
+using common::render::text::GlyphRasterizer;
+using common::render::text::Shape;
+
+constexpr std::uint32_t first_code = 0x21;
+constexpr std::uint32_t last_code = 0x7E;
+constexpr std::size_t supersampling = 4;
+
+struct Result
+{
+    double milliseconds;
+    std::size_t num_of_texel_bytes;
+    std::size_t num_of_samples;
+    std::size_t num_of_mismatches;
+};
+
+float sample(const std::vector<std::uint8_t>& texels, std::size_t width, std::size_t height, std::size_t channels, std::size_t channel, float x, float y)
+{
+    // Bilinear filtering as done by the sampler, texel centers at half integers.
+    const auto fx = std::clamp(x - 0.5f, 0.0f, static_cast<float>(width - 1));
+    const auto fy = std::clamp(y - 0.5f, 0.0f, static_cast<float>(height - 1));
+    const auto x0 = static_cast<std::size_t>(fx);
+    const auto y0 = static_cast<std::size_t>(fy);
+    const auto x1 = std::min(x0 + 1, width - 1);
+    const auto y1 = std::min(y0 + 1, height - 1);
+    const auto ax = fx - static_cast<float>(x0);
+    const auto ay = fy - static_cast<float>(y0);
+    const auto at = [&](std::size_t tx, std::size_t ty){ return static_cast<float>(texels[(ty * width + tx) * channels + channel]) / 255.0f; };
+    const auto top = at(x0, y0) + (at(x1, y0) - at(x0, y0)) * ax;
+    const auto bottom = at(x0, y1) + (at(x1, y1) - at(x0, y1)) * ax;
+    return top + (bottom - top) * ay;
+}
+
+// Counts the magnified samples whose inside test disagrees with the outline.
+void compare(const GlyphRasterizer::Bitmap& bitmap, DistanceFieldType type, const Shape& shape, Result& result)
+{
+    const auto channels = (type == DistanceFieldType::MSDF) ? std::size_t(3) : std::size_t(1);
+    const std::size_t width = bitmap.width;
+    const std::size_t height = bitmap.height;
+    for(std::size_t y = 0; y < height * supersampling; y++)
+    {
+        for(std::size_t x = 0; x < width * supersampling; x++)
+        {
+            const auto px = (static_cast<float>(x) + 0.5f) / static_cast<float>(supersampling);
+            const auto py = (static_cast<float>(y) + 0.5f) / static_cast<float>(supersampling);
+            float distance;
+            if(channels == 3)
+            {
+                const auto r = sample(bitmap.texels, width, height, 3, 0, px, py);
+                const auto g = sample(bitmap.texels, width, height, 3, 1, px, py);
+                const auto b = sample(bitmap.texels, width, height, 3, 2, px, py);
+                distance = std::max(std::min(r, g), std::min(std::max(r, g), b));
+            }
+            else
+            {
+                distance = sample(bitmap.texels, width, height, 1, 0, px, py);
+            }
+            if((distance > 0.5f) != shape.Contains(px, py))
+                result.num_of_mismatches++;
+            result.num_of_samples++;
+        }
+    }
+}
+
+Result measure(const GlyphRasterizer& rasterizer, DistanceFieldType type, std::size_t num_of_iterations)
+{
+    Result result{ 0.0, 0, 0, 0 };
+
+    double best = 0.0;
+    for(std::size_t i = 0; i < num_of_iterations; i++)
+    {
+        std::size_t num_of_texel_bytes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for(auto code = first_code; code <= last_code; code++)
+            num_of_texel_bytes += rasterizer.Rasterize(code, type).texels.size();
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if((i == 0) || (elapsed < best))
+            best = elapsed;
+        result.num_of_texel_bytes = num_of_texel_bytes;
+    }
+    result.milliseconds = best;
+
+    for(auto code = first_code; code <= last_code; code++)
+    {
+        Shape shape;
+        const auto bitmap = rasterizer.Rasterize(code, type, &shape);
+        if(!bitmap.texels.empty())
+            compare(bitmap, type, shape, result);
+    }
+    return result;
+}
+
+void print(const char* name, const Result& result)
+{
+    const auto mismatch = (result.num_of_samples > 0) ? 100.0 * static_cast<double>(result.num_of_mismatches) / static_cast<double>(result.num_of_samples) : 0.0;
+    LOG_I("  " << name << ": " << result.milliseconds << " ms, " << result.num_of_texel_bytes << " bytes, mismatch " << mismatch << " %");
+}
+
+}
+
+void RunDistanceFieldBenchmark(const DistanceFieldBenchmarkOptions& options)
+{
+    LOG_I("Generating distance fields. [font=" << options.font_filepath.string() << ", spread=" << options.spread
+        << ", glyphs=" << (last_code - first_code + 1) << ", supersampling=" << supersampling << "x]");
+
+    for(auto pixel_height : options.pixel_heights)
+    {
+        GlyphRasterizer rasterizer(options.font_filepath, pixel_height, options.spread);
+        LOG_I("pixel height " << pixel_height << ":");
+        print("SDF ", measure(rasterizer, DistanceFieldType::SDF, options.num_of_iterations));
+        print("MSDF", measure(rasterizer, DistanceFieldType::MSDF, options.num_of_iterations));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+struct DistanceFieldBenchmarkOptions
+{
+    std::filesystem::path font_filepath;
+    std::vector<float> pixel_heights = { 16.0f, 24.0f, 32.0f, 48.0f };
+    float spread = 4.0f;
+    std::size_t num_of_iterations = 5;
+};
+
+/*!
+ * Generates SDF and MSDF bitmaps of the printable ASCII glyphs at several sizes and compares
+ * the generation time, the atlas size and how well each reconstructs the outline when magnified.
+ */
+void RunDistanceFieldBenchmark(const DistanceFieldBenchmarkOptions& options);
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <regex>
+#include <string>
+#include <vector>
+#include "../../common/logger.h"
+#include "../../common/render/text/fnt_parser.h"
+#include "fnt_benchmark.h"
+
+namespace
+{
+
+using common::render::text::FntParser;
+
+struct GeneratedFont
+{
+    std::vector<FntParser::Char> chars;
+    std::vector<FntParser::Kerning> kernings;
+};
+
+GeneratedFont generate_font(const FntBenchmarkOptions& options)
+{
+    GeneratedFont font;
+    font.chars.reserve(options.num_of_chars);
+    for(std::size_t i = 0; i < options.num_of_chars; i++)
+    {
+        // CJK Unified Ideographs and beyond.
+        const auto id = static_cast<std::uint32_t>(0x4E00 + i);
+        const auto x = static_cast<std::uint16_t>((i % 64) * 32);
+        const auto y = static_cast<std::uint16_t>(((i / 64) % 64) * 32);
+        const auto page = static_cast<std::uint8_t>(i / 4096);
+        font.chars.emplace_back(id, x, y, std::uint16_t(30), std::uint16_t(31), std::int16_t(-1), std::int16_t(2), std::int16_t(29), page, std::uint8_t(15));
+    }
+    font.kernings.reserve(options.num_of_kernings);
+    for(std::size_t i = 0; i < options.num_of_kernings; i++)
+    {
+        const auto first = static_cast<std::uint32_t>(0x4E00 + (i * 7) % options.num_of_chars);
+        const auto second = static_cast<std::uint32_t>(0x4E00 + (i * 13 + 1) % options.num_of_chars);
+        font.kernings.emplace_back(first, second, static_cast<std::int16_t>(static_cast<int>(i % 7) - 3));
+    }
+    return font;
+}
+
+std::size_t get_num_of_pages(const GeneratedFont& font)
+{
+    return static_cast<std::size_t>(std::get<8>(font.chars.back())) + 1;
+}
+
+void write_text(const std::filesystem::path& filepath, const GeneratedFont& font)
+{
+    std::ofstream ofs(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+    const auto num_of_pages = get_num_of_pages(font);
+    ofs << "info face=\"Generated Font\" size=32 bold=0 italic=0 charset=\"\" unicode=1 stretchH=100 smooth=1 aa=1 padding=0,0,0,0 spacing=1,1 outline=0\r\n";
+    ofs << "common lineHeight=32 base=26 scaleW=2048 scaleH=2048 pages=" << num_of_pages << " packed=0 alphaChnl=0 redChnl=4 greenChnl=4 blueChnl=4\r\n";
+    for(std::size_t i = 0; i < num_of_pages; i++)
+        ofs << "page id=" << i << " file=\"generated_" << i << ".png\"\r\n";
+    ofs << "chars count=" << font.chars.size() << "\r\n";
+    for(const auto& c : font.chars)
+    {
+        ofs << "char id=" << std::get<0>(c) << "   x=" << std::get<1>(c) << "    y=" << std::get<2>(c)
+            << "    width=" << std::get<3>(c) << "    height=" << std::get<4>(c)
+            << "    xoffset=" << std::get<5>(c) << "    yoffset=" << std::get<6>(c) << "    xadvance=" << std::get<7>(c)
+            << "    page=" << static_cast<int>(std::get<8>(c)) << "  chnl=" << static_cast<int>(std::get<9>(c)) << "\r\n";
+    }
+    ofs << "kernings count=" << font.kernings.size() << "\r\n";
+    for(const auto& k : font.kernings)
+        ofs << "kerning first=" << std::get<0>(k) << "  second=" << std::get<1>(k) << "  amount=" << std::get<2>(k) << "\r\n";
+}
+
+template<typename T>
+void write(std::ofstream& ofs, T value)
+{
+    ofs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write_binary(const std::filesystem::path& filepath, const GeneratedFont& font)
+{
+    std::ofstream ofs(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+    const auto num_of_pages = get_num_of_pages(font);
+    const std::string face = "Generated Font";
+
+    ofs.write("BMF\3", 4);
+
+    write<std::uint8_t>(ofs, 1);
+    write<std::uint32_t>(ofs, static_cast<std::uint32_t>(14 + face.size() + 1));
+    write<std::int16_t>(ofs, 32);
+    write<std::uint8_t>(ofs, 0x03);     // smooth, unicode
+    write<std::uint8_t>(ofs, 0);
+    write<std::uint16_t>(ofs, 100);
+    write<std::uint8_t>(ofs, 1);
+    for(int i = 0; i < 4; i++)
+        write<std::uint8_t>(ofs, 0);
+    write<std::uint8_t>(ofs, 1);
+    write<std::uint8_t>(ofs, 1);
+    write<std::uint8_t>(ofs, 0);
+    ofs.write(face.c_str(), static_cast<std::streamsize>(face.size() + 1));
+
+    write<std::uint8_t>(ofs, 2);
+    write<std::uint32_t>(ofs, 15);
+    write<std::uint16_t>(ofs, 32);
+    write<std::uint16_t>(ofs, 26);
+    write<std::uint16_t>(ofs, 2048);
+    write<std::uint16_t>(ofs, 2048);
+    write<std::uint16_t>(ofs, static_cast<std::uint16_t>(num_of_pages));
+    write<std::uint8_t>(ofs, 0);
+    write<std::uint8_t>(ofs, 0);
+    write<std::uint8_t>(ofs, 4);
+    write<std::uint8_t>(ofs, 4);
+    write<std::uint8_t>(ofs, 4);
+
+    std::vector<std::string> pages;
+    for(std::size_t i = 0; i < num_of_pages; i++)
+        pages.push_back("generated_" + std::to_string(i) + ".png");
+    std::size_t pages_size = 0;
+    for(const auto& page : pages)
+        pages_size += page.size() + 1;
+    write<std::uint8_t>(ofs, 3);
+    write<std::uint32_t>(ofs, static_cast<std::uint32_t>(pages_size));
+    for(const auto& page : pages)
+        ofs.write(page.c_str(), static_cast<std::streamsize>(page.size() + 1));
+
+    write<std::uint8_t>(ofs, 4);
+    write<std::uint32_t>(ofs, static_cast<std::uint32_t>(font.chars.size() * 20));
+    for(const auto& c : font.chars)
+    {
+        write(ofs, std::get<0>(c));
+        write(ofs, std::get<1>(c));
+        write(ofs, std::get<2>(c));
+        write(ofs, std::get<3>(c));
+        write(ofs, std::get<4>(c));
+        write(ofs, std::get<5>(c));
+        write(ofs, std::get<6>(c));
+        write(ofs, std::get<7>(c));
+        write(ofs, std::get<8>(c));
+        write(ofs, std::get<9>(c));
+    }
+
+    write<std::uint8_t>(ofs, 5);
+    write<std::uint32_t>(ofs, static_cast<std::uint32_t>(font.kernings.size() * 10));
+    for(const auto& k : font.kernings)
+    {
+        write(ofs, std::get<0>(k));
+        write(ofs, std::get<1>(k));
+        write(ofs, std::get<2>(k));
+    }
+}
+
+// The previous implementation: one std::regex per field of every line.
+int legacy_get_integer(const std::string& source, const std::string& name)
+{
+    std::smatch match;
+    if(std::regex_search(source, match, std::regex(name + R"(=([-]{0,1}[\d]+))")))
+        return std::stoi(match[1]);
+    return 0;
+}
+
+bool legacy_parse(const std::filesystem::path& filepath, FntParser::Data& data)
+{
+    data = FntParser::Data();
+
+    std::ifstream ifs(filepath.string(), std::ios::in | std::ios::binary);
+    if(ifs.fail())
+        return false;
+
+    static const char* const char_fields[] = { "id", "x", "y", "width", "height", "xoffset", "yoffset", "xadvance", "page", "chnl" };
+
+    std::string line;
+    while(std::getline(ifs, line))
+    {
+        if(line.compare(0, 5, "char ") == 0)
+        {
+            int v[10];
+            for(std::size_t i = 0; i < 10; i++)
+                v[i] = legacy_get_integer(line, std::string(" ") + char_fields[i]);
+            data.chars.emplace_back(
+                static_cast<std::uint32_t>(v[0]), static_cast<std::uint16_t>(v[1]), static_cast<std::uint16_t>(v[2]),
+                static_cast<std::uint16_t>(v[3]), static_cast<std::uint16_t>(v[4]), static_cast<std::int16_t>(v[5]),
+                static_cast<std::int16_t>(v[6]), static_cast<std::int16_t>(v[7]), static_cast<std::uint8_t>(v[8]),
+                static_cast<std::uint8_t>(v[9]));
+        }
+        else if(line.compare(0, 8, "kerning ") == 0)
+        {
+            data.kernings.emplace_back(
+                static_cast<std::uint32_t>(legacy_get_integer(line, "first")),
+                static_cast<std::uint32_t>(legacy_get_integer(line, "second")),
+                static_cast<std::int16_t>(legacy_get_integer(line, "amount")));
+        }
+    }
+    return !data.chars.empty();
+}
+
+double measure(const char* name, std::size_t num_of_iterations, const std::function<bool(FntParser::Data&)>& parse, const GeneratedFont& expected)
+{
+    double best = 0.0;
+    for(std::size_t i = 0; i < num_of_iterations; i++)
+    {
+        FntParser::Data data;
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = parse(data);
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(!result || (data.chars != expected.chars) || (data.kernings != expected.kernings))
+        {
+            LOG_E(name << ": the parsed data does not match the generated font.");
+            return 0.0;
+        }
+        best = (i == 0) ? elapsed : std::min(best, elapsed);
+    }
+    LOG_I(name << ": " << best << " ms");
+    return best;
+}
+
+}
+
+void RunFntBenchmark(const FntBenchmarkOptions& options)
+{
+    LOG_I("Generating a font. [chars=" << options.num_of_chars << ", kernings=" << options.num_of_kernings << "]");
+
+    const auto font = generate_font(options);
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto text_filepath = directory / "generated_text.fnt";
+    const auto binary_filepath = directory / "generated_binary.fnt";
+    write_text(text_filepath, font);
+    write_binary(binary_filepath, font);
+
+    LOG_I("text: " << std::filesystem::file_size(text_filepath) << " bytes, binary: " << std::filesystem::file_size(binary_filepath) << " bytes");
+
+    // The regex parser is orders of magnitude slower, so it is only run once.
+    const auto legacy = measure("regex(text)", 1,
+        [&](FntParser::Data& data){ return legacy_parse(text_filepath, data); }, font);
+    const auto text = measure("FntParser(text)", options.num_of_iterations,
+        [&](FntParser::Data& data){ return FntParser::Parse(text_filepath, data); }, font);
+    const auto binary = measure("FntParser(binary)", options.num_of_iterations,
+        [&](FntParser::Data& data){ return FntParser::Parse(binary_filepath, data); }, font);
+
+    if((text > 0.0) && (binary > 0.0))
+        LOG_I("speedup: text " << legacy / text << "x, binary " << legacy / binary << "x");
+
+    std::filesystem::remove(text_filepath);
+    std::filesystem::remove(binary_filepath);
+}
\ No newline at end of file
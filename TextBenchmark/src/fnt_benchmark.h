@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+
+struct FntBenchmarkOptions
+{
+    std::size_t num_of_chars = 20000;
+    std::size_t num_of_kernings = 20000;
+    std::size_t num_of_iterations = 5;
+};
+
+/*!
+ * Generates a large font in both the text and binary formats and compares the load times
+ * of the regex based parser used previously with FntParser.
+ */
+void RunFntBenchmark(const FntBenchmarkOptions& options);
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <hasenpfote/log/console_appender.h>
+#include "../../common/logger.h"
+#include "distance_field_benchmark.h"
+#include "fnt_benchmark.h"
+
+namespace
+{
+
+void print_usage()
+{
+    std::cout
+        << "Usage: TextBenchmark [options]" << std::endl
+        << "Options:" << std::endl
+        << "  --chars <n>       Number of chars in the generated font." << std::endl
+        << "  --kernings <n>    Number of kerning pairs in the generated font." << std::endl
+        << "  --iterations <n>  Number of iterations." << std::endl
+        << "  --msdf <font>     Compares SDF and MSDF generation from a TrueType font instead." << std::endl
+        << "  --spread <n>      Distance field spread in texels for --msdf." << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace hasenpfote::log;
+    common::Logger::GetMutableInstance().AddAppender<ConsoleAppender>(std::make_shared<ConsoleAppender>());
+
+    FntBenchmarkOptions fnt_options;
+    DistanceFieldBenchmarkOptions df_options;
+
+    try{
+        for(int i = 1; i < argc; i++)
+        {
+            if((std::strcmp(argv[i], "--chars") == 0) && (i + 1 < argc))
+            {
+                fnt_options.num_of_chars = std::stoul(argv[++i]);
+            }
+            else if((std::strcmp(argv[i], "--kernings") == 0) && (i + 1 < argc))
+            {
+                fnt_options.num_of_kernings = std::stoul(argv[++i]);
+            }
+            else if((std::strcmp(argv[i], "--iterations") == 0) && (i + 1 < argc))
+            {
+                fnt_options.num_of_iterations = std::stoul(argv[++i]);
+                df_options.num_of_iterations = fnt_options.num_of_iterations;
+            }
+            else if((std::strcmp(argv[i], "--msdf") == 0) && (i + 1 < argc))
+            {
+                df_options.font_filepath = argv[++i];
+            }
+            else if((std::strcmp(argv[i], "--spread") == 0) && (i + 1 < argc))
+            {
+                df_options.spread = std::stof(argv[++i]);
+            }
+            else
+            {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch(const std::exception&){
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    try{
+        if(df_options.font_filepath.empty())
+            RunFntBenchmark(fnt_options);
+        else
+            RunDistanceFieldBenchmark(df_options);
+    }
+    catch(const std::exception& e){
+        LOG_F("Exception: " << e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -72,6 +72,7 @@ void MyWindow::Setup()
         std::filesystem::path fontpath = "assets/fonts/test3.fnt";
         auto font = std::make_shared<Font>(fontpath);
         text = std::make_unique<SDFText>(font, std::make_shared<SDFTextRenderer>());
+        overlay = std::make_unique<TextLayout>(font, 2.0f);
         text->SetSmoothness(smoothness);
     }
     //
@@ -195,7 +196,8 @@ void MyWindow::OnRender()
 
         text->BeginRendering();
         {
-            text->DrawString(std::move(oss.str()), 0.0f, 0.0f, 2.0f);
+            overlay->SetText(oss.str());
+            text->DrawLayout(*overlay);
         }
         text->EndRendering();
 
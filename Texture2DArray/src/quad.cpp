@@ -99,29 +99,42 @@ void Quad::Initialize()
 #else
     glGenTextures(1, &texture);
     glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, 128, 128, 2);
     //glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, 128, 128, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
     {
-        int width, height, component;
-        unsigned char* pixels = stbi_load("assets/textures/rate-star-button.png", &width, &height, &component, STBI_default);
-        if(pixels != nullptr)
+        auto& uploader = System::GetMutableInstance().GetTextureUploader();
+
+        const char* filepaths[] =
         {
-            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-            stbi_image_free(pixels);
-        }
-    }
-    {
-        int width, height, component;
-        unsigned char* pixels = stbi_load("assets/textures/plain-heart.png", &width, &height, &component, STBI_default);
-        if(pixels != nullptr)
+            "assets/textures/rate-star-button.png",
+            "assets/textures/plain-heart.png"
+        };
+        GLint layer = 0;
+        for(auto filepath : filepaths)
         {
-            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 1, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-            stbi_image_free(pixels);
+            int width, height, component;
+            unsigned char* pixels = stbi_load(filepath, &width, &height, &component, STBI_rgb_alpha);
+            if(pixels != nullptr)
+            {
+                TextureUploader::Region region;
+                region.texture = texture;
+                region.target = GL_TEXTURE_2D_ARRAY;
+                region.zoffset = layer;
+                region.width = width;
+                region.height = height;
+                region.format = GL_RGBA;
+                region.type = GL_UNSIGNED_BYTE;
+                region.unpack_alignment = 4;
+                uploader.Upload(region, pixels, static_cast<GLsizeiptr>(width) * height * 4);
+                stbi_image_free(pixels);
+            }
+            layer++;
         }
     }
 
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
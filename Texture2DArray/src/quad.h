@@ -8,6 +8,7 @@ class Quad final
 {
     using System = common::System;
     using Texture = common::render::Texture;
+    using TextureUploader = common::render::TextureUploader;
     using Program = common::render::shader::Program;
     using ProgramPipeline = common::render::shader::ProgramPipeline;
 
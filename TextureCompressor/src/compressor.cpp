@@ -0,0 +1,182 @@
+#include <chrono>
+#include <cctype>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "../../common/logger.h"
+#include "../../common/render/image.h"
+#include "../../common/render/mipmap_generator.h"
+#include "../../common/render/compression/ktx2.h"
+#include "compressor.h"
+
+namespace
+{
+
+using common::render::Image;
+using common::render::MipmapGenerator;
+using common::render::compression::BlockFormat;
+using common::render::compression::Ktx2Image;
+
+bool ends_with_ignore_case(const std::string& s, const std::string& suffix)
+{
+    if(s.size() < suffix.size())
+        return false;
+
+    return std::equal(
+        std::rbegin(suffix),
+        std::rend(suffix),
+        std::rbegin(s),
+        [](const char& c1, const char& c2)
+        {
+            return ((c1 == c2) || (std::toupper(c1) == std::toupper(c2)));
+        }
+    );
+}
+
+BlockFormat select_format(const Image& image)
+{
+    if(image.GetPixelType() != Image::PixelType::UnsignedByte)
+        return BlockFormat::BC6H;
+    if(image.GetColorFormat() == Image::ColorFormat::R)
+        return BlockFormat::BC4;
+    if(image.GetColorFormat() == Image::ColorFormat::RG)
+        return BlockFormat::BC5;
+    return BlockFormat::BC7;
+}
+
+const char* to_string(BlockFormat format)
+{
+    switch(format)
+    {
+    case BlockFormat::BC1:
+        return "BC1";
+    case BlockFormat::BC3:
+        return "BC3";
+    case BlockFormat::BC4:
+        return "BC4";
+    case BlockFormat::BC5:
+        return "BC5";
+    case BlockFormat::BC6H:
+        return "BC6H";
+    case BlockFormat::BC7:
+        return "BC7";
+    default:
+        return "Unknown";
+    }
+}
+
+template<typename T>
+using Level = MipmapGenerator::Level<T>;
+
+// Expands the image to RGBA8 so that every LDR encoder can read it.
+Level<std::uint8_t> to_rgba8(const Image& image)
+{
+    const auto num_of_channels = static_cast<std::size_t>(image.GetColorFormat());
+    const auto num_of_pixels = image.GetWidth() * image.GetHeight();
+    const auto src = image.GetData();
+
+    Level<std::uint8_t> level{ image.GetWidth(), image.GetHeight(), std::vector<std::uint8_t>(num_of_pixels * 4) };
+    for(std::size_t i = 0; i < num_of_pixels; i++)
+    {
+        for(std::size_t c = 0; c < 4; c++)
+        {
+            const std::uint8_t fill = (c == 3) ? 255 : 0;
+            level.texels[i * 4 + c] = (c < num_of_channels) ? src[i * num_of_channels + c] : fill;
+        }
+    }
+    return level;
+}
+
+// Converts the image to RGB32F for BC6H.
+Level<float> to_rgb32f(const Image& image)
+{
+    const auto num_of_channels = static_cast<std::size_t>(image.GetColorFormat());
+    const auto num_of_pixels = image.GetWidth() * image.GetHeight();
+    const auto is_half = (image.GetPixelType() == Image::PixelType::Half);
+
+    Level<float> level{ image.GetWidth(), image.GetHeight(), std::vector<float>(num_of_pixels * 3) };
+    for(std::size_t i = 0; i < num_of_pixels; i++)
+    {
+        for(std::size_t c = 0; c < 3; c++)
+        {
+            const auto index = i * num_of_channels + std::min(c, num_of_channels - 1);
+            float value;
+            if(is_half)
+            {
+                std::uint16_t half;
+                std::memcpy(&half, image.GetData() + index * sizeof(half), sizeof(half));
+                value = common::render::compression::HalfToFloat(half);
+            }
+            else
+            {
+                std::memcpy(&value, image.GetData() + index * sizeof(value), sizeof(value));
+            }
+            level.texels[i * 3 + c] = value;
+        }
+    }
+    return level;
+}
+
+template<typename T>
+void compress_levels(Ktx2Image& ktx2, const Level<T>& base, std::size_t num_of_channels, const CompressorOptions& options)
+{
+    using common::render::compression::Compress;
+
+    const auto format = ktx2.GetBlockFormat();
+    ktx2.AddLevel(Compress(format, base.texels.data(), base.width, base.height, options.num_of_threads));
+    if(!options.generate_mipmap)
+        return;
+
+    const MipmapGenerator generator(options.filter, options.num_of_threads);
+    std::vector<MipmapGenerator::Level<T>> levels;
+    if constexpr(std::is_same_v<T, std::uint8_t>)
+        levels = generator.Generate(base.texels.data(), base.width, base.height, num_of_channels, ktx2.IsSRGB());
+    else
+        levels = generator.Generate(base.texels.data(), base.width, base.height, num_of_channels);
+
+    for(const auto& level : levels)
+        ktx2.AddLevel(Compress(format, level.texels.data(), level.width, level.height, options.num_of_threads));
+}
+
+}
+
+bool CompressFile(const std::filesystem::path& filepath, const CompressorOptions& options)
+{
+    Image image;
+    if(!image.LoadFromFile(filepath))
+        return false;
+
+    const auto format = options.format.value_or(select_format(image));
+    const auto is_hdr_image = (image.GetPixelType() != Image::PixelType::UnsignedByte);
+    if(common::render::compression::IsHDR(format) != is_hdr_image)
+    {
+        LOG_E(to_string(format) << " cannot be used for `" << filepath.string() << "`.");
+        return false;
+    }
+
+    // Same naming rule as Texture.
+    const auto is_srgb = !ends_with_ignore_case(filepath.stem().string(), "_linear")
+        && ((format == BlockFormat::BC1) || (format == BlockFormat::BC3) || (format == BlockFormat::BC7));
+
+    LOG_I("Compressing `" << filepath.string() << "`. [format=" << to_string(format) << (is_srgb ? "_SRGB" : "") << "]");
+
+    const auto start = std::chrono::steady_clock::now();
+
+    Ktx2Image ktx2(format, is_srgb, static_cast<std::uint32_t>(image.GetWidth()), static_cast<std::uint32_t>(image.GetHeight()));
+    if(is_hdr_image)
+        compress_levels(ktx2, to_rgb32f(image), 3, options);
+    else
+        compress_levels(ktx2, to_rgba8(image), 4, options);
+
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    auto ktx2_filepath = filepath;
+    ktx2_filepath.replace_extension(".ktx2");
+    if(!ktx2.SaveToFile(ktx2_filepath))
+        return false;
+
+    LOG_I("Saved `" << ktx2_filepath.string() << "`. [levels=" << ktx2.GetNumOfLevels() << ", time=" << elapsed << "ms]");
+
+    return true;
+}
\ No newline at end of file
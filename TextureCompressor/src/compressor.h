@@ -0,0 +1,19 @@
+#pragma once
+#include <filesystem>
+#include <optional>
+#include "../../common/render/compression/block_compression.h"
+#include "../../common/render/mipmap_generator.h"
+
+struct CompressorOptions
+{
+    // Chosen from the image when not specified.
+    std::optional<common::render::compression::BlockFormat> format;
+    bool generate_mipmap = true;
+    common::render::MipmapGenerator::Filter filter = common::render::MipmapGenerator::Filter::Kaiser;
+    unsigned int num_of_threads = 0;
+};
+
+/*!
+ * Compresses an image into `<stem>.ktx2` next to it, which Texture picks up instead of the source image.
+ */
+bool CompressFile(const std::filesystem::path& filepath, const CompressorOptions& options);
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <hasenpfote/log/console_appender.h>
+#include "../../common/logger.h"
+#include "compressor.h"
+
+namespace
+{
+
+void print_usage()
+{
+    std::cout
+        << "Usage: TextureCompressor [options] <file or directory>..." << std::endl
+        << "Options:" << std::endl
+        << "  --format <bc1|bc3|bc4|bc5|bc6h|bc7>  Block format. Chosen from the image by default." << std::endl
+        << "  --filter <box|kaiser|lanczos>        Mipmap filter. kaiser by default." << std::endl
+        << "  --threads <n>                        Number of threads. All hardware threads by default." << std::endl
+        << "  --no-mipmap                          Compress only the base level." << std::endl;
+}
+
+bool is_image_file(const std::filesystem::path& filepath)
+{
+    const auto extension = filepath.extension();
+    return (extension == ".png") || (extension == ".exr");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace hasenpfote::log;
+    common::Logger::GetMutableInstance().AddAppender<ConsoleAppender>(std::make_shared<ConsoleAppender>());
+
+    using common::render::compression::BlockFormat;
+    const std::map<std::string, BlockFormat> formats = {
+        { "bc1", BlockFormat::BC1 },
+        { "bc3", BlockFormat::BC3 },
+        { "bc4", BlockFormat::BC4 },
+        { "bc5", BlockFormat::BC5 },
+        { "bc6h", BlockFormat::BC6H },
+        { "bc7", BlockFormat::BC7 }
+    };
+
+    using common::render::MipmapGenerator;
+    const std::map<std::string, MipmapGenerator::Filter> filters = {
+        { "box", MipmapGenerator::Filter::Box },
+        { "kaiser", MipmapGenerator::Filter::Kaiser },
+        { "lanczos", MipmapGenerator::Filter::Lanczos }
+    };
+
+    CompressorOptions options;
+    std::vector<std::filesystem::path> filepaths;
+
+    try{
+        for(int i = 1; i < argc; i++)
+        {
+            if((std::strcmp(argv[i], "--format") == 0) && (i + 1 < argc))
+            {
+                options.format = formats.at(argv[++i]);
+            }
+            else if((std::strcmp(argv[i], "--filter") == 0) && (i + 1 < argc))
+            {
+                options.filter = filters.at(argv[++i]);
+            }
+            else if((std::strcmp(argv[i], "--threads") == 0) && (i + 1 < argc))
+            {
+                options.num_of_threads = static_cast<unsigned int>(std::stoul(argv[++i]));
+            }
+            else if(std::strcmp(argv[i], "--no-mipmap") == 0)
+            {
+                options.generate_mipmap = false;
+            }
+            else if(argv[i][0] == '-')
+            {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+            else if(std::filesystem::is_directory(argv[i]))
+            {
+                for(const auto& entry : std::filesystem::recursive_directory_iterator(argv[i]))
+                {
+                    if(entry.is_regular_file() && is_image_file(entry.path()))
+                        filepaths.push_back(entry.path());
+                }
+            }
+            else
+            {
+                filepaths.emplace_back(argv[i]);
+            }
+        }
+    }
+    catch(const std::exception&){
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    if(filepaths.empty())
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    bool succeeded = true;
+    for(const auto& filepath : filepaths)
+    {
+        try{
+            if(!CompressFile(filepath, options))
+                succeeded = false;
+        }
+        catch(const std::exception& e){
+            LOG_E("Exception: " << e.what());
+            succeeded = false;
+        }
+    }
+    return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -42,6 +42,9 @@ function(make_simple_example_project project_name uses_imgui)
     ### Compiler settings.
     include(compiler_settings)
 
+    ### Threads.
+    find_package(Threads REQUIRED)
+
     ### The relative path from `CMAKE_CURRENT_SOURCE_DIR`.
     set(SRC_DIR "src")
 
@@ -130,6 +133,7 @@ function(make_simple_example_project project_name uses_imgui)
         glew_s
         glm
         hasenpfote
+        Threads::Threads
     )
 
     ### Install.
@@ -0,0 +1,145 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+#include "logger.h"
+#include "memory_mapped_file.h"
+
+namespace common
+{
+
+#ifdef _WIN32
+
+MemoryMappedFile::MemoryMappedFile()
+    : data_(nullptr), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+{
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile()
+    : data_(nullptr), size_(0), fd_(-1)
+{
+}
+
+#endif
+
+MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& filepath)
+    : MemoryMappedFile()
+{
+    Open(filepath);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MemoryMappedFile::Open(const std::filesystem::path& filepath)
+{
+    Close();
+
+    file_ = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file_ == INVALID_HANDLE_VALUE)
+    {
+        LOG_E("Failed to open file `" << filepath.string() << "`.");
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file_, &size) || (size.QuadPart == 0))
+    {
+        LOG_E("Failed to map file `" << filepath.string() << "`.");
+        Close();
+        return false;
+    }
+
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping_ != nullptr)
+        data_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if(data_ == nullptr)
+    {
+        LOG_E("Failed to map file `" << filepath.string() << "`.");
+        Close();
+        return false;
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if(data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if(mapping_ != nullptr)
+        CloseHandle(mapping_);
+    if(file_ != INVALID_HANDLE_VALUE)
+        CloseHandle(file_);
+
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MemoryMappedFile::Open(const std::filesystem::path& filepath)
+{
+    Close();
+
+    fd_ = open(filepath.c_str(), O_RDONLY);
+    if(fd_ < 0)
+    {
+        LOG_E("Failed to open file `" << filepath.string() << "`.");
+        return false;
+    }
+
+    struct stat st;
+    if((fstat(fd_, &st) != 0) || (st.st_size == 0))
+    {
+        LOG_E("Failed to map file `" << filepath.string() << "`.");
+        Close();
+        return false;
+    }
+
+    const auto size = static_cast<std::size_t>(st.st_size);
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if(data == MAP_FAILED)
+    {
+        LOG_E("Failed to map file `" << filepath.string() << "`.");
+        Close();
+        return false;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const std::uint8_t*>(data);
+    size_ = size;
+
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if(data_ != nullptr)
+        munmap(const_cast<std::uint8_t*>(data_), size_);
+    if(fd_ >= 0)
+        close(fd_);
+
+    data_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+}
+
+#endif
+
+}   // namespace common
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+
+namespace common
+{
+
+/*!
+ * @class MemoryMappedFile
+ * @brief Read-only view of a whole file mapped into memory.
+ */
+class MemoryMappedFile final
+{
+public:
+    MemoryMappedFile();
+    explicit MemoryMappedFile(const std::filesystem::path& filepath);
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator = (const MemoryMappedFile&) = delete;
+    MemoryMappedFile(MemoryMappedFile&&) = delete;
+    MemoryMappedFile& operator = (MemoryMappedFile&&) = delete;
+
+    bool Open(const std::filesystem::path& filepath);
+    void Close();
+
+    bool IsOpen() const noexcept { return data_ != nullptr; }
+    const std::uint8_t* GetData() const noexcept { return data_; }
+    std::size_t GetSize() const noexcept { return size_; }
+
+private:
+    const std::uint8_t* data_;
+    std::size_t size_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int fd_;
+#endif
+};
+
+}   // namespace common
\ No newline at end of file
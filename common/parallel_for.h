@@ -0,0 +1,47 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace common
+{
+
+/*!
+ * Calls `func(i)` for each i in [0, count), the indices are handed out to the threads one at a time.
+ * The calling thread is one of the `num_of_threads`. `func` must not throw.
+ */
+template<typename Func>
+void parallel_for(std::size_t count, unsigned int num_of_threads, const Func& func)
+{
+    std::atomic<std::size_t> next(0);
+    // std::thread asks whether the worker may throw, gcc's -Wnoexcept fires unless the answer is spelled out.
+    auto worker = [&]() noexcept
+    {
+        for(auto i = next++; i < count; i = next++)
+            func(i);
+    };
+
+    num_of_threads = static_cast<unsigned int>(std::min<std::size_t>(num_of_threads, count));
+
+    std::vector<std::thread> threads;
+    for(unsigned int i = 1; i < num_of_threads; i++)
+        threads.emplace_back(worker);
+    worker();
+    for(auto& thread : threads)
+        thread.join();
+}
+
+//! Calls `func(begin, end)` for each tile of `tile_size` indices in [0, count), the last tile may be shorter.
+template<typename Func>
+void parallel_for_tiles(std::size_t count, std::size_t tile_size, unsigned int num_of_threads, const Func& func)
+{
+    const auto num_of_tiles = (count + tile_size - 1) / tile_size;
+    parallel_for(num_of_tiles, num_of_threads, [&](std::size_t tile)
+    {
+        func(tile * tile_size, std::min(count, (tile + 1) * tile_size));
+    });
+}
+
+}   // namespace common
\ No newline at end of file
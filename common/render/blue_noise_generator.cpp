@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <hasenpfote/assert.h>
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+#include "../logger.h"
+#include "../parallel_for.h"
+#include "image.h"
+#include "blue_noise_generator.h"
+
+namespace
+{
+
+// The kernel is cut off where it has fallen to about 1e-8 of its peak.
+constexpr float kernel_extent = 6.0f;
+
+// Initial patterns have this fraction of the texels set.
+constexpr float initial_density = 0.1f;
+
+// Weights at offsets [-radius, radius] of a Gaussian wrapped on a torus of the size.
+std::vector<double> make_kernel(float sigma, std::size_t size, int& radius)
+{
+    radius = std::min(static_cast<int>(std::ceil(sigma * kernel_extent)), static_cast<int>((size - 1) / 2));
+    std::vector<double> kernel(static_cast<std::size_t>(radius) * 2 + 1);
+    for(auto i = -radius; i <= radius; i++)
+        kernel[static_cast<std::size_t>(i + radius)] = std::exp(-static_cast<double>(i * i) / (2.0 * sigma * sigma));
+    return kernel;
+}
+
+/*
+ * The binary pattern and its energy, with the lowest energy among the unset texels(voids) and the highest among
+ * the set texels(clusters) of every row. A row is a line along x in one layer.
+ */
+class Field final
+{
+public:
+    Field(std::size_t width, std::size_t height, std::size_t depth, float sigma, float temporal_sigma)
+        : width_(width), height_(height), depth_(depth), num_of_rows_(height * depth),
+          pattern_(width * height * depth, 0), energy_(width * height * depth, 0.0),
+          voids_(num_of_rows_), clusters_(num_of_rows_)
+    {
+        kx_ = make_kernel(sigma, width, rx_);
+        ky_ = make_kernel(sigma, height, ry_);
+        kz_ = make_kernel(temporal_sigma, depth, rz_);
+    }
+
+    std::size_t GetSize() const noexcept { return pattern_.size(); }
+
+    //! Sets the texels without updating the energy, Relax() or Convolve() must follow.
+    void Scatter(std::size_t count, std::uint32_t seed)
+    {
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<std::size_t> distribution(0, pattern_.size() - 1);
+        for(std::size_t i = 0; i < count;)
+        {
+            auto& p = pattern_[distribution(engine)];
+            if(p == 0)
+            {
+                p = 1;
+                i++;
+            }
+        }
+    }
+
+    //! Recomputes the energy of the whole pattern with a separable convolution.
+    void Convolve(unsigned int num_of_threads)
+    {
+        std::vector<double> temp(energy_.size());
+        std::transform(pattern_.cbegin(), pattern_.cend(), energy_.begin(), [](std::uint8_t p){ return static_cast<double>(p); });
+
+        // Along x, y and z in turn, each line on its own.
+        const std::size_t sizes[] = { width_, height_, depth_ };
+        const std::size_t strides[] = { 1, width_, width_ * height_ };
+        const std::vector<double>* kernels[] = { &kx_, &ky_, &kz_ };
+        const int radii[] = { rx_, ry_, rz_ };
+        for(std::size_t axis = 0; axis < 3; axis++)
+        {
+            const auto size = sizes[axis];
+            const auto stride = strides[axis];
+            const auto& kernel = *kernels[axis];
+            const auto radius = radii[axis];
+            const auto num_of_lines = energy_.size() / size;
+            common::parallel_for(num_of_lines, num_of_threads, [&](std::size_t line)
+            {
+                // The first texel of the line, the lines of an axis are in row-major order of the other two.
+                const auto first = (line / stride) * stride * size + (line % stride);
+                for(std::size_t i = 0; i < size; i++)
+                {
+                    auto sum = 0.0;
+                    for(auto k = -radius; k <= radius; k++)
+                    {
+                        const auto j = (i + static_cast<std::size_t>(k + static_cast<int>(size))) % size;
+                        sum += energy_[first + j * stride] * kernel[static_cast<std::size_t>(k + radius)];
+                    }
+                    temp[first + i * stride] = sum;
+                }
+            });
+            energy_.swap(temp);
+        }
+
+        common::parallel_for(num_of_rows_, num_of_threads, [this](std::size_t row){ update_row(row); });
+    }
+
+    //! Flips the texel and updates the energy within the reach of the kernel.
+    void Toggle(std::size_t index)
+    {
+        auto& p = pattern_[index];
+        p = (p != 0) ? 0 : 1;
+        const auto sign = (p != 0) ? 1.0 : -1.0;
+
+        const auto x = index % width_;
+        const auto y = (index / width_) % height_;
+        const auto z = index / (width_ * height_);
+        for(auto dz = -rz_; dz <= rz_; dz++)
+        {
+            const auto zz = (z + static_cast<std::size_t>(dz + static_cast<int>(depth_))) % depth_;
+            const auto wz = sign * kz_[static_cast<std::size_t>(dz + rz_)];
+            for(auto dy = -ry_; dy <= ry_; dy++)
+            {
+                const auto yy = (y + static_cast<std::size_t>(dy + static_cast<int>(height_))) % height_;
+                const auto wy = wz * ky_[static_cast<std::size_t>(dy + ry_)];
+                const auto row = zz * height_ + yy;
+                auto energy = energy_.begin() + static_cast<std::ptrdiff_t>(row * width_);
+                for(auto dx = -rx_; dx <= rx_; dx++)
+                {
+                    const auto xx = (x + static_cast<std::size_t>(dx + static_cast<int>(width_))) % width_;
+                    energy[static_cast<std::ptrdiff_t>(xx)] += wy * kx_[static_cast<std::size_t>(dx + rx_)];
+                }
+                update_row(row);
+            }
+        }
+    }
+
+    std::size_t FindLargestVoid() const
+    {
+        auto it = std::min_element(voids_.cbegin(), voids_.cend(), [](const auto& a, const auto& b){ return a.value < b.value; });
+        return static_cast<std::size_t>(std::distance(voids_.cbegin(), it)) * width_ + it->x;
+    }
+
+    std::size_t FindTightestCluster() const
+    {
+        auto it = std::max_element(clusters_.cbegin(), clusters_.cend(), [](const auto& a, const auto& b){ return a.value < b.value; });
+        return static_cast<std::size_t>(std::distance(clusters_.cbegin(), it)) * width_ + it->x;
+    }
+
+    //! Moves the tightest cluster to the largest void until that would put it back.
+    void Relax()
+    {
+        for(std::size_t i = 0; i < pattern_.size(); i++)
+        {
+            const auto cluster = FindTightestCluster();
+            Toggle(cluster);
+            const auto hole = FindLargestVoid();
+            Toggle(hole);
+            if(hole == cluster)
+                break;
+        }
+    }
+
+private:
+    struct Extremum
+    {
+        double value;
+        std::size_t x;
+    };
+
+    void update_row(std::size_t row)
+    {
+        auto& v = voids_[row];
+        auto& c = clusters_[row];
+        v = { std::numeric_limits<double>::max(), 0 };
+        c = { std::numeric_limits<double>::lowest(), 0 };
+
+        const auto first = row * width_;
+        for(std::size_t x = 0; x < width_; x++)
+        {
+            const auto e = energy_[first + x];
+            if(pattern_[first + x] != 0)
+            {
+                if(e > c.value)
+                    c = { e, x };
+            }
+            else
+            {
+                if(e < v.value)
+                    v = { e, x };
+            }
+        }
+    }
+
+private:
+    std::size_t width_, height_, depth_, num_of_rows_;
+    std::vector<double> kx_, ky_, kz_;
+    int rx_, ry_, rz_;
+    std::vector<std::uint8_t> pattern_;
+    std::vector<double> energy_;
+    std::vector<Extremum> voids_;
+    std::vector<Extremum> clusters_;
+};
+
+// The mask only depends on these, they are written next to the cache so that a change of any of them regenerates it.
+std::string make_parameters(std::size_t width, std::size_t height, std::size_t depth, float sigma, float temporal_sigma, std::uint32_t seed)
+{
+    std::ostringstream oss;
+    oss.precision(std::numeric_limits<float>::max_digits10);
+    oss << "size=" << width << "x" << height << "x" << depth
+        << " sigma=" << sigma << " temporal_sigma=" << temporal_sigma << " seed=" << seed << "\n";
+    return oss.str();
+}
+
+std::filesystem::path get_parameters_path(const std::filesystem::path& filepath)
+{
+    auto path = filepath;
+    path += ".txt";
+    return path;
+}
+
+std::string read_text(const std::filesystem::path& filepath)
+{
+    std::ifstream ifs(filepath, std::ios::in | std::ios::binary);
+    if(!ifs)
+        return std::string();
+    return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+}
+
+namespace common::render
+{
+
+BlueNoiseGenerator::BlueNoiseGenerator(float sigma, float temporal_sigma, unsigned int num_of_threads)
+    : sigma_(sigma), temporal_sigma_(temporal_sigma),
+      num_of_threads_((num_of_threads > 0) ? num_of_threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+    HASENPFOTE_ASSERT(sigma > 0.0f);
+    HASENPFOTE_ASSERT(temporal_sigma > 0.0f);
+}
+
+std::vector<float> BlueNoiseGenerator::Generate(std::size_t width, std::size_t height, std::size_t depth, std::uint32_t seed) const
+{
+    HASENPFOTE_ASSERT((width > 0) && (height > 0) && (depth > 0));
+
+    Field field(width, height, depth, sigma_, temporal_sigma_);
+    const auto size = field.GetSize();
+    std::vector<std::size_t> ranks(size);
+
+    // 1) Spread a random pattern evenly.
+    const auto num_of_initial = std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<float>(size) * initial_density));
+    field.Scatter(num_of_initial, seed);
+    field.Convolve(num_of_threads_);
+    field.Relax();
+
+    // 2) Rank the initial texels by taking the tightest cluster away one at a time.
+    {
+        Field temp = field;
+        for(auto rank = num_of_initial; rank > 0; rank--)
+        {
+            const auto cluster = temp.FindTightestCluster();
+            temp.Toggle(cluster);
+            ranks[cluster] = rank - 1;
+        }
+    }
+    // 3) Rank the others by filling the largest void one at a time.
+    // Past half of the texels, the largest void of the set texels is also the tightest cluster of the unset ones.
+    for(auto rank = num_of_initial; rank < size; rank++)
+    {
+        const auto hole = field.FindLargestVoid();
+        field.Toggle(hole);
+        ranks[hole] = rank;
+    }
+
+    std::vector<float> thresholds(size);
+    std::transform(ranks.cbegin(), ranks.cend(), thresholds.begin(), [size](std::size_t rank)
+    {
+        return static_cast<float>(rank) / static_cast<float>(size);
+    });
+    return thresholds;
+}
+
+std::vector<std::uint8_t> BlueNoiseGenerator::LoadOrGenerate(const std::filesystem::path& filepath, std::size_t width, std::size_t height, std::size_t depth) const
+{
+    constexpr std::uint32_t seed = 0;
+    const auto parameters = make_parameters(width, height, depth, sigma_, temporal_sigma_, seed);
+    const auto parameters_path = get_parameters_path(filepath);
+
+    if(std::filesystem::exists(filepath))
+    {
+        Image image;
+        if((read_text(parameters_path) == parameters)
+            && image.LoadFromFile(filepath)
+            && (image.GetColorFormat() == Image::ColorFormat::R)
+            && (image.GetWidth() == width)
+            && (image.GetHeight() == height * depth))
+        {
+            return std::vector<std::uint8_t>(image.GetData(), image.GetData() + image.GetDataSize());
+        }
+        LOG_W("Blue noise cache does not match, regenerating. [path=" << filepath.string() << "]");
+    }
+
+    LOG_I("Generating blue noise. [size=" << width << "x" << height << "x" << depth << "]");
+
+    const auto thresholds = Generate(width, height, depth, seed);
+    std::vector<std::uint8_t> pixels(thresholds.size());
+    std::transform(thresholds.cbegin(), thresholds.cend(), pixels.begin(), [](float t)
+    {
+        return static_cast<std::uint8_t>(t * 256.0f);
+    });
+
+    std::error_code ec;
+    if(filepath.has_parent_path())
+        std::filesystem::create_directories(filepath.parent_path(), ec);
+    const auto w = static_cast<int>(width);
+    if(stbi_write_png(filepath.string().c_str(), w, static_cast<int>(height * depth), 1, pixels.data(), w) == 0)
+    {
+        LOG_W("Failed to cache blue noise. [path=" << filepath.string() << "]");
+        return pixels;
+    }
+    std::ofstream ofs(parameters_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!(ofs << parameters))
+        LOG_W("Failed to cache blue noise parameters. [path=" << parameters_path.string() << "]");
+    return pixels;
+}
+
+}   // namespace common::render
\ No newline at end of file
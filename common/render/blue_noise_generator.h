@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace common::render
+{
+
+/*!
+ * @class BlueNoiseGenerator
+ * @brief Builds tileable blue noise threshold masks with the void-and-cluster method.
+ *
+ * Texels are ranked by repeatedly taking the tightest cluster or the largest void of a binary pattern, measured as the
+ * energy of a Gaussian on a torus. The initial energy is computed by a separable convolution split across threads.
+ * After that each step only updates the window the kernel reaches, and keeps the extrema of every row up to date so
+ * that the next texel is found without scanning the whole mask.
+ * A mask with more than one layer is spatio-temporal: the kernel also spans the layers, so each texel is spread over
+ * time as well as over the screen.
+ */
+class BlueNoiseGenerator final
+{
+public:
+    explicit BlueNoiseGenerator(float sigma = 1.5f, float temporal_sigma = 1.0f, unsigned int num_of_threads = 0);
+    ~BlueNoiseGenerator() = default;
+
+    BlueNoiseGenerator(const BlueNoiseGenerator&) = delete;
+    BlueNoiseGenerator& operator = (const BlueNoiseGenerator&) = delete;
+    BlueNoiseGenerator(BlueNoiseGenerator&&) = delete;
+    BlueNoiseGenerator& operator = (BlueNoiseGenerator&&) = delete;
+
+    /*!
+     * @return the threshold of every texel in [0, 1), x first and layer last.
+     */
+    std::vector<float> Generate(std::size_t width, std::size_t height, std::size_t depth = 1, std::uint32_t seed = 0) const;
+
+    /*!
+     * Loads the mask cached at the path, or generates and caches it there when it is missing or was generated with another
+     * size or sigma.
+     * The cache is an 8-bit grayscale PNG with the layers stacked vertically, so it can be loaded as a texture.
+     * The parameters it was generated with are kept in a text file of the same name with ".txt" appended.
+     * @return the thresholds scaled to [0, 255].
+     */
+    std::vector<std::uint8_t> LoadOrGenerate(const std::filesystem::path& filepath, std::size_t width, std::size_t height, std::size_t depth = 1) const;
+
+private:
+    float sigma_;
+    float temporal_sigma_;
+    unsigned int num_of_threads_;
+};
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include <hasenpfote/assert.h>
+#include "../logger.h"
+#include "blur_tuner.h"
+
+namespace
+{
+
+// Measurements become available after the latency of the timers.
+constexpr std::size_t timer_latency = 4;
+
+}
+
+namespace common::render
+{
+
+BlurTuner::BlurTuner(float tolerance, std::size_t num_of_frames)
+    : tolerance_(tolerance), num_of_frames_(num_of_frames), key_(0, 0, 0, 0.0f), frame_(0)
+{
+    HASENPFOTE_ASSERT(tolerance >= 0.0f);
+    HASENPFOTE_ASSERT(num_of_frames > 0);
+}
+
+float BlurTuner::CalcKawaseSigma(const std::vector<int>& iterations)
+{
+    // Per axis, an iteration picks the texels at +-i and +-(i + 1) with equal weights.
+    float variance = 0.0f;
+    for(auto i : iterations)
+        variance += static_cast<float>((i + 1) * (i + 1) + i * i) * 0.5f;
+    return std::sqrt(variance);
+}
+
+float BlurTuner::CalcDualKawaseSigma(int num_of_levels)
+{
+    // Going down from level k and back up adds a variance of 5/3 in texels of level k, 5 * (4^n - 1) / 9 in total.
+    const auto n = std::pow(4.0f, static_cast<float>(num_of_levels));
+    return std::sqrt(5.0f * (n - 1.0f) / 9.0f);
+}
+
+std::optional<std::string> BlurTuner::Tune(GLsizei width, GLsizei height, GLenum internal_format, float sigma, const std::vector<Candidate>& candidates)
+{
+    HASENPFOTE_ASSERT(!candidates.empty());
+
+    const Key key(width, height, internal_format, sigma);
+    auto it = results_.find(key);
+    if(it != results_.cend())
+        return it->second;
+
+    // Starts over whenever the configuration changes in the middle of tuning.
+    if(!IsTuning() || (key != key_))
+    {
+        key_ = key;
+        frame_ = 0;
+        indices_.clear();
+        timers_.clear();
+        elapsed_.clear();
+
+        for(std::size_t i = 0; i < candidates.size(); i++)
+        {
+            if(std::abs(candidates[i].sigma - sigma) <= tolerance_ * sigma)
+                indices_.push_back(i);
+        }
+        if(indices_.empty())
+        {
+            auto closest = std::min_element(candidates.cbegin(), candidates.cend(), [sigma](const auto& a, const auto& b)
+            {
+                return std::abs(a.sigma - sigma) < std::abs(b.sigma - sigma);
+            });
+            LOG_W("No blur is within the tolerance. [sigma=" << sigma << ", closest=" << closest->name << "]");
+            finish(closest->name);
+            return closest->name;
+        }
+        if(indices_.size() == 1)
+        {
+            const auto name = candidates[indices_.front()].name;
+            finish(name);
+            return name;
+        }
+
+        for(std::size_t i = 0; i < indices_.size(); i++)
+        {
+            timers_.push_back(std::make_unique<GpuTimer>(timer_latency));
+            elapsed_.push_back(0.0);
+        }
+    }
+
+    for(std::size_t i = 0; i < indices_.size(); i++)
+    {
+        timers_[i]->Begin();
+        candidates[indices_[i]].execute();
+        timers_[i]->End();
+        if(frame_ >= timer_latency)
+            elapsed_[i] += timers_[i]->GetElapsedTime();
+    }
+    if(++frame_ < timer_latency + num_of_frames_)
+        return std::nullopt;
+
+    const auto best = static_cast<std::size_t>(std::distance(elapsed_.cbegin(), std::min_element(elapsed_.cbegin(), elapsed_.cend())));
+    const auto& name = candidates[indices_[best]].name;
+    LOG_I("Blur tuned. [size=" << width << "x" << height << ", format=" << internal_format << ", sigma=" << sigma
+        << ", name=" << name << ", time=" << elapsed_[best] / static_cast<double>(num_of_frames_) << "ms]");
+    finish(name);
+    return name;
+}
+
+void BlurTuner::Clear()
+{
+    results_.clear();
+    indices_.clear();
+    timers_.clear();
+    elapsed_.clear();
+}
+
+void BlurTuner::finish(const std::string& name)
+{
+    results_.emplace(key_, name);
+    indices_.clear();
+    timers_.clear();
+    elapsed_.clear();
+}
+
+}   // namespace common::render
\ No newline at end of file
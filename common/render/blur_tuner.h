@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <GL/glew.h>
+#include "gpu_timer.h"
+
+namespace common::render
+{
+
+/*!
+ * @class BlurTuner
+ * @brief Picks the fastest blur that approximates a Gaussian of the requested sigma closely enough.
+ *
+ * Candidates whose effective sigma is within the relative tolerance of the request are all run once per frame,
+ * each under its own GpuTimer, for a number of frames. The one with the lowest total time wins and is cached by
+ * the resolution and format of the image, so each configuration is tuned once on each machine.
+ * If no candidate is within the tolerance, the closest one is chosen without measuring.
+ */
+class BlurTuner final
+{
+public:
+    struct Candidate
+    {
+        std::string name;
+        float sigma;                    // Effective Gaussian sigma in texels.
+        std::function<void()> execute;  // Runs the blur once.
+    };
+
+public:
+    explicit BlurTuner(float tolerance = 0.15f, std::size_t num_of_frames = 16);
+    ~BlurTuner() = default;
+
+    BlurTuner(const BlurTuner&) = delete;
+    BlurTuner& operator = (const BlurTuner&) = delete;
+    BlurTuner(BlurTuner&&) = delete;
+    BlurTuner& operator = (BlurTuner&&) = delete;
+
+    //! Sigma of a sequence of Kawase iterations, each averaging four bilinear taps at (i + 0.5) texels.
+    static float CalcKawaseSigma(const std::vector<int>& iterations);
+    //! Sigma of a Dual Kawase blur through `num_of_levels` half resolution levels, averaged over the texel phase.
+    static float CalcDualKawaseSigma(int num_of_levels);
+
+    /*!
+     * Advances the tuning of the configuration by a frame. The candidates must be the same every frame until it returns.
+     * @return the name of the chosen candidate, or nothing while the candidates are being measured.
+     */
+    std::optional<std::string> Tune(GLsizei width, GLsizei height, GLenum internal_format, float sigma, const std::vector<Candidate>& candidates);
+
+    bool IsTuning() const noexcept { return !timers_.empty(); }
+    //! Forgets every result, e.g. after the candidates have changed.
+    void Clear();
+
+private:
+    using Key = std::tuple<GLsizei, GLsizei, GLenum, float>;
+
+    void finish(const std::string& name);
+
+private:
+    float tolerance_;
+    std::size_t num_of_frames_;
+    std::map<Key, std::string> results_;
+
+    // The configuration being tuned.
+    Key key_;
+    std::size_t frame_;
+    std::vector<std::size_t> indices_;
+    std::vector<std::unique_ptr<GpuTimer>> timers_;
+    std::vector<double> elapsed_;
+};
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <hasenpfote/assert.h>
+#include "../parallel_for.h"
+#include "color_lut.h"
+
+namespace
+{
+
+using ColorLut = common::render::ColorLut;
+
+constexpr float middle_grey = 0.18f;
+
+glm::vec3 aces_film(const glm::vec3& x)
+{
+    constexpr float a = 2.51f;
+    constexpr float b = 0.03f;
+    constexpr float c = 2.43f;
+    constexpr float d = 0.59f;
+    constexpr float e = 0.14f;
+    return glm::clamp((x * (a * x + b)) / (x * (c * x + d) + e), glm::vec3(0.0f), glm::vec3(1.0f));
+}
+
+float linear_to_srgb(float u)
+{
+    if(u <= 0.0031308f)
+        return 12.92f * u;
+    return 1.055f * std::pow(u, 1.0f / 2.4f) - 0.055f;
+}
+
+std::vector<glm::vec4> bake(GLsizei size, unsigned int num_of_threads, const ColorLut::Grade& grade)
+{
+    const auto n = static_cast<std::size_t>(size);
+    std::vector<glm::vec4> texels(n * n * n);
+
+    // Texel i holds the color at the shaper value i / (size - 1), the shader samples texel centers accordingly.
+    std::vector<float> decoded(n);
+    for(std::size_t i = 0; i < n; i++)
+    {
+        const auto t = static_cast<float>(i) / static_cast<float>(n - 1);
+        decoded[i] = std::exp2(ColorLut::min_log2 + t * (ColorLut::max_log2 - ColorLut::min_log2));
+    }
+
+    common::parallel_for(n, num_of_threads, [&](std::size_t b)
+    {
+        auto texel = texels.begin() + static_cast<std::ptrdiff_t>(b * n * n);
+        for(std::size_t g = 0; g < n; g++)
+        {
+            for(std::size_t r = 0; r < n; r++)
+                *texel++ = glm::vec4(ColorLut::Evaluate(glm::vec3(decoded[r], decoded[g], decoded[b]), grade), 1.0f);
+        }
+    });
+    return texels;
+}
+
+}
+
+namespace common::render
+{
+
+ColorLut::ColorLut(GLsizei size, unsigned int num_of_threads)
+    : size_(size),
+      num_of_threads_((num_of_threads > 0) ? num_of_threads : std::max(1u, std::thread::hardware_concurrency())),
+      texture_(0)
+{
+    HASENPFOTE_ASSERT(size >= 2);
+
+    glCreateTextures(GL_TEXTURE_3D, 1, &texture_);
+    glTextureStorage3D(texture_, 1, GL_RGBA16F, size, size, size);
+    glTextureParameteri(texture_, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(texture_, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(texture_, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture_, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture_, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    upload(bake(size_, num_of_threads_, grade_));
+}
+
+ColorLut::~ColorLut()
+{
+    // A running bake only touches its own data, it is waited for rather than abandoned.
+    if(bake_.valid())
+        bake_.wait();
+    if(glIsTexture(texture_))
+        glDeleteTextures(1, &texture_);
+}
+
+glm::vec3 ColorLut::Evaluate(const glm::vec3& color, const Grade& grade)
+{
+    auto c = glm::max(color * grade.gain, glm::vec3(0.0f));
+
+    // Contrast pivots around middle grey so that the exposure is preserved.
+    c = middle_grey * glm::pow(c / middle_grey, glm::vec3(grade.contrast));
+
+    const auto luminance = glm::dot(c, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    c = glm::max(glm::vec3(luminance) + (c - glm::vec3(luminance)) * grade.saturation, glm::vec3(0.0f));
+
+    c = aces_film(c);
+    return glm::vec3(linear_to_srgb(c.x), linear_to_srgb(c.y), linear_to_srgb(c.z));
+}
+
+void ColorLut::SetGrade(const Grade& grade)
+{
+    if(grade == (pending_ ? *pending_ : grade_))
+        return;
+
+    if(IsBaking())
+    {
+        // Going back to the grade being baked cancels the pending one.
+        if(grade == grade_)
+            pending_.reset();
+        else
+            pending_ = grade;
+        return;
+    }
+    start_bake(grade);
+}
+
+bool ColorLut::Update()
+{
+    if(!IsBaking() || (bake_.wait_for(std::chrono::seconds(0)) != std::future_status::ready))
+        return false;
+
+    upload(bake_.get());
+
+    // Only the latest of the grades requested in the meantime is baked.
+    if(pending_)
+    {
+        start_bake(*pending_);
+        pending_.reset();
+    }
+    return true;
+}
+
+void ColorLut::start_bake(const Grade& grade)
+{
+    grade_ = grade;
+    bake_ = std::async(std::launch::async, bake, size_, num_of_threads_, grade);
+}
+
+void ColorLut::upload(const std::vector<glm::vec4>& texels)
+{
+    const auto n = static_cast<std::size_t>(size_);
+    HASENPFOTE_ASSERT(texels.size() == n * n * n);
+
+    glTextureSubImage3D(texture_, 0, 0, 0, 0, size_, size_, size_, GL_RGBA, GL_FLOAT, texels.data());
+}
+
+}   // namespace common::render
\ No newline at end of file
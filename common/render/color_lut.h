@@ -0,0 +1,79 @@
+#pragma once
+#include <future>
+#include <optional>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+namespace common::render
+{
+
+/*!
+ * @class ColorLut
+ * @brief Bakes the tone mapping, the color grading and the sRGB encoding into a 3D texture.
+ *
+ * HDR colors are mapped to texture coordinates through a log2 shaper covering [2^min_log2, 2^max_log2], so the
+ * LUT spends its texels evenly over the stops rather than over the linear range. The chain is evaluated on the CPU
+ * with the slices split across threads. Changing the grade re-bakes on a background thread while the previous
+ * LUT stays in use, Update() uploads the result once it is ready.
+ */
+class ColorLut final
+{
+public:
+    static constexpr float min_log2 = -12.0f;
+    static constexpr float max_log2 = 6.0f;
+
+    struct Grade
+    {
+        float contrast = 1.0f;                  // Slope in log2 space around middle grey.
+        float saturation = 1.0f;
+        glm::vec3 gain = glm::vec3(1.0f);       // Per channel scale, e.g. for white balance.
+
+        bool operator == (const Grade& other) const noexcept
+        {
+            return (contrast == other.contrast) && (saturation == other.saturation) && (gain == other.gain);
+        }
+        bool operator != (const Grade& other) const noexcept { return !(*this == other); }
+    };
+
+public:
+    //! Bakes the default grade before returning, so the texture is always valid.
+    explicit ColorLut(GLsizei size = 32, unsigned int num_of_threads = 0);
+    ~ColorLut();
+
+    ColorLut(const ColorLut&) = delete;
+    ColorLut& operator = (const ColorLut&) = delete;
+    ColorLut(ColorLut&&) = delete;
+    ColorLut& operator = (ColorLut&&) = delete;
+
+    //! Evaluates the chain for a linear HDR color, as the LUT stores it.
+    static glm::vec3 Evaluate(const glm::vec3& color, const Grade& grade);
+
+    //! Requests a re-bake if the grade differs from the last one requested.
+    void SetGrade(const Grade& grade);
+    const Grade& GetGrade() const noexcept { return grade_; }
+
+    /*!
+     * Uploads a finished bake. Must be called on the thread that owns the GL context.
+     * @return true if the texture has been updated.
+     */
+    bool Update();
+    bool IsBaking() const noexcept { return bake_.valid(); }
+
+    GLuint GetTexture() const noexcept { return texture_; }
+    GLsizei GetSize() const noexcept { return size_; }
+
+private:
+    void start_bake(const Grade& grade);
+    void upload(const std::vector<glm::vec4>& texels);
+
+private:
+    GLsizei size_;
+    unsigned int num_of_threads_;
+    GLuint texture_;
+    Grade grade_;
+    std::optional<Grade> pending_;      // Requested while a bake was running.
+    std::future<std::vector<glm::vec4>> bake_;
+};
+
+}   // namespace common::render
\ No newline at end of file
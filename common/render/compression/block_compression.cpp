@@ -0,0 +1,681 @@
+﻿#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include "../../parallel_for.h"
+#include "block_compression.h"
+
+namespace
+{
+
+using namespace common::render::compression;
+
+// Interpolation weights shared by the 4-bit index modes of BC6H and BC7.
+constexpr std::array<int, 16> weights4 = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+class BitWriter final
+{
+public:
+    BitWriter(std::uint8_t* dst, std::size_t size)
+        : dst_(dst), pos_(0)
+    {
+        std::memset(dst_, 0, size);
+    }
+
+    void Put(std::uint32_t value, std::size_t bits)
+    {
+        for(std::size_t i = 0; i < bits; i++)
+        {
+            if((value >> i) & 1u)
+                dst_[pos_ >> 3] |= static_cast<std::uint8_t>(1u << (pos_ & 7));
+            pos_++;
+        }
+    }
+
+private:
+    std::uint8_t* dst_;
+    std::size_t pos_;
+};
+
+template<std::size_t N>
+using Points = std::array<std::array<float, N>, texels_per_block>;
+
+template<std::size_t N>
+using Endpoint = std::array<float, N>;
+
+// Fits a line through the points along their principal axis and returns the extreme projections.
+template<std::size_t N>
+void fit_endpoints(const Points<N>& points, Endpoint<N>& e0, Endpoint<N>& e1, float inset = 0.0f)
+{
+    Endpoint<N> mean{};
+    for(const auto& p : points)
+        for(std::size_t c = 0; c < N; c++)
+            mean[c] += p[c];
+    for(auto& m : mean)
+        m /= static_cast<float>(texels_per_block);
+
+    std::array<std::array<float, N>, N> cov{};
+    for(const auto& p : points)
+        for(std::size_t i = 0; i < N; i++)
+            for(std::size_t j = 0; j < N; j++)
+                cov[i][j] += (p[i] - mean[i]) * (p[j] - mean[j]);
+
+    // Power iteration.
+    Endpoint<N> axis;
+    axis.fill(1.0f);
+    for(int iteration = 0; iteration < 8; iteration++)
+    {
+        Endpoint<N> next{};
+        for(std::size_t i = 0; i < N; i++)
+            for(std::size_t j = 0; j < N; j++)
+                next[i] += cov[i][j] * axis[j];
+
+        float norm = 0.0f;
+        for(auto v : next)
+            norm += v * v;
+        if(norm < std::numeric_limits<float>::epsilon())
+            break;
+        norm = std::sqrt(norm);
+        for(std::size_t i = 0; i < N; i++)
+            axis[i] = next[i] / norm;
+    }
+
+    float t_min = std::numeric_limits<float>::max();
+    float t_max = std::numeric_limits<float>::lowest();
+    for(const auto& p : points)
+    {
+        float t = 0.0f;
+        for(std::size_t c = 0; c < N; c++)
+            t += (p[c] - mean[c]) * axis[c];
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+    const auto d = (t_max - t_min) * inset;
+    t_min += d;
+    t_max -= d;
+
+    for(std::size_t c = 0; c < N; c++)
+    {
+        e0[c] = mean[c] + axis[c] * t_min;
+        e1[c] = mean[c] + axis[c] * t_max;
+    }
+}
+
+// Least squares endpoints for the given interpolation weights(0 selects e0, 1 selects e1).
+template<std::size_t N>
+bool refine_endpoints(const Points<N>& points, const std::array<float, texels_per_block>& w, Endpoint<N>& e0, Endpoint<N>& e1)
+{
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    Endpoint<N> ax{}, bx{};
+    for(std::size_t i = 0; i < texels_per_block; i++)
+    {
+        const auto a = 1.0f - w[i];
+        const auto b = w[i];
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for(std::size_t c = 0; c < N; c++)
+        {
+            ax[c] += a * points[i][c];
+            bx[c] += b * points[i][c];
+        }
+    }
+    const auto det = aa * bb - ab * ab;
+    if(std::fabs(det) < std::numeric_limits<float>::epsilon())
+        return false;
+
+    const auto rcp = 1.0f / det;
+    for(std::size_t c = 0; c < N; c++)
+    {
+        e0[c] = (ax[c] * bb - bx[c] * ab) * rcp;
+        e1[c] = (bx[c] * aa - ax[c] * ab) * rcp;
+    }
+    return true;
+}
+
+template<std::size_t N, typename T>
+float squared_distance(const std::array<float, N>& p, const std::array<T, N>& q)
+{
+    float sum = 0.0f;
+    for(std::size_t c = 0; c < N; c++)
+    {
+        const auto d = p[c] - static_cast<float>(q[c]);
+        sum += d * d;
+    }
+    return sum;
+}
+
+template<std::size_t N, typename T, std::size_t M>
+float select_indices(const Points<N>& points, const std::array<std::array<T, N>, M>& palette, std::array<std::uint32_t, texels_per_block>& indices)
+{
+    float total = 0.0f;
+    for(std::size_t i = 0; i < texels_per_block; i++)
+    {
+        float best = std::numeric_limits<float>::max();
+        for(std::size_t k = 0; k < M; k++)
+        {
+            const auto e = squared_distance(points[i], palette[k]);
+            if(e < best)
+            {
+                best = e;
+                indices[i] = static_cast<std::uint32_t>(k);
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+template<std::size_t N>
+Points<N> load_points(const std::uint8_t rgba[texels_per_block * 4])
+{
+    Points<N> points;
+    for(std::size_t i = 0; i < texels_per_block; i++)
+        for(std::size_t c = 0; c < N; c++)
+            points[i][c] = static_cast<float>(rgba[i * 4 + c]);
+    return points;
+}
+
+int clamp_round(float v, int lo, int hi)
+{
+    return std::clamp(static_cast<int>(std::lround(v)), lo, hi);
+}
+
+// BC1
+
+std::uint16_t pack565(const Endpoint<3>& e)
+{
+    const auto r = static_cast<std::uint16_t>(clamp_round(e[0] * 31.0f / 255.0f, 0, 31));
+    const auto g = static_cast<std::uint16_t>(clamp_round(e[1] * 63.0f / 255.0f, 0, 63));
+    const auto b = static_cast<std::uint16_t>(clamp_round(e[2] * 31.0f / 255.0f, 0, 31));
+    return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+}
+
+std::array<int, 3> unpack565(std::uint16_t c)
+{
+    const int r = (c >> 11) & 0x1F;
+    const int g = (c >> 5) & 0x3F;
+    const int b = c & 0x1F;
+    return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+}
+
+float encode_bc1_color(const Points<3>& points, const Endpoint<3>& lo, const Endpoint<3>& hi, std::uint16_t& c0, std::uint16_t& c1, std::array<std::uint32_t, texels_per_block>& indices)
+{
+    c0 = pack565(hi);
+    c1 = pack565(lo);
+    if(c0 < c1)
+        std::swap(c0, c1);
+
+    const auto p0 = unpack565(c0);
+    const auto p1 = unpack565(c1);
+    std::array<std::array<int, 3>, 4> palette;
+    palette[0] = p0;
+    palette[1] = p1;
+    for(std::size_t c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * p0[c] + p1[c]) / 3;
+        palette[3][c] = (p0[c] + 2 * p1[c]) / 3;
+    }
+    return select_indices(points, palette, indices);
+}
+
+void write_bc1(std::uint16_t c0, std::uint16_t c1, const std::array<std::uint32_t, texels_per_block>& indices, std::uint8_t* dst)
+{
+    BitWriter writer(dst, 8);
+    writer.Put(c0, 16);
+    writer.Put(c1, 16);
+    for(auto index : indices)
+        writer.Put((c0 == c1) ? 0 : index, 2);
+}
+
+// BC4
+
+void write_bc4(const std::array<float, texels_per_block>& values, std::uint8_t* dst)
+{
+    const auto [mn_it, mx_it] = std::minmax_element(values.cbegin(), values.cend());
+    const auto a0 = clamp_round(*mx_it, 0, 255);
+    const auto a1 = clamp_round(*mn_it, 0, 255);
+
+    std::array<int, 8> palette;
+    palette[0] = a0;
+    palette[1] = a1;
+    for(int i = 2; i < 8; i++)
+        palette[static_cast<std::size_t>(i)] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+
+    BitWriter writer(dst, 8);
+    writer.Put(static_cast<std::uint32_t>(a0), 8);
+    writer.Put(static_cast<std::uint32_t>(a1), 8);
+    for(auto v : values)
+    {
+        std::uint32_t index = 0;
+        if(a0 != a1)
+        {
+            float best = std::numeric_limits<float>::max();
+            for(std::size_t k = 0; k < palette.size(); k++)
+            {
+                const auto e = std::fabs(v - static_cast<float>(palette[k]));
+                if(e < best)
+                {
+                    best = e;
+                    index = static_cast<std::uint32_t>(k);
+                }
+            }
+        }
+        writer.Put(index, 3);
+    }
+}
+
+// BC6H(mode 11: one region, 10-bit endpoints, 4-bit indices)
+
+int bc6h_quantize(float h)
+{
+    const auto comp = std::min(65535.0f, h * 64.0f / 31.0f);
+    return clamp_round(comp * 1023.0f / 65535.0f, 0, 1023);
+}
+
+int bc6h_unquantize(int q)
+{
+    if(q == 0)
+        return 0;
+    if(q == 1023)
+        return 0xFFFF;
+    return ((q << 16) + 0x8000) >> 10;
+}
+
+int bc6h_finish_unquantize(int comp)
+{
+    return (comp * 31) >> 6;
+}
+
+// BC7(mode 6: one subset, RGBA 7.7.7.7 endpoints with unique p-bits, 4-bit indices)
+
+void bc7_quantize(const Endpoint<4>& e, std::array<int, 4>& q, int& p)
+{
+    float best = std::numeric_limits<float>::max();
+    for(int pbit = 0; pbit < 2; pbit++)
+    {
+        std::array<int, 4> candidate;
+        float error = 0.0f;
+        for(std::size_t c = 0; c < 4; c++)
+        {
+            candidate[c] = clamp_round((e[c] - static_cast<float>(pbit)) * 0.5f, 0, 127);
+            const auto d = e[c] - static_cast<float>((candidate[c] << 1) | pbit);
+            error += d * d;
+        }
+        if(error < best)
+        {
+            best = error;
+            q = candidate;
+            p = pbit;
+        }
+    }
+}
+
+float bc7_evaluate(const Points<4>& points, const Endpoint<4>& lo, const Endpoint<4>& hi, std::array<std::array<int, 4>, 2>& q, std::array<int, 2>& p, std::array<std::uint32_t, texels_per_block>& indices)
+{
+    bc7_quantize(lo, q[0], p[0]);
+    bc7_quantize(hi, q[1], p[1]);
+
+    std::array<std::array<int, 4>, 16> palette;
+    for(std::size_t k = 0; k < palette.size(); k++)
+    {
+        for(std::size_t c = 0; c < 4; c++)
+        {
+            const auto a = (q[0][c] << 1) | p[0];
+            const auto b = (q[1][c] << 1) | p[1];
+            palette[k][c] = ((64 - weights4[k]) * a + weights4[k] * b + 32) >> 6;
+        }
+    }
+    return select_indices(points, palette, indices);
+}
+
+template<typename T, typename Encoder>
+void compress_blocks(const T* src, std::size_t channels, std::size_t width, std::size_t height, std::size_t bytes_per_block, unsigned int num_of_threads, std::uint8_t* dst, Encoder encoder)
+{
+    const auto blocks_x = (width + block_width - 1) / block_width;
+    const auto blocks_y = (height + block_height - 1) / block_height;
+    if((blocks_x == 0) || (blocks_y == 0))
+        return;
+
+    if(num_of_threads == 0)
+        num_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // One row of blocks per tile.
+    common::parallel_for_tiles(blocks_x * blocks_y, blocks_x, num_of_threads, [&](std::size_t begin, std::size_t end)
+    {
+        std::array<T, texels_per_block * 4> block;
+        for(auto i = begin; i < end; i++)
+        {
+            const auto bx = i % blocks_x;
+            const auto by = i / blocks_x;
+            // Edge texels are replicated for partial blocks.
+            for(std::size_t y = 0; y < block_height; y++)
+            {
+                const auto sy = std::min(by * block_height + y, height - 1);
+                for(std::size_t x = 0; x < block_width; x++)
+                {
+                    const auto sx = std::min(bx * block_width + x, width - 1);
+                    const auto s = &src[(sy * width + sx) * channels];
+                    std::copy(s, s + channels, &block[(y * block_width + x) * channels]);
+                }
+            }
+            encoder(block.data(), &dst[i * bytes_per_block]);
+        }
+    });
+}
+
+}   // namespace
+
+namespace common::render::compression
+{
+
+std::size_t GetBytesPerBlock(BlockFormat format)
+{
+    switch(format)
+    {
+    case BlockFormat::BC1:
+    case BlockFormat::BC4:
+        return 8;
+    case BlockFormat::BC3:
+    case BlockFormat::BC5:
+    case BlockFormat::BC6H:
+    case BlockFormat::BC7:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+std::size_t CalcCompressedSize(BlockFormat format, std::size_t width, std::size_t height)
+{
+    const auto blocks_x = (width + block_width - 1) / block_width;
+    const auto blocks_y = (height + block_height - 1) / block_height;
+    return blocks_x * blocks_y * GetBytesPerBlock(format);
+}
+
+bool IsHDR(BlockFormat format)
+{
+    return format == BlockFormat::BC6H;
+}
+
+void EncodeBC1Block(const std::uint8_t rgba[texels_per_block * 4], std::uint8_t* dst)
+{
+    const auto points = load_points<3>(rgba);
+
+    Endpoint<3> lo, hi;
+    fit_endpoints(points, lo, hi, 1.0f / 16.0f);
+
+    std::uint16_t c0, c1;
+    std::array<std::uint32_t, texels_per_block> indices;
+    auto error = encode_bc1_color(points, lo, hi, c0, c1, indices);
+
+    // One refinement step from the selected indices.
+    if(c0 != c1)
+    {
+        constexpr std::array<float, 4> index_to_weight = { 1.0f, 0.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        std::array<float, texels_per_block> w;
+        for(std::size_t i = 0; i < texels_per_block; i++)
+            w[i] = index_to_weight[indices[i]];
+
+        Endpoint<3> refined_lo, refined_hi;
+        if(refine_endpoints(points, w, refined_lo, refined_hi))
+        {
+            std::uint16_t r0, r1;
+            std::array<std::uint32_t, texels_per_block> refined_indices;
+            const auto refined_error = encode_bc1_color(points, refined_lo, refined_hi, r0, r1, refined_indices);
+            if(refined_error < error)
+            {
+                c0 = r0;
+                c1 = r1;
+                indices = refined_indices;
+            }
+        }
+    }
+    write_bc1(c0, c1, indices, dst);
+}
+
+void EncodeBC3Block(const std::uint8_t rgba[texels_per_block * 4], std::uint8_t* dst)
+{
+    EncodeBC4Block(rgba, 3, dst);
+    EncodeBC1Block(rgba, dst + 8);
+}
+
+void EncodeBC4Block(const std::uint8_t rgba[texels_per_block * 4], std::size_t channel, std::uint8_t* dst)
+{
+    std::array<float, texels_per_block> values;
+    for(std::size_t i = 0; i < texels_per_block; i++)
+        values[i] = static_cast<float>(rgba[i * 4 + channel]);
+    write_bc4(values, dst);
+}
+
+void EncodeBC5Block(const std::uint8_t rgba[texels_per_block * 4], std::uint8_t* dst)
+{
+    EncodeBC4Block(rgba, 0, dst);
+    EncodeBC4Block(rgba, 1, dst + 8);
+}
+
+void EncodeBC6HBlock(const float rgb[texels_per_block * 3], std::uint8_t* dst)
+{
+    // Work on the half float bit patterns, which BC6H interpolates.
+    Points<3> points;
+    for(std::size_t i = 0; i < texels_per_block; i++)
+    {
+        for(std::size_t c = 0; c < 3; c++)
+        {
+            const auto h = FloatToHalf(std::clamp(rgb[i * 3 + c], 0.0f, 65504.0f));
+            points[i][c] = static_cast<float>(h);
+        }
+    }
+
+    Endpoint<3> lo, hi;
+    fit_endpoints(points, lo, hi);
+
+    std::array<std::array<int, 3>, 2> q;
+    for(std::size_t c = 0; c < 3; c++)
+    {
+        q[0][c] = bc6h_quantize(std::max(0.0f, lo[c]));
+        q[1][c] = bc6h_quantize(std::max(0.0f, hi[c]));
+    }
+
+    std::array<std::array<int, 3>, 16> palette;
+    for(std::size_t k = 0; k < palette.size(); k++)
+    {
+        for(std::size_t c = 0; c < 3; c++)
+        {
+            const auto a = bc6h_unquantize(q[0][c]);
+            const auto b = bc6h_unquantize(q[1][c]);
+            palette[k][c] = bc6h_finish_unquantize(((64 - weights4[k]) * a + weights4[k] * b + 32) >> 6);
+        }
+    }
+
+    std::array<std::uint32_t, texels_per_block> indices;
+    select_indices(points, palette, indices);
+
+    // The MSB of the anchor index is implicitly zero.
+    if(indices[0] & 8u)
+    {
+        std::swap(q[0], q[1]);
+        for(auto& index : indices)
+            index = 15u - index;
+    }
+
+    BitWriter writer(dst, 16);
+    writer.Put(0x03, 5);
+    for(std::size_t e = 0; e < 2; e++)
+        for(std::size_t c = 0; c < 3; c++)
+            writer.Put(static_cast<std::uint32_t>(q[e][c]), 10);
+    writer.Put(indices[0], 3);
+    for(std::size_t i = 1; i < texels_per_block; i++)
+        writer.Put(indices[i], 4);
+}
+
+void EncodeBC7Block(const std::uint8_t rgba[texels_per_block * 4], std::uint8_t* dst)
+{
+    const auto points = load_points<4>(rgba);
+
+    Endpoint<4> lo, hi;
+    fit_endpoints(points, lo, hi);
+
+    std::array<std::array<int, 4>, 2> q;
+    std::array<int, 2> p;
+    std::array<std::uint32_t, texels_per_block> indices;
+    auto error = bc7_evaluate(points, lo, hi, q, p, indices);
+
+    // One refinement step from the selected indices.
+    {
+        std::array<float, texels_per_block> w;
+        for(std::size_t i = 0; i < texels_per_block; i++)
+            w[i] = static_cast<float>(weights4[indices[i]]) / 64.0f;
+
+        Endpoint<4> refined_lo, refined_hi;
+        if(refine_endpoints(points, w, refined_lo, refined_hi))
+        {
+            std::array<std::array<int, 4>, 2> refined_q;
+            std::array<int, 2> refined_p;
+            std::array<std::uint32_t, texels_per_block> refined_indices;
+            const auto refined_error = bc7_evaluate(points, refined_lo, refined_hi, refined_q, refined_p, refined_indices);
+            if(refined_error < error)
+            {
+                q = refined_q;
+                p = refined_p;
+                indices = refined_indices;
+            }
+        }
+    }
+
+    // The MSB of the anchor index is implicitly zero.
+    if(indices[0] & 8u)
+    {
+        std::swap(q[0], q[1]);
+        std::swap(p[0], p[1]);
+        for(auto& index : indices)
+            index = 15u - index;
+    }
+
+    BitWriter writer(dst, 16);
+    writer.Put(1u << 6, 7);
+    for(std::size_t c = 0; c < 4; c++)
+    {
+        writer.Put(static_cast<std::uint32_t>(q[0][c]), 7);
+        writer.Put(static_cast<std::uint32_t>(q[1][c]), 7);
+    }
+    writer.Put(static_cast<std::uint32_t>(p[0]), 1);
+    writer.Put(static_cast<std::uint32_t>(p[1]), 1);
+    writer.Put(indices[0], 3);
+    for(std::size_t i = 1; i < texels_per_block; i++)
+        writer.Put(indices[i], 4);
+}
+
+std::vector<std::uint8_t> Compress(BlockFormat format, const std::uint8_t* rgba, std::size_t width, std::size_t height, unsigned int num_of_threads)
+{
+    void (*encode)(const std::uint8_t*, std::uint8_t*) = nullptr;
+    switch(format)
+    {
+    case BlockFormat::BC1:
+        encode = [](const std::uint8_t* src, std::uint8_t* dst){ EncodeBC1Block(src, dst); };
+        break;
+    case BlockFormat::BC3:
+        encode = [](const std::uint8_t* src, std::uint8_t* dst){ EncodeBC3Block(src, dst); };
+        break;
+    case BlockFormat::BC4:
+        encode = [](const std::uint8_t* src, std::uint8_t* dst){ EncodeBC4Block(src, 0, dst); };
+        break;
+    case BlockFormat::BC5:
+        encode = [](const std::uint8_t* src, std::uint8_t* dst){ EncodeBC5Block(src, dst); };
+        break;
+    case BlockFormat::BC7:
+        encode = [](const std::uint8_t* src, std::uint8_t* dst){ EncodeBC7Block(src, dst); };
+        break;
+    default:
+        throw std::invalid_argument("The format requires floating point input.");
+    }
+
+    std::vector<std::uint8_t> result(CalcCompressedSize(format, width, height));
+    compress_blocks(rgba, 4, width, height, GetBytesPerBlock(format), num_of_threads, result.data(), encode);
+    return result;
+}
+
+std::vector<std::uint8_t> Compress(BlockFormat format, const float* rgb, std::size_t width, std::size_t height, unsigned int num_of_threads)
+{
+    if(format != BlockFormat::BC6H)
+        throw std::invalid_argument("The format requires 8-bit input.");
+
+    std::vector<std::uint8_t> result(CalcCompressedSize(format, width, height));
+    compress_blocks(rgb, 3, width, height, GetBytesPerBlock(format), num_of_threads, result.data(),
+        [](const float* src, std::uint8_t* dst){ EncodeBC6HBlock(src, dst); });
+    return result;
+}
+
+std::uint16_t FloatToHalf(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+    const auto exponent = static_cast<int>((bits >> 23) & 0xFFu) - 127 + 15;
+    auto mantissa = bits & 0x007FFFFFu;
+
+    if(((bits >> 23) & 0xFFu) == 0xFFu)   // Inf or NaN
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (mantissa ? 0x0200u : 0u));
+    if(exponent >= 0x1F)                    // Overflow
+        return static_cast<std::uint16_t>(sign | 0x7C00u);
+    if(exponent <= 0)                       // Subnormal or zero
+    {
+        if(exponent < -10)
+            return sign;
+        mantissa |= 0x00800000u;
+        const auto shift = static_cast<std::uint32_t>(14 - exponent);
+        auto half = mantissa >> shift;
+        if((mantissa >> (shift - 1)) & 1u)  // Round half up.
+            half++;
+        return static_cast<std::uint16_t>(sign | half);
+    }
+    auto half = static_cast<std::uint32_t>(sign) | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if(mantissa & 0x00001000u)              // Round half up, may carry into the exponent.
+        half++;
+    return static_cast<std::uint16_t>(half);
+}
+
+float HalfToFloat(std::uint16_t value)
+{
+    const auto sign = static_cast<std::uint32_t>(value & 0x8000u) << 16;
+    auto exponent = static_cast<std::uint32_t>((value >> 10) & 0x1Fu);
+    auto mantissa = static_cast<std::uint32_t>(value & 0x03FFu);
+
+    std::uint32_t bits;
+    if(exponent == 0)
+    {
+        if(mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // Normalize the subnormal.
+            exponent = 127 - 15 + 1;
+            while((mantissa & 0x0400u) == 0)
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x03FFu) << 13);
+        }
+    }
+    else if(exponent == 0x1F)
+    {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+}   // namespace common::render::compression
\ No newline at end of file
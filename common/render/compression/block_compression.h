@@ -0,0 +1,66 @@
+/*!
+* @file block_compression.h
+* @brief CPU encoders for the BCn block-compressed texture formats.
+*
+* This module does not depend on OpenGL, so it can be used and verified on machines without a GPU.
+*/
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace common::render::compression
+{
+
+enum class BlockFormat
+{
+    BC1,    // RGB, 4bpp
+    BC3,    // RGBA, 8bpp
+    BC4,    // R, 4bpp
+    BC5,    // RG, 8bpp
+    BC6H,   // RGB half float, 8bpp
+    BC7     // RGBA, 8bpp
+};
+
+constexpr std::size_t block_width = 4;
+constexpr std::size_t block_height = 4;
+constexpr std::size_t texels_per_block = block_width * block_height;
+
+std::size_t GetBytesPerBlock(BlockFormat format);
+std::size_t CalcCompressedSize(BlockFormat format, std::size_t width, std::size_t height);
+bool IsHDR(BlockFormat format);
+
+// Single block encoders. `rgba` holds 16 texels in row-major order.
+void EncodeBC1Block(const std::uint8_t rgba[texels_per_block * 4], std::uint8_t* dst);
+void EncodeBC3Block(const std::uint8_t rgba[texels_per_block * 4], std::uint8_t* dst);
+void EncodeBC4Block(const std::uint8_t rgba[texels_per_block * 4], std::size_t channel, std::uint8_t* dst);
+void EncodeBC5Block(const std::uint8_t rgba[texels_per_block * 4], std::uint8_t* dst);
+void EncodeBC6HBlock(const float rgb[texels_per_block * 3], std::uint8_t* dst);
+void EncodeBC7Block(const std::uint8_t rgba[texels_per_block * 4], std::uint8_t* dst);
+
+/*!
+ * Compresses an RGBA8 image with an LDR format.
+ * @param num_of_threads 0 to use all hardware threads.
+ */
+std::vector<std::uint8_t> Compress(
+    BlockFormat format,
+    const std::uint8_t* rgba,
+    std::size_t width,
+    std::size_t height,
+    unsigned int num_of_threads = 0);
+
+/*!
+ * Compresses an RGB32F image with BC6H.
+ * @param num_of_threads 0 to use all hardware threads.
+ */
+std::vector<std::uint8_t> Compress(
+    BlockFormat format,
+    const float* rgb,
+    std::size_t width,
+    std::size_t height,
+    unsigned int num_of_threads = 0);
+
+std::uint16_t FloatToHalf(float value);
+float HalfToFloat(std::uint16_t value);
+
+}   // namespace common::render::compression
\ No newline at end of file
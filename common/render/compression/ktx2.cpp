@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <hasenpfote/assert.h>
+#include "../../logger.h"
+#include "ktx2.h"
+
+namespace
+{
+
+constexpr std::uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+constexpr std::size_t header_size = sizeof(identifier) + 9 * sizeof(std::uint32_t);
+constexpr std::size_t index_size = 4 * sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t);
+constexpr std::size_t level_index_entry_size = 3 * sizeof(std::uint64_t);
+
+// Level data is aligned to lcm(texel block size, 4), which is at most 16 for BCn.
+constexpr std::size_t level_alignment = 16;
+
+// Khronos Data Format Specification.
+constexpr std::uint32_t KHR_DF_MODEL_BC1A = 128;
+constexpr std::uint32_t KHR_DF_MODEL_BC3 = 130;
+constexpr std::uint32_t KHR_DF_MODEL_BC4 = 131;
+constexpr std::uint32_t KHR_DF_MODEL_BC5 = 132;
+constexpr std::uint32_t KHR_DF_MODEL_BC6H = 133;
+constexpr std::uint32_t KHR_DF_MODEL_BC7 = 134;
+constexpr std::uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+constexpr std::uint32_t KHR_DF_TRANSFER_LINEAR = 1;
+constexpr std::uint32_t KHR_DF_TRANSFER_SRGB = 2;
+constexpr std::uint32_t KHR_DF_SAMPLE_DATATYPE_FLOAT = 0x80;
+
+template<typename T>
+T read(const std::uint8_t* src)
+{
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return value;
+}
+
+template<typename T>
+void write(std::vector<std::uint8_t>& dst, T value)
+{
+    std::uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    dst.insert(dst.end(), std::begin(bytes), std::end(bytes));
+}
+
+void pad(std::vector<std::uint8_t>& dst, std::size_t alignment)
+{
+    dst.resize((dst.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+std::size_t calc_level_size(common::render::compression::BlockFormat format, std::uint32_t width, std::uint32_t height, std::size_t level)
+{
+    const auto w = std::max<std::size_t>(1, width >> level);
+    const auto h = std::max<std::size_t>(1, height >> level);
+    return common::render::compression::CalcCompressedSize(format, w, h);
+}
+
+}
+
+namespace common::render::compression
+{
+
+Ktx2Image::Ktx2Image()
+    : vk_format(VK_FORMAT_UNDEFINED), block_format(BlockFormat::BC1), srgb(false), width(0), height(0), levels()
+{
+}
+
+Ktx2Image::Ktx2Image(BlockFormat format, bool is_srgb, std::uint32_t pixel_width, std::uint32_t pixel_height)
+    : vk_format(ToVkFormat(format, is_srgb)), block_format(format), srgb(is_srgb), width(pixel_width), height(pixel_height), levels()
+{
+}
+
+bool Ktx2Image::LoadFromFile(const std::filesystem::path& filepath)
+{
+    std::ifstream ifs(filepath, std::ios::in | std::ios::binary);
+    if(!ifs.is_open())
+    {
+        LOG_E("Failed to open file `" << filepath.string() << "`.");
+        return false;
+    }
+    const std::vector<std::uint8_t> file((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    if((file.size() < header_size + index_size) || !std::equal(std::begin(identifier), std::end(identifier), file.cbegin()))
+    {
+        LOG_E("Invalid KTX2 file `" << filepath.string() << "`.");
+        return false;
+    }
+
+    auto p = file.data() + sizeof(identifier);
+    const auto format = read<std::uint32_t>(p + 0);
+    const auto pixel_width = read<std::uint32_t>(p + 8);
+    const auto pixel_height = read<std::uint32_t>(p + 12);
+    const auto pixel_depth = read<std::uint32_t>(p + 16);
+    const auto layer_count = read<std::uint32_t>(p + 20);
+    const auto face_count = read<std::uint32_t>(p + 24);
+    const auto level_count = std::max(1u, read<std::uint32_t>(p + 28));
+    const auto supercompression_scheme = read<std::uint32_t>(p + 32);
+
+    BlockFormat bf;
+    bool is_srgb;
+    if(!FromVkFormat(format, bf, is_srgb))
+    {
+        LOG_E("Unsupported vkFormat " << format << " in `" << filepath.string() << "`.");
+        return false;
+    }
+    if((pixel_depth != 0) || (layer_count != 0) || (face_count != 1) || (supercompression_scheme != 0))
+    {
+        LOG_E("Only non-supercompressed 2D textures are supported. `" << filepath.string() << "`");
+        return false;
+    }
+
+    const auto level_index = header_size + index_size;
+    if(file.size() < level_index + level_count * level_index_entry_size)
+    {
+        LOG_E("Truncated KTX2 file `" << filepath.string() << "`.");
+        return false;
+    }
+
+    std::vector<std::vector<std::uint8_t>> data(level_count);
+    for(std::size_t level = 0; level < level_count; level++)
+    {
+        const auto entry = file.data() + level_index + level * level_index_entry_size;
+        const auto offset = read<std::uint64_t>(entry);
+        const auto length = read<std::uint64_t>(entry + 8);
+        if((offset + length > file.size()) || (length != calc_level_size(bf, pixel_width, pixel_height, level)))
+        {
+            LOG_E("Invalid level " << level << " in `" << filepath.string() << "`.");
+            return false;
+        }
+        const auto begin = file.cbegin() + static_cast<std::ptrdiff_t>(offset);
+        data[level].assign(begin, begin + static_cast<std::ptrdiff_t>(length));
+    }
+
+    vk_format = format;
+    block_format = bf;
+    srgb = is_srgb;
+    width = pixel_width;
+    height = pixel_height;
+    levels = std::move(data);
+
+    return true;
+}
+
+bool Ktx2Image::SaveToFile(const std::filesystem::path& filepath) const
+{
+    const auto dfd = CreateDataFormatDescriptor();
+    const auto level_count = static_cast<std::uint32_t>(levels.size());
+    const auto dfd_offset = header_size + index_size + level_count * level_index_entry_size;
+
+    std::vector<std::uint8_t> file(std::begin(identifier), std::end(identifier));
+    write<std::uint32_t>(file, vk_format);
+    write<std::uint32_t>(file, 1);  // typeSize
+    write<std::uint32_t>(file, width);
+    write<std::uint32_t>(file, height);
+    write<std::uint32_t>(file, 0);  // pixelDepth
+    write<std::uint32_t>(file, 0);  // layerCount
+    write<std::uint32_t>(file, 1);  // faceCount
+    write<std::uint32_t>(file, level_count);
+    write<std::uint32_t>(file, 0);  // supercompressionScheme
+    write<std::uint32_t>(file, static_cast<std::uint32_t>(dfd_offset));
+    write<std::uint32_t>(file, static_cast<std::uint32_t>(dfd.size()));
+    write<std::uint32_t>(file, 0);  // kvdByteOffset
+    write<std::uint32_t>(file, 0);  // kvdByteLength
+    write<std::uint64_t>(file, 0);  // sgdByteOffset
+    write<std::uint64_t>(file, 0);  // sgdByteLength
+
+    // The level index is written in the order of the levels, but the data is laid out from the smallest level.
+    std::vector<std::uint64_t> offsets(levels.size());
+    auto offset = dfd_offset + dfd.size();
+    for(auto level = levels.size(); level-- > 0;)
+    {
+        offset = (offset + level_alignment - 1) / level_alignment * level_alignment;
+        offsets[level] = offset;
+        offset += levels[level].size();
+    }
+    for(std::size_t level = 0; level < levels.size(); level++)
+    {
+        write<std::uint64_t>(file, offsets[level]);
+        write<std::uint64_t>(file, levels[level].size());
+        write<std::uint64_t>(file, levels[level].size());
+    }
+
+    file.insert(file.end(), dfd.cbegin(), dfd.cend());
+    for(auto level = levels.size(); level-- > 0;)
+    {
+        pad(file, level_alignment);
+        file.insert(file.end(), levels[level].cbegin(), levels[level].cend());
+    }
+
+    std::ofstream ofs(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!ofs.is_open())
+    {
+        LOG_E("Failed to open file `" << filepath.string() << "`.");
+        return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+
+    return ofs.good();
+}
+
+void Ktx2Image::AddLevel(std::vector<std::uint8_t>&& data)
+{
+    HASENPFOTE_ASSERT(data.size() == calc_level_size(block_format, width, height, levels.size()));
+    levels.push_back(std::move(data));
+}
+
+std::uint32_t Ktx2Image::ToVkFormat(BlockFormat format, bool is_srgb)
+{
+    switch(format)
+    {
+    case BlockFormat::BC1:
+        return is_srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    case BlockFormat::BC3:
+        return is_srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+    case BlockFormat::BC4:
+        return VK_FORMAT_BC4_UNORM_BLOCK;
+    case BlockFormat::BC5:
+        return VK_FORMAT_BC5_UNORM_BLOCK;
+    case BlockFormat::BC6H:
+        return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+    case BlockFormat::BC7:
+        return is_srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    default:
+        return VK_FORMAT_UNDEFINED;
+    }
+}
+
+bool Ktx2Image::FromVkFormat(std::uint32_t format, BlockFormat& block_format, bool& is_srgb)
+{
+    switch(format)
+    {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        block_format = BlockFormat::BC1;
+        break;
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        block_format = BlockFormat::BC3;
+        break;
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        block_format = BlockFormat::BC4;
+        break;
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        block_format = BlockFormat::BC5;
+        break;
+    case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        block_format = BlockFormat::BC6H;
+        break;
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        block_format = BlockFormat::BC7;
+        break;
+    default:
+        return false;
+    }
+    is_srgb = (format == VK_FORMAT_BC1_RGB_SRGB_BLOCK)
+        || (format == VK_FORMAT_BC3_SRGB_BLOCK)
+        || (format == VK_FORMAT_BC7_SRGB_BLOCK);
+    return true;
+}
+
+std::vector<std::uint8_t> Ktx2Image::CreateDataFormatDescriptor() const
+{
+    struct Sample
+    {
+        std::uint32_t bit_offset;
+        std::uint32_t bit_length;
+        std::uint32_t channel;
+    };
+
+    // Appended one by one, as assigning an initializer list trips gcc's -Wnonnull.
+    std::uint32_t model;
+    std::vector<Sample> samples;
+    samples.reserve(2);
+    switch(block_format)
+    {
+    case BlockFormat::BC1:
+        model = KHR_DF_MODEL_BC1A;
+        samples.push_back({ 0, 64, 0 });
+        break;
+    case BlockFormat::BC3:
+        model = KHR_DF_MODEL_BC3;
+        samples.push_back({ 0, 64, 15 });
+        samples.push_back({ 64, 64, 0 });
+        break;
+    case BlockFormat::BC4:
+        model = KHR_DF_MODEL_BC4;
+        samples.push_back({ 0, 64, 0 });
+        break;
+    case BlockFormat::BC5:
+        model = KHR_DF_MODEL_BC5;
+        samples.push_back({ 0, 64, 0 });
+        samples.push_back({ 64, 64, 1 });
+        break;
+    case BlockFormat::BC6H:
+        model = KHR_DF_MODEL_BC6H;
+        samples.push_back({ 0, 128, KHR_DF_SAMPLE_DATATYPE_FLOAT });
+        break;
+    case BlockFormat::BC7:
+    default:
+        model = KHR_DF_MODEL_BC7;
+        samples.push_back({ 0, 128, 0 });
+        break;
+    }
+
+    const auto block_size = static_cast<std::uint32_t>(24 + 16 * samples.size());
+
+    std::vector<std::uint8_t> dfd;
+    write<std::uint32_t>(dfd, 4 + block_size);                                     // dfdTotalSize
+    write<std::uint32_t>(dfd, 0);                                                  // vendorId, descriptorType
+    write<std::uint32_t>(dfd, 2 | (block_size << 16));                             // versionNumber, descriptorBlockSize
+    write<std::uint32_t>(dfd, model | (KHR_DF_PRIMARIES_BT709 << 8)
+        | ((srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR) << 16));        // colorModel, colorPrimaries, transferFunction, flags
+    write<std::uint32_t>(dfd, 3 | (3 << 8));                                       // texelBlockDimension[0-3]
+    write<std::uint32_t>(dfd, static_cast<std::uint32_t>(GetBytesPerBlock(block_format)));  // bytesPlane[0-3]
+    write<std::uint32_t>(dfd, 0);                                                  // bytesPlane[4-7]
+    for(const auto& sample : samples)
+    {
+        const bool is_float = (sample.channel & KHR_DF_SAMPLE_DATATYPE_FLOAT) != 0;
+        write<std::uint32_t>(dfd, sample.bit_offset | ((sample.bit_length - 1) << 16) | (sample.channel << 24));
+        write<std::uint32_t>(dfd, 0);                                              // samplePosition[0-3]
+        write<std::uint32_t>(dfd, 0);                                              // sampleLower
+        write<std::uint32_t>(dfd, is_float ? 0x3F800000u : 0xFFFFFFFFu);           // sampleUpper
+    }
+    return dfd;
+}
+
+}   // namespace common::render::compression
\ No newline at end of file
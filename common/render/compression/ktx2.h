@@ -0,0 +1,72 @@
+/*!
+* @file ktx2.h
+* @brief Minimal reader/writer for KTX 2.0 files(https://github.khronos.org/KTX-Specification/).
+*
+* Only non-supercompressed 2D textures with a full or partial mip chain are supported.
+*/
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "block_compression.h"
+
+namespace common::render::compression
+{
+
+class Ktx2Image final
+{
+public:
+    // VkFormat values of the supported formats.
+    enum VkFormat : std::uint32_t
+    {
+        VK_FORMAT_UNDEFINED = 0,
+        VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131,
+        VK_FORMAT_BC1_RGB_SRGB_BLOCK = 132,
+        VK_FORMAT_BC3_UNORM_BLOCK = 137,
+        VK_FORMAT_BC3_SRGB_BLOCK = 138,
+        VK_FORMAT_BC4_UNORM_BLOCK = 139,
+        VK_FORMAT_BC5_UNORM_BLOCK = 141,
+        VK_FORMAT_BC6H_UFLOAT_BLOCK = 143,
+        VK_FORMAT_BC7_UNORM_BLOCK = 145,
+        VK_FORMAT_BC7_SRGB_BLOCK = 146
+    };
+
+public:
+    Ktx2Image();
+    Ktx2Image(BlockFormat format, bool is_srgb, std::uint32_t pixel_width, std::uint32_t pixel_height);
+    ~Ktx2Image() = default;
+
+    Ktx2Image(const Ktx2Image&) = delete;
+    Ktx2Image& operator = (const Ktx2Image&) = delete;
+    Ktx2Image(Ktx2Image&&) = delete;
+    Ktx2Image& operator = (Ktx2Image&&) = delete;
+
+    bool LoadFromFile(const std::filesystem::path& filepath);
+    bool SaveToFile(const std::filesystem::path& filepath) const;
+
+    // Levels must be added from the base level.
+    void AddLevel(std::vector<std::uint8_t>&& data);
+
+    std::uint32_t GetVkFormat() const { return vk_format; }
+    BlockFormat GetBlockFormat() const { return block_format; }
+    bool IsSRGB() const { return srgb; }
+    std::uint32_t GetWidth() const { return width; }
+    std::uint32_t GetHeight() const { return height; }
+    std::size_t GetNumOfLevels() const { return levels.size(); }
+    const std::vector<std::uint8_t>& GetLevel(std::size_t level) const { return levels[level]; }
+
+    static std::uint32_t ToVkFormat(BlockFormat format, bool is_srgb);
+    static bool FromVkFormat(std::uint32_t format, BlockFormat& block_format, bool& is_srgb);
+
+private:
+    std::vector<std::uint8_t> CreateDataFormatDescriptor() const;
+
+private:
+    std::uint32_t vk_format;
+    BlockFormat block_format;
+    bool srgb;
+    std::uint32_t width, height;
+    std::vector<std::vector<std::uint8_t>> levels;
+};
+
+}   // namespace common::render::compression
\ No newline at end of file
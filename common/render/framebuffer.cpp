@@ -46,23 +46,42 @@ void GetFrameBufferSize(GLuint fbo, GLint* width, GLint* height)
 namespace common::render
 {
 
-FrameBuffer::FrameBuffer(GLuint color, GLuint depth, GLuint stencil)
+FrameBuffer::FrameBuffer(GLuint color, GLuint depth, GLuint)
+    : FrameBuffer(std::vector<GLuint>({ color }), depth)
+{
+}
+
+FrameBuffer::FrameBuffer(const std::vector<GLuint>& colors, GLuint depth)
 {
     LOG_I("Creating FBO.");
 
     memset(prev_viewport, 0, sizeof(prev_viewport));
     is_active = false;
+    width = height = 0;
+    color_format = GL_NONE;
 
     glGenFramebuffers(1, &fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
-    if(glIsTexture(color))
+    std::vector<GLenum> draw_buffers;
+    for(const auto color : colors)
     {
+        if(!glIsTexture(color))
+            continue;
+
+        const auto attachment = static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + draw_buffers.size());
         LOG_I("Attaching color texture to fbo. [id=" << color << "]");
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, color, 0);
+        if(draw_buffers.empty())
+        {
+            GLint format;
+            glGetTextureLevelParameteriv(color, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+            color_format = static_cast<GLenum>(format);
+        }
+        draw_buffers.push_back(attachment);
 
         GLint encoding = 0;
-        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING, &encoding);
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING, &encoding);
         if(encoding == GL_LINEAR)
             LOG_I("Framebuffer attachment color encoding is linear.");
         else if(encoding == GL_SRGB)
@@ -70,6 +89,8 @@ FrameBuffer::FrameBuffer(GLuint color, GLuint depth, GLuint stencil)
         else
             assert(false);
     }
+    if(draw_buffers.size() > 1)
+        glDrawBuffers(static_cast<GLsizei>(draw_buffers.size()), draw_buffers.data());
 
     if(glIsTexture(depth))
     {
@@ -84,7 +105,8 @@ FrameBuffer::FrameBuffer(GLuint color, GLuint depth, GLuint stencil)
         assert(false);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // Unbinds the framebuffer.
+    GetFrameBufferSize(fbo, &width, &height);
 
     LOG_I("FBO created successfully. [id=" << fbo << "]");
 }
@@ -102,9 +124,6 @@ void FrameBuffer::Bind()
     is_active = true;
     glGetIntegerv(GL_VIEWPORT, prev_viewport);
 
-    GLint width, height;
-    GetFrameBufferSize(fbo, &width, &height);
-
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
     glViewport(0, 0, width, height);
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 #include <GLFW/glfw3.h>
 
 namespace common::render
@@ -8,6 +9,8 @@ class FrameBuffer final
 {
 public:
     FrameBuffer(GLuint color, GLuint depth = 0, GLuint stencil = 0);
+    //! Attaches the textures to consecutive color attachments, all of which are drawn to.
+    explicit FrameBuffer(const std::vector<GLuint>& colors, GLuint depth = 0);
     ~FrameBuffer();
 
     FrameBuffer(const FrameBuffer&) = delete;
@@ -22,10 +25,19 @@ public:
     GLuint GetColorTexture();
     GLuint GetDepthTexture();
 
+    //! The size of the first attachment, taken when the framebuffer is created since the attachments never change.
+    GLsizei GetWidth() const noexcept { return width; }
+    GLsizei GetHeight() const noexcept { return height; }
+    //! The internal format of the first color attachment, GL_NONE without one.
+    GLenum GetColorFormat() const noexcept { return color_format; }
+
 private:
     GLuint  fbo;
     bool    is_active;
     GLint   prev_viewport[4];
+    GLint   width;
+    GLint   height;
+    GLenum  color_format;
 };
 
 }   // namespace common::render
\ No newline at end of file
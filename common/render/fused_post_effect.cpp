@@ -0,0 +1,226 @@
+#include <sstream>
+#include <utility>
+#include <glm/glm.hpp>
+#include <hasenpfote/assert.h>
+#include "../logger.h"
+#include "fused_post_effect.h"
+#include "shader_snippets.h"
+
+namespace
+{
+
+using FusedPostEffect = common::render::FusedPostEffect;
+
+// Every stage is compiled in or out by its macro, the defines are inserted after the version.
+const std::string fs_source_body =
+"out vec4 OutColor;\n"
+"uniform sampler2D texture0;\n"
+"uniform sampler2D texture1;\n"
+"uniform vec2 pixel_size;\n"
+"uniform float exposure;\n"
+"uniform float quantization_levels;\n"
+"uniform ivec2 dither_layer;\n"
+"uniform sampler3D texture2;\n"
+"uniform vec3 lut_shaper;\n"
+"#if defined(EXPOSURE_BUFFER)\n"
+"layout(std430, binding = 1) readonly buffer Exposure\n"
+"{\n"
+    "float buffered_exposure;\n"
+"};\n"
+"#endif\n"
+"vec3 aces_film(vec3 x)\n"
+"{\n"
+    "const float a = 2.51;\n"
+    "const float b = 0.03;\n"
+    "const float c = 2.43;\n"
+    "const float d = 0.59;\n"
+    "const float e = 0.14;\n"
+    "return clamp((x * (a * x + b)) / (x * (c * x + d) + e), vec3(0.0), vec3(1.0));\n"
+"}\n"
+"vec3 linear_to_srgb(vec3 u)\n"
+"{\n"
+    "vec3 lower = 12.92 * u;\n"
+    "vec3 higher = 1.055 * pow(u, vec3(1.0 / 2.4)) - 0.055;\n"
+    "return mix(higher, lower, step(u, vec3(0.0031308)));\n"
+"}\n"
+"void main(void)\n"
+"{\n"
+    "vec3 color = texture(texture0, gl_FragCoord.xy * pixel_size).rgb;\n"
+"#if defined(EXPOSURE)\n"
+    "color *= exposure;\n"
+"#endif\n"
+"#if defined(EXPOSURE_BUFFER)\n"
+    "color *= buffered_exposure;\n"
+"#endif\n"
+"#if defined(CLIPPING_OVERLAY)\n"
+    "bool is_clipped = any(greaterThan(color, vec3(1.0)));\n"
+"#endif\n"
+"#if defined(ACES)\n"
+    "color = aces_film(color);\n"
+"#endif\n"
+"#if defined(LUT)\n"
+    // The log2 shaper is (min, 1 / (max - min), size), texel centers lie at [0.5, size - 0.5].
+    "vec3 t = clamp((log2(max(color, vec3(1e-10))) - lut_shaper.x) * lut_shaper.y, 0.0, 1.0);\n"
+    "color = texture(texture2, (t * (lut_shaper.z - 1.0) + 0.5) / lut_shaper.z).rgb;\n"
+"#endif\n"
+"#if defined(LUMINANCE)\n"
+    "color = vec3(dot(color, vec3(0.2126, 0.7152, 0.0722)));\n"
+"#endif\n"
+"#if defined(SRGB_ENCODE)\n"
+    "color = linear_to_srgb(max(color, vec3(0.0)));\n"
+"#endif\n"
+"#if defined(DITHER)\n"
+    "ivec2 size = textureSize(texture1, 0) / ivec2(1, dither_layer.y);\n"
+    "ivec2 texel = ivec2(gl_FragCoord.xy) % size + ivec2(0, size.y * dither_layer.x);\n"
+    "float threshold = texelFetch(texture1, texel, 0).r;\n"
+    "color = floor(color * quantization_levels + threshold) / quantization_levels;\n"
+"#endif\n"
+"#if defined(CLIPPING_OVERLAY)\n"
+    "if(is_clipped && (fract((gl_FragCoord.x + gl_FragCoord.y) / 16.0) < 0.5))\n"
+        "color = vec3(1.0, 0.0, 1.0);\n"
+"#endif\n"
+    "OutColor = vec4(color, 1.0);\n"
+"}\n";
+
+std::string make_fs_source(FusedPostEffect::Stages stages)
+{
+    const std::pair<FusedPostEffect::Stage, const char*> macros[] =
+    {
+        { FusedPostEffect::Exposure, "EXPOSURE" },
+        { FusedPostEffect::ExposureBuffer, "EXPOSURE_BUFFER" },
+        { FusedPostEffect::ClippingOverlay, "CLIPPING_OVERLAY" },
+        { FusedPostEffect::ACES, "ACES" },
+        { FusedPostEffect::Lut, "LUT" },
+        { FusedPostEffect::Luminance, "LUMINANCE" },
+        { FusedPostEffect::SRGBEncode, "SRGB_ENCODE" },
+        { FusedPostEffect::Dither, "DITHER" },
+    };
+
+    std::ostringstream oss;
+    oss << "#version 430\n";
+    for(const auto& [stage, macro] : macros)
+    {
+        if((stages & stage) != 0)
+            oss << "#define " << macro << "\n";
+    }
+    oss << fs_source_body;
+    return oss.str();
+}
+
+}
+
+namespace common::render
+{
+
+FusedPostEffect::FusedPostEffect(FullScreenQuad& quad)
+    : quad_(quad), exposure_(1.0f), quantization_levels_(255.0f), lut_(nullptr), dither_layer_(0, 1)
+{
+    vs_ = std::make_unique<shader::Program>(GetFullScreenVertexShaderSource(), GL_VERTEX_SHADER);
+}
+
+void FusedPostEffect::SetDitherLayer(GLint layer, GLint num_of_layers)
+{
+    HASENPFOTE_ASSERT(num_of_layers > 0);
+    if(num_of_layers <= 0)
+    {
+        dither_layer_ = glm::ivec2(0, 1);
+        return;
+    }
+    // The remainder takes the sign of the layer, negative layers wrap from the last one.
+    const auto wrapped = layer % num_of_layers;
+    dither_layer_ = glm::ivec2((wrapped < 0) ? wrapped + num_of_layers : wrapped, num_of_layers);
+}
+
+void FusedPostEffect::Execute(Stages stages, GLuint input, GLuint sampler, GLuint dither, FrameBuffer* output)
+{
+    HASENPFOTE_ASSERT(((stages & Dither) == 0) || (dither != 0));
+    HASENPFOTE_ASSERT(((stages & Lut) == 0) || (lut_ != nullptr));
+
+    auto& permutation = get_permutation(stages);
+
+    if(output != nullptr)
+        output->Bind();
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // Uniforms the permutation does not use have been optimized away, setting them would fail.
+    auto& uniform = permutation.pipeline->GetPipelineUniform();
+    auto set = [&permutation, &uniform](const std::string& name, const auto& v)
+    {
+        if(permutation.fs->GetUniform().GetLocation(name) >= 0)
+            uniform.Set(name, v);
+    };
+    set("texture0", 0);
+    set("texture1", 1);
+    set("pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
+    set("exposure", exposure_);
+    set("quantization_levels", quantization_levels_);
+    set("dither_layer", dither_layer_);
+    set("texture2", 2);
+    if(lut_ != nullptr)
+        set("lut_shaper", glm::vec3(ColorLut::min_log2, 1.0f / (ColorLut::max_log2 - ColorLut::min_log2), static_cast<float>(lut_->GetSize())));
+
+    permutation.pipeline->Bind();
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, input);
+        glBindSampler(0, sampler);
+
+        if((stages & Dither) != 0)
+        {
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, dither);
+            glBindSampler(1, 0);
+        }
+
+        // The LUT filters with its own parameters.
+        if((stages & Lut) != 0)
+        {
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_3D, lut_->GetTexture());
+            glBindSampler(2, 0);
+        }
+
+        quad_.Draw();
+
+        if((stages & Lut) != 0)
+        {
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_3D, 0);
+        }
+        if((stages & Dither) != 0)
+        {
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        glBindSampler(0, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    permutation.pipeline->Unbind();
+
+    if(output != nullptr)
+        output->Unbind();
+}
+
+void FusedPostEffect::Prepare(Stages stages)
+{
+    get_permutation(stages);
+}
+
+FusedPostEffect::Permutation& FusedPostEffect::get_permutation(Stages stages)
+{
+    auto it = permutations_.find(stages);
+    if(it != permutations_.end())
+        return it->second;
+
+    LOG_I("Compiling post effect permutation. [stages=0x" << std::hex << stages << std::dec << "]");
+
+    Permutation permutation;
+    permutation.fs = std::make_unique<shader::Program>(make_fs_source(stages), GL_FRAGMENT_SHADER);
+    permutation.pipeline = std::make_unique<shader::ProgramPipeline>(shader::ProgramPipeline::ProgramPtrSet({ vs_.get(), permutation.fs.get() }));
+    return permutations_.emplace(stages, std::move(permutation)).first->second;
+}
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "color_lut.h"
+#include "framebuffer.h"
+#include "fullscreen_quad.h"
+#include "shader/shader.h"
+
+namespace common::render
+{
+
+/*!
+ * @class FusedPostEffect
+ * @brief Runs any combination of the per-pixel post effect stages as a single full screen pass.
+ *
+ * Each combination of stages is compiled once into its own shader permutation and cached, so the image is read and
+ * written once however many stages are enabled. Stages are applied in the order they are declared.
+ * The input is read from texture unit 0, the threshold matrix of the dither from texture unit 1 and the LUT from texture unit 2.
+ */
+class FusedPostEffect final
+{
+public:
+    using Stages = std::uint32_t;
+
+    enum Stage : Stages
+    {
+        Exposure        = 1 << 0,   // Scales by the exposure given to SetExposure().
+        ExposureBuffer  = 1 << 1,   // Scales by the first float of the storage buffer at binding 1.
+        ClippingOverlay = 1 << 2,   // Stripes the pixels that are above 1 after the exposure.
+        ACES            = 1 << 3,   // Tone maps with the ACES filmic curve.
+        Lut             = 1 << 4,   // Looks up the ColorLut given to SetLut(), which replaces ACES and SRGBEncode.
+        Luminance       = 1 << 5,   // Replaces the color by its luminance.
+        SRGBEncode      = 1 << 6,   // Encodes to sRGB, for targets that are not encoded by GL_FRAMEBUFFER_SRGB.
+        Dither          = 1 << 7,   // Quantizes against a tiled threshold matrix, e.g. a Bayer matrix or blue noise.
+    };
+
+public:
+    explicit FusedPostEffect(FullScreenQuad& quad);
+    ~FusedPostEffect() = default;
+
+    FusedPostEffect(const FusedPostEffect&) = delete;
+    FusedPostEffect& operator = (const FusedPostEffect&) = delete;
+    FusedPostEffect(FusedPostEffect&&) = delete;
+    FusedPostEffect& operator = (FusedPostEffect&&) = delete;
+
+    void SetExposure(float exposure) noexcept { exposure_ = exposure; }
+    //! The number of steps the dither quantizes each channel to, 255 for an 8-bit target.
+    void SetQuantizationLevels(float levels) noexcept { quantization_levels_ = levels; }
+    void SetLut(const ColorLut* lut) noexcept { lut_ = lut; }
+    /*!
+     * Selects a layer of a spatio-temporal dither, stored as `num_of_layers` tiles stacked vertically.
+     * The layer wraps around, so a frame counter can be passed as is. `num_of_layers` must be positive.
+     */
+    void SetDitherLayer(GLint layer, GLint num_of_layers = 1);
+
+    /*!
+     * Draws the input through the stages into the output, or into the bound framebuffer if it is null.
+     * @param dither the threshold matrix in [0, 1), tiled over the screen. Only read by the Dither stage.
+     */
+    void Execute(Stages stages, GLuint input, GLuint sampler, GLuint dither = 0, FrameBuffer* output = nullptr);
+
+    //! Compiles the permutation ahead of its first use.
+    void Prepare(Stages stages);
+    std::size_t GetNumOfPermutations() const noexcept { return permutations_.size(); }
+
+private:
+    struct Permutation
+    {
+        std::unique_ptr<shader::Program> fs;
+        std::unique_ptr<shader::ProgramPipeline> pipeline;
+    };
+
+    Permutation& get_permutation(Stages stages);
+
+private:
+    FullScreenQuad& quad_;
+    std::unique_ptr<shader::Program> vs_;
+    std::unordered_map<Stages, Permutation> permutations_;
+    float exposure_;
+    float quantization_levels_;
+    const ColorLut* lut_;
+    glm::ivec2 dither_layer_;
+};
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <glm/glm.hpp>
+#include <hasenpfote/assert.h>
+#include "../logger.h"
+#include "gaussian_blur.h"
+#include "shader_snippets.h"
+
+namespace
+{
+
+// A center tap and one merged tap per pair of texels on each side.
+constexpr int max_taps = common::render::GaussianBlur::max_radius / 2 + 1;
+constexpr GLuint row_size = 256;
+
+const std::string fs_source =
+"#version 430\n"
+"#define MAX_TAPS " + std::to_string(max_taps) + "\n"
+"out vec4 OutColor;\n"
+"uniform sampler2D texture0;\n"
+"uniform vec2 pixel_size;\n"
+"uniform int level;\n"
+"uniform vec2 direction;\n"
+"uniform int num_of_taps;\n"
+"uniform float offsets[MAX_TAPS];\n"
+"uniform float tap_weights[MAX_TAPS];\n"
+"void main(void)\n"
+"{\n"
+    "vec2 tex_coord = gl_FragCoord.xy * pixel_size;\n"
+    "vec2 step = direction * pixel_size;\n"
+    "float lod = float(level);\n"
+    "vec3 color = textureLod(texture0, tex_coord, lod).rgb * tap_weights[0];\n"
+    "for(int i = 1; i < num_of_taps; i++)\n"
+    "{\n"
+        "vec2 offset = step * offsets[i];\n"
+        "color += (textureLod(texture0, tex_coord - offset, lod).rgb + textureLod(texture0, tex_coord + offset, lod).rgb) * tap_weights[i];\n"
+    "}\n"
+    "OutColor = vec4(color, 1.0);\n"
+"}\n";
+
+// Each work group filters a segment of a row, or of a column, of 256 texels.
+const std::string cs_source_header =
+"#version 430\n"
+"#define MAX_RADIUS " + std::to_string(common::render::GaussianBlur::max_radius) + "\n"
+"#define ROW_SIZE " + std::to_string(row_size) + "\n"
+"layout(local_size_x = ROW_SIZE) in;\n"
+"layout(";
+
+const std::string cs_source_body =
+") uniform writeonly image2D image0;\n"
+"uniform sampler2D texture0;\n"
+"uniform int level;\n"
+"uniform vec2 direction;\n"
+"uniform int radius;\n"
+"uniform float weights[MAX_RADIUS + 1];\n"
+"shared vec3 row[ROW_SIZE + MAX_RADIUS * 2];\n"
+"ivec2 to_texel(int a, int line)\n"
+"{\n"
+    "return (direction.x > 0.0) ? ivec2(a, line) : ivec2(line, a);\n"
+"}\n"
+"void main(void)\n"
+"{\n"
+    "const int index = int(gl_LocalInvocationIndex);\n"
+    "const int line = int(gl_WorkGroupID.y);\n"
+    "const ivec2 size = textureSize(texture0, level);\n"
+    "const int length = (direction.x > 0.0) ? size.x : size.y;\n"
+    "const int first = int(gl_WorkGroupID.x) * ROW_SIZE;\n"
+    // Reads are clamped to the image, which matches GL_CLAMP_TO_EDGE on the fragment path.
+    "for(int i = index; i < ROW_SIZE + radius * 2; i += ROW_SIZE)\n"
+    "{\n"
+        "int a = clamp(first - radius + i, 0, length - 1);\n"
+        "row[i] = texelFetch(texture0, to_texel(a, line), level).rgb;\n"
+    "}\n"
+    "barrier();\n"
+    "const int a = first + index;\n"
+    "if(a >= length)\n"
+        "return;\n"
+    "const int center = index + radius;\n"
+    "vec3 color = row[center] * weights[0];\n"
+    "for(int k = 1; k <= radius; k++)\n"
+        "color += (row[center - k] + row[center + k]) * weights[k];\n"
+    "imageStore(image0, to_texel(a, line), vec4(color, 1.0));\n"
+"}\n";
+
+}
+
+namespace common::render
+{
+
+GaussianBlur::GaussianBlur(FullScreenQuad& quad, GLenum internal_format)
+    : sigma_(0.0f)
+{
+    const auto format = GetImageFormatQualifier(internal_format);
+    if(format == nullptr)
+    {
+        LOG_E("Internal format is not supported by the Gaussian blur. [format=" << internal_format << "]");
+        throw std::runtime_error("");
+    }
+
+    vs_ = std::make_unique<shader::Program>(GetFullScreenVertexShaderSource(), GL_VERTEX_SHADER);
+    fs_ = std::make_unique<shader::Program>(fs_source, GL_FRAGMENT_SHADER);
+    cs_ = std::make_unique<shader::Program>(cs_source_header + format + cs_source_body, GL_COMPUTE_SHADER);
+    pass_ = std::make_unique<ImagePass>(quad, vs_.get(), fs_.get(), cs_.get());
+
+    SetSigma(1.0f);
+}
+
+GaussianBlur::Kernel GaussianBlur::CalcKernel(float sigma)
+{
+    HASENPFOTE_ASSERT(sigma > 0.0f);
+
+    const auto radius = std::min(static_cast<int>(std::ceil(sigma * 3.0f)), max_radius);
+
+    Kernel kernel;
+    kernel.weights.resize(static_cast<std::size_t>(radius) + 1);
+    auto sum = 0.0f;
+    for(auto i = 0; i <= radius; i++)
+    {
+        const auto x = static_cast<float>(i);
+        const auto w = std::exp(-x * x / (2.0f * sigma * sigma));
+        kernel.weights[static_cast<std::size_t>(i)] = w;
+        sum += (i == 0) ? w : w * 2.0f;
+    }
+    for(auto& w : kernel.weights)
+        w /= sum;
+
+    // Texels i and i + 1 are fetched at once from the point that splits their weights.
+    kernel.offsets.push_back(0.0f);
+    kernel.tap_weights.push_back(kernel.weights[0]);
+    for(auto i = 1; i <= radius; i += 2)
+    {
+        const auto w0 = kernel.weights[static_cast<std::size_t>(i)];
+        const auto w1 = (i < radius) ? kernel.weights[static_cast<std::size_t>(i) + 1] : 0.0f;
+        const auto w = w0 + w1;
+        kernel.offsets.push_back((static_cast<float>(i) * w0 + static_cast<float>(i + 1) * w1) / w);
+        kernel.tap_weights.push_back(w);
+    }
+    return kernel;
+}
+
+void GaussianBlur::SetSigma(float sigma)
+{
+    if(sigma == sigma_)
+        return;
+
+    sigma_ = sigma;
+    kernel_ = CalcKernel(sigma);
+
+    auto to_array = [](const std::vector<float>& v)
+    {
+        std::vector<glm::vec1> a(v.size());
+        std::transform(v.cbegin(), v.cend(), a.begin(), [](float x){ return glm::vec1(x); });
+        return a;
+    };
+    const auto weights = to_array(kernel_.weights);
+    const auto offsets = to_array(kernel_.offsets);
+    const auto tap_weights = to_array(kernel_.tap_weights);
+
+    pass_->Set("radius", GetRadius());
+    pass_->Set("weights", weights.data(), weights.size());
+    pass_->Set("num_of_taps", static_cast<GLint>(offsets.size()));
+    pass_->Set("offsets", offsets.data(), offsets.size());
+    pass_->Set("tap_weights", tap_weights.data(), tap_weights.size());
+}
+
+void GaussianBlur::Execute(ImagePass::Path path, GLuint input, GLint level, GLuint sampler, FrameBuffer* work, FrameBuffer* output)
+{
+    execute(path, input, level, sampler, work, true);
+    execute(path, work->GetColorTexture(), 0, sampler, output, false);
+}
+
+void GaussianBlur::execute(ImagePass::Path path, GLuint input, GLint level, GLuint sampler, FrameBuffer* output, bool is_horizontal)
+{
+    pass_->Set("level", level);
+    pass_->Set("direction", is_horizontal ? glm::vec2(1.0f, 0.0f) : glm::vec2(0.0f, 1.0f));
+
+    if(path == ImagePass::Path::Fragment)
+    {
+        pass_->Execute(path, input, sampler, output);
+        return;
+    }
+
+    const auto length = static_cast<GLuint>(is_horizontal ? output->GetWidth() : output->GetHeight());
+    const auto num_of_lines = static_cast<GLuint>(is_horizontal ? output->GetHeight() : output->GetWidth());
+    pass_->Dispatch(input, sampler, output, (length + row_size - 1) / row_size, num_of_lines);
+}
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <GL/glew.h>
+#include "framebuffer.h"
+#include "fullscreen_quad.h"
+#include "image_pass.h"
+#include "shader/shader.h"
+
+namespace common::render
+{
+
+/*!
+ * @class GaussianBlur
+ * @brief A separable Gaussian blur of arbitrary sigma, run as a horizontal and a vertical pass.
+ *
+ * The fragment path merges each pair of neighbouring taps into one bilinear fetch placed between them, so a
+ * kernel of radius r costs r / 2 + 1 fetches per pass. The compute path caches a row of 256 texels and its halo
+ * in shared memory and applies the discrete weights from there.
+ * The input may be read from any level of its mip chain, the outputs are rendered to or written at level 0.
+ * Images must be in the internal format given at construction.
+ */
+class GaussianBlur final
+{
+public:
+    static constexpr int max_radius = 64;
+
+    struct Kernel
+    {
+        std::vector<float> weights;     // Discrete weights from the center outward.
+        std::vector<float> offsets;     // Offsets of the merged taps in texels, the center first.
+        std::vector<float> tap_weights; // Weights of the merged taps.
+    };
+
+public:
+    GaussianBlur(FullScreenQuad& quad, GLenum internal_format = GL_RGBA16F);
+    ~GaussianBlur() = default;
+
+    GaussianBlur(const GaussianBlur&) = delete;
+    GaussianBlur& operator = (const GaussianBlur&) = delete;
+    GaussianBlur(GaussianBlur&&) = delete;
+    GaussianBlur& operator = (GaussianBlur&&) = delete;
+
+    //! Generates a normalized kernel covering 3 sigma, clamped to `max_radius`.
+    static Kernel CalcKernel(float sigma);
+
+    void SetSigma(float sigma);
+    float GetSigma() const noexcept { return sigma_; }
+    int GetRadius() const noexcept { return static_cast<int>(kernel_.weights.size()) - 1; }
+
+    /*!
+     * Blurs `level` of the input horizontally into `work`, then `work` vertically into `output`.
+     * Both targets must be the size of the input level. The input sampler must filter linearly, with GL_LINEAR_MIPMAP_NEAREST to read a level above 0.
+     */
+    void Execute(ImagePass::Path path, GLuint input, GLint level, GLuint sampler, FrameBuffer* work, FrameBuffer* output);
+
+private:
+    void execute(ImagePass::Path path, GLuint input, GLint level, GLuint sampler, FrameBuffer* output, bool is_horizontal);
+
+private:
+    float sigma_;
+    Kernel kernel_;
+    std::unique_ptr<shader::Program> vs_;
+    std::unique_ptr<shader::Program> fs_;
+    std::unique_ptr<shader::Program> cs_;
+    std::unique_ptr<ImagePass> pass_;
+};
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <string>
+#include <hasenpfote/assert.h>
+#include "shader/shader.h"
+#include "gpu_sort.h"
+
+namespace
+{
+
+using GpuSort = common::render::GpuSort;
+
+constexpr GLuint radix = 1 << GpuSort::bits_per_pass;
+constexpr GLuint group_size = 256;
+constexpr GLuint scan_group_size = 1024;
+
+// Buffer bindings shared by the kernels.
+const std::string cs_source_header =
+"#version 430\n"
+"#define RADIX " + std::to_string(radix) + "u\n"
+"#define GROUP_SIZE " + std::to_string(group_size) + "u\n"
+"#define ELEMENTS_PER_GROUP " + std::to_string(GpuSort::elements_per_group) + "u\n"
+"#define ELEMENTS_PER_THREAD (ELEMENTS_PER_GROUP / GROUP_SIZE)\n"
+"layout(std430, binding = 0) buffer Keys { uint keys[]; };\n"
+"layout(std430, binding = 1) buffer Values { uint values[]; };\n"
+"layout(std430, binding = 2) buffer Histograms { uint histograms[]; };\n"
+"layout(std430, binding = 3) buffer DstKeys { uint dst_keys[]; };\n"
+"layout(std430, binding = 4) buffer DstValues { uint dst_values[]; };\n"
+"layout(std430, binding = 5) buffer Offsets { uint offsets[]; };\n"
+"uniform uint num_of_elements;\n";
+
+// Counts the digits of each group, digit major so that an exclusive scan gives each group the first position of each of its digits.
+const std::string count_source =
+"layout(local_size_x = GROUP_SIZE) in;\n"
+"uniform uint shift;\n"
+"shared uint bins[RADIX];\n"
+"void main(void)\n"
+"{\n"
+    "const uint index = gl_LocalInvocationIndex;\n"
+    "if(index < RADIX)\n"
+        "bins[index] = 0u;\n"
+    "barrier();\n"
+    "const uint first = gl_WorkGroupID.x * ELEMENTS_PER_GROUP;\n"
+    "const uint last = min(first + ELEMENTS_PER_GROUP, num_of_elements);\n"
+    "for(uint i = first + index; i < last; i += GROUP_SIZE)\n"
+        "atomicAdd(bins[(keys[i] >> shift) & (RADIX - 1u)], 1u);\n"
+    "barrier();\n"
+    "if(index < RADIX)\n"
+        "histograms[index * gl_NumWorkGroups.x + gl_WorkGroupID.x] = bins[index];\n"
+"}\n";
+
+// An exclusive scan of the histograms in place by a single group, each thread takes a run of them.
+const std::string scan_source =
+"layout(local_size_x = " + std::to_string(scan_group_size) + ") in;\n"
+"shared uint sums[gl_WorkGroupSize.x];\n"
+"void main(void)\n"
+"{\n"
+    "const uint index = gl_LocalInvocationIndex;\n"
+    "const uint run = (num_of_elements + gl_WorkGroupSize.x - 1u) / gl_WorkGroupSize.x;\n"
+    "const uint first = min(index * run, num_of_elements);\n"
+    "const uint last = min(first + run, num_of_elements);\n"
+    "uint sum = 0u;\n"
+    "for(uint i = first; i < last; i++)\n"
+        "sum += histograms[i];\n"
+    "sums[index] = sum;\n"
+    "barrier();\n"
+    "for(uint offset = 1u; offset < gl_WorkGroupSize.x; offset <<= 1)\n"
+    "{\n"
+        "const uint value = (index >= offset) ? sums[index - offset] : 0u;\n"
+        "barrier();\n"
+        "sums[index] += value;\n"
+        "barrier();\n"
+    "}\n"
+    "uint prefix = sums[index] - sum;\n"
+    "for(uint i = first; i < last; i++)\n"
+    "{\n"
+        "const uint count = histograms[i];\n"
+        "histograms[i] = prefix;\n"
+        "prefix += count;\n"
+    "}\n"
+"}\n";
+
+// Each thread takes consecutive elements, so ranking them by digit, then thread, then element keeps the sort stable.
+const std::string scatter_source =
+"layout(local_size_x = GROUP_SIZE) in;\n"
+"uniform uint shift;\n"
+"shared uint ranks[RADIX * GROUP_SIZE];\n"
+"shared uint sums[GROUP_SIZE];\n"
+"shared uint digit_firsts[RADIX];\n"
+"void main(void)\n"
+"{\n"
+    "const uint index = gl_LocalInvocationIndex;\n"
+    "const uint first = gl_WorkGroupID.x * ELEMENTS_PER_GROUP + index * ELEMENTS_PER_THREAD;\n"
+    "for(uint d = 0u; d < RADIX; d++)\n"
+        "ranks[d * GROUP_SIZE + index] = 0u;\n"
+    "uint element_keys[ELEMENTS_PER_THREAD];\n"
+    "for(uint e = 0u; e < ELEMENTS_PER_THREAD; e++)\n"
+    "{\n"
+        "element_keys[e] = (first + e < num_of_elements) ? keys[first + e] : 0u;\n"
+        "if(first + e < num_of_elements)\n"
+            "ranks[((element_keys[e] >> shift) & (RADIX - 1u)) * GROUP_SIZE + index]++;\n"
+    "}\n"
+    "barrier();\n"
+    // An exclusive scan of the digit major counts puts each digit of a thread after the smaller digits and the threads before it.
+    "uint sum = 0u;\n"
+    "for(uint i = 0u; i < RADIX; i++)\n"
+        "sum += ranks[index * RADIX + i];\n"
+    "sums[index] = sum;\n"
+    "barrier();\n"
+    "for(uint offset = 1u; offset < GROUP_SIZE; offset <<= 1)\n"
+    "{\n"
+        "const uint value = (index >= offset) ? sums[index - offset] : 0u;\n"
+        "barrier();\n"
+        "sums[index] += value;\n"
+        "barrier();\n"
+    "}\n"
+    "uint prefix = sums[index] - sum;\n"
+    "for(uint i = 0u; i < RADIX; i++)\n"
+    "{\n"
+        "const uint count = ranks[index * RADIX + i];\n"
+        "ranks[index * RADIX + i] = prefix;\n"
+        "prefix += count;\n"
+    "}\n"
+    "barrier();\n"
+    "if(index < RADIX)\n"
+        "digit_firsts[index] = ranks[index * GROUP_SIZE];\n"
+    "barrier();\n"
+    "for(uint e = 0u; e < ELEMENTS_PER_THREAD; e++)\n"
+    "{\n"
+        "if(first + e >= num_of_elements)\n"
+            "break;\n"
+        "const uint digit = (element_keys[e] >> shift) & (RADIX - 1u);\n"
+        "const uint rank = ranks[digit * GROUP_SIZE + index]++ - digit_firsts[digit];\n"
+        "const uint position = histograms[digit * gl_NumWorkGroups.x + gl_WorkGroupID.x] + rank;\n"
+        "dst_keys[position] = element_keys[e];\n"
+        "dst_values[position] = values[first + e];\n"
+    "}\n"
+"}\n";
+
+// Maps float bits to unsigned integers of the same order, or back.
+const std::string map_keys_source =
+"layout(local_size_x = GROUP_SIZE) in;\n"
+"uniform bool is_inverse;\n"
+"void main(void)\n"
+"{\n"
+    "const uint i = gl_GlobalInvocationID.x;\n"
+    "if(i >= num_of_elements)\n"
+        "return;\n"
+    "const uint key = keys[i];\n"
+    "const bool is_negative = is_inverse ? ((key & 0x80000000u) == 0u) : ((key & 0x80000000u) != 0u);\n"
+    "keys[i] = key ^ (is_negative ? 0xFFFFFFFFu : 0x80000000u);\n"
+"}\n";
+
+const std::string iota_source =
+"layout(local_size_x = GROUP_SIZE) in;\n"
+"void main(void)\n"
+"{\n"
+    "const uint i = gl_GlobalInvocationID.x;\n"
+    "if(i < num_of_elements)\n"
+        "values[i] = i;\n"
+"}\n";
+
+// Replaces the keys by the segments the element indices fall in.
+const std::string segment_ids_source =
+"layout(local_size_x = GROUP_SIZE) in;\n"
+"uniform uint num_of_segments;\n"
+"void main(void)\n"
+"{\n"
+    "const uint i = gl_GlobalInvocationID.x;\n"
+    "if(i >= num_of_elements)\n"
+        "return;\n"
+    "const uint element = values[i];\n"
+    "uint lower = 0u;\n"
+    "uint upper = num_of_segments;\n"
+    "while(upper - lower > 1u)\n"
+    "{\n"
+        "const uint middle = (lower + upper) / 2u;\n"
+        "if(offsets[middle] <= element)\n"
+            "lower = middle;\n"
+        "else\n"
+            "upper = middle;\n"
+    "}\n"
+    "keys[i] = lower;\n"
+"}\n";
+
+// Reorders the pairs by the element indices in the histogram binding.
+const std::string gather_source =
+"layout(local_size_x = GROUP_SIZE) in;\n"
+"void main(void)\n"
+"{\n"
+    "const uint i = gl_GlobalInvocationID.x;\n"
+    "if(i >= num_of_elements)\n"
+        "return;\n"
+    "const uint element = histograms[i];\n"
+    "dst_keys[i] = keys[element];\n"
+    "dst_values[i] = values[element];\n"
+"}\n";
+
+GLuint calc_num_of_groups(GLuint num_of_elements, GLuint elements_per_group)
+{
+    return (num_of_elements + elements_per_group - 1) / elements_per_group;
+}
+
+}
+
+namespace common::render
+{
+
+GpuSort::GpuSort(GLuint capacity)
+    : capacity_(0), scratch_keys_{ 0, 0 }, scratch_values_{ 0, 0 }, histograms_(0)
+{
+    auto make_kernel = [](Kernel& kernel, const std::string& source)
+    {
+        kernel.cs = std::make_unique<shader::Program>(cs_source_header + source, GL_COMPUTE_SHADER);
+        kernel.pipeline = std::make_unique<shader::ProgramPipeline>(shader::ProgramPipeline::ProgramPtrSet({ kernel.cs.get() }));
+    };
+    make_kernel(count_, count_source);
+    make_kernel(scan_, scan_source);
+    make_kernel(scatter_, scatter_source);
+    make_kernel(map_keys_, map_keys_source);
+    make_kernel(iota_, iota_source);
+    make_kernel(segment_ids_, segment_ids_source);
+    make_kernel(gather_, gather_source);
+
+    reserve(capacity);
+}
+
+GpuSort::~GpuSort()
+{
+    for(auto buffer : { scratch_keys_[0], scratch_keys_[1], scratch_values_[0], scratch_values_[1], histograms_ })
+    {
+        if(glIsBuffer(buffer))
+            glDeleteBuffers(1, &buffer);
+    }
+}
+
+void GpuSort::SortPairs(GLuint keys, GLuint values, GLuint count, KeyType key_type)
+{
+    if(count <= 1)
+        return;
+    reserve(count);
+
+    if(key_type == KeyType::Float)
+        map_keys(keys, count, false);
+
+    // An even number of passes leaves the result in the buffers given.
+    const auto result = radix_sort({ keys, scratch_keys_[0] }, { values, scratch_values_[0] }, count, 32);
+    HASENPFOTE_ASSERT(result == 0);
+
+    if(key_type == KeyType::Float)
+        map_keys(keys, count, true);
+}
+
+void GpuSort::SortSegments(GLuint keys, GLuint values, GLuint count, GLuint offsets, GLuint num_of_segments, KeyType key_type)
+{
+    if(num_of_segments <= 1)
+    {
+        SortPairs(keys, values, count, key_type);
+        return;
+    }
+    if(count <= 1)
+        return;
+    reserve(count);
+
+    // 1) sort the element indices by key, the keys given are left as they are.
+    const auto size = static_cast<GLsizeiptr>(count * sizeof(GLuint));
+    glCopyNamedBufferSubData(keys, scratch_keys_[0], 0, 0, size);
+    if(key_type == KeyType::Float)
+        map_keys(scratch_keys_[0], count, false);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, scratch_values_[0]);
+    iota_.pipeline->GetPipelineUniform().Set("num_of_elements", count);
+    dispatch(iota_, count, group_size);
+
+    auto result = radix_sort(scratch_keys_, scratch_values_, count, 32);
+
+    // 2) sort them by segment, which keeps their order by key within each segment.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, scratch_keys_[result]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, scratch_values_[result]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, offsets);
+    {
+        auto& uniform = segment_ids_.pipeline->GetPipelineUniform();
+        uniform.Set("num_of_elements", count);
+        uniform.Set("num_of_segments", num_of_segments);
+    }
+    dispatch(segment_ids_, count, group_size);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, 0);
+
+    GLuint num_of_bits = 0;
+    while((num_of_bits < 32) && ((num_of_segments - 1) >> num_of_bits))
+        num_of_bits += bits_per_pass;
+    result = (result + radix_sort(
+        { scratch_keys_[result], scratch_keys_[1 - result] },
+        { scratch_values_[result], scratch_values_[1 - result] },
+        count, num_of_bits)) % 2;
+
+    // 3) gather the pairs given into the free scratch buffers, then copy them back.
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keys);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, values);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, scratch_values_[result]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, scratch_keys_[0]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, scratch_values_[1 - result]);
+    gather_.pipeline->GetPipelineUniform().Set("num_of_elements", count);
+    dispatch(gather_, count, group_size);
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glCopyNamedBufferSubData(scratch_keys_[0], keys, 0, 0, size);
+    glCopyNamedBufferSubData(scratch_values_[1 - result], values, 0, 0, size);
+
+    for(GLuint i = 0; i <= 5; i++)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+}
+
+void GpuSort::reserve(GLuint count)
+{
+    if(count <= capacity_)
+        return;
+
+    for(auto buffer : { scratch_keys_[0], scratch_keys_[1], scratch_values_[0], scratch_values_[1], histograms_ })
+    {
+        if(glIsBuffer(buffer))
+            glDeleteBuffers(1, &buffer);
+    }
+
+    // The gather of the segmented sort reads the element indices through the histogram binding.
+    const auto size = static_cast<GLsizeiptr>(count * sizeof(GLuint));
+    const auto num_of_groups = calc_num_of_groups(count, elements_per_group);
+    const auto histogram_size = static_cast<GLsizeiptr>(num_of_groups * radix * sizeof(GLuint));
+
+    glCreateBuffers(2, scratch_keys_.data());
+    glCreateBuffers(2, scratch_values_.data());
+    glCreateBuffers(1, &histograms_);
+    for(std::size_t i = 0; i < 2; i++)
+    {
+        glNamedBufferStorage(scratch_keys_[i], size, nullptr, 0);
+        glNamedBufferStorage(scratch_values_[i], size, nullptr, 0);
+    }
+    glNamedBufferStorage(histograms_, histogram_size, nullptr, 0);
+
+    capacity_ = count;
+}
+
+void GpuSort::dispatch(Kernel& kernel, GLuint num_of_elements, GLuint group_elements)
+{
+    kernel.pipeline->Bind();
+    glDispatchCompute(calc_num_of_groups(num_of_elements, group_elements), 1, 1);
+    kernel.pipeline->Unbind();
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuSort::map_keys(GLuint keys, GLuint count, bool is_inverse)
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keys);
+    {
+        auto& uniform = map_keys_.pipeline->GetPipelineUniform();
+        uniform.Set("num_of_elements", count);
+        uniform.Set("is_inverse", is_inverse ? 1 : 0);
+    }
+    dispatch(map_keys_, count, group_size);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+}
+
+std::size_t GpuSort::radix_sort(const std::array<GLuint, 2>& keys, const std::array<GLuint, 2>& values, GLuint count, GLuint num_of_bits)
+{
+    const auto num_of_groups = calc_num_of_groups(count, elements_per_group);
+
+    count_.pipeline->GetPipelineUniform().Set("num_of_elements", count);
+    scan_.pipeline->GetPipelineUniform().Set("num_of_elements", num_of_groups * radix);
+    scatter_.pipeline->GetPipelineUniform().Set("num_of_elements", count);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, histograms_);
+
+    std::size_t src = 0;
+    for(GLuint shift = 0; shift < num_of_bits; shift += bits_per_pass)
+    {
+        const auto dst = 1 - src;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keys[src]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, values[src]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, keys[dst]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, values[dst]);
+
+        count_.pipeline->GetPipelineUniform().Set("shift", shift);
+        scatter_.pipeline->GetPipelineUniform().Set("shift", shift);
+
+        dispatch(count_, count, elements_per_group);
+        dispatch(scan_, scan_group_size, scan_group_size);
+        dispatch(scatter_, count, elements_per_group);
+
+        src = dst;
+    }
+
+    for(GLuint i = 0; i <= 4; i++)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    return src;
+}
+
+}   // namespace common::render
\ No newline at end of file
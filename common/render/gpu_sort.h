@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <GL/glew.h>
+
+namespace common::render
+{
+
+// Only the kernels need the shaders, the CPU reference is built without them.
+namespace shader
+{
+class Program;
+class ProgramPipeline;
+}
+
+/*!
+ * @class GpuSort
+ * @brief Sorts 32-bit keys with 32-bit payloads in storage buffers with a stable LSD radix sort.
+ *
+ * Each pass sorts on 4 bits of the keys with three dispatches: every group counts the digits of its 1024 elements,
+ * a single group scans the counts of all the groups, and every group scatters its elements in order. Float keys are
+ * mapped to unsigned integers of the same order before the passes and back after them.
+ * A segmented sort sorts on the keys first and then on the segments, which keeps the elements in their segments.
+ * The CPU reference needs no GL context. As both sorts are stable, their results match bit for bit.
+ */
+class GpuSort final
+{
+public:
+    static constexpr GLuint bits_per_pass = 4;
+    static constexpr GLuint elements_per_group = 1024;
+
+    enum class KeyType
+    {
+        Uint,
+        Float   // IEEE 754 single, negative values and -0 sort before the positive ones.
+    };
+
+public:
+    explicit GpuSort(GLuint capacity = 0);
+    ~GpuSort();
+
+    GpuSort(const GpuSort&) = delete;
+    GpuSort& operator = (const GpuSort&) = delete;
+    GpuSort(GpuSort&&) = delete;
+    GpuSort& operator = (GpuSort&&) = delete;
+
+    //! Sorts the first `count` elements of the buffers by key, elements with equal keys keep their order.
+    void SortPairs(GLuint keys, GLuint values, GLuint count, KeyType key_type = KeyType::Uint);
+
+    /*!
+     * Sorts each segment [offsets[i], offsets[i + 1]) of the buffers on its own.
+     * @param offsets a buffer of `num_of_segments + 1` ascending offsets, from 0 to `count`.
+     */
+    void SortSegments(GLuint keys, GLuint values, GLuint count, GLuint offsets, GLuint num_of_segments, KeyType key_type = KeyType::Uint);
+
+    //! The CPU reference of SortPairs(), an LSD radix sort with the elements split across threads.
+    static void SortPairs(std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& values, KeyType key_type = KeyType::Uint, unsigned int num_of_threads = 0);
+
+    //! The CPU reference of SortSegments(), the segments are sorted in parallel.
+    static void SortSegments(std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& values, const std::vector<std::uint32_t>& offsets, KeyType key_type = KeyType::Uint, unsigned int num_of_threads = 0);
+
+    GLuint GetCapacity() const noexcept { return capacity_; }
+
+private:
+    struct Kernel
+    {
+        std::unique_ptr<shader::Program> cs;
+        std::unique_ptr<shader::ProgramPipeline> pipeline;
+    };
+
+    void reserve(GLuint count);
+    void dispatch(Kernel& kernel, GLuint num_of_elements, GLuint group_elements);
+    void map_keys(GLuint keys, GLuint count, bool is_inverse);
+
+    /*!
+     * Runs the passes over the lowest `num_of_bits` bits, ping-ponging between the two pairs of buffers.
+     * @return the index of the pair holding the result.
+     */
+    std::size_t radix_sort(const std::array<GLuint, 2>& keys, const std::array<GLuint, 2>& values, GLuint count, GLuint num_of_bits);
+
+private:
+    GLuint capacity_;
+    std::array<GLuint, 2> scratch_keys_;
+    std::array<GLuint, 2> scratch_values_;
+    GLuint histograms_;
+
+    Kernel count_;
+    Kernel scan_;
+    Kernel scatter_;
+    Kernel map_keys_;
+    Kernel iota_;
+    Kernel segment_ids_;
+    Kernel gather_;
+};
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <hasenpfote/assert.h>
+#include "../parallel_for.h"
+#include "gpu_sort.h"
+
+// The CPU reference of GpuSort, kept apart from the kernels so that it can be built and tested without a GL context.
+
+namespace
+{
+
+using GpuSort = common::render::GpuSort;
+
+unsigned int get_num_of_threads(unsigned int num_of_threads)
+{
+    return (num_of_threads > 0) ? num_of_threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::uint32_t map_key(std::uint32_t key, GpuSort::KeyType key_type)
+{
+    if(key_type == GpuSort::KeyType::Uint)
+        return key;
+    return key ^ ((key & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u);
+}
+
+std::uint32_t unmap_key(std::uint32_t key, GpuSort::KeyType key_type)
+{
+    if(key_type == GpuSort::KeyType::Uint)
+        return key;
+    return key ^ ((key & 0x80000000u) ? 0x80000000u : 0xFFFFFFFFu);
+}
+
+}
+
+namespace common::render
+{
+
+void GpuSort::SortPairs(std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& values, KeyType key_type, unsigned int num_of_threads)
+{
+    HASENPFOTE_ASSERT(keys.size() == values.size());
+
+    const auto count = keys.size();
+    const std::size_t chunk_size = 1 << 16;
+    const auto num_of_chunks = (count + chunk_size - 1) / chunk_size;
+    num_of_threads = get_num_of_threads(num_of_threads);
+
+    for(auto& key : keys)
+        key = map_key(key, key_type);
+
+    // 8 bits per pass rather than 4, any stable sort gives the same result.
+    constexpr std::size_t cpu_radix = 256;
+    std::vector<std::array<std::size_t, cpu_radix>> positions(num_of_chunks);
+    std::vector<std::uint32_t> temp_keys(count);
+    std::vector<std::uint32_t> temp_values(count);
+
+    for(std::uint32_t shift = 0; shift < 32; shift += 8)
+    {
+        common::parallel_for(num_of_chunks, num_of_threads, [&](std::size_t chunk)
+        {
+            auto& bins = positions[chunk];
+            bins.fill(0);
+            const auto last = std::min(count, (chunk + 1) * chunk_size);
+            for(auto i = chunk * chunk_size; i < last; i++)
+                bins[(keys[i] >> shift) & (cpu_radix - 1)]++;
+        });
+
+        // Digit major, so that the chunks scatter each digit in order.
+        std::size_t position = 0;
+        for(std::size_t digit = 0; digit < cpu_radix; digit++)
+        {
+            for(auto& bins : positions)
+            {
+                const auto n = bins[digit];
+                bins[digit] = position;
+                position += n;
+            }
+        }
+
+        common::parallel_for(num_of_chunks, num_of_threads, [&](std::size_t chunk)
+        {
+            auto& bins = positions[chunk];
+            const auto last = std::min(count, (chunk + 1) * chunk_size);
+            for(auto i = chunk * chunk_size; i < last; i++)
+            {
+                const auto p = bins[(keys[i] >> shift) & (cpu_radix - 1)]++;
+                temp_keys[p] = keys[i];
+                temp_values[p] = values[i];
+            }
+        });
+        keys.swap(temp_keys);
+        values.swap(temp_values);
+    }
+
+    for(auto& key : keys)
+        key = unmap_key(key, key_type);
+}
+
+void GpuSort::SortSegments(std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& values, const std::vector<std::uint32_t>& offsets, KeyType key_type, unsigned int num_of_threads)
+{
+    HASENPFOTE_ASSERT(keys.size() == values.size());
+    HASENPFOTE_ASSERT(!offsets.empty() && (offsets.front() == 0) && (offsets.back() == keys.size()));
+    HASENPFOTE_ASSERT(std::is_sorted(offsets.cbegin(), offsets.cend()));
+
+    common::parallel_for(offsets.size() - 1, get_num_of_threads(num_of_threads), [&](std::size_t segment)
+    {
+        const auto first = offsets[segment];
+        const auto last = offsets[segment + 1];
+
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+        pairs.reserve(last - first);
+        for(auto i = first; i < last; i++)
+            pairs.emplace_back(map_key(keys[i], key_type), values[i]);
+
+        std::stable_sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+
+        for(auto i = first; i < last; i++)
+        {
+            keys[i] = unmap_key(pairs[i - first].first, key_type);
+            values[i] = pairs[i - first].second;
+        }
+    });
+}
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include <hasenpfote/assert.h>
+#include "gpu_timer.h"
+
+namespace common::render
+{
+
+GpuTimer::GpuTimer(std::size_t latency)
+    : queries_(latency * 2, 0), head_(0), count_(0), is_active_(false), is_skipped_(false), elapsed_(0.0)
+{
+    HASENPFOTE_ASSERT(latency > 0);
+    glGenQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+}
+
+GpuTimer::~GpuTimer()
+{
+    glDeleteQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+}
+
+void GpuTimer::Begin()
+{
+    HASENPFOTE_ASSERT(!is_active_);
+    is_active_ = true;
+
+    Collect();
+
+    // Every slot is still in flight, drop this measurement rather than stall.
+    const auto num_of_slots = queries_.size() / 2;
+    is_skipped_ = count_ == num_of_slots;
+    if(!is_skipped_)
+        glQueryCounter(queries_[head_ * 2], GL_TIMESTAMP);
+}
+
+void GpuTimer::End()
+{
+    HASENPFOTE_ASSERT(is_active_);
+    is_active_ = false;
+
+    if(is_skipped_)
+        return;
+
+    glQueryCounter(queries_[head_ * 2 + 1], GL_TIMESTAMP);
+    head_ = (head_ + 1) % (queries_.size() / 2);
+    count_++;
+}
+
+void GpuTimer::Collect()
+{
+    const auto num_of_slots = queries_.size() / 2;
+    while(count_ > 0)
+    {
+        const auto tail = (head_ + num_of_slots - count_) % num_of_slots;
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(queries_[tail * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available == GL_FALSE)
+            break;
+
+        GLuint64 begin, end;
+        glGetQueryObjectui64v(queries_[tail * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(queries_[tail * 2 + 1], GL_QUERY_RESULT, &end);
+        elapsed_ = static_cast<double>(end - begin) * 1e-6;
+        count_--;
+    }
+}
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>
+
+namespace common::render
+{
+
+/*!
+ * @class GpuTimer
+ * @brief Measures the GPU time between Begin() and End() with timestamp queries.
+ *
+ * Results are read back a few frames later so the CPU never waits for them. Timestamps may nest
+ * and interleave with other timers, unlike GL_TIME_ELAPSED queries.
+ */
+class GpuTimer final
+{
+public:
+    explicit GpuTimer(std::size_t latency = 4);
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator = (const GpuTimer&) = delete;
+    GpuTimer(GpuTimer&&) = delete;
+    GpuTimer& operator = (GpuTimer&&) = delete;
+
+    void Begin();
+    void End();
+
+    //! The latest available measurement in milliseconds.
+    double GetElapsedTime() const noexcept { return elapsed_; }
+
+private:
+    void Collect();
+
+private:
+    std::vector<GLuint> queries_;   // Begin and end of each slot.
+    std::size_t head_;
+    std::size_t count_;
+    bool is_active_;
+    bool is_skipped_;
+    double elapsed_;
+};
+
+}   // namespace common::render
\ No newline at end of file
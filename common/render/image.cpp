@@ -226,36 +226,57 @@ void Image::Release()
     data.reset();
 }
 
-std::unique_ptr<std::uint8_t[]> Image::ExtractChannel(Channel channel) const
+std::size_t Image::GetBytesPerChannel() const
+{
+    if(pixel_type == PixelType::UnsignedByte)
+        return 1;
+    if(pixel_type == PixelType::Half)
+        return 2;
+    if(pixel_type == PixelType::Float)
+        return 4;
+    return 0;
+}
+
+std::size_t Image::GetDataSize() const
 {
     if(!data || (color_format == ColorFormat::Unknown))
+        return 0;
+
+    const auto num_of_channels = static_cast<std::size_t>(color_format);
+    return width * height * num_of_channels * GetBytesPerChannel();
+}
+
+std::unique_ptr<std::uint8_t[]> Image::ExtractChannel(Channel channel) const
+{
+    auto ptr = std::make_unique<std::uint8_t[]>(width * height * GetBytesPerChannel());
+    if(!ExtractChannel(channel, ptr.get()))
         return nullptr;
+    return ptr;
+}
+
+bool Image::ExtractChannel(Channel channel, std::uint8_t* dst) const
+{
+    if(!data || (color_format == ColorFormat::Unknown))
+        return false;
 
     if(channel == Channel::Green)
     {
         if(color_format == ColorFormat::R)
-            return nullptr;
+            return false;
     }
     else if(channel == Channel::Blue)
     {
         if(color_format == ColorFormat::R || color_format == ColorFormat::RG)
-            return nullptr;
+            return false;
     }
     else if(channel == Channel::Alpha)
     {
         if(color_format == ColorFormat::R || color_format == ColorFormat::RG || color_format == ColorFormat::RGB)
-            return nullptr;
+            return false;
     }
 
-    std::size_t bytes_per_channel = 0;
-    if(pixel_type == PixelType::UnsignedByte)
-        bytes_per_channel = 1;
-    else if(pixel_type == PixelType::Half)
-        bytes_per_channel = 2;
-    else if(pixel_type == PixelType::Float)
-        bytes_per_channel = 4;
-    else
-        HASENPFOTE_ASSERT(false);
+    const auto bytes_per_channel = GetBytesPerChannel();
+    HASENPFOTE_ASSERT(bytes_per_channel > 0);
 
     const auto num_of_channels = static_cast<std::size_t>(color_format);
     const auto src_stride = bytes_per_channel * num_of_channels;
@@ -264,8 +285,6 @@ std::unique_ptr<std::uint8_t[]> Image::ExtractChannel(Channel channel) const
     const auto dst_row_bytes = dst_stride * width;
     const auto offset = static_cast<std::underlying_type<Channel>::type>(channel);
 
-    auto ptr = std::make_unique<std::uint8_t[]>(width * height * bytes_per_channel);
-
     for(decltype(height) i = 0; i < height; i++)
     {
         auto src_base = i * src_row_bytes;
@@ -273,11 +292,11 @@ std::unique_ptr<std::uint8_t[]> Image::ExtractChannel(Channel channel) const
         for(decltype(width) j = 0; j < width; j++)
         {
             auto src = &data[src_base + (j * num_of_channels + offset) * bytes_per_channel];
-            auto dst = &ptr[dst_base + j * bytes_per_channel];
-            std::memcpy(dst, src, bytes_per_channel);
+            auto d = &dst[dst_base + j * bytes_per_channel];
+            std::memcpy(d, src, bytes_per_channel);
         }
     }
-    return ptr;
+    return true;
 }
 
 }   // namespace common::render
\ No newline at end of file
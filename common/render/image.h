@@ -48,11 +48,14 @@ public:
     ColorFormat GetColorFormat() const { return color_format; }
     PixelType GetPixelType() const { return pixel_type; }
     const std::uint8_t* GetData() const { return data.get(); }
+    std::size_t GetDataSize() const;
     std::unique_ptr<std::uint8_t[]> ExtractChannel(Channel channel) const;
+    bool ExtractChannel(Channel channel, std::uint8_t* dst) const;
 
 private:
     bool LoadFromExrFile(const std::filesystem::path& filepath);
     void Release();
+    std::size_t GetBytesPerChannel() const;
 
 private:
     std::size_t width, height;
@@ -0,0 +1,99 @@
+#include <glm/glm.hpp>
+#include <hasenpfote/assert.h>
+#include "image_pass.h"
+
+namespace common::render
+{
+
+ImagePass::ImagePass(FullScreenQuad& quad, shader::Program* vs, shader::Program* fs, shader::Program* cs)
+    : quad_(quad), vs_(vs), fs_(fs), cs_(cs), local_size_{ 0, 0, 0 }
+{
+    HASENPFOTE_ASSERT((fs != nullptr) || (cs != nullptr));
+
+    if(fs != nullptr)
+    {
+        HASENPFOTE_ASSERT(vs != nullptr);
+        fragment_ = std::make_unique<shader::ProgramPipeline>(shader::ProgramPipeline::ProgramPtrSet({ vs, fs }));
+    }
+    if(cs != nullptr)
+    {
+        compute_ = std::make_unique<shader::ProgramPipeline>(shader::ProgramPipeline::ProgramPtrSet({ cs }));
+        glGetProgramiv(cs->GetProgram(), GL_COMPUTE_WORK_GROUP_SIZE, local_size_);
+    }
+    Set("texture0", 0);
+    Set("image0", 0);
+}
+
+bool ImagePass::HasPath(Path path) const noexcept
+{
+    return (path == Path::Fragment) ? static_cast<bool>(fragment_) : static_cast<bool>(compute_);
+}
+
+bool ImagePass::HasUniform(Path path, const std::string& name) const
+{
+    // Uniforms the compiler has optimized away are skipped, setting them would fail.
+    if(path == Path::Fragment)
+        return fragment_ && ((vs_->GetUniform().GetLocation(name) >= 0) || (fs_->GetUniform().GetLocation(name) >= 0));
+    return compute_ && (cs_->GetUniform().GetLocation(name) >= 0);
+}
+
+void ImagePass::Execute(Path path, GLuint input, GLuint sampler, FrameBuffer* output)
+{
+    HASENPFOTE_ASSERT(HasPath(path));
+
+    if(path == Path::Fragment)
+    {
+        output->Bind();
+        {
+            GLint viewport[4];
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            if(HasUniform(Path::Fragment, "pixel_size"))
+                fragment_->GetPipelineUniform().Set("pixel_size", glm::vec2(1.0f / static_cast<float>(viewport[2]), 1.0f / static_cast<float>(viewport[3])));
+
+            fragment_->Bind();
+            {
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, input);
+                glBindSampler(0, sampler);
+
+                quad_.Draw();
+            }
+            fragment_->Unbind();
+        }
+        output->Unbind();
+        return;
+    }
+
+    const auto num_groups_x = (static_cast<GLuint>(output->GetWidth()) + GetLocalSizeX() - 1) / GetLocalSizeX();
+    const auto num_groups_y = (static_cast<GLuint>(output->GetHeight()) + GetLocalSizeY() - 1) / GetLocalSizeY();
+    Dispatch(input, sampler, output, num_groups_x, num_groups_y);
+}
+
+void ImagePass::Dispatch(GLuint input, GLuint sampler, FrameBuffer* output, GLuint num_groups_x, GLuint num_groups_y)
+{
+    HASENPFOTE_ASSERT(HasPath(Path::Compute));
+
+    // The framebuffer keeps the size and format of its texture, so nothing is queried per dispatch.
+    const auto texture = output->GetColorTexture();
+    const auto format = output->GetColorFormat();
+    if(HasUniform(Path::Compute, "pixel_size"))
+        compute_->GetPipelineUniform().Set("pixel_size", glm::vec2(1.0f / static_cast<float>(output->GetWidth()), 1.0f / static_cast<float>(output->GetHeight())));
+
+    compute_->Bind();
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, input);
+        glBindSampler(0, sampler);
+        glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, format);
+
+        glDispatchCompute(num_groups_x, num_groups_y, 1);
+
+        glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, format);
+    }
+    compute_->Unbind();
+
+    // Later passes may sample, load or render to the output.
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+}
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <GL/glew.h>
+#include "framebuffer.h"
+#include "fullscreen_quad.h"
+#include "shader/shader.h"
+
+namespace common::render
+{
+
+/*!
+ * @class ImagePass
+ * @brief An image to image pass implemented both as a fragment shader and as a compute shader.
+ *
+ * Both implementations read `texture0` from texture unit 0 and receive `pixel_size`, the reciprocal of the output size.
+ * Any other uniform is sent by Set() to whichever implementations use it, so the caller can switch paths every frame and time one against the other.
+ * The fragment shader is drawn on a FullScreenQuad into the output framebuffer. The compute shader writes `image0`
+ * on image unit 0, one invocation per output texel unless it is dispatched explicitly.
+ */
+class ImagePass final
+{
+public:
+    enum class Path
+    {
+        Fragment,
+        Compute
+    };
+
+public:
+    //! Either `fs`(with `vs`) or `cs` may be null if the pass has only one implementation.
+    ImagePass(FullScreenQuad& quad, shader::Program* vs, shader::Program* fs, shader::Program* cs);
+    ~ImagePass() = default;
+
+    ImagePass(const ImagePass&) = delete;
+    ImagePass& operator = (const ImagePass&) = delete;
+    ImagePass(ImagePass&&) = delete;
+    ImagePass& operator = (ImagePass&&) = delete;
+
+    bool HasPath(Path path) const noexcept;
+    bool HasUniform(Path path, const std::string& name) const;
+
+    template<typename T>
+    void Set(const std::string& name, const T& v)
+    {
+        if(HasUniform(Path::Fragment, name))
+            fragment_->GetPipelineUniform().Set(name, v);
+        if(HasUniform(Path::Compute, name))
+            compute_->GetPipelineUniform().Set(name, v);
+    }
+
+    template<typename T>
+    void Set(const std::string& name, const T a[], std::size_t size)
+    {
+        if(HasUniform(Path::Fragment, name))
+            fragment_->GetPipelineUniform().Set(name, a, size);
+        if(HasUniform(Path::Compute, name))
+            compute_->GetPipelineUniform().Set(name, a, size);
+    }
+
+    void Execute(Path path, GLuint input, GLuint sampler, FrameBuffer* output);
+
+    /*!
+     * Runs the compute shader on the color texture of the output with a caller chosen number of work groups.
+     * `pixel_size` is still that of the output.
+     */
+    void Dispatch(GLuint input, GLuint sampler, FrameBuffer* output, GLuint num_groups_x, GLuint num_groups_y);
+
+    //! Work group size of the compute shader.
+    GLuint GetLocalSizeX() const noexcept { return static_cast<GLuint>(local_size_[0]); }
+    GLuint GetLocalSizeY() const noexcept { return static_cast<GLuint>(local_size_[1]); }
+
+private:
+    FullScreenQuad& quad_;
+    shader::Program* vs_;
+    shader::Program* fs_;
+    shader::Program* cs_;
+    std::unique_ptr<shader::ProgramPipeline> fragment_;
+    std::unique_ptr<shader::ProgramPipeline> compute_;
+    GLint local_size_[3];
+};
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+#include "../parallel_for.h"
+#include "mipmap_generator.h"
+
+namespace
+{
+
+using Filter = common::render::MipmapGenerator::Filter;
+
+constexpr float pi = 3.14159265358979f;
+
+// Rows are handed out to the threads in tiles of this size.
+constexpr std::size_t rows_per_tile = 16;
+
+float sinc(float x)
+{
+    if(std::fabs(x) < 1e-6f)
+        return 1.0f;
+    x *= pi;
+    return std::sin(x) / x;
+}
+
+// Zeroth order modified Bessel function of the first kind.
+float bessel_i0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    const auto y = x * x * 0.25f;
+    for(int k = 1; k < 32; k++)
+    {
+        term *= y / static_cast<float>(k * k);
+        sum += term;
+        if(term < sum * 1e-8f)
+            break;
+    }
+    return sum;
+}
+
+float get_support(Filter filter)
+{
+    switch(filter)
+    {
+    case Filter::Box:
+        return 0.5f;
+    case Filter::Kaiser:
+    case Filter::Lanczos:
+        return 3.0f;
+    default:
+        return 0.5f;
+    }
+}
+
+float evaluate(Filter filter, float x)
+{
+    switch(filter)
+    {
+    case Filter::Box:
+        return ((x >= -0.5f) && (x < 0.5f)) ? 1.0f : 0.0f;
+    case Filter::Kaiser:
+        {
+            constexpr float width = 3.0f;
+            constexpr float alpha = 4.0f;
+            const auto t = x / width;
+            if(std::fabs(t) >= 1.0f)
+                return 0.0f;
+            return sinc(x) * bessel_i0(alpha * std::sqrt(1.0f - t * t)) / bessel_i0(alpha);
+        }
+    case Filter::Lanczos:
+        return (std::fabs(x) < 3.0f) ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+    default:
+        return 0.0f;
+    }
+}
+
+struct Contributor
+{
+    std::size_t first;
+    std::vector<float> weights;
+};
+
+// Precomputes the normalized weights of the source texels for each destination texel.
+std::vector<Contributor> calc_contributors(Filter filter, std::size_t src_size, std::size_t dst_size)
+{
+    const auto scale = static_cast<float>(src_size) / static_cast<float>(dst_size);
+    const auto radius = get_support(filter) * scale;
+
+    std::vector<Contributor> contributors(dst_size);
+    for(std::size_t i = 0; i < dst_size; i++)
+    {
+        const auto center = (static_cast<float>(i) + 0.5f) * scale;
+        const auto first = static_cast<std::ptrdiff_t>(std::floor(center - radius));
+        const auto last = static_cast<std::ptrdiff_t>(std::ceil(center + radius));
+
+        // Texels outside the image are clamped to the edge.
+        const auto lo = std::clamp<std::ptrdiff_t>(first, 0, static_cast<std::ptrdiff_t>(src_size) - 1);
+        const auto hi = std::clamp<std::ptrdiff_t>(last, 0, static_cast<std::ptrdiff_t>(src_size) - 1);
+        std::vector<float> weights(static_cast<std::size_t>(hi - lo + 1), 0.0f);
+        float sum = 0.0f;
+        for(auto j = first; j <= last; j++)
+        {
+            const auto w = evaluate(filter, (static_cast<float>(j) + 0.5f - center) / scale);
+            if(w == 0.0f)
+                continue;
+            weights[static_cast<std::size_t>(std::clamp(j, lo, hi) - lo)] += w;
+            sum += w;
+        }
+
+        // Trim the taps which do not contribute.
+        std::size_t head = 0;
+        while((head + 1 < weights.size()) && (weights[head] == 0.0f))
+            head++;
+        auto tail = weights.size();
+        while((tail > head + 1) && (weights[tail - 1] == 0.0f))
+            tail--;
+
+        auto& contributor = contributors[i];
+        contributor.first = static_cast<std::size_t>(lo) + head;
+        contributor.weights.assign(weights.cbegin() + static_cast<std::ptrdiff_t>(head), weights.cbegin() + static_cast<std::ptrdiff_t>(tail));
+        for(auto& w : contributor.weights)
+            w /= sum;
+    }
+    return contributors;
+}
+
+const std::array<float, 256>& get_srgb_to_linear_table()
+{
+    static const auto table = []()
+    {
+        std::array<float, 256> t;
+        for(std::size_t i = 0; i < t.size(); i++)
+        {
+            const auto c = static_cast<float>(i) / 255.0f;
+            t[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return table;
+}
+
+std::uint8_t linear_to_srgb(float c)
+{
+    c = std::clamp(c, 0.0f, 1.0f);
+    c = (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    return static_cast<std::uint8_t>(c * 255.0f + 0.5f);
+}
+
+std::uint8_t to_unorm8(float c)
+{
+    return static_cast<std::uint8_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+}
+
+namespace common::render
+{
+
+MipmapGenerator::MipmapGenerator(Filter filter, unsigned int num_of_threads)
+    : filter_(filter),
+      num_of_threads_((num_of_threads > 0) ? num_of_threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+std::vector<MipmapGenerator::Level<float>> MipmapGenerator::Generate(
+    const float* texels,
+    std::size_t width,
+    std::size_t height,
+    std::size_t num_of_channels,
+    std::size_t num_of_levels) const
+{
+    if(num_of_levels == 0)
+        num_of_levels = CalcNumOfLevels(width, height);
+
+    std::vector<Level<float>> levels;
+    if(num_of_levels < 2)
+        return levels;
+    levels.reserve(num_of_levels - 1);
+
+    Level<float> base;
+    base.width = width;
+    base.height = height;
+    base.texels.assign(texels, texels + width * height * num_of_channels);
+
+    const Level<float>* src = &base;
+    for(std::size_t level = 1; level < num_of_levels; level++)
+    {
+        Level<float> dst;
+        dst.width = std::max<std::size_t>(1, width >> level);
+        dst.height = std::max<std::size_t>(1, height >> level);
+        Downsample(*src, dst, num_of_channels);
+        levels.push_back(std::move(dst));
+        src = &levels.back();
+    }
+    return levels;
+}
+
+std::vector<MipmapGenerator::Level<std::uint8_t>> MipmapGenerator::Generate(
+    const std::uint8_t* texels,
+    std::size_t width,
+    std::size_t height,
+    std::size_t num_of_channels,
+    bool srgb,
+    std::size_t num_of_levels) const
+{
+    const auto& srgb_to_linear = get_srgb_to_linear_table();
+    const auto is_color = [&](std::size_t c){ return srgb && (c != 3); };
+
+    const auto num_of_texels = width * height * num_of_channels;
+    std::vector<float> linear(num_of_texels);
+    common::parallel_for_tiles(height, rows_per_tile, num_of_threads_, [&](std::size_t begin, std::size_t end)
+    {
+        for(auto i = begin * width * num_of_channels; i < end * width * num_of_channels; i++)
+        {
+            const auto c = i % num_of_channels;
+            linear[i] = is_color(c) ? srgb_to_linear[texels[i]] : static_cast<float>(texels[i]) / 255.0f;
+        }
+    });
+
+    const auto float_levels = Generate(linear.data(), width, height, num_of_channels, num_of_levels);
+
+    std::vector<Level<std::uint8_t>> levels(float_levels.size());
+    for(std::size_t level = 0; level < levels.size(); level++)
+    {
+        const auto& src = float_levels[level];
+        auto& dst = levels[level];
+        dst.width = src.width;
+        dst.height = src.height;
+        dst.texels.resize(src.texels.size());
+        common::parallel_for_tiles(dst.height, rows_per_tile, num_of_threads_, [&](std::size_t begin, std::size_t end)
+        {
+            for(auto i = begin * dst.width * num_of_channels; i < end * dst.width * num_of_channels; i++)
+            {
+                const auto c = i % num_of_channels;
+                dst.texels[i] = is_color(c) ? linear_to_srgb(src.texels[i]) : to_unorm8(src.texels[i]);
+            }
+        });
+    }
+    return levels;
+}
+
+std::size_t MipmapGenerator::CalcNumOfLevels(std::size_t width, std::size_t height)
+{
+    std::size_t levels = 1;
+    for(auto size = std::max(width, height); size > 1; size >>= 1)
+        levels++;
+    return levels;
+}
+
+void MipmapGenerator::Downsample(const Level<float>& src, Level<float>& dst, std::size_t num_of_channels) const
+{
+    const auto horizontal = calc_contributors(filter_, src.width, dst.width);
+    const auto vertical = calc_contributors(filter_, src.height, dst.height);
+
+    const auto src_stride = src.width * num_of_channels;
+    const auto dst_stride = dst.width * num_of_channels;
+
+    // Horizontal pass: src.width x src.height -> dst.width x src.height.
+    std::vector<float> temp(dst_stride * src.height);
+    common::parallel_for_tiles(src.height, rows_per_tile, num_of_threads_, [&](std::size_t begin, std::size_t end)
+    {
+        for(auto y = begin; y < end; y++)
+        {
+            const auto src_row = &src.texels[y * src_stride];
+            const auto dst_row = &temp[y * dst_stride];
+            for(std::size_t x = 0; x < dst.width; x++)
+            {
+                const auto& contributor = horizontal[x];
+                const auto s = &src_row[contributor.first * num_of_channels];
+                const auto d = &dst_row[x * num_of_channels];
+                for(std::size_t c = 0; c < num_of_channels; c++)
+                    d[c] = 0.0f;
+                for(std::size_t k = 0; k < contributor.weights.size(); k++)
+                {
+                    const auto w = contributor.weights[k];
+                    for(std::size_t c = 0; c < num_of_channels; c++)
+                        d[c] += w * s[k * num_of_channels + c];
+                }
+            }
+        }
+    });
+
+    // Vertical pass: whole rows are accumulated, which keeps the inner loop contiguous for the vectorizer.
+    dst.texels.assign(dst_stride * dst.height, 0.0f);
+    common::parallel_for_tiles(dst.height, rows_per_tile, num_of_threads_, [&](std::size_t begin, std::size_t end)
+    {
+        for(auto y = begin; y < end; y++)
+        {
+            const auto& contributor = vertical[y];
+            const auto d = &dst.texels[y * dst_stride];
+            for(std::size_t k = 0; k < contributor.weights.size(); k++)
+            {
+                const auto w = contributor.weights[k];
+                const auto s = &temp[(contributor.first + k) * dst_stride];
+                for(std::size_t i = 0; i < dst_stride; i++)
+                    d[i] += w * s[i];
+            }
+        }
+    });
+}
+
+}   // namespace common::render
\ No newline at end of file
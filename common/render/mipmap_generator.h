@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace common::render
+{
+
+/*!
+ * @class MipmapGenerator
+ * @brief Builds mipmap chains on the CPU with a selectable separable filter.
+ *
+ * Filtering is done in linear space; sRGB encoded texels are decoded before filtering and encoded afterwards.
+ * Each level is resampled from the previous one in floating point, and the rows are split across threads.
+ */
+class MipmapGenerator final
+{
+public:
+    enum class Filter
+    {
+        Box,
+        Kaiser,
+        Lanczos
+    };
+
+    template<typename T>
+    struct Level
+    {
+        std::size_t width = 0;
+        std::size_t height = 0;
+        std::vector<T> texels;
+    };
+
+public:
+    explicit MipmapGenerator(Filter filter = Filter::Kaiser, unsigned int num_of_threads = 0);
+    ~MipmapGenerator() = default;
+
+    MipmapGenerator(const MipmapGenerator&) = delete;
+    MipmapGenerator& operator = (const MipmapGenerator&) = delete;
+    MipmapGenerator(MipmapGenerator&&) = delete;
+    MipmapGenerator& operator = (MipmapGenerator&&) = delete;
+
+    Filter GetFilter() const noexcept { return filter_; }
+
+    /*!
+     * Generates the levels below the base level.
+     * @param num_of_levels the number of levels including the base level, 0 for a full chain.
+     * @return levels [1, num_of_levels).
+     */
+    std::vector<Level<float>> Generate(
+        const float* texels,
+        std::size_t width,
+        std::size_t height,
+        std::size_t num_of_channels,
+        std::size_t num_of_levels = 0) const;
+
+    /*!
+     * 8-bit version. If `srgb` is true, all channels except the fourth are treated as sRGB encoded.
+     */
+    std::vector<Level<std::uint8_t>> Generate(
+        const std::uint8_t* texels,
+        std::size_t width,
+        std::size_t height,
+        std::size_t num_of_channels,
+        bool srgb,
+        std::size_t num_of_levels = 0) const;
+
+    static std::size_t CalcNumOfLevels(std::size_t width, std::size_t height);
+
+private:
+    void Downsample(const Level<float>& src, Level<float>& dst, std::size_t num_of_channels) const;
+
+private:
+    Filter filter_;
+    unsigned int num_of_threads_;
+};
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include <stdexcept>
+#include <algorithm>
+#include <hasenpfote/assert.h>
+#include "../logger.h"
+#include "readback.h"
+
+namespace
+{
+
+constexpr GLsizeiptr min_capacity = 256;
+
+GLsizeiptr get_num_of_components(GLenum format)
+{
+    switch(format)
+    {
+    case GL_RED:
+    case GL_GREEN:
+    case GL_BLUE:
+    case GL_RED_INTEGER:
+    case GL_DEPTH_COMPONENT:
+    case GL_STENCIL_INDEX:
+        return 1;
+    case GL_RG:
+    case GL_RG_INTEGER:
+        return 2;
+    case GL_RGB:
+    case GL_BGR:
+    case GL_RGB_INTEGER:
+        return 3;
+    case GL_RGBA:
+    case GL_BGRA:
+    case GL_RGBA_INTEGER:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+GLsizeiptr get_component_size(GLenum type)
+{
+    switch(type)
+    {
+    case GL_UNSIGNED_BYTE:
+    case GL_BYTE:
+        return 1;
+    case GL_UNSIGNED_SHORT:
+    case GL_SHORT:
+    case GL_HALF_FLOAT:
+        return 2;
+    case GL_UNSIGNED_INT:
+    case GL_INT:
+    case GL_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+// Every row is padded to the pack alignment, including the last one.
+GLsizeiptr calc_image_size(const common::render::Readback::Region& region)
+{
+    const auto pixel_size = get_num_of_components(region.format) * get_component_size(region.type);
+    HASENPFOTE_ASSERT_MSG(pixel_size > 0, "Unsupported pixel format or type.");
+
+    const auto alignment = static_cast<GLsizeiptr>(region.pack_alignment);
+    const auto row_size = (pixel_size * region.width + alignment - 1) / alignment * alignment;
+    return row_size * region.height * region.depth;
+}
+
+}
+
+namespace common::render
+{
+
+Readback::Readback(std::size_t max_reads_in_flight)
+    : max_reads_in_flight_(max_reads_in_flight)
+{
+    HASENPFOTE_ASSERT(max_reads_in_flight > 0);
+
+    // Buffers are created on demand, the slots never move so that callbacks may issue new reads.
+    slots_.resize(max_reads_in_flight_);
+    for(std::size_t i = max_reads_in_flight_; i > 0; i--)
+        free_.push_back(i - 1);
+}
+
+Readback::~Readback()
+{
+    for(auto& slot : slots_)
+    {
+        if(slot.fence != nullptr)
+            glDeleteSync(slot.fence);
+        if(glIsBuffer(slot.buffer))
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+}
+
+bool Readback::Read(const Region& region, const Callback& callback)
+{
+    const auto size = calc_image_size(region);
+    auto slot = acquire(size);
+    if(slot == nullptr)
+        return false;
+
+    GLint prev_alignment;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &prev_alignment);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, region.pack_alignment);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+    glGetTextureSubImage(
+        region.texture, region.level,
+        region.xoffset, region.yoffset, region.zoffset,
+        region.width, region.height, region.depth,
+        region.format, region.type, static_cast<GLsizei>(size), nullptr
+    );
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, prev_alignment);
+
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->callback = callback;
+    return true;
+}
+
+bool Readback::Read(GLuint buffer, GLintptr offset, GLsizeiptr size, const Callback& callback)
+{
+    auto slot = acquire(size);
+    if(slot == nullptr)
+        return false;
+
+    glCopyNamedBufferSubData(buffer, slot->buffer, offset, 0, size);
+
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->callback = callback;
+    return true;
+}
+
+void Readback::Update()
+{
+    retire(false);
+}
+
+void Readback::Finish()
+{
+    retire(true);
+}
+
+Readback::Slot* Readback::acquire(GLsizeiptr size)
+{
+    HASENPFOTE_ASSERT(size > 0);
+
+    if(free_.empty())
+        return nullptr;
+
+    // Take the smallest buffer that fits, otherwise grow the largest one.
+    auto it = free_.end();
+    for(auto jt = free_.begin(); jt != free_.end(); jt++)
+    {
+        const auto capacity = slots_[*jt].capacity;
+        if(it == free_.end())
+        {
+            it = jt;
+            continue;
+        }
+        const auto best = slots_[*it].capacity;
+        if((best < size) ? (capacity > best) : ((capacity >= size) && (capacity < best)))
+            it = jt;
+    }
+    const auto index = *it;
+    free_.erase(it);
+
+    auto& slot = slots_[index];
+    if(slot.capacity < size)
+    {
+        if(glIsBuffer(slot.buffer))
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glDeleteBuffers(1, &slot.buffer);
+        }
+
+        slot.capacity = min_capacity;
+        while(slot.capacity < size)
+            slot.capacity *= 2;
+
+        LOG_I("Creating readback buffer. [capacity=" << slot.capacity << "]");
+
+        constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferStorage(GL_PIXEL_PACK_BUFFER, slot.capacity, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+        slot.mapped = static_cast<const std::uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.capacity, flags));
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        if(slot.mapped == nullptr)
+        {
+            LOG_E("Failed to map the readback buffer.");
+            glDeleteBuffers(1, &slot.buffer);
+            slot.buffer = 0;
+            slot.capacity = 0;
+            free_.push_back(index);
+            throw std::runtime_error("");
+        }
+    }
+
+    slot.size = size;
+    in_flight_.push_back(index);
+    return &slot;
+}
+
+void Readback::retire(bool wait)
+{
+    constexpr GLuint64 timeout = 1000000000; // 1 sec.
+
+    // Copies complete in the order they were issued, so stop at the first one still in flight.
+    while(!in_flight_.empty())
+    {
+        const auto index = in_flight_.front();
+        auto& slot = slots_[index];
+
+        GLenum result;
+        do
+        {
+            result = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? timeout : 0);
+        }
+        while(wait && (result == GL_TIMEOUT_EXPIRED));
+
+        if((result != GL_ALREADY_SIGNALED) && (result != GL_CONDITION_SATISFIED))
+            break;
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        in_flight_.pop_front();
+
+        // The slot is handed back only after the callback, which may issue new reads.
+        auto callback = std::move(slot.callback);
+        slot.callback = nullptr;
+        if(callback)
+            callback(slot.mapped, slot.size);
+        free_.push_back(index);
+    }
+}
+
+}   // namespace common::render
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+#include <GL/glew.h>
+
+namespace common::render
+{
+
+/*!
+ * @class Readback
+ * @brief Copies texture and buffer contents back to the CPU without stalling the pipeline.
+ *
+ * Each read is copied into a persistent-mapped pixel pack buffer taken from a pool and fenced.
+ * Update() hands the completed ones to their callbacks, usually a few frames after they were issued.
+ * Every member must be called on the thread that owns the GL context.
+ */
+class Readback final
+{
+public:
+    static constexpr std::size_t default_max_reads_in_flight = 16;
+
+    struct Region
+    {
+        GLuint texture = 0;
+        GLint level = 0;
+        GLint xoffset = 0;
+        GLint yoffset = 0;
+        GLint zoffset = 0;
+        GLsizei width = 1;
+        GLsizei height = 1;
+        GLsizei depth = 1;
+        GLenum format = GL_RGBA;
+        GLenum type = GL_UNSIGNED_BYTE;
+        GLint pack_alignment = 4;
+    };
+
+    // Receives the copied data, which is only valid during the call.
+    using Callback = std::function<void(const void* data, GLsizeiptr size)>;
+
+public:
+    explicit Readback(std::size_t max_reads_in_flight = default_max_reads_in_flight);
+    ~Readback();
+
+    Readback(const Readback&) = delete;
+    Readback& operator = (const Readback&) = delete;
+    Readback(Readback&&) = delete;
+    Readback& operator = (Readback&&) = delete;
+
+    std::size_t GetNumOfReadsInFlight() const noexcept { return in_flight_.size(); }
+
+    //! Queues a copy of the texture region. Returns false, dropping the read, if too many reads are in flight.
+    bool Read(const Region& region, const Callback& callback);
+    //! Queues a copy of the buffer range. Returns false, dropping the read, if too many reads are in flight.
+    bool Read(GLuint buffer, GLintptr offset, GLsizeiptr size, const Callback& callback);
+
+    //! Invokes the callbacks of the reads that have completed, in the order they were issued. Never blocks.
+    void Update();
+    //! Waits for every read in flight and invokes its callback.
+    void Finish();
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        GLsizeiptr capacity = 0;
+        const std::uint8_t* mapped = nullptr;
+        GLsizeiptr size = 0;
+        GLsync fence = nullptr;
+        Callback callback;
+    };
+
+    Slot* acquire(GLsizeiptr size);
+    void retire(bool wait);
+
+private:
+    std::size_t max_reads_in_flight_;
+    std::vector<Slot> slots_;
+    std::vector<std::size_t> free_;
+    std::deque<std::size_t> in_flight_;
+};
+
+}   // namespace common::render
\ No newline at end of file
@@ -51,6 +51,8 @@ GLenum file_extension_to_shader_type(const std::filesystem::path& extension)
         return GL_GEOMETRY_SHADER;
     if(ext == ".fs")
         return GL_FRAGMENT_SHADER;
+    if(ext == ".cs")
+        return GL_COMPUTE_SHADER;
     return 0;
 }
 
@@ -66,6 +68,8 @@ GLbitfield shader_type_to_stage(GLenum type)
         return GL_GEOMETRY_SHADER_BIT;
     if(type == GL_FRAGMENT_SHADER)
         return GL_FRAGMENT_SHADER_BIT;
+    if(type == GL_COMPUTE_SHADER)
+        return GL_COMPUTE_SHADER_BIT;
     return 0;
 }
 
@@ -113,7 +117,7 @@ Program::~Program()
 
 const Resource<Program>::string_set_t& Program::allowed_extensions_impl()
 {
-    static string_set_t ss({ ".vs", ".tcs", ".tes", ".gs", ".fs" });
+    static string_set_t ss({ ".vs", ".tcs", ".tes", ".gs", ".fs", ".cs" });
     return ss;
 }
 
@@ -0,0 +1,43 @@
+#include "shader_snippets.h"
+
+namespace common::render
+{
+
+const std::string& GetFullScreenVertexShaderSource()
+{
+    static const std::string source =
+    "#version 430\n"
+    "layout(location = 0) in vec3 vsPosition;\n"
+    "out gl_PerVertex\n"
+    "{\n"
+        "vec4 gl_Position;\n"
+    "};\n"
+    "void main(void)\n"
+    "{\n"
+        "gl_Position = vec4(vsPosition.x, vsPosition.y, 0.0, 1.0);\n"
+    "}\n";
+    return source;
+}
+
+const char* GetImageFormatQualifier(GLenum internal_format)
+{
+    switch(internal_format)
+    {
+    case GL_RGBA32F:
+        return "rgba32f";
+    case GL_RGBA16F:
+        return "rgba16f";
+    case GL_R11F_G11F_B10F:
+        return "r11f_g11f_b10f";
+    case GL_RGBA8:
+        return "rgba8";
+    case GL_R32F:
+        return "r32f";
+    case GL_R16F:
+        return "r16f";
+    default:
+        return nullptr;
+    }
+}
+
+}   // namespace common::render
\ No newline at end of file
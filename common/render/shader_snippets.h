@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <GL/glew.h>
+
+namespace common::render
+{
+
+/*!
+ * A vertex shader that passes the vertices of a FullScreenQuad through, for passes that only need a fragment shader.
+ * `vsPosition` is read from location 0.
+ */
+const std::string& GetFullScreenVertexShaderSource();
+
+/*!
+ * The format layout qualifier an image of `internal_format` is declared with, e.g. "rgba16f".
+ * @return nullptr if the format is not one the passes support.
+ */
+const char* GetImageFormatQualifier(GLenum internal_format);
+
+}   // namespace common::render
\ No newline at end of file
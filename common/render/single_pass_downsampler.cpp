@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <hasenpfote/assert.h>
+#include "../logger.h"
+#include "shader_snippets.h"
+#include "single_pass_downsampler.h"
+
+namespace
+{
+
+// 256 invocations reduce a 64x64 tile of the base level, four level 1 texels each.
+const std::string cs_source_header =
+"#version 430\n"
+"layout(local_size_x = 256) in;\n"
+"layout(std430, binding = 0) coherent buffer Counter\n"
+"{\n"
+    "uint counter;\n"
+"};\n"
+"layout(";
+
+const std::string cs_source_body =
+", binding = 0) coherent uniform image2D images[8];\n"
+"uniform sampler2D texture0;\n"
+"uniform int num_of_levels;\n"
+"uniform uint num_of_groups;\n"
+"shared vec4 tile[32 * 32];\n"
+"shared bool is_last;\n"
+"vec4 load_base(ivec2 p, ivec2 size)\n"
+"{\n"
+    "return texelFetch(texture0, min(p, size - 1), 0);\n"
+"}\n"
+"void store(int level, ivec2 p, vec4 v)\n"
+"{\n"
+    "if(all(lessThan(p, imageSize(images[level - 1]))))\n"
+        "imageStore(images[level - 1], p, v);\n"
+"}\n"
+"void main(void)\n"
+"{\n"
+    "const int index = int(gl_LocalInvocationIndex);\n"
+    "const ivec2 group = ivec2(gl_WorkGroupID.xy);\n"
+    "const ivec2 size = textureSize(texture0, 0);\n"
+    // A texel inside a level only depends on texels inside the level above, so clamped reads never leak into it.
+    "for(int i = 0; i < 4; i++)\n"
+    "{\n"
+        "int j = index + i * 256;\n"
+        "ivec2 p = group * 32 + ivec2(j % 32, j / 32);\n"
+        "ivec2 s = p * 2;\n"
+        "vec4 v = load_base(s, size) + load_base(s + ivec2(1, 0), size) + load_base(s + ivec2(0, 1), size) + load_base(s + ivec2(1, 1), size);\n"
+        "v *= 0.25;\n"
+        "store(1, p, v);\n"
+        "tile[j] = v;\n"
+    "}\n"
+    "barrier();\n"
+    // The tile is repacked with the width of each level, the reads must finish before it is overwritten.
+    "int width = 32;\n"
+    "for(int level = 2; level <= min(num_of_levels, 6); level++)\n"
+    "{\n"
+        "int src_width = width;\n"
+        "width /= 2;\n"
+        "bool active = index < width * width;\n"
+        "vec4 v = vec4(0.0);\n"
+        "if(active)\n"
+        "{\n"
+            "ivec2 p = ivec2(index % width, index / width);\n"
+            "int k = p.y * 2 * src_width + p.x * 2;\n"
+            "v = 0.25 * (tile[k] + tile[k + 1] + tile[k + src_width] + tile[k + src_width + 1]);\n"
+            "store(level, group * width + p, v);\n"
+        "}\n"
+        "barrier();\n"
+        "if(active)\n"
+            "tile[index] = v;\n"
+        "barrier();\n"
+    "}\n"
+    "if(num_of_levels <= 6)\n"
+        "return;\n"
+    // Level 6 has been written by the first invocation, publish it before counting the group as done.
+    "if(index == 0)\n"
+    "{\n"
+        "memoryBarrierImage();\n"
+        "is_last = atomicAdd(counter, 1u) == num_of_groups - 1u;\n"
+    "}\n"
+    "barrier();\n"
+    "if(!is_last)\n"
+        "return;\n"
+    "if(index == 0)\n"
+        "counter = 0u;\n"
+    "for(int level = 7; level <= num_of_levels; level++)\n"
+    "{\n"
+        "ivec2 dst_size = imageSize(images[level - 1]);\n"
+        "for(int j = index; j < dst_size.x * dst_size.y; j += 256)\n"
+        "{\n"
+            "ivec2 p = ivec2(j % dst_size.x, j / dst_size.x);\n"
+            "ivec2 s = p * 2;\n"
+            "vec4 v = imageLoad(images[level - 2], s) + imageLoad(images[level - 2], s + ivec2(1, 0)) + imageLoad(images[level - 2], s + ivec2(0, 1)) + imageLoad(images[level - 2], s + ivec2(1, 1));\n"
+            "imageStore(images[level - 1], p, v * 0.25);\n"
+        "}\n"
+        "memoryBarrierImage();\n"
+        "barrier();\n"
+    "}\n"
+"}\n";
+
+}
+
+namespace common::render
+{
+
+SinglePassDownsampler::SinglePassDownsampler(GLenum internal_format)
+    : internal_format_(internal_format), counter_(0)
+{
+    const auto format = GetImageFormatQualifier(internal_format);
+    if(format == nullptr)
+    {
+        LOG_E("Internal format is not supported by the downsampler. [format=" << internal_format << "]");
+        throw std::runtime_error("");
+    }
+
+    cs_ = std::make_unique<shader::Program>(cs_source_header + format + cs_source_body, GL_COMPUTE_SHADER);
+    pipeline_ = std::make_unique<shader::ProgramPipeline>(shader::ProgramPipeline::ProgramPtrSet({ cs_.get() }));
+    pipeline_->GetPipelineUniform().Set("texture0", 0);
+
+    // The last group resets the counter, so it is only cleared here.
+    const GLuint zero = 0;
+    glCreateBuffers(1, &counter_);
+    glNamedBufferStorage(counter_, sizeof(zero), &zero, 0);
+}
+
+SinglePassDownsampler::~SinglePassDownsampler()
+{
+    if(glIsBuffer(counter_))
+        glDeleteBuffers(1, &counter_);
+}
+
+void SinglePassDownsampler::Generate(GLuint texture, GLint num_of_levels)
+{
+    GLint immutable_levels = 0;
+    glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_LEVELS, &immutable_levels);
+    HASENPFOTE_ASSERT(immutable_levels > 0);
+
+    if(num_of_levels == 0)
+        num_of_levels = immutable_levels - 1;
+    num_of_levels = std::min(num_of_levels, max_levels);
+    HASENPFOTE_ASSERT(num_of_levels < immutable_levels);
+    if(num_of_levels <= 0)
+        return;
+
+    GLint width, height;
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
+    const auto num_groups_x = static_cast<GLuint>(width + 63) / 64;
+    const auto num_groups_y = static_cast<GLuint>(height + 63) / 64;
+
+    auto& uniform = pipeline_->GetPipelineUniform();
+    uniform.Set("num_of_levels", num_of_levels);
+    uniform.Set("num_of_groups", num_groups_x * num_groups_y);
+
+    pipeline_->Bind();
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindSampler(0, 0);
+        for(GLint i = 0; i < num_of_levels; i++)
+            glBindImageTexture(static_cast<GLuint>(i), texture, i + 1, GL_FALSE, 0, GL_READ_WRITE, internal_format_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, counter_);
+
+        glDispatchCompute(num_groups_x, num_groups_y, 1);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+        for(GLint i = 0; i < num_of_levels; i++)
+            glBindImageTexture(static_cast<GLuint>(i), 0, 0, GL_FALSE, 0, GL_READ_WRITE, internal_format_);
+    }
+    pipeline_->Unbind();
+
+    // Later passes may sample, load or render to any level, and the next dispatch reads the counter reset by the last group.
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+}   // namespace common::render
\ No newline at end of file
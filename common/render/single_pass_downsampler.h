@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <GL/glew.h>
+#include "shader/shader.h"
+
+namespace common::render
+{
+
+/*!
+ * @class SinglePassDownsampler
+ * @brief Generates the mip chain of a texture with a single compute dispatch.
+ *
+ * Each work group reduces a 64x64 tile of the base level to levels 1 through 6 in shared memory, with a 2x2 box
+ * filter. The last group to finish, found with a global atomic counter, reduces the remaining levels from level 6.
+ * Every level is written through its own image unit, so at most `max_levels` levels are generated.
+ * The texture must have immutable storage in the format given at construction.
+ */
+class SinglePassDownsampler final
+{
+public:
+    static constexpr GLint max_levels = 8;
+
+public:
+    explicit SinglePassDownsampler(GLenum internal_format = GL_RGBA16F);
+    ~SinglePassDownsampler();
+
+    SinglePassDownsampler(const SinglePassDownsampler&) = delete;
+    SinglePassDownsampler& operator = (const SinglePassDownsampler&) = delete;
+    SinglePassDownsampler(SinglePassDownsampler&&) = delete;
+    SinglePassDownsampler& operator = (SinglePassDownsampler&&) = delete;
+
+    /*!
+     * Overwrites levels [1, num_of_levels] from the base level.
+     * @param num_of_levels the number of levels below the base level, 0 for every level of the storage.
+     */
+    void Generate(GLuint texture, GLint num_of_levels = 0);
+
+private:
+    GLenum internal_format_;
+    GLuint counter_;
+    std::unique_ptr<shader::Program> cs_;
+    std::unique_ptr<shader::ProgramPipeline> pipeline_;
+};
+
+}   // namespace common::render
\ No newline at end of file
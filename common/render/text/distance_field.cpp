@@ -0,0 +1,422 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "distance_field.h"
+
+namespace
+{
+
+constexpr float infinity = 1e20f;
+
+using Shape = common::render::text::Shape;
+
+struct Vec2
+{
+    float x;
+    float y;
+};
+
+Vec2 lerp(const Vec2& a, const Vec2& b, float t)
+{
+    return Vec2{ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+float cross(const Vec2& a, const Vec2& b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+float dot(const Vec2& a, const Vec2& b)
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+Vec2 normalize(const Vec2& v)
+{
+    const auto length = std::sqrt(dot(v, v));
+    return (length > 0.0f) ? Vec2{ v.x / length, v.y / length } : Vec2{ 0.0f, 0.0f };
+}
+
+Vec2 get_point(const Shape::Edge& edge, std::size_t i)
+{
+    return Vec2{ edge.x[i], edge.y[i] };
+}
+
+// Splits the edge at `t` with de Casteljau's algorithm.
+void split(const Shape::Edge& edge, float t, Shape::Edge& head, Shape::Edge& tail)
+{
+    Vec2 points[4];
+    for(std::size_t i = 0; i <= edge.degree; i++)
+        points[i] = get_point(edge, i);
+
+    head = edge;
+    tail = edge;
+    for(std::size_t level = 0; level <= edge.degree; level++)
+    {
+        head.x[level] = points[0].x;
+        head.y[level] = points[0].y;
+        tail.x[edge.degree - level] = points[edge.degree - level].x;
+        tail.y[edge.degree - level] = points[edge.degree - level].y;
+        for(std::size_t i = 0; i + level < edge.degree; i++)
+            points[i] = lerp(points[i], points[i + 1], t);
+    }
+}
+
+Vec2 evaluate(const Shape::Edge& edge, float t)
+{
+    Vec2 points[4];
+    for(std::size_t i = 0; i <= edge.degree; i++)
+        points[i] = get_point(edge, i);
+    for(std::size_t level = edge.degree; level > 0; level--)
+    {
+        for(std::size_t i = 0; i < level; i++)
+            points[i] = lerp(points[i], points[i + 1], t);
+    }
+    return points[0];
+}
+
+// Tangent at the start or the end, skipping control points that coincide with the end point.
+Vec2 get_direction(const Shape::Edge& edge, bool at_end)
+{
+    const auto n = edge.degree;
+    for(std::size_t i = 1; i <= n; i++)
+    {
+        const auto d = at_end
+            ? Vec2{ edge.x[n] - edge.x[n - i], edge.y[n] - edge.y[n - i] }
+            : Vec2{ edge.x[i] - edge.x[0], edge.y[i] - edge.y[0] };
+        if((d.x != 0.0f) || (d.y != 0.0f))
+            return normalize(d);
+    }
+    return Vec2{ 0.0f, 0.0f };
+}
+
+std::uint8_t switch_color(std::uint8_t color, std::uint8_t banned)
+{
+    constexpr std::uint8_t colors[] = { Shape::Cyan, Shape::Magenta, Shape::Yellow };
+    std::size_t start = 0;
+    for(std::size_t i = 0; i < 3; i++)
+    {
+        if(colors[i] == color)
+            start = i + 1;
+    }
+    for(std::size_t i = 0; i < 3; i++)
+    {
+        const auto candidate = colors[(start + i) % 3];
+        if((candidate != color) && (candidate != banned))
+            return candidate;
+    }
+    return color;
+}
+
+// Lower envelope of the parabolas rooted at each sample of `f`.
+void transform_1d(const float* f, float* d, std::size_t n, std::size_t* v, float* z)
+{
+    std::size_t k = 0;
+    v[0] = 0;
+    z[0] = -std::numeric_limits<float>::infinity();
+    z[1] = std::numeric_limits<float>::infinity();
+    for(std::size_t q = 1; q < n; q++)
+    {
+        const auto fq = f[q] + static_cast<float>(q * q);
+        const auto intersect = [&](std::size_t r)
+        {
+            return (fq - f[r] - static_cast<float>(r * r)) / static_cast<float>(2 * (q - r));
+        };
+        // z[0] is -infinity, so this never runs past the first parabola.
+        auto s = intersect(v[k]);
+        while(s <= z[k])
+            s = intersect(v[--k]);
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = std::numeric_limits<float>::infinity();
+    }
+
+    k = 0;
+    for(std::size_t q = 0; q < n; q++)
+    {
+        while(z[k + 1] < static_cast<float>(q))
+            k++;
+        const auto r = v[k];
+        const auto dq = static_cast<float>(q) - static_cast<float>(r);
+        d[q] = dq * dq + f[r];
+    }
+}
+
+}   // namespace
+
+namespace common::render::text
+{
+
+void Shape::ColorEdges(float angle_threshold)
+{
+    const auto cross_threshold = std::sin(angle_threshold);
+    for(auto& contour : contours_)
+    {
+        if(contour.empty())
+            continue;
+
+        std::vector<std::size_t> corners;
+        auto prev_direction = get_direction(contour.back(), true);
+        for(std::size_t i = 0; i < contour.size(); i++)
+        {
+            const auto direction = get_direction(contour[i], false);
+            if((dot(prev_direction, direction) <= 0.0f) || (std::fabs(cross(prev_direction, direction)) > cross_threshold))
+                corners.push_back(i);
+            prev_direction = get_direction(contour[i], true);
+        }
+
+        // Smooth contour.
+        if(corners.empty())
+        {
+            for(auto& edge : contour)
+                edge.color = White;
+            continue;
+        }
+
+        // Teardrop: three colors spread symmetrically from the corner, which needs at least three edges.
+        if(corners.size() == 1)
+        {
+            auto corner = corners.front();
+            if(contour.size() < 3)
+            {
+                Contour thirds;
+                for(const auto& edge : contour)
+                {
+                    Edge first, rest, second, third;
+                    split(edge, 1.0f / 3.0f, first, rest);
+                    split(rest, 0.5f, second, third);
+                    thirds.insert(thirds.end(), { first, second, third });
+                }
+                contour.swap(thirds);
+                corner *= 3;
+            }
+
+            constexpr std::uint8_t colors[] = { Magenta, White, Yellow };
+            const auto m = contour.size();
+            for(std::size_t k = 0; k < m; k++)
+            {
+                const auto position = static_cast<float>(k) / static_cast<float>(m - 1);
+                const auto index = static_cast<std::size_t>(3.0f + 2.875f * position - 1.4375f + 0.5f) - 2;
+                contour[(corner + k) % m].color = colors[index];
+            }
+            continue;
+        }
+
+        // Switch the color at every corner, the last spline must also differ from the first.
+        std::vector<bool> is_corner(contour.size(), false);
+        for(auto corner : corners)
+            is_corner[corner] = true;
+
+        const auto start = corners.front();
+        std::uint8_t color = Cyan;
+        const auto initial = color;
+        std::size_t spline = 0;
+        for(std::size_t k = 0; k < contour.size(); k++)
+        {
+            const auto index = (start + k) % contour.size();
+            if((k > 0) && is_corner[index])
+            {
+                spline++;
+                color = switch_color(color, (spline == corners.size() - 1) ? initial : static_cast<std::uint8_t>(Black));
+            }
+            contour[index].color = color;
+        }
+    }
+}
+
+void Shape::Flatten(std::size_t steps_per_curve)
+{
+    segments_.clear();
+    for(const auto& contour : contours_)
+    {
+        for(const auto& edge : contour)
+        {
+            const auto steps = (edge.degree == 1) ? 1 : steps_per_curve;
+            auto a = get_point(edge, 0);
+            for(std::size_t i = 1; i <= steps; i++)
+            {
+                const auto b = (i == steps) ? get_point(edge, edge.degree) : evaluate(edge, static_cast<float>(i) / static_cast<float>(steps));
+                segments_.push_back(Segment{ a.x, a.y, b.x, b.y, edge.color, i == 1, i == steps });
+                a = b;
+            }
+        }
+    }
+}
+
+bool Shape::Contains(float x, float y) const
+{
+    int winding = 0;
+    for(const auto& segment : segments_)
+    {
+        const auto side = (segment.bx - segment.ax) * (y - segment.ay) - (x - segment.ax) * (segment.by - segment.ay);
+        if(segment.ay <= y)
+        {
+            if((segment.by > y) && (side > 0.0f))
+                winding++;
+        }
+        else if((segment.by <= y) && (side < 0.0f))
+        {
+            winding--;
+        }
+    }
+    return winding != 0;
+}
+
+void DistanceTransform(float* grid, std::size_t width, std::size_t height)
+{
+    const auto n = std::max(width, height);
+    std::vector<float> f(n);
+    std::vector<float> d(n);
+    std::vector<std::size_t> v(n);
+    std::vector<float> z(n + 1);
+
+    for(std::size_t x = 0; x < width; x++)
+    {
+        for(std::size_t y = 0; y < height; y++)
+            f[y] = grid[y * width + x];
+        transform_1d(f.data(), d.data(), height, v.data(), z.data());
+        for(std::size_t y = 0; y < height; y++)
+            grid[y * width + x] = d[y];
+    }
+    for(std::size_t y = 0; y < height; y++)
+    {
+        const auto row = &grid[y * width];
+        std::copy(row, row + width, f.begin());
+        transform_1d(f.data(), row, width, v.data(), z.data());
+    }
+}
+
+void GenerateSignedDistanceField(const std::uint8_t* coverage, std::size_t width, std::size_t height, float spread, std::uint8_t* sdf)
+{
+    const auto size = width * height;
+    std::vector<float> outer(size);
+    std::vector<float> inner(size);
+    for(std::size_t i = 0; i < size; i++)
+    {
+        const auto a = static_cast<float>(coverage[i]) / 255.0f;
+        if(coverage[i] == 255)
+        {
+            outer[i] = 0.0f;
+            inner[i] = infinity;
+        }
+        else if(coverage[i] == 0)
+        {
+            outer[i] = infinity;
+            inner[i] = 0.0f;
+        }
+        else
+        {
+            // Approximates the distance from the pixel centre to the edge by the coverage.
+            const auto o = std::max(0.0f, 0.5f - a);
+            const auto in = std::max(0.0f, a - 0.5f);
+            outer[i] = o * o;
+            inner[i] = in * in;
+        }
+    }
+
+    DistanceTransform(outer.data(), width, height);
+    DistanceTransform(inner.data(), width, height);
+
+    const auto scale = 0.5f / spread;
+    for(std::size_t i = 0; i < size; i++)
+    {
+        const auto distance = std::sqrt(outer[i]) - std::sqrt(inner[i]);
+        const auto value = std::clamp(0.5f - distance * scale, 0.0f, 1.0f);
+        sdf[i] = static_cast<std::uint8_t>(value * 255.0f + 0.5f);
+    }
+}
+
+void GenerateMultiChannelDistanceField(const Shape& shape, std::size_t width, std::size_t height, float spread, std::uint8_t* msdf)
+{
+    struct Nearest
+    {
+        float distance = infinity;  // Unsigned, for the comparison.
+        float orthogonality = 1.0f; // Breaks ties at shared end points, 0 is perpendicular.
+        float signed_distance = -infinity;
+        const Shape::Segment* segment = nullptr;
+        float t = 0.0f;
+    };
+
+    const auto& segments = shape.GetSegments();
+    const auto scale = 0.5f / spread;
+    for(std::size_t y = 0; y < height; y++)
+    {
+        for(std::size_t x = 0; x < width; x++)
+        {
+            const Vec2 p{ static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f };
+
+            Nearest nearest[3];
+            for(const auto& segment : segments)
+            {
+                const Vec2 a{ segment.ax, segment.ay };
+                const Vec2 ab{ segment.bx - segment.ax, segment.by - segment.ay };
+                const auto length2 = dot(ab, ab);
+                if(length2 <= 0.0f)
+                    continue;
+
+                const Vec2 ap{ p.x - a.x, p.y - a.y };
+                const auto t = dot(ap, ab) / length2;
+                const auto tc = std::clamp(t, 0.0f, 1.0f);
+                const Vec2 qp{ ap.x - ab.x * tc, ap.y - ab.y * tc };
+                const auto distance = std::sqrt(dot(qp, qp));
+                const auto orthogonality = (t == tc) ? 0.0f : std::fabs(dot(normalize(ab), normalize(qp)));
+                const auto signed_distance = (cross(ab, ap) >= 0.0f) ? distance : -distance;
+                for(std::size_t c = 0; c < 3; c++)
+                {
+                    if(((segment.color >> c) & 1) == 0)
+                        continue;
+                    auto& n = nearest[c];
+                    if((distance < n.distance) || ((distance == n.distance) && (orthogonality < n.orthogonality)))
+                        n = Nearest{ distance, orthogonality, signed_distance, &segment, t };
+                }
+            }
+
+            float d[3];
+            for(std::size_t c = 0; c < 3; c++)
+            {
+                const auto& n = nearest[c];
+                d[c] = n.signed_distance;
+                if(n.segment == nullptr)
+                    continue;
+
+                // Beyond the ends of an edge the distance to its tangent line is used instead.
+                const auto& segment = *n.segment;
+                const auto direction = normalize(Vec2{ segment.bx - segment.ax, segment.by - segment.ay });
+                Vec2 q{ 0.0f, 0.0f };
+                auto beyond = false;
+                if(segment.first && (n.t < 0.0f))
+                {
+                    q = Vec2{ p.x - segment.ax, p.y - segment.ay };
+                    beyond = dot(q, direction) < 0.0f;
+                }
+                else if(segment.last && (n.t > 1.0f))
+                {
+                    q = Vec2{ p.x - segment.bx, p.y - segment.by };
+                    beyond = dot(q, direction) > 0.0f;
+                }
+                if(beyond)
+                {
+                    const auto pseudo_distance = cross(direction, q);
+                    if(std::fabs(pseudo_distance) <= std::fabs(d[c]))
+                        d[c] = pseudo_distance;
+                }
+            }
+
+            // The winding of the outline decides the sign, whatever the orientation of the contours.
+            const auto median = std::max(std::min(d[0], d[1]), std::min(std::max(d[0], d[1]), d[2]));
+            if((median > 0.0f) != shape.Contains(p.x, p.y))
+            {
+                for(auto& v : d)
+                    v = -v;
+            }
+
+            const auto texel = &msdf[(y * width + x) * 3];
+            for(std::size_t c = 0; c < 3; c++)
+                texel[c] = static_cast<std::uint8_t>(std::clamp(0.5f + d[c] * scale, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+}
+
+}   // namespace common::render::text
\ No newline at end of file
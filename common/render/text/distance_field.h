@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace common::render::text
+{
+
+enum class DistanceFieldType
+{
+    SDF,    // Single channel.
+    MSDF    // Multi-channel, the distance is the median of RGB.
+};
+
+/*!
+ * @class Shape
+ * @brief Glyph outline in bitmap space(y down) for multi-channel distance field generation.
+ */
+class Shape final
+{
+public:
+    enum Color : std::uint8_t
+    {
+        Black = 0,
+        Red = 1,
+        Green = 2,
+        Yellow = 3,
+        Blue = 4,
+        Magenta = 5,
+        Cyan = 6,
+        White = 7
+    };
+
+    //! Bezier curve of degree 1 to 3.
+    struct Edge
+    {
+        std::uint8_t degree;
+        std::uint8_t color;
+        float x[4];
+        float y[4];
+    };
+    using Contour = std::vector<Edge>;
+
+    //! Line segment of a flattened edge.
+    struct Segment
+    {
+        float ax, ay;
+        float bx, by;
+        std::uint8_t color;
+        bool first;     // Starts an edge.
+        bool last;      // Ends an edge.
+    };
+
+public:
+    Shape() = default;
+    ~Shape() = default;
+
+    Shape(const Shape&) = default;
+    Shape& operator = (const Shape&) = default;
+    Shape(Shape&&) = default;
+    Shape& operator = (Shape&&) = default;
+
+    std::vector<Contour>& GetContours() noexcept { return contours_; }
+    const std::vector<Contour>& GetContours() const noexcept { return contours_; }
+    const std::vector<Segment>& GetSegments() const noexcept { return segments_; }
+
+    /*!
+     * Assigns channels so that the edges meeting at a corner never share two channels(Chlumsky's simple edge coloring).
+     * @param angle_threshold the minimum turn in radians that counts as a corner.
+     */
+    void ColorEdges(float angle_threshold = 3.0f);
+    //! Converts the colored edges into segments, must be called before Contains() and field generation.
+    void Flatten(std::size_t steps_per_curve = 8);
+    //! Non-zero winding test.
+    bool Contains(float x, float y) const;
+
+private:
+    std::vector<Contour> contours_;
+    std::vector<Segment> segments_;
+};
+
+/*!
+ * Exact squared Euclidean distance transform in linear time (Felzenszwalb and Huttenlocher).
+ * @param grid on input 0 at feature pixels and a large value elsewhere, on output the squared distance to the nearest feature.
+ */
+void DistanceTransform(float* grid, std::size_t width, std::size_t height);
+
+/*!
+ * Converts a coverage bitmap into a signed distance field.
+ * Partially covered pixels place the edge at sub-pixel precision. The edge maps to 128 and `spread` pixels to either end of the range.
+ */
+void GenerateSignedDistanceField(const std::uint8_t* coverage, std::size_t width, std::size_t height, float spread, std::uint8_t* sdf);
+
+/*!
+ * Generates an RGB multi-channel signed distance field from a flattened shape.
+ * Each channel holds the pseudo-distance to the nearest edge of that color, which keeps corners sharp after interpolation.
+ */
+void GenerateMultiChannelDistanceField(const Shape& shape, std::size_t width, std::size_t height, float spread, std::uint8_t* msdf);
+
+}   // namespace common::render::text
\ No newline at end of file
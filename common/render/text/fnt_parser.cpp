@@ -1,205 +1,476 @@
-﻿#include <fstream>
-#include <regex>
+﻿#include <charconv>
+#include <cstring>
+#include <string_view>
+#include "../../logger.h"
+#include "../../memory_mapped_file.h"
 #include "fnt_parser.h"
 
 namespace common::render::text
 {
 
-const std::string FntParser::INFO_TAG = "info";
-const std::string FntParser::COMMON_TAG = "common";
-const std::string FntParser::PAGE_TAG = "page";
-const std::string FntParser::CHARS_TAG = "chars";
-const std::string FntParser::CHAR_TAG = "char";
-const std::string FntParser::KERNINGS_TAG = "kernings";
-const std::string FntParser::KERNING_TAG = "kerning";
+namespace
+{
 
-template <typename T>
-static T GetInteger(const std::string& source, const std::string& name, T default_value = 0)
+// Splits a text line into `tag key=value key="value" ...` without copying.
+class Tokenizer final
 {
-    std::smatch match;
-    if(std::regex_search(source, match, std::regex(name + R"(=([-]{0,1}[\d]+))")))
-        return static_cast<T>(std::stoi(match[1])); // fnt ファイルで扱う分には問題ない数値となるが要注意.
-    return default_value;
-}
+public:
+    Tokenizer(const char* begin, const char* end)
+        : p(begin), last(end)
+    {
+    }
 
-template <typename T>
-static std::tuple<T, T> GetIntegerDuplet(const std::string& source, const std::string& name, std::tuple<T, T> default_value = { 0, 0 })
+    bool NextLine(std::string_view& tag)
+    {
+        while((p != last) && IsSpaceOrNewLine(*p))
+            p++;
+        if(p == last)
+            return false;
+
+        const auto begin = p;
+        while((p != last) && !IsSpaceOrNewLine(*p))
+            p++;
+        tag = std::string_view(begin, static_cast<std::size_t>(p - begin));
+        return true;
+    }
+
+    bool NextAttribute(std::string_view& key, std::string_view& value)
+    {
+        while((p != last) && IsSpace(*p))
+            p++;
+        if((p == last) || IsNewLine(*p))
+            return false;
+
+        const auto key_begin = p;
+        while((p != last) && (*p != '=') && !IsSpaceOrNewLine(*p))
+            p++;
+        key = std::string_view(key_begin, static_cast<std::size_t>(p - key_begin));
+
+        value = std::string_view();
+        if((p == last) || (*p != '='))
+            return true;
+        p++;
+
+        if((p != last) && (*p == '"'))
+        {
+            const auto value_begin = ++p;
+            while((p != last) && (*p != '"') && !IsNewLine(*p))
+                p++;
+            value = std::string_view(value_begin, static_cast<std::size_t>(p - value_begin));
+            if((p != last) && (*p == '"'))
+                p++;
+        }
+        else
+        {
+            const auto value_begin = p;
+            while((p != last) && !IsSpaceOrNewLine(*p))
+                p++;
+            value = std::string_view(value_begin, static_cast<std::size_t>(p - value_begin));
+        }
+        return true;
+    }
+
+private:
+    static bool IsSpace(char c) { return (c == ' ') || (c == '\t'); }
+    static bool IsNewLine(char c) { return (c == '\r') || (c == '\n'); }
+    static bool IsSpaceOrNewLine(char c) { return IsSpace(c) || IsNewLine(c); }
+
+private:
+    const char* p;
+    const char* last;
+};
+
+// Parses comma separated integers, e.g. `padding=0,0,0,0`.
+template <typename T, std::size_t N>
+void ToIntegers(std::string_view value, T (&result)[N])
 {
-    std::smatch match;
-    if(std::regex_search(source, match, std::regex(name + R"(=([-]{0,1}[\d]+),([-]{0,1}[\d]+))")))
-        return std::make_tuple(
-            static_cast<T>(std::stoi(match[1])),
-            static_cast<T>(std::stoi(match[2])));
-    return default_value;
+    auto p = value.data();
+    const auto last = value.data() + value.size();
+    for(std::size_t i = 0; i < N; i++){
+        long v = 0;
+        p = std::from_chars(p, last, v).ptr;
+        result[i] = static_cast<T>(v);  // fnt ファイルで扱う分には問題ない数値となるが要注意.
+        if((p == last) || (*p != ','))
+            break;
+        p++;
+    }
 }
 
 template <typename T>
-static std::tuple<T, T, T, T> GetIntegerQuadruplet(const std::string& source, const std::string& name, std::tuple<T, T, T, T> default_value = { 0, 0, 0, 0 })
+T ToInteger(std::string_view value)
 {
-    std::smatch match;
-    if(std::regex_search(source, match, std::regex(name + R"(=([-]{0,1}[\d]+),([-]{0,1}[\d]+),([-]{0,1}[\d]+),([-]{0,1}[\d]+))")))
-        return std::make_tuple(
-            static_cast<T>(std::stoi(match[1])),
-            static_cast<T>(std::stoi(match[2])),
-            static_cast<T>(std::stoi(match[3])),
-            static_cast<T>(std::stoi(match[4])));
-    return default_value;
+    T result[1] = {};
+    ToIntegers(value, result);
+    return result[0];
 }
 
-static bool GetBoolean(const std::string& source, const std::string& name, bool default_value = false)
+void ParseInfo(Tokenizer& tokenizer, FntParser::Info& info)
 {
-    std::smatch match;
-    if(std::regex_search(source, match, std::regex(name + R"(=([\d]))")))
-        return std::stoi(match[1]) > 0;
-    return default_value;
+    using E = FntParser::InfoElement;
+    std::string_view key, value;
+    while(tokenizer.NextAttribute(key, value)){
+        if(key == "face")
+            std::get<FntParser::as_integer(E::Face)>(info) = std::string(value);
+        else if(key == "size")
+            std::get<FntParser::as_integer(E::Size)>(info) = ToInteger<std::uint16_t>(value);
+        else if(key == "bold")
+            std::get<FntParser::as_integer(E::Bold)>(info) = ToInteger<std::uint8_t>(value);
+        else if(key == "italic")
+            std::get<FntParser::as_integer(E::Italic)>(info) = ToInteger<std::uint8_t>(value);
+        else if(key == "charset")
+            std::get<FntParser::as_integer(E::Charset)>(info) = std::string(value);
+        else if(key == "unicode")
+            std::get<FntParser::as_integer(E::Unicode)>(info) = ToInteger<std::uint8_t>(value);
+        else if(key == "stretchH")
+            std::get<6>(info) = ToInteger<std::uint16_t>(value);
+        else if(key == "smooth")
+            std::get<7>(info) = ToInteger<std::uint8_t>(value);
+        else if(key == "aa")
+            std::get<8>(info) = ToInteger<std::uint8_t>(value);
+        else if(key == "padding"){
+            std::uint8_t padding[4] = {};
+            ToIntegers(value, padding);
+            std::get<9>(info) = std::make_tuple(padding[0], padding[1], padding[2], padding[3]);
+        }
+        else if(key == "spacing"){
+            std::uint8_t spacing[2] = {};
+            ToIntegers(value, spacing);
+            std::get<10>(info) = std::make_tuple(spacing[0], spacing[1]);
+        }
+        else if(key == "outline")
+            std::get<11>(info) = ToInteger<std::uint8_t>(value);
+    }
 }
 
-static std::string GetString(const std::string& source, const std::string& name)
+void ParseCommon(Tokenizer& tokenizer, FntParser::Common& common)
 {
-    std::smatch match;
-    if(std::regex_search(source, match, std::regex(name + R"(=\"([\w|\s|\+|\.|-]*)\")")))
-        return match[1];
-    return "";
+    using E = FntParser::CommonElement;
+    std::string_view key, value;
+    while(tokenizer.NextAttribute(key, value)){
+        if(key == "lineHeight")
+            std::get<FntParser::as_integer(E::LineHeight)>(common) = ToInteger<std::uint16_t>(value);
+        else if(key == "base")
+            std::get<FntParser::as_integer(E::Base)>(common) = ToInteger<std::uint16_t>(value);
+        else if(key == "scaleW")
+            std::get<FntParser::as_integer(E::ScaleW)>(common) = ToInteger<std::uint16_t>(value);
+        else if(key == "scaleH")
+            std::get<FntParser::as_integer(E::ScaleH)>(common) = ToInteger<std::uint16_t>(value);
+        else if(key == "pages")
+            std::get<FntParser::as_integer(E::Pages)>(common) = ToInteger<std::uint16_t>(value);
+        else if(key == "packed")
+            std::get<FntParser::as_integer(E::Packed)>(common) = ToInteger<std::uint8_t>(value);
+        else if(key == "alphaChnl")
+            std::get<6>(common) = ToInteger<std::uint8_t>(value);
+        else if(key == "redChnl")
+            std::get<7>(common) = ToInteger<std::uint8_t>(value);
+        else if(key == "greenChnl")
+            std::get<8>(common) = ToInteger<std::uint8_t>(value);
+        else if(key == "blueChnl")
+            std::get<9>(common) = ToInteger<std::uint8_t>(value);
+    }
 }
 
-std::string FntParser::ReadLine(std::ifstream& ifs, const std::string& tag)
+void ParsePage(Tokenizer& tokenizer, FntParser::Page& page)
 {
-    std::string field;
-    if(!std::getline(ifs, field)){
-        throw std::runtime_error("Failed to get line.");
+    using E = FntParser::PageElement;
+    std::string_view key, value;
+    while(tokenizer.NextAttribute(key, value)){
+        if(key == "id")
+            std::get<FntParser::as_integer(E::Id)>(page) = ToInteger<std::uint8_t>(value);
+        else if(key == "file")
+            std::get<FntParser::as_integer(E::File)>(page) = std::string(value);
     }
-    if(!field.compare(0, tag.length(), tag) == 0){
-        throw std::runtime_error("Does not match the tag.");
+}
+
+std::uint32_t ParseCount(Tokenizer& tokenizer)
+{
+    std::uint32_t count = 0;
+    std::string_view key, value;
+    while(tokenizer.NextAttribute(key, value)){
+        if(key == "count")
+            count = ToInteger<std::uint32_t>(value);
     }
-    return field;
+    return count;
 }
 
-FntParser::Info FntParser::ParseInfo(const std::string& source)
+void ParseChar(Tokenizer& tokenizer, FntParser::Char& c)
 {
-    return std::make_tuple(
-        GetString(source, "face"),
-        GetInteger<std::uint16_t>(source, "size"),
-        GetInteger<std::uint8_t>(source, "bold"),
-        GetInteger<std::uint8_t>(source, "italic"),
-        GetString(source, "charset"),
-        GetInteger<std::uint8_t>(source, "unicode"),
-        GetInteger<std::uint16_t>(source, "stretchH"),
-        GetInteger<std::uint8_t>(source, "smooth"),
-        GetInteger<std::uint8_t>(source, "aa"),
-        GetIntegerQuadruplet<std::uint8_t>(source, "padding"),
-        GetIntegerDuplet<std::uint8_t>(source, "spacing"),
-        GetInteger<std::uint8_t>(source, "outline")
-    );
+    using E = FntParser::CharElement;
+    std::string_view key, value;
+    while(tokenizer.NextAttribute(key, value)){
+        // Dispatch on the first character to keep the comparisons to a minimum.
+        switch(key.empty() ? '\0' : key[0]){
+        case 'i':
+            if(key == "id")
+                std::get<FntParser::as_integer(E::Id)>(c) = ToInteger<std::uint32_t>(value);
+            break;
+        case 'x':
+            if(key == "x")
+                std::get<FntParser::as_integer(E::X)>(c) = ToInteger<std::uint16_t>(value);
+            else if(key == "xoffset")
+                std::get<FntParser::as_integer(E::XOffset)>(c) = ToInteger<std::int16_t>(value);
+            else if(key == "xadvance")
+                std::get<FntParser::as_integer(E::XAdvance)>(c) = ToInteger<std::int16_t>(value);
+            break;
+        case 'y':
+            if(key == "y")
+                std::get<FntParser::as_integer(E::Y)>(c) = ToInteger<std::uint16_t>(value);
+            else if(key == "yoffset")
+                std::get<FntParser::as_integer(E::YOffset)>(c) = ToInteger<std::int16_t>(value);
+            break;
+        case 'w':
+            if(key == "width")
+                std::get<FntParser::as_integer(E::Width)>(c) = ToInteger<std::uint16_t>(value);
+            break;
+        case 'h':
+            if(key == "height")
+                std::get<FntParser::as_integer(E::Height)>(c) = ToInteger<std::uint16_t>(value);
+            break;
+        case 'p':
+            if(key == "page")
+                std::get<FntParser::as_integer(E::Page)>(c) = ToInteger<std::uint8_t>(value);
+            break;
+        case 'c':
+            if(key == "chnl")
+                std::get<FntParser::as_integer(E::Chnl)>(c) = ToInteger<std::uint8_t>(value);
+            break;
+        default:
+            break;
+        }
+    }
 }
 
-FntParser::Common FntParser::ParseCommon(const std::string& source)
+void ParseKerning(Tokenizer& tokenizer, FntParser::Kerning& kerning)
 {
-    return std::make_tuple(
-        GetInteger<std::uint16_t>(source, "lineHeight"),
-        GetInteger<std::uint16_t>(source, "base"),
-        GetInteger<std::uint16_t>(source, "scaleW"),
-        GetInteger<std::uint16_t>(source, "scaleH"),
-        GetInteger<std::uint16_t>(source, "pages"),
-        GetInteger<std::uint8_t>(source, "packed"),
-        GetInteger<std::uint8_t>(source, "alphaChnl"),
-        GetInteger<std::uint8_t>(source, "redChnl"),
-        GetInteger<std::uint8_t>(source, "greenChnl"),
-        GetInteger<std::uint8_t>(source, "blueChnl")
-    );
+    using E = FntParser::KerningElement;
+    std::string_view key, value;
+    while(tokenizer.NextAttribute(key, value)){
+        if(key == "first")
+            std::get<FntParser::as_integer(E::First)>(kerning) = ToInteger<std::uint32_t>(value);
+        else if(key == "second")
+            std::get<FntParser::as_integer(E::Second)>(kerning) = ToInteger<std::uint32_t>(value);
+        else if(key == "amount")
+            std::get<FntParser::as_integer(E::Amount)>(kerning) = ToInteger<std::int16_t>(value);
+    }
 }
 
-FntParser::Page FntParser::ParsePage(const std::string& source)
+// Little-endian reader for the binary format.
+class BinaryReader final
+{
+public:
+    BinaryReader(const std::uint8_t* begin, const std::uint8_t* end)
+        : p(begin), last(end)
+    {
+    }
+
+    const std::uint8_t* GetPointer() const { return p; }
+    std::size_t GetRemaining() const { return static_cast<std::size_t>(last - p); }
+
+    template <typename T>
+    T Read()
+    {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    std::string ReadString()
+    {
+        const auto end = static_cast<const std::uint8_t*>(std::memchr(p, '\0', GetRemaining()));
+        const auto length = static_cast<std::size_t>(((end != nullptr) ? end : last) - p);
+        std::string s(reinterpret_cast<const char*>(p), length);
+        p += (end != nullptr) ? length + 1 : length;
+        return s;
+    }
+
+    void Skip(std::size_t size) { p += size; }
+
+private:
+    const std::uint8_t* p;
+    const std::uint8_t* last;
+};
+
+constexpr std::uint8_t binary_signature[] = { 'B', 'M', 'F' };
+constexpr std::uint8_t binary_version = 3;
+
+constexpr std::size_t binary_info_size = 14;
+constexpr std::size_t binary_common_size = 15;
+constexpr std::size_t binary_char_size = 20;
+constexpr std::size_t binary_kerning_size = 10;
+
+}   // namespace
+
+bool FntParser::Parse(const std::filesystem::path& filepath, Data& data)
 {
-    return std::make_tuple(
-        GetInteger<std::uint8_t>(source, "id"),
-        GetString(source, "file")
-    );
+    MemoryMappedFile file;
+    if(!file.Open(filepath))
+        return false;
+
+    const auto first = file.GetData();
+    const auto last = first + file.GetSize();
+    if((file.GetSize() >= sizeof(binary_signature)) && (std::memcmp(first, binary_signature, sizeof(binary_signature)) == 0))
+        return ParseBinary(first, last, data);
+    return ParseText(reinterpret_cast<const char*>(first), reinterpret_cast<const char*>(last), data);
 }
 
-std::uint32_t FntParser::ParseChars(const std::string& source)
+bool FntParser::ParseText(const char* first, const char* last, Data& data)
 {
-    return GetInteger<std::uint32_t>(source, "count");
+    data = Data();
+
+    Tokenizer tokenizer(first, last);
+    std::string_view tag;
+    while(tokenizer.NextLine(tag)){
+        if(tag == "char"){
+            ParseChar(tokenizer, data.chars.emplace_back());
+        }
+        else if(tag == "kerning"){
+            ParseKerning(tokenizer, data.kernings.emplace_back());
+        }
+        else if(tag == "info"){
+            ParseInfo(tokenizer, data.info);
+        }
+        else if(tag == "common"){
+            ParseCommon(tokenizer, data.common);
+        }
+        else if(tag == "page"){
+            ParsePage(tokenizer, data.pages.emplace_back());
+        }
+        else if(tag == "chars"){
+            data.chars.reserve(ParseCount(tokenizer));
+        }
+        else if(tag == "kernings"){
+            data.kernings.reserve(ParseCount(tokenizer));
+        }
+        else{
+            // Skip unknown tags.
+            std::string_view key, value;
+            while(tokenizer.NextAttribute(key, value));
+        }
+    }
+
+    if(data.chars.empty()){
+        LOG_E("No chars were found.");
+        return false;
+    }
+    return true;
 }
 
-FntParser::Char FntParser::ParseChar(const std::string& source)
+bool FntParser::ParseBinary(const std::uint8_t* first, const std::uint8_t* last, Data& data)
 {
-    static const std::string id_tag = "id=";
-    static const std::string x_tag = "x=";
-    static const std::string y_tag = "y=";
-    static const std::string width_tag = "width=";
-    static const std::string height_tag = "height=";
-    static const std::string xoffset_tag = "xoffset=";
-    static const std::string yoffset_tag = "yoffset=";
-    static const std::string xadvance_tag = "xadvance=";
-    static const std::string page_tag = "page=";
-    static const std::string chnl_tag = "chnl=";
-
-    FntParser::Char result;
-
-    std::size_t start = 0;
-    std::string delim = " ";
-    auto end = source.find(delim);
-    while(end != std::string::npos){
-        auto sub = source.substr(start, end - start);
-        if(!sub.empty()){
-            if(sub.compare(0, id_tag.length(), id_tag) == 0){
-                std::get<as_integer(CharElement::Id)>(result) = std::stoi(sub.substr(id_tag.length()));
-            }
-            else
-            if(sub.compare(0, x_tag.length(), x_tag) == 0){
-                std::get<as_integer(CharElement::X)>(result) = std::stoi(sub.substr(x_tag.length()));
-            }
-            else
-            if(sub.compare(0, y_tag.length(), y_tag) == 0){
-                std::get<as_integer(CharElement::Y)>(result) = std::stoi(sub.substr(y_tag.length()));
-            }
-            else
-            if(sub.compare(0, width_tag.length(), width_tag) == 0){
-                std::get<as_integer(CharElement::Width)>(result) = std::stoi(sub.substr(width_tag.length()));
-            }
-            else
-            if(sub.compare(0, height_tag.length(), height_tag) == 0){
-                std::get<as_integer(CharElement::Height)>(result) = std::stoi(sub.substr(height_tag.length()));
-            }
-            else
-            if(sub.compare(0, xoffset_tag.length(), xoffset_tag) == 0){
-                std::get<as_integer(CharElement::XOffset)>(result) = std::stoi(sub.substr(xoffset_tag.length()));
-            }
-            else
-            if(sub.compare(0, yoffset_tag.length(), yoffset_tag) == 0){
-                std::get<as_integer(CharElement::YOffset)>(result) = std::stoi(sub.substr(yoffset_tag.length()));
+    data = Data();
+
+    BinaryReader reader(first, last);
+    if((reader.GetRemaining() < 4) || (std::memcmp(first, binary_signature, sizeof(binary_signature)) != 0)){
+        LOG_E("Invalid binary font.");
+        return false;
+    }
+    reader.Skip(sizeof(binary_signature));
+    if(const auto version = reader.Read<std::uint8_t>(); version != binary_version){
+        LOG_E("Unsupported binary font version " << static_cast<int>(version) << ".");
+        return false;
+    }
+
+    while(reader.GetRemaining() >= 5){
+        const auto type = reader.Read<std::uint8_t>();
+        const auto size = static_cast<std::size_t>(reader.Read<std::uint32_t>());
+        if(size > reader.GetRemaining()){
+            LOG_E("Truncated binary font block. [type=" << static_cast<int>(type) << "]");
+            return false;
+        }
+        BinaryReader block(reader.GetPointer(), reader.GetPointer() + size);
+        reader.Skip(size);
+
+        switch(type){
+        case 1: // info
+            if(size >= binary_info_size){
+                const auto font_size = block.Read<std::int16_t>();
+                const auto bits = block.Read<std::uint8_t>();
+                const auto charset = block.Read<std::uint8_t>();
+                const auto stretch_h = block.Read<std::uint16_t>();
+                const auto aa = block.Read<std::uint8_t>();
+                std::uint8_t padding[4];
+                for(auto& v : padding)
+                    v = block.Read<std::uint8_t>();
+                std::uint8_t spacing[2];
+                for(auto& v : spacing)
+                    v = block.Read<std::uint8_t>();
+                const auto outline = block.Read<std::uint8_t>();
+                const auto face = block.ReadString();
+                data.info = std::make_tuple(
+                    face,
+                    static_cast<std::uint16_t>(font_size),
+                    static_cast<std::uint8_t>((bits >> 3) & 1),
+                    static_cast<std::uint8_t>((bits >> 2) & 1),
+                    std::to_string(static_cast<unsigned int>(charset)),
+                    static_cast<std::uint8_t>((bits >> 1) & 1),
+                    stretch_h,
+                    static_cast<std::uint8_t>(bits & 1),
+                    aa,
+                    std::make_tuple(padding[0], padding[1], padding[2], padding[3]),
+                    std::make_tuple(spacing[0], spacing[1]),
+                    outline
+                );
             }
-            else
-            if(sub.compare(0, xadvance_tag.length(), xadvance_tag) == 0){
-                std::get<as_integer(CharElement::XAdvance)>(result) = std::stoi(sub.substr(xadvance_tag.length()));
+            break;
+        case 2: // common
+            if(size >= binary_common_size){
+                const auto line_height = block.Read<std::uint16_t>();
+                const auto base = block.Read<std::uint16_t>();
+                const auto scale_w = block.Read<std::uint16_t>();
+                const auto scale_h = block.Read<std::uint16_t>();
+                const auto pages = block.Read<std::uint16_t>();
+                const auto bits = block.Read<std::uint8_t>();
+                const auto alpha_chnl = block.Read<std::uint8_t>();
+                const auto red_chnl = block.Read<std::uint8_t>();
+                const auto green_chnl = block.Read<std::uint8_t>();
+                const auto blue_chnl = block.Read<std::uint8_t>();
+                data.common = std::make_tuple(
+                    line_height, base, scale_w, scale_h, pages,
+                    static_cast<std::uint8_t>((bits >> 7) & 1),
+                    alpha_chnl, red_chnl, green_chnl, blue_chnl
+                );
             }
-            else
-            if(sub.compare(0, page_tag.length(), page_tag) == 0){
-                std::get<as_integer(CharElement::Page)>(result) = std::stoi(sub.substr(page_tag.length()));
+            break;
+        case 3: // pages
+            for(std::uint8_t id = 0; block.GetRemaining() > 0; id++)
+                data.pages.emplace_back(id, block.ReadString());
+            break;
+        case 4: // chars
+            data.chars.reserve(size / binary_char_size);
+            while(block.GetRemaining() >= binary_char_size){
+                const auto id = block.Read<std::uint32_t>();
+                const auto x = block.Read<std::uint16_t>();
+                const auto y = block.Read<std::uint16_t>();
+                const auto width = block.Read<std::uint16_t>();
+                const auto height = block.Read<std::uint16_t>();
+                const auto xoffset = block.Read<std::int16_t>();
+                const auto yoffset = block.Read<std::int16_t>();
+                const auto xadvance = block.Read<std::int16_t>();
+                const auto page = block.Read<std::uint8_t>();
+                const auto chnl = block.Read<std::uint8_t>();
+                data.chars.emplace_back(id, x, y, width, height, xoffset, yoffset, xadvance, page, chnl);
             }
-            else
-            if(sub.compare(0, chnl_tag.length(), chnl_tag) == 0){
-                std::get<as_integer(CharElement::Chnl)>(result) = std::stoi(sub.substr(chnl_tag.length()));
+            break;
+        case 5: // kerning pairs
+            data.kernings.reserve(size / binary_kerning_size);
+            while(block.GetRemaining() >= binary_kerning_size){
+                const auto first_id = block.Read<std::uint32_t>();
+                const auto second_id = block.Read<std::uint32_t>();
+                const auto amount = block.Read<std::int16_t>();
+                data.kernings.emplace_back(first_id, second_id, amount);
             }
+            break;
+        default:
+            break;
         }
-        start = end + delim.length();
-        end = source.find(delim, start);
     }
-    return result;
-}
 
-std::uint32_t FntParser::ParseKernings(const std::string& source)
-{
-    return GetInteger<std::uint32_t>(source, "count");
-}
-
-FntParser::Kerning FntParser::ParseKerning(const std::string& source)
-{
-    return std::make_tuple(
-        GetInteger<std::uint32_t>(source, "first"),
-        GetInteger<std::uint32_t>(source, "second"),
-        GetInteger<std::int16_t>(source, "amount")
-    );
+    if(data.chars.empty()){
+        LOG_E("No chars were found.");
+        return false;
+    }
+    return true;
 }
 
 }   // namespace common::render::text
\ No newline at end of file
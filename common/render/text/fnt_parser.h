@@ -6,8 +6,10 @@
 */
 #pragma once
 #include <cinttypes>
+#include <filesystem>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace common::render::text
 {
@@ -126,13 +128,14 @@ public:
         return static_cast<typename std::underlying_type<Enumeration>::type>(e);
     }
 
-    static const std::string INFO_TAG;
-    static const std::string COMMON_TAG;
-    static const std::string PAGE_TAG;
-    static const std::string CHARS_TAG;
-    static const std::string CHAR_TAG;
-    static const std::string KERNINGS_TAG;
-    static const std::string KERNING_TAG;
+    struct Data
+    {
+        Info info;
+        Common common;
+        std::vector<Page> pages;
+        std::vector<Char> chars;
+        std::vector<Kerning> kernings;
+    };
 
 public:
     FntParser() = delete;
@@ -142,15 +145,13 @@ public:
     FntParser(FntParser&&) = delete;
     FntParser& operator=(FntParser&&) = delete;
 
-    static std::string ReadLine(std::ifstream& ifs, const std::string& tag);
-
-    static Info ParseInfo(const std::string& source);
-    static Common ParseCommon(const std::string& source);
-    static Page ParsePage(const std::string& source);
-    static std::uint32_t ParseChars(const std::string& source);
-    static Char ParseChar(const std::string& source);
-    static std::uint32_t ParseKernings(const std::string& source);
-    static Kerning ParseKerning(const std::string& source);
+    /*!
+     * Parses a text or binary(version 3) file, which is detected from the header.
+     * The file is memory-mapped and scanned in a single pass.
+     */
+    static bool Parse(const std::filesystem::path& filepath, Data& data);
+    static bool ParseText(const char* first, const char* last, Data& data);
+    static bool ParseBinary(const std::uint8_t* first, const std::uint8_t* last, Data& data);
 };
 
 }   // namespace common::render::text
\ No newline at end of file
@@ -1,9 +1,13 @@
 ﻿#include <assert.h>
+#include <algorithm>
+#include <cctype>
 #include <stdexcept>
-#include <fstream>
-#include <iostream>
+#include <vector>
+#include "../../system.h"
 #include "../image.h"
+#include "../texture_uploader.h"
 #include "fnt_parser.h"
+#include "glyph_cache.h"
 #include "font.h"
 
 namespace common::render::text
@@ -16,8 +20,10 @@ static GLuint Create2DArrayTexture(GLsizei width, GLsizei height, const std::vec
     GLuint texture = 0;
     glGenTextures(1, &texture);
     glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R8, width, height, filepaths.size());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    auto& uploader = System::GetMutableInstance().GetTextureUploader();
 
     Image image;
     GLsizei depth = 0;
@@ -25,13 +31,39 @@ static GLuint Create2DArrayTexture(GLsizei width, GLsizei height, const std::vec
     {
         if(!image.LoadFromFile(filepath) || (image.GetColorFormat() != Image::ColorFormat::RGBA))
         {
+            uploader.Flush();
             glDeleteTextures(1, &texture);
             return 0;
         }
-        auto alpha_channel = image.ExtractChannel(Image::Channel::Alpha);
-        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, depth, image.GetHeight(), image.GetHeight(), 1, GL_RED, GL_UNSIGNED_BYTE, alpha_channel.get());
+
+        TextureUploader::Region region;
+        region.texture = texture;
+        region.target = GL_TEXTURE_2D_ARRAY;
+        region.zoffset = depth;
+        region.width = static_cast<GLsizei>(image.GetWidth());
+        region.height = static_cast<GLsizei>(image.GetHeight());
+        region.format = GL_RED;
+        region.type = GL_UNSIGNED_BYTE;
+        region.unpack_alignment = 1;
+
+        // The alpha channel is extracted straight into the mapped upload buffer.
+        const auto size = static_cast<GLsizeiptr>(image.GetWidth() * image.GetHeight());
+        TextureUploader::Staging staging;
+        if(uploader.TryAllocate(size, staging))
+        {
+            image.ExtractChannel(Image::Channel::Alpha, staging.data);
+            uploader.Submit(staging, region);
+        }
+        else
+        {
+            auto alpha_channel = image.ExtractChannel(Image::Channel::Alpha);
+            uploader.Upload(region, alpha_channel.get(), size);
+        }
         depth++;
     }
+    uploader.Flush();
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
 
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -98,115 +130,149 @@ bool Glyph::IsValid() const
 
 class Font::Impl final
 {
-public:
-    using GlyphMap = std::unordered_map<std::uint32_t, Glyph>;
-    using KerningAmount = std::tuple<std::uint32_t, std::int16_t>;
-
 public:
     Impl() = delete;
     explicit Impl(const std::filesystem::path& filepath);
+    Impl(const std::filesystem::path& filepath, const GlyphCacheOptions& options);
     ~Impl();
 
-    GLuint GetTexture() const { return texture; }
+    GLuint GetTexture() const { return cache ? cache->GetTexture() : texture; }
     Size GetTextureSize() const { return texture_size; }
+    DistanceFieldType GetDistanceFieldType() const { return cache ? cache->GetDistanceFieldType() : DistanceFieldType::SDF; }
     std::uint16_t GetBase() const { return base; }
     std::uint16_t GetLineHeight() const { return line_height; }
-    const GlyphMap& GetGlyphMap() const {return glyph; }
-    Glyph GetGlyph(std::uint32_t code) const;
+    std::int32_t GetAscent() const { return ascent; }
+    std::int32_t GetDescent() const { return descent; }
+    const Glyph& GetGlyph(std::uint32_t code) const;
     std::int16_t GetKerningAmount(std::uint32_t first, std::uint32_t second) const;
+    void TouchPages(const std::vector<std::uint16_t>& pages) const;
+    void Update();
+    std::uint64_t GetGeneration() const { return generation; }
 
 private:
     void Create(const std::filesystem::path& filepath);
-    static bool Compare(const KerningAmount& lhs, const KerningAmount& rhs);
+    void CreateGlyphTable(const std::vector<FntParser::Char>& chars);
+    void CreateKerningTable(const std::vector<FntParser::Kerning>& kernings);
+    void ClearGlyphTable();
+    void InsertGlyph(std::uint32_t code, const Glyph& glyph);
+    void EraseGlyph(std::uint32_t code);
 
 private:
+    static constexpr std::uint32_t max_code = 0x10FFFF;
+    static constexpr std::uint32_t page_size = 256;
+    static constexpr std::uint64_t empty_slot = ~std::uint64_t(0);
+
     GLuint texture;
     Size texture_size;
     std::uint16_t base;
     std::uint16_t line_height;
-    GlyphMap glyph;
-    using KerningPairMap = std::unordered_map<std::uint32_t, std::vector<KerningAmount>>;
-    KerningPairMap kerning_pair;
+    std::int32_t ascent;
+    std::int32_t descent;
+    // Glyphs are indexed through 256-code pages; pages without glyphs share the first block of zeros.
+    std::vector<Glyph> glyphs;
+    std::vector<std::uint32_t> glyph_pages;
+    std::vector<std::uint32_t> glyph_indices;
+    std::vector<std::uint32_t> free_glyphs;
+    // Open addressing table of `(first << 21 | second) << 16 | amount`.
+    std::vector<std::uint64_t> kerning_slots;
+    unsigned int kerning_shift;
+    // Only for fonts built at runtime.
+    std::unique_ptr<GlyphCache> cache;
+    std::uint64_t generation;
 };
 
-Font::Impl::Impl(const std::filesystem::path& filepath)
-    : texture(0)
+static std::uint64_t PackKerningKey(std::uint32_t first, std::uint32_t second)
 {
-    Create(filepath);
+    return (static_cast<std::uint64_t>(first) << 21) | second;
 }
 
-Font::Impl::~Impl()
+static std::size_t HashKerningKey(std::uint64_t key, unsigned int shift)
 {
-    if(glIsTexture(texture))
-        glDeleteTextures(1, &texture);
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
 }
 
-Glyph Font::Impl::GetGlyph(std::uint32_t code) const
+Font::Impl::Impl(const std::filesystem::path& filepath)
+    : Impl(filepath, GlyphCacheOptions())
 {
-    decltype(glyph)::const_iterator it = glyph.find(code);
-#if defined(_MSC_VER)
-    static Glyph invalid;
-    return Glyph((it != glyph.cend())? it->second : invalid);
-#else
-    return (it != glyph.cend()? it->second : Glyph();
-#endif
 }
 
-std::int16_t Font::Impl::GetKerningAmount(std::uint32_t first, std::uint32_t second) const
+Font::Impl::Impl(const std::filesystem::path& filepath, const GlyphCacheOptions& options)
+    : texture(0), ascent(0), descent(0), kerning_shift(64), generation(0)
 {
-    decltype(kerning_pair)::const_iterator it = kerning_pair.find(first);
-    if(it != kerning_pair.cend()){
-        const auto key = std::make_tuple(second, 0);
-        auto lb_it = std::lower_bound(it->second.cbegin(), it->second.cend(), key, Compare);
-        if((lb_it != it->second.cend()) && !Compare(key, *lb_it)){
-            return std::get<1>(*lb_it);
-        }
+    auto extension = filepath.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c){ return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+    if((extension == ".ttf") || (extension == ".otf") || (extension == ".ttc")){
+        cache = std::make_unique<GlyphCache>(filepath, options);
+        texture_size = cache->GetTextureSize();
+        base = cache->GetBase();
+        line_height = cache->GetLineHeight();
+        ascent = cache->GetAscent();
+        descent = cache->GetDescent();
+        ClearGlyphTable();
+    }
+    else{
+        Create(filepath);
     }
-    return 0;
 }
 
-void Font::Impl::Create(const std::filesystem::path& filepath)
+Font::Impl::~Impl()
 {
-    std::ifstream ifs(filepath.string(), std::ios::in | std::ios::binary);
-    if(ifs.fail()){
-        throw std::runtime_error("Failed to open file `" + filepath.string() + "`.");
-    }
+    if(glIsTexture(texture))
+        glDeleteTextures(1, &texture);
+}
 
-    std::string field;
+const Glyph& Font::Impl::GetGlyph(std::uint32_t code) const
+{
+    if(code > max_code)
+        return glyphs.front();
+    const auto& glyph = glyphs[glyph_indices[glyph_pages[code / page_size] + code % page_size]];
+    if(cache){
+        if(!glyph.IsValid())
+            cache->Request(code);
+        else if(glyph.HasPixels())
+            cache->Touch(glyph.GetPage());
+    }
+    return glyph;
+}
 
-    // <info>
-    field = FntParser::ReadLine(ifs, FntParser::INFO_TAG);
-    //auto info = FntParser::ParseInfo(field);
+void Font::Impl::TouchPages(const std::vector<std::uint16_t>& pages) const
+{
+    if(!cache)
+        return;
+    for(auto page : pages)
+        cache->Touch(page);
+}
 
-    // <common>
-    field = FntParser::ReadLine(ifs, FntParser::COMMON_TAG);
-    const auto common = FntParser::ParseCommon(field);
+std::int16_t Font::Impl::GetKerningAmount(std::uint32_t first, std::uint32_t second) const
+{
+    if(cache)
+        return cache->GetKerningAmount(first, second);
+    if(kerning_slots.empty() || (first > max_code) || (second > max_code))
+        return 0;
 
-    // <page>
-    const auto parent_path = filepath.parent_path();
-    const auto num_pages = static_cast<int>(std::get<FntParser::as_integer(FntParser::CommonElement::Pages)>(common));
-    std::vector<std::filesystem::path> filepaths;
-    for(auto i = 0; i < num_pages; i++){
-        field = FntParser::ReadLine(ifs, FntParser::PAGE_TAG);
-        const auto page = FntParser::ParsePage(field);
-        filepaths.emplace_back(parent_path / std::get<FntParser::as_integer(FntParser::PageElement::File)>(page));
+    const auto key = PackKerningKey(first, second);
+    const auto mask = kerning_slots.size() - 1;
+    for(auto i = HashKerningKey(key, kerning_shift); ; i = (i + 1) & mask){
+        const auto slot = kerning_slots[i];
+        if(slot == empty_slot)
+            return 0;
+        if((slot >> 16) == key)
+            return static_cast<std::int16_t>(static_cast<std::uint16_t>(slot & 0xFFFF));
     }
+}
 
-    // <chars>
-    field = FntParser::ReadLine(ifs, FntParser::CHARS_TAG);
-    const auto num_chars = FntParser::ParseChars(field);
-    assert(num_chars > 0);
-    GlyphMap glyph;
-    glyph.reserve(num_chars);
-
-    // <char>
-    for(std::uint32_t i = 0; i < num_chars; i++){
-        field = FntParser::ReadLine(ifs, FntParser::CHAR_TAG);
-        const auto c = FntParser::ParseChar(field);
-        glyph.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(std::get<FntParser::as_integer(FntParser::CharElement::Id)>(c)),
-            std::forward_as_tuple(
+void Font::Impl::CreateGlyphTable(const std::vector<FntParser::Char>& chars)
+{
+    ClearGlyphTable();
+    glyphs.reserve(chars.size() + 1);
+    for(const auto& c : chars){
+        const auto code = std::get<FntParser::as_integer(FntParser::CharElement::Id)>(c);
+        if((code > max_code) || GetGlyph(code).IsValid())
+            continue;   // Keep the first definition.
+
+        InsertGlyph(
+            code,
+            Glyph(
                 std::forward_as_tuple(
                     std::get<FntParser::as_integer(FntParser::CharElement::X)>(c),
                     std::get<FntParser::as_integer(FntParser::CharElement::Y)>(c)
@@ -224,39 +290,130 @@ void Font::Impl::Create(const std::filesystem::path& filepath)
             )
         );
     }
-    assert(num_chars == glyph.size());
-
-    // <kernings>
-    field = FntParser::ReadLine(ifs, FntParser::KERNINGS_TAG);
-    const auto num_kernings = FntParser::ParseKernings(field);
-
-    // <kerning>
-    KerningPairMap kerning_pair;
-    for(std::uint32_t i = 0; i < num_kernings; i++){
-        field = FntParser::ReadLine(ifs, FntParser::KERNING_TAG);
-        const auto kerning = FntParser::ParseKerning(field);
-        //
-        auto it = kerning_pair.find(std::get<FntParser::as_integer(FntParser::KerningElement::First)>(kerning));
-        if(it == kerning_pair.cend()){
-            it = kerning_pair.insert(
-                std::make_pair(
-                    std::get<FntParser::as_integer(FntParser::KerningElement::First)>(kerning),
-                    std::vector<std::tuple<std::uint32_t, std::int16_t>>()
-                )
-            ).first;
+
+    // The cell of the atlas.
+    const auto base_line = static_cast<std::int32_t>(base);
+    std::int32_t lowest = 0;
+    for(auto it = std::next(glyphs.cbegin()); it != glyphs.cend(); ++it){
+        const auto temp = base_line - std::get<1>(it->GetOffset());
+        ascent = std::max(ascent, temp);
+        lowest = std::min(lowest, temp - std::get<1>(it->GetSize()));
+    }
+    descent = std::abs(lowest);
+}
+
+void Font::Impl::ClearGlyphTable()
+{
+    glyphs.assign(1, Glyph());
+    glyph_pages.assign((max_code + 1) / page_size, 0);
+    glyph_indices.assign(page_size, 0);
+    free_glyphs.clear();
+}
+
+void Font::Impl::InsertGlyph(std::uint32_t code, const Glyph& glyph)
+{
+    auto& page = glyph_pages[code / page_size];
+    if(page == 0){
+        page = static_cast<std::uint32_t>(glyph_indices.size());
+        glyph_indices.resize(glyph_indices.size() + page_size, 0);
+    }
+    auto& index = glyph_indices[page + code % page_size];
+    if(index == 0){
+        if(free_glyphs.empty()){
+            index = static_cast<std::uint32_t>(glyphs.size());
+            glyphs.emplace_back();
+        }
+        else{
+            index = free_glyphs.back();
+            free_glyphs.pop_back();
+        }
+    }
+    glyphs[index] = glyph;
+}
+
+void Font::Impl::EraseGlyph(std::uint32_t code)
+{
+    auto& index = glyph_indices[glyph_pages[code / page_size] + code % page_size];
+    if(index == 0)
+        return;
+    glyphs[index] = Glyph();
+    free_glyphs.push_back(index);
+    index = 0;
+}
+
+void Font::Impl::Update()
+{
+    if(!cache)
+        return;
+
+    std::vector<std::pair<std::uint32_t, Glyph>> added;
+    std::vector<std::uint32_t> removed;
+    if(!cache->Update(added, removed))
+        return;
+
+    for(auto code : removed)
+        EraseGlyph(code);
+    for(const auto& pair : added)
+        InsertGlyph(pair.first, pair.second);
+    generation++;
+}
+
+void Font::Impl::CreateKerningTable(const std::vector<FntParser::Kerning>& kernings)
+{
+    kerning_slots.clear();
+    kerning_shift = 64;
+    if(kernings.empty())
+        return;
+
+    // Keep the load factor at or below 0.5 so that probe sequences stay short.
+    std::size_t capacity = 2;
+    unsigned int bits = 1;
+    while(capacity < kernings.size() * 2){
+        capacity <<= 1;
+        bits++;
+    }
+    kerning_slots.assign(capacity, empty_slot);
+    kerning_shift = 64 - bits;
+
+    const auto mask = capacity - 1;
+    for(const auto& kerning : kernings){
+        const auto first = std::get<FntParser::as_integer(FntParser::KerningElement::First)>(kerning);
+        const auto second = std::get<FntParser::as_integer(FntParser::KerningElement::Second)>(kerning);
+        const auto amount = std::get<FntParser::as_integer(FntParser::KerningElement::Amount)>(kerning);
+        if((first > max_code) || (second > max_code))
+            continue;
+
+        const auto key = PackKerningKey(first, second);
+        for(auto i = HashKerningKey(key, kerning_shift); ; i = (i + 1) & mask){
+            auto& slot = kerning_slots[i];
+            if(slot == empty_slot){
+                slot = (key << 16) | static_cast<std::uint16_t>(amount);
+                break;
+            }
+            if((slot >> 16) == key)
+                break;  // Keep the first definition.
         }
-        it->second.emplace_back(
-            std::make_tuple(
-                std::get<FntParser::as_integer(FntParser::KerningElement::Second)>(kerning),
-                std::get<FntParser::as_integer(FntParser::KerningElement::Amount)>(kerning)
-            )
-        );
     }
+}
 
-    // eof
-    std::getline(ifs, field);
-    if(!ifs.eof()){
-        throw std::runtime_error("");
+void Font::Impl::Create(const std::filesystem::path& filepath)
+{
+    FntParser::Data data;
+    if(!FntParser::Parse(filepath, data)){
+        throw std::runtime_error("Failed to parse file `" + filepath.string() + "`.");
+    }
+    const auto& common = data.common;
+
+    // <page>
+    const auto parent_path = filepath.parent_path();
+    const auto num_pages = static_cast<std::size_t>(std::get<FntParser::as_integer(FntParser::CommonElement::Pages)>(common));
+    std::vector<std::filesystem::path> filepaths(num_pages);
+    for(const auto& page : data.pages){
+        const auto id = static_cast<std::size_t>(std::get<FntParser::as_integer(FntParser::PageElement::Id)>(page));
+        if(id >= num_pages){
+            throw std::runtime_error("Invalid page id.");
+        }
+        filepaths[id] = parent_path / std::get<FntParser::as_integer(FntParser::PageElement::File)>(page);
     }
 
     // Setup
@@ -270,17 +427,10 @@ void Font::Impl::Create(const std::filesystem::path& filepath)
     texture_size = std::make_tuple(scale_w, scale_h);
     this->base = std::get<FntParser::as_integer(FntParser::CommonElement::Base)>(common);
     line_height = std::get<FntParser::as_integer(FntParser::CommonElement::LineHeight)>(common);
-    this->glyph = std::move(glyph);
-    // for binary search.
-    for(auto& pair : kerning_pair){
-        std::sort(pair.second.begin(), pair.second.end(), Compare);
-    }
-    this->kerning_pair = std::move(kerning_pair);
-}
 
-bool Font::Impl::Compare(const KerningAmount& lhs, const KerningAmount& rhs)
-{
-    return std::get<0>(lhs) < std::get<0>(rhs);
+    // <char>, <kerning>
+    CreateGlyphTable(data.chars);
+    CreateKerningTable(data.kernings);
 }
 
 // Font
@@ -290,6 +440,11 @@ Font::Font(const std::filesystem::path& filepath)
 {
 }
 
+Font::Font(const std::filesystem::path& filepath, const GlyphCacheOptions& options)
+    : pimpl(std::make_shared<Impl>(filepath, options)), metrics(std::make_unique<FontMetrics>(*this))
+{
+}
+
 Font::~Font() = default;
 
 GLuint Font::GetTexture() const
@@ -302,12 +457,17 @@ Font::Size Font::GetTextureSize() const
     return pimpl->GetTextureSize();;
 }
 
+DistanceFieldType Font::GetDistanceFieldType() const
+{
+    return pimpl->GetDistanceFieldType();
+}
+
 std::uint16_t Font::GetBase() const
 {
     return pimpl->GetBase();
 }
 
-Glyph Font::GetGlyph(std::uint32_t code) const
+const Glyph& Font::GetGlyph(std::uint32_t code) const
 {
     return pimpl->GetGlyph(code);
 }
@@ -322,6 +482,21 @@ FontMetrics Font::GetFontMetrics() const
     return *metrics.get();
 }
 
+void Font::TouchPages(const std::vector<std::uint16_t>& pages) const
+{
+    pimpl->TouchPages(pages);
+}
+
+void Font::Update()
+{
+    pimpl->Update();
+}
+
+std::uint64_t Font::GetGeneration() const
+{
+    return pimpl->GetGeneration();
+}
+
 // FontMetrics
 
 FontMetrics::FontMetrics(const Font& font)
@@ -331,19 +506,9 @@ FontMetrics::FontMetrics(const Font& font)
     if(!sp)
         throw std::runtime_error("Failed to construct `FontMetrics`.");
 
-    const auto base = static_cast<std::int32_t>(sp->GetBase());
     const auto line_h = static_cast<std::int32_t>(sp->GetLineHeight());
-    std::int32_t ascent = 0;
-    std::int32_t descent = 0;
-    for(const auto& pair : sp->GetGlyphMap()){
-        //auto key = pair.first;
-        const auto& glyph = pair.second;
-        const auto temp = base - std::get<1>(glyph.GetOffset());
-        ascent = std::max(ascent, temp);
-        descent = std::min(descent, temp - std::get<1>(glyph.GetSize()));
-    }
-    this->ascent = ascent;
-    this->descent = std::abs(descent);
+    ascent = sp->GetAscent();
+    descent = sp->GetDescent();
     const auto cell_height = this->ascent + this->descent;
     line_height = (line_h < cell_height) ? cell_height : line_h;
     line_gap = line_height - cell_height;
@@ -369,7 +534,7 @@ std::int32_t FontMetrics::GetLineHeight() const
     return line_height;
 }
 
-std::int32_t FontMetrics::MeasureWidth(const std::u16string& string) const
+std::int32_t FontMetrics::MeasureWidth(std::u32string_view string) const
 {
     auto sp = font_impl.lock();
     if(!sp)
@@ -377,9 +542,9 @@ std::int32_t FontMetrics::MeasureWidth(const std::u16string& string) const
 
     std::int32_t width = 0;
     std::int32_t adjust = 0;
-    char16_t prev_code = 0;
+    char32_t prev_code = 0;
     for(auto code : string){
-        auto glyph = sp->GetGlyph(code);
+        const auto& glyph = sp->GetGlyph(code);
         if(!glyph.IsValid())
             continue;
 
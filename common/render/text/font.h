@@ -8,8 +8,11 @@
 #include <cinttypes>
 #include <tuple>
 #include <filesystem>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 #include <GL/glew.h>
+#include "distance_field.h"
 
 namespace common::render::text
 {
@@ -53,9 +56,28 @@ private:
     std::uint16_t page;
 };
 
+/*!
+ * @struct GlyphCacheOptions
+ * @brief Parameters of the glyph atlas built at runtime from a TrueType font.
+ */
+struct GlyphCacheOptions
+{
+    float pixel_height = 48.0f;         // Rasterized height of the glyphs in texels.
+    float spread = 6.0f;                // Texels covered by the distance field on each side of the outline.
+    std::uint32_t page_size = 1024;
+    std::uint32_t num_of_pages = 2;
+    unsigned int num_of_threads = 0;    // 0 uses all but one hardware thread.
+    DistanceFieldType type = DistanceFieldType::SDF;
+};
+
+class FontMetrics;
+
 /*!
  * @class Font
  * @brief Generate bitmap fonts from TrueType fonts.
+ *
+ * A `.fnt` file loads a pre-baked atlas. A TrueType or OpenType file builds the atlas at runtime,
+ * glyphs then become available from the Update() after they were first looked up.
  */
 class Font final
 {
@@ -67,6 +89,7 @@ public:
 public:
     Font() = delete;
     explicit Font(const std::filesystem::path& filepath);
+    Font(const std::filesystem::path& filepath, const GlyphCacheOptions& options);
     ~Font();
 
     Font(const Font&) = delete;
@@ -76,10 +99,19 @@ public:
 
     GLuint GetTexture() const;
     Size GetTextureSize() const;
+    //! Pre-baked fonts are always SDF.
+    DistanceFieldType GetDistanceFieldType() const;
     std::uint16_t GetBase() const;
-    Glyph GetGlyph(std::uint32_t code) const;
+    const Glyph& GetGlyph(std::uint32_t code) const;
     std::int16_t GetKerningAmount(std::uint32_t first, std::uint32_t second) const;
     FontMetrics GetFontMetrics() const;
+    //! Keeps the glyph pages in use for the current frame, for glyphs drawn without being looked up again.
+    void TouchPages(const std::vector<std::uint16_t>& pages) const;
+
+    //! Applies the glyphs rasterized at runtime, must be called on the thread that owns the GL context.
+    void Update();
+    //! Incremented whenever a glyph is added or removed, cached layouts are stale once it changes.
+    std::uint64_t GetGeneration() const;
 
 private:
     class Impl;
@@ -107,7 +139,7 @@ public:
     std::int32_t GetDescent() const;
     std::int32_t GetLineGap() const;
     std::int32_t GetLineHeight() const;
-    std::int32_t MeasureWidth(const std::u16string& string) const;
+    std::int32_t MeasureWidth(std::u32string_view string) const;
 
 private:
     std::weak_ptr<Font::Impl> font_impl;
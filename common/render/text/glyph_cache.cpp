@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "../../logger.h"
+#include "../../system.h"
+#include "../texture_uploader.h"
+#include "glyph_cache.h"
+
+namespace common::render::text
+{
+
+GlyphCache::GlyphCache(const std::filesystem::path& filepath, const GlyphCacheOptions& options)
+    : options_(options), rasterizer_(filepath, options.pixel_height, options.spread), texture_(0), frame_(1), stop_(false)
+{
+    const auto page_size = static_cast<GLsizei>(options_.page_size);
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, (options_.type == DistanceFieldType::MSDF) ? GL_RGBA8 : GL_R8, page_size, page_size, static_cast<GLsizei>(options_.num_of_pages));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    const GLubyte zero = 0;
+    glClearTexImage(texture_, 0, GL_RED, GL_UNSIGNED_BYTE, &zero);
+
+    packers_.assign(options_.num_of_pages, SkylinePacker(options_.page_size, options_.page_size));
+    page_frames_.assign(options_.num_of_pages, 0);
+    page_glyphs_.resize(options_.num_of_pages);
+
+    const auto num_of_threads = (options_.num_of_threads > 0) ? options_.num_of_threads : std::max(2u, std::thread::hardware_concurrency()) - 1;
+    for(unsigned int i = 0; i < num_of_threads; i++)
+        workers_.emplace_back(&GlyphCache::Work, this);
+}
+
+GlyphCache::~GlyphCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for(auto& worker : workers_)
+        worker.join();
+
+    if(glIsTexture(texture_))
+        glDeleteTextures(1, &texture_);
+}
+
+GlyphCache::Size GlyphCache::GetTextureSize() const
+{
+    const auto size = static_cast<std::uint16_t>(options_.page_size);
+    return Size(size, size);
+}
+
+void GlyphCache::Request(std::uint32_t code)
+{
+    if(!known_.insert(code).second)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(code);
+    }
+    cv_.notify_one();
+}
+
+std::int16_t GlyphCache::GetKerningAmount(std::uint32_t first, std::uint32_t second)
+{
+    const auto key = (static_cast<std::uint64_t>(first) << 32) | second;
+    auto it = kerning_.find(key);
+    if(it == kerning_.cend())
+    {
+        if(kerning_.size() >= max_kerning_pairs)
+            kerning_.clear();
+        it = kerning_.emplace(key, rasterizer_.GetKerningAmount(first, second)).first;
+    }
+    return it->second;
+}
+
+bool GlyphCache::Update(std::vector<std::pair<std::uint32_t, Glyph>>& added, std::vector<std::uint32_t>& removed)
+{
+    added.clear();
+    removed.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(auto& result : results_)
+            deferred_.push_back(std::move(result));
+        results_.clear();
+    }
+
+    auto& uploader = System::GetMutableInstance().GetTextureUploader();
+    const auto page_size = options_.page_size;
+
+    std::size_t count = deferred_.size();
+    while(count-- > 0)
+    {
+        auto result = std::move(deferred_.front());
+        deferred_.pop_front();
+        if(!result.exists)
+            continue;   // Stays known so that it is never requested again.
+
+        std::uint16_t page = 0;
+        SkylinePacker::Rect rect;
+        if((result.width > 0) && (result.height > 0))
+        {
+            // One texel of padding keeps linear filtering from reaching the neighbours.
+            if((result.width + 1u > page_size) || (result.height + 1u > page_size))
+            {
+                LOG_W("Glyph does not fit in a page. [code=" << result.code << "]");
+                continue;
+            }
+            if(!Allocate(result.width + 1u, result.height + 1u, page, rect, removed))
+            {
+                // Every page is in use by this frame, try again later.
+                deferred_.push_back(std::move(result));
+                continue;
+            }
+
+            TextureUploader::Region region;
+            region.texture = texture_;
+            region.target = GL_TEXTURE_2D_ARRAY;
+            region.xoffset = static_cast<GLint>(rect.x);
+            region.yoffset = static_cast<GLint>(rect.y);
+            region.zoffset = page;
+            region.width = result.width;
+            region.height = result.height;
+            region.format = (options_.type == DistanceFieldType::MSDF) ? GL_RGB : GL_RED;
+            region.type = GL_UNSIGNED_BYTE;
+            region.unpack_alignment = 1;
+            uploader.Upload(region, result.texels.data(), static_cast<GLsizeiptr>(result.texels.size()));
+            page_glyphs_[page].push_back(result.code);
+            page_frames_[page] = frame_;
+        }
+
+        added.emplace_back(
+            result.code,
+            Glyph(
+                Glyph::UI16Duplet(static_cast<std::uint16_t>(rect.x), static_cast<std::uint16_t>(rect.y)),
+                Glyph::UI16Duplet(result.width, result.height),
+                Glyph::I16Duplet(result.xoffset, result.yoffset),
+                result.advance,
+                page
+            )
+        );
+    }
+    uploader.Flush();
+
+    frame_++;
+    return !added.empty() || !removed.empty();
+}
+
+void GlyphCache::Work()
+{
+    while(true)
+    {
+        std::uint32_t code;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this](){ return stop_ || !jobs_.empty(); });
+            if(stop_)
+                return;
+            code = jobs_.front();
+            jobs_.pop_front();
+        }
+
+        auto result = rasterizer_.Rasterize(code, options_.type);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.push_back(std::move(result));
+    }
+}
+
+bool GlyphCache::Allocate(std::uint32_t width, std::uint32_t height, std::uint16_t& page, SkylinePacker::Rect& rect, std::vector<std::uint32_t>& removed)
+{
+    for(std::size_t i = 0; i < packers_.size(); i++)
+    {
+        if(packers_[i].Allocate(width, height, rect))
+        {
+            page = static_cast<std::uint16_t>(i);
+            return true;
+        }
+    }
+
+    // Evict the least recently used page, unless the current frame is still drawing from it.
+    const auto it = std::min_element(page_frames_.cbegin(), page_frames_.cend());
+    if(*it >= frame_)
+        return false;
+
+    page = static_cast<std::uint16_t>(std::distance(page_frames_.cbegin(), it));
+    LOG_I("Evicting glyph cache page. [page=" << page << ", glyphs=" << page_glyphs_[page].size() << "]");
+    for(auto code : page_glyphs_[page])
+    {
+        known_.erase(code);
+        removed.push_back(code);
+    }
+
+    const std::unordered_set<std::uint32_t> evicted(page_glyphs_[page].cbegin(), page_glyphs_[page].cend());
+    for(auto pair = kerning_.begin(); pair != kerning_.end(); )
+    {
+        const auto first = static_cast<std::uint32_t>(pair->first >> 32);
+        const auto second = static_cast<std::uint32_t>(pair->first);
+        if((evicted.count(first) > 0) || (evicted.count(second) > 0))
+            pair = kerning_.erase(pair);
+        else
+            pair++;
+    }
+    page_glyphs_[page].clear();
+    packers_[page].Clear();
+
+    // Linear filtering reads the padding around each glyph, which must not keep texels of the evicted ones.
+    // No copy to this page is pending, as it has not been used by this frame.
+    const auto page_size = static_cast<GLsizei>(options_.page_size);
+    const GLubyte zero = 0;
+    glClearTexSubImage(texture_, 0, 0, 0, page, page_size, page_size, 1, GL_RED, GL_UNSIGNED_BYTE, &zero);
+
+    return packers_[page].Allocate(width, height, rect);
+}
+
+}   // namespace common::render::text
\ No newline at end of file
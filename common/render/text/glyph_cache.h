@@ -0,0 +1,93 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <GL/glew.h>
+#include "font.h"
+#include "glyph_rasterizer.h"
+#include "skyline_packer.h"
+
+namespace common::render::text
+{
+
+/*!
+ * @class GlyphCache
+ * @brief Rasterizes glyphs from a TrueType font on demand into distance field pages.
+ *
+ * Requested glyphs are rasterized and converted on a worker pool, Update() packs the finished ones into a
+ * GL_TEXTURE_2D_ARRAY(R8 for SDF, RGBA8 for MSDF) with a skyline allocator per page. When every page is full,
+ * the page that has not been used for the longest time is cleared and its glyphs are evicted.
+ */
+class GlyphCache final
+{
+public:
+    using Size = Font::Size;
+
+public:
+    GlyphCache(const std::filesystem::path& filepath, const GlyphCacheOptions& options);
+    ~GlyphCache();
+
+    GlyphCache(const GlyphCache&) = delete;
+    GlyphCache& operator = (const GlyphCache&) = delete;
+    GlyphCache(GlyphCache&&) = delete;
+    GlyphCache& operator = (GlyphCache&&) = delete;
+
+    GLuint GetTexture() const noexcept { return texture_; }
+    Size GetTextureSize() const;
+    DistanceFieldType GetDistanceFieldType() const noexcept { return options_.type; }
+    std::uint16_t GetBase() const noexcept { return rasterizer_.GetBase(); }
+    std::uint16_t GetLineHeight() const noexcept { return rasterizer_.GetLineHeight(); }
+    std::int32_t GetAscent() const noexcept { return rasterizer_.GetAscent(); }
+    std::int32_t GetDescent() const noexcept { return rasterizer_.GetDescent(); }
+
+    //! Queues the glyph for rasterization unless it is already known.
+    void Request(std::uint32_t code);
+    //! Marks the page as used by the current frame.
+    void Touch(std::uint16_t page) { page_frames_[page] = frame_; }
+    std::int16_t GetKerningAmount(std::uint32_t first, std::uint32_t second);
+
+    /*!
+     * Packs and uploads the glyphs finished since the last call. Must be called on the thread that owns the GL context.
+     * @param removed the glyphs evicted, to be dropped before `added` are inserted.
+     * @return true if any glyph was added or removed.
+     */
+    bool Update(std::vector<std::pair<std::uint32_t, Glyph>>& added, std::vector<std::uint32_t>& removed);
+
+private:
+    using Result = GlyphRasterizer::Bitmap;
+
+    // Kerning pairs are cached as they are laid out, the cache is dropped rather than grown past this.
+    static constexpr std::size_t max_kerning_pairs = 1 << 16;
+
+    void Work();
+    bool Allocate(std::uint32_t width, std::uint32_t height, std::uint16_t& page, SkylinePacker::Rect& rect, std::vector<std::uint32_t>& removed);
+
+private:
+    GlyphCacheOptions options_;
+    GlyphRasterizer rasterizer_;
+
+    GLuint texture_;
+    std::vector<SkylinePacker> packers_;
+    std::vector<std::uint64_t> page_frames_;
+    std::vector<std::vector<std::uint32_t>> page_glyphs_;
+    std::uint64_t frame_;
+
+    std::unordered_set<std::uint32_t> known_;
+    std::unordered_map<std::uint64_t, std::int16_t> kerning_;   // Evicted along with the glyphs of a page.
+    std::deque<Result> deferred_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::uint32_t> jobs_;
+    std::vector<Result> results_;
+    bool stop_;
+    std::vector<std::thread> workers_;
+};
+
+}   // namespace common::render::text
\ No newline at end of file
@@ -0,0 +1,160 @@
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#include <stb_truetype.h>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "../../logger.h"
+#include "glyph_rasterizer.h"
+
+namespace
+{
+
+using Shape = common::render::text::Shape;
+
+// Converts the outline from font units(y up) into the bitmap space of the glyph.
+void build_shape(const stbtt_vertex* vertices, int num_of_vertices, float scale, float x, float y, Shape& shape)
+{
+    auto& contours = shape.GetContours();
+    contours.clear();
+
+    float px = 0.0f;
+    float py = 0.0f;
+    for(int i = 0; i < num_of_vertices; i++)
+    {
+        const auto& v = vertices[i];
+        const auto vx = static_cast<float>(v.x) * scale - x;
+        const auto vy = -static_cast<float>(v.y) * scale - y;
+        if(v.type == STBTT_vmove)
+        {
+            contours.emplace_back();
+            px = vx;
+            py = vy;
+            continue;
+        }
+        if(contours.empty() || ((v.type == STBTT_vline) && (vx == px) && (vy == py)))
+            continue;
+
+        Shape::Edge edge{};
+        edge.x[0] = px;
+        edge.y[0] = py;
+        if(v.type == STBTT_vline)
+        {
+            edge.degree = 1;
+        }
+        else if(v.type == STBTT_vcurve)
+        {
+            edge.degree = 2;
+            edge.x[1] = static_cast<float>(v.cx) * scale - x;
+            edge.y[1] = -static_cast<float>(v.cy) * scale - y;
+        }
+        else
+        {
+            edge.degree = 3;
+            edge.x[1] = static_cast<float>(v.cx) * scale - x;
+            edge.y[1] = -static_cast<float>(v.cy) * scale - y;
+            edge.x[2] = static_cast<float>(v.cx1) * scale - x;
+            edge.y[2] = -static_cast<float>(v.cy1) * scale - y;
+        }
+        edge.x[edge.degree] = vx;
+        edge.y[edge.degree] = vy;
+        contours.back().push_back(edge);
+        px = vx;
+        py = vy;
+    }
+}
+
+}
+
+namespace common::render::text
+{
+
+GlyphRasterizer::GlyphRasterizer(const std::filesystem::path& filepath, float pixel_height, float spread)
+    : info_(std::make_unique<stbtt_fontinfo>()), pixel_height_(pixel_height), spread_(spread)
+{
+    if(!file_.Open(filepath))
+        throw std::runtime_error("Failed to open file `" + filepath.string() + "`.");
+
+    const auto data = file_.GetData();
+    const auto offset = stbtt_GetFontOffsetForIndex(data, 0);
+    if((offset < 0) || !stbtt_InitFont(info_.get(), data, offset))
+    {
+        LOG_E("Failed to parse font `" << filepath.string() << "`.");
+        throw std::runtime_error("");
+    }
+
+    int ascent, descent, line_gap;
+    stbtt_GetFontVMetrics(info_.get(), &ascent, &descent, &line_gap);
+    scale_ = stbtt_ScaleForPixelHeight(info_.get(), pixel_height_);
+    ascent_ = static_cast<std::int32_t>(std::ceil(static_cast<float>(ascent) * scale_));
+    descent_ = static_cast<std::int32_t>(std::ceil(static_cast<float>(-descent) * scale_));
+    base_ = static_cast<std::uint16_t>(ascent_);
+    line_height_ = static_cast<std::uint16_t>(ascent_ + descent_ + static_cast<std::int32_t>(std::round(static_cast<float>(line_gap) * scale_)));
+}
+
+GlyphRasterizer::~GlyphRasterizer() = default;
+
+std::int16_t GlyphRasterizer::GetKerningAmount(std::uint32_t first, std::uint32_t second) const
+{
+    const auto amount = stbtt_GetCodepointKernAdvance(info_.get(), static_cast<int>(first), static_cast<int>(second));
+    return static_cast<std::int16_t>(std::lround(static_cast<float>(amount) * scale_));
+}
+
+GlyphRasterizer::Bitmap GlyphRasterizer::Rasterize(std::uint32_t code, DistanceFieldType type, Shape* shape) const
+{
+    Bitmap bitmap{ code, false, 0, 0, 0, 0, 0, {} };
+
+    const auto index = stbtt_FindGlyphIndex(info_.get(), static_cast<int>(code));
+    if(index == 0)
+        return bitmap;
+
+    int advance, lsb;
+    stbtt_GetGlyphHMetrics(info_.get(), index, &advance, &lsb);
+    bitmap.exists = true;
+    bitmap.advance = static_cast<std::int16_t>(std::lround(static_cast<float>(advance) * scale_));
+
+    int x0, y0, x1, y1;
+    stbtt_GetGlyphBitmapBox(info_.get(), index, scale_, scale_, &x0, &y0, &x1, &y1);
+    if((x1 <= x0) || (y1 <= y0))
+        return bitmap;
+
+    // The field extends `spread` texels beyond the outline on every side.
+    const auto pad = static_cast<int>(std::ceil(spread_));
+    const auto width = x1 - x0 + pad * 2;
+    const auto height = y1 - y0 + pad * 2;
+    const auto size = static_cast<std::size_t>(width * height);
+
+    Shape local;
+    if((type == DistanceFieldType::MSDF) || (shape != nullptr))
+    {
+        auto& target = (shape != nullptr) ? *shape : local;
+        stbtt_vertex* vertices = nullptr;
+        const auto num_of_vertices = stbtt_GetGlyphShape(info_.get(), index, &vertices);
+        build_shape(vertices, num_of_vertices, scale_, static_cast<float>(x0 - pad), static_cast<float>(y0 - pad), target);
+        stbtt_FreeShape(info_.get(), vertices);
+        target.ColorEdges();
+        target.Flatten();
+    }
+
+    if(type == DistanceFieldType::MSDF)
+    {
+        bitmap.texels.resize(size * 3);
+        GenerateMultiChannelDistanceField((shape != nullptr) ? *shape : local, static_cast<std::size_t>(width), static_cast<std::size_t>(height), spread_, bitmap.texels.data());
+    }
+    else
+    {
+        std::vector<std::uint8_t> coverage(size, 0);
+        stbtt_MakeGlyphBitmap(info_.get(), &coverage[static_cast<std::size_t>(pad * width + pad)], x1 - x0, y1 - y0, width, scale_, scale_, index);
+
+        bitmap.texels.resize(size);
+        GenerateSignedDistanceField(coverage.data(), static_cast<std::size_t>(width), static_cast<std::size_t>(height), spread_, bitmap.texels.data());
+    }
+
+    bitmap.width = static_cast<std::uint16_t>(width);
+    bitmap.height = static_cast<std::uint16_t>(height);
+    bitmap.xoffset = static_cast<std::int16_t>(x0 - pad);
+    bitmap.yoffset = static_cast<std::int16_t>(base_ + y0 - pad);
+    return bitmap;
+}
+
+}   // namespace common::render::text
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include "../../memory_mapped_file.h"
+#include "distance_field.h"
+
+struct stbtt_fontinfo;
+
+namespace common::render::text
+{
+
+/*!
+ * @class GlyphRasterizer
+ * @brief Converts the glyphs of a TrueType font into distance field bitmaps.
+ *
+ * Does not touch GL and Rasterize() only reads the font, so any number of threads may share an instance.
+ */
+class GlyphRasterizer final
+{
+public:
+    struct Bitmap
+    {
+        std::uint32_t code;
+        bool exists;
+        std::uint16_t width;
+        std::uint16_t height;
+        std::int16_t xoffset;
+        std::int16_t yoffset;
+        std::int16_t advance;
+        std::vector<std::uint8_t> texels;   // 1 channel for SDF, 3 for MSDF.
+    };
+
+public:
+    GlyphRasterizer(const std::filesystem::path& filepath, float pixel_height, float spread);
+    ~GlyphRasterizer();
+
+    GlyphRasterizer(const GlyphRasterizer&) = delete;
+    GlyphRasterizer& operator = (const GlyphRasterizer&) = delete;
+    GlyphRasterizer(GlyphRasterizer&&) = delete;
+    GlyphRasterizer& operator = (GlyphRasterizer&&) = delete;
+
+    float GetPixelHeight() const noexcept { return pixel_height_; }
+    float GetSpread() const noexcept { return spread_; }
+    std::uint16_t GetBase() const noexcept { return base_; }
+    std::uint16_t GetLineHeight() const noexcept { return line_height_; }
+    std::int32_t GetAscent() const noexcept { return ascent_; }
+    std::int32_t GetDescent() const noexcept { return descent_; }
+
+    std::int16_t GetKerningAmount(std::uint32_t first, std::uint32_t second) const;
+
+    /*!
+     * Rasterizes the glyph into a distance field with `spread` texels of padding on every side.
+     * @param shape receives the colored and flattened outline in bitmap space if not null.
+     */
+    Bitmap Rasterize(std::uint32_t code, DistanceFieldType type, Shape* shape = nullptr) const;
+
+private:
+    MemoryMappedFile file_;
+    std::unique_ptr<stbtt_fontinfo> info_;
+    float pixel_height_;
+    float spread_;
+    float scale_;
+    std::uint16_t base_;
+    std::uint16_t line_height_;
+    std::int32_t ascent_;
+    std::int32_t descent_;
+};
+
+}   // namespace common::render::text
\ No newline at end of file
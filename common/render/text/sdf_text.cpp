@@ -1,23 +1,33 @@
-﻿#include <array>
+﻿#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include "../../logger.h"
 #include "sdf_text.h"
 
 namespace common::render::text
 {
 
+// One instance per glyph, the quad corners are derived from gl_VertexID.
 static const std::string vs_source =
 "#version 430\n"
-"layout(location = 0) in vec2 vsPosition;\n"
-"layout(location = 1) in vec3 vsTexCoord;\n"
+"layout(location = 0) in vec4 vsBounds;\n"
+"layout(location = 1) in vec4 vsTexCoordBounds;\n"
+"layout(location = 2) in vec4 vsColor;\n"
+"layout(location = 3) in float vsLayer;\n"
 "out gl_PerVertex\n"
 "{\n"
     "vec4 gl_Position;\n"
 "};\n"
 "out vec3 fsTexCoord;\n"
+"out vec4 fsColor;\n"
 "uniform mat4 mvp;\n"
+"uniform vec2 offset = vec2(0.0, 0.0);\n"
 "void main(void)\n"
 "{\n"
-    "gl_Position = mvp * vec4(vsPosition.xy, 0.0, 1.0);\n"
-    "fsTexCoord = vsTexCoord.xyz;\n"
+    "vec2 corner = vec2(gl_VertexID >> 1, gl_VertexID & 1);\n"
+    "gl_Position = mvp * vec4(mix(vsBounds.xy, vsBounds.zw, corner) + offset, 0.0, 1.0);\n"
+    "fsTexCoord = vec3(mix(vsTexCoordBounds.xy, vsTexCoordBounds.zw, corner), vsLayer);\n"
+    "fsColor = vsColor;\n"
 "}\n";
 
 #if 0
@@ -27,22 +37,28 @@ static const std::string fs_source =
 "#version 430\n"
 "#extension GL_EXT_texture_array : enable\n"
 "in vec3 fsTexCoord;\n"
+"in vec4 fsColor;\n"
 "out vec4 outColor;\n"
 "uniform sampler2DArray texture;\n"
-"uniform vec4 color = vec4(1.0, 1.0, 1.0, 1.0);\n"
+"uniform int multi_channel = 0;\n"
 "uniform float smoothness = 0.5;\n"
 "const float SMOOTHING_BASE = 0.5;\n"
+"float median(vec3 v)\n"
+"{\n"
+    "return max(min(v.r, v.g), min(max(v.r, v.g), v.b));\n"
+"}\n"
 "void main(void)\n"
 "{\n"
-    "float distance = texture2DArray(texture, fsTexCoord.xyz).r;\n"
+    "vec4 texel = texture2DArray(texture, fsTexCoord.xyz);\n"
+    "float distance = (multi_channel != 0)? median(texel.rgb) : texel.r;\n"
     "if(smoothness > 0.0){\n"
         "float value = clamp(smoothness * SMOOTHING_BASE, 0.0, SMOOTHING_BASE);\n"
-        "outColor.a = color.a * smoothstep(SMOOTHING_BASE - value, SMOOTHING_BASE + value, distance);\n"
+        "outColor.a = fsColor.a * smoothstep(SMOOTHING_BASE - value, SMOOTHING_BASE + value, distance);\n"
     "}\n"
     "else{\n"
         "outColor.a = (distance < SMOOTHING_BASE)? 0.0 : (distance > SMOOTHING_BASE)? 1.0 : 0.5;\n"
     "}\n"
-    "outColor.rgb = color.rgb;\n"
+    "outColor.rgb = fsColor.rgb;\n"
 "}\n";
 #else
 // Distance field rendering with outline.
@@ -51,24 +67,30 @@ static const std::string fs_source =
 "#version 430\n"
 "#extension GL_EXT_texture_array : enable\n"
 "in vec3 fsTexCoord;\n"
+"in vec4 fsColor;\n"
 "out vec4 outColor;\n"
 "uniform sampler2DArray texture;\n"
-"uniform vec4 color = vec4(1.0, 1.0, 1.0, 1.0);\n"
+"uniform int multi_channel = 0;\n"
 "uniform float smoothness = 0.5;\n"
 "const float SMOOTHING_BASE = 0.3;\n"
 "uniform vec4 outline_color = vec4(0.0, 0.0, 0.0, 1.0);\n"
 "const float OUTLINE_MIN = 0.25;\n"
 "const float OUTLINE_MAX = 0.50;\n"
+"float median(vec3 v)\n"
+"{\n"
+    "return max(min(v.r, v.g), min(max(v.r, v.g), v.b));\n"
+"}\n"
 "void main(void)\n"
 "{\n"
-    "vec4 baseColor = color;\n"
-    "float distance = texture2DArray(texture, fsTexCoord.xyz).r;\n"
+    "vec4 baseColor = fsColor;\n"
+    "vec4 texel = texture2DArray(texture, fsTexCoord.xyz);\n"
+    "float distance = (multi_channel != 0)? median(texel.rgb) : texel.r;\n"
     "if(distance <= OUTLINE_MIN){\n"
         "baseColor = outline_color;\n"
     "}\n"
     "else if(distance < OUTLINE_MAX){\n"
         "float factor = smoothstep(OUTLINE_MIN, OUTLINE_MAX, distance);\n"
-        "baseColor = mix(outline_color, color, factor);\n"
+        "baseColor = mix(outline_color, fsColor, factor);\n"
     "}\n"
     "if(smoothness > 0.0){\n"
         "float value = clamp(smoothness * SMOOTHING_BASE, 0.0, SMOOTHING_BASE);\n"
@@ -84,24 +106,33 @@ static const std::string fs_source =
 // SDFTextRenderer
 
 SDFTextRenderer::SDFTextRenderer()
+    : vao(0), sampler(0), segment(0), head(0), tail(0), current_color{{255, 255, 255, 255}}
 {
-    vertices.reserve(max_vertices);
-    indices.reserve(max_indices);
-
+    try
+    {
+        for(std::size_t i = 0; i < initial_num_of_segments; i++)
+            segments.push_back(CreateSegment());
+    }
+    catch(...)
+    {
+        for(auto& s : segments)
+            DeleteSegment(s);
+        throw;
+    }
+
+    // The vertex buffer is bound per draw, as each segment has its own.
     glGenVertexArrays(1, &vao);
     glBindVertexArray(vao);
-
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * max_vertices, nullptr, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const GLvoid*>(offsetof(Vertex, s)));
-    glEnableVertexAttribArray(1);
-
-    glGenBuffers(1, &ibo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * max_indices, nullptr, GL_DYNAMIC_DRAW);
+    glVertexBindingDivisor(0, 1);
+    glVertexAttribFormat(0, 4, GL_FLOAT, GL_FALSE, offsetof(GlyphInstance, bounds));
+    glVertexAttribFormat(1, 4, GL_FLOAT, GL_FALSE, offsetof(GlyphInstance, texcoord_bounds));
+    glVertexAttribFormat(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(GlyphInstance, color));
+    glVertexAttribFormat(3, 1, GL_FLOAT, GL_FALSE, offsetof(GlyphInstance, layer));
+    for(GLuint i = 0; i < 4; i++)
+    {
+        glVertexAttribBinding(i, 0);
+        glEnableVertexAttribArray(i);
+    }
 
     glBindVertexArray(0);
 
@@ -130,22 +161,21 @@ SDFTextRenderer::SDFTextRenderer()
 
 SDFTextRenderer::~SDFTextRenderer()
 {
+    for(auto& s : segments)
+        DeleteSegment(s);
     if(glIsSampler(sampler))
         glDeleteSamplers(1, &sampler);
-    if(glIsBuffer(ibo))
-        glDeleteBuffers(1, &ibo);
-    if(glIsBuffer(vbo))
-        glDeleteBuffers(1, &vbo);
     if(glIsVertexArray(vao))
         glDeleteVertexArrays(1, &vao);
 }
 
-void SDFTextRenderer::BeginRendering(GLuint texture)
+void SDFTextRenderer::BeginRendering(GLuint texture, DistanceFieldType type)
 {
     glDisable(GL_DEPTH_TEST);
     glDepthMask(GL_FALSE);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    pipeline->GetPipelineUniform().Set("multi_channel", (type == DistanceFieldType::MSDF) ? 1 : 0);
     pipeline->Bind();
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
@@ -154,6 +184,9 @@ void SDFTextRenderer::BeginRendering(GLuint texture)
 
 void SDFTextRenderer::EndRendering()
 {
+    Render();
+    NextSegment();
+
     glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
     glActiveTexture(GL_TEXTURE0);
     pipeline->Unbind();
@@ -164,71 +197,134 @@ void SDFTextRenderer::EndRendering()
 
 void SDFTextRenderer::Render()
 {
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * vertices.size(), vertices.data());
+    if(head == tail)
+        return;
+
+    glBindVertexArray(vao);
+    glBindVertexBuffer(0, segments[segment].vbo, 0, sizeof(GlyphInstance));
+    glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(head - tail), static_cast<GLuint>(tail));
+    glBindVertexArray(0);
+    tail = head;
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(std::uint32_t) * indices.size(), indices.data());
+void SDFTextRenderer::RenderInstances(GLuint buffer, std::size_t count, GLfloat x, GLfloat y)
+{
+    Render();
 
+    auto& uniform = pipeline->GetPipelineUniform();
+    uniform.Set("offset", glm::vec2(x, y));
     glBindVertexArray(vao);
-    glDrawElements(GL_TRIANGLE_STRIP, indices.size(), GL_UNSIGNED_INT, nullptr);
+    glBindVertexBuffer(0, buffer, 0, sizeof(GlyphInstance));
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count));
     glBindVertexArray(0);
+    uniform.Set("offset", glm::vec2(0.0f, 0.0f));
+}
+
+void SDFTextRenderer::NextSegment()
+{
+    if(head == 0)
+        return;
+
+    segments[segment].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    head = tail = 0;
+
+    // The next segment is the oldest one. It is only polled, so the GL thread never waits for the GPU.
+    const auto next = (segment + 1) % segments.size();
+    auto& fence = segments[next].fence;
+    if((fence != nullptr) && (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED))
+    {
+        // Still being read, a new segment goes in front of it.
+        segments.insert(segments.begin() + static_cast<std::ptrdiff_t>(segment + 1), CreateSegment());
+        segment++;
+        LOG_D("The glyph instance ring has grown to " << segments.size() << " segments.");
+        return;
+    }
+    if(fence != nullptr)
+    {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    segment = next;
+}
+
+SDFTextRenderer::Segment SDFTextRenderer::CreateSegment()
+{
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    constexpr auto size = static_cast<GLsizeiptr>(sizeof(GlyphInstance) * max_buffer_length);
+
+    Segment s{ 0, nullptr, nullptr };
+    glCreateBuffers(1, &s.vbo);
+    glNamedBufferStorage(s.vbo, size, nullptr, flags);
+    s.instances = static_cast<GlyphInstance*>(glMapNamedBufferRange(s.vbo, 0, size, flags));
+    if(s.instances == nullptr)
+    {
+        glDeleteBuffers(1, &s.vbo);
+        throw std::runtime_error("Failed to map the glyph instance buffer.");
+    }
+    return s;
+}
+
+void SDFTextRenderer::DeleteSegment(Segment& s)
+{
+    if(s.fence != nullptr)
+        glDeleteSync(s.fence);
+    if(glIsBuffer(s.vbo))
+    {
+        glUnmapNamedBuffer(s.vbo);
+        glDeleteBuffers(1, &s.vbo);
+    }
+    s = Segment{ 0, nullptr, nullptr };
 }
 
 void SDFTextRenderer::SetOrthographicProjectionMatrix(const GLfloat* m)
 {
+    Render();
     auto mat = glm::make_mat4(m);
     pipeline->GetPipelineUniform().Set("mvp", &mat, 1, false);
 }
 
 void SDFTextRenderer::SetColor(const GLfloat* color)
 {
-    pipeline->GetPipelineUniform().Set("color", glm::make_vec4(color));
+    for(std::size_t i = 0; i < current_color.size(); i++)
+        current_color[i] = static_cast<GLubyte>(glm::clamp(color[i], 0.0f, 1.0f) * 255.0f + 0.5f);
 }
 
 void SDFTextRenderer::SetSmoothness(GLfloat smoothness)
 {
+    Render();
     pipeline->GetPipelineUniform().Set("smoothness", smoothness);
 }
 
 void SDFTextRenderer::SetOutlineColor(const GLfloat* color)
 {
+    Render();
     pipeline->GetPipelineUniform().Set("outline_color", glm::make_vec4(color));
 }
 
-std::size_t SDFTextRenderer::GetMaxBufferLength()
-{
-    return max_buffer_length;
-}
-
 bool SDFTextRenderer::IsBufferEmpty()
 {
-    return vertices.empty();
+    return head == tail;
 }
 
 void SDFTextRenderer::SetToBuffer(const Rect& bounds, const Rect& texcoord_bounds, std::uint16_t page)
 {
-    if(!vertices.empty())
-        indices.emplace_back(vertices.size());// for degenerate triangle.
-
-    indices.emplace_back(vertices.size());
-    vertices.emplace_back(std::get<0>(bounds), std::get<1>(bounds), std::get<0>(texcoord_bounds), std::get<1>(texcoord_bounds), static_cast<float>(page)); // left / top
-
-    indices.emplace_back(vertices.size());
-    vertices.emplace_back(std::get<0>(bounds), std::get<3>(bounds), std::get<0>(texcoord_bounds), std::get<3>(texcoord_bounds), static_cast<float>(page)); // left / bottom
-
-    indices.emplace_back(vertices.size());
-    vertices.emplace_back(std::get<2>(bounds), std::get<1>(bounds), std::get<2>(texcoord_bounds), std::get<1>(texcoord_bounds), static_cast<float>(page)); // right / top
-
-    indices.emplace_back(vertices.size());
-    indices.emplace_back(vertices.size());   // for degenerate triangle.
-    vertices.emplace_back(std::get<2>(bounds), std::get<3>(bounds), std::get<2>(texcoord_bounds), std::get<3>(texcoord_bounds), static_cast<float>(page)); // right / bottom
-}
-
-void SDFTextRenderer::ClearBuffer()
-{
-    vertices.clear();
-    indices.clear();
+    if(head == max_buffer_length)
+    {
+        Render();
+        NextSegment();
+    }
+
+    auto& instance = segments[segment].instances[head++];
+    instance.bounds[0] = std::get<0>(bounds);
+    instance.bounds[1] = std::get<1>(bounds);
+    instance.bounds[2] = std::get<2>(bounds);
+    instance.bounds[3] = std::get<3>(bounds);
+    instance.texcoord_bounds[0] = std::get<0>(texcoord_bounds);
+    instance.texcoord_bounds[1] = std::get<1>(texcoord_bounds);
+    instance.texcoord_bounds[2] = std::get<2>(texcoord_bounds);
+    instance.texcoord_bounds[3] = std::get<3>(texcoord_bounds);
+    std::copy(current_color.cbegin(), current_color.cend(), instance.color);
+    instance.layer = static_cast<GLfloat>(page);
 }
 
 // SDFText
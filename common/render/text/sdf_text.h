@@ -1,4 +1,6 @@
 ﻿#pragma once
+#include <array>
+#include <vector>
 #include "../shader/shader.h"
 #include "text.h"
 
@@ -13,50 +15,50 @@ class SDFTextRenderer final : public ITextRenderer
 {
     friend class SDFText;
 
-    static constexpr std::size_t max_buffer_length = 32;
-    static constexpr GLsizei max_vertices = max_buffer_length * 4;
-    static constexpr GLsizei max_indices = max_vertices + max_buffer_length * 2 - 1;
+    // Glyph instances are streamed through a ring of segments, one segment per batch.
+    // The ring grows rather than waits when the GPU has not consumed the segment it comes round to.
+    static constexpr std::size_t max_buffer_length = 4096;
+    static constexpr std::size_t initial_num_of_segments = 3;
+
+    struct Segment
+    {
+        GLuint vbo;
+        GlyphInstance* instances;
+        GLsync fence;
+    };
 
 public:
     SDFTextRenderer();
     ~SDFTextRenderer();
 
 private:
-    void BeginRendering(GLuint texture) override;
+    void BeginRendering(GLuint texture, DistanceFieldType type) override;
     void EndRendering() override;
     void Render() override;
 
     void SetOrthographicProjectionMatrix(const GLfloat* m) override;
     void SetColor(const GLfloat* color) override;
 
-    std::size_t GetMaxBufferLength() override;
     bool IsBufferEmpty() override;
     void SetToBuffer(const Rect& bounds, const Rect& texcoord_bounds, std::uint16_t page) override;
-    void ClearBuffer() override;
+    void RenderInstances(GLuint buffer, std::size_t count, GLfloat x, GLfloat y) override;
 
     void SetSmoothness(GLfloat smoothness);
     void SetOutlineColor(const GLfloat* color);
 
+    void NextSegment();
+
+    static Segment CreateSegment();
+    static void DeleteSegment(Segment& s);
+
 private:
     GLuint vao;
-    GLuint vbo;
-    GLuint ibo;
     GLuint sampler;
-    struct Vertex
-    {
-        GLfloat x;
-        GLfloat y;
-        GLfloat s;
-        GLfloat t;
-        GLfloat layer;
-        Vertex(GLfloat x, GLfloat y, GLfloat s, GLfloat t, GLfloat layer)
-            : x(x), y(y), s(s), t(t), layer(layer)
-        {
-        }
-    };
-
-    std::vector<Vertex> vertices;
-    std::vector<std::uint32_t> indices;
+    std::vector<Segment> segments;
+    std::size_t segment;
+    std::size_t head;   // Instances written to the current segment.
+    std::size_t tail;   // Instances of the current segment already drawn.
+    std::array<GLubyte, 4> current_color;
 
     std::unique_ptr<shader::Program> vs;
     std::unique_ptr<shader::Program> fs;
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <limits>
+#include "skyline_packer.h"
+
+namespace common::render::text
+{
+
+SkylinePacker::SkylinePacker(std::uint32_t width, std::uint32_t height)
+    : width_(width), height_(height)
+{
+    Clear();
+}
+
+bool SkylinePacker::Allocate(std::uint32_t width, std::uint32_t height, Rect& rect)
+{
+    if((width == 0) || (height == 0) || (width > width_) || (height > height_))
+        return false;
+
+    // Bottom-left: the lowest position, ties are broken by the narrowest segment.
+    auto best_index = skyline_.size();
+    auto best_y = std::numeric_limits<std::uint32_t>::max();
+    auto best_width = std::numeric_limits<std::uint32_t>::max();
+    for(std::size_t i = 0; i < skyline_.size(); i++)
+    {
+        std::uint32_t y;
+        if(!fit(i, width, height, y))
+            continue;
+        if((y < best_y) || ((y == best_y) && (skyline_[i].width < best_width)))
+        {
+            best_index = i;
+            best_y = y;
+            best_width = skyline_[i].width;
+        }
+    }
+    if(best_index == skyline_.size())
+        return false;
+
+    rect.x = skyline_[best_index].x;
+    rect.y = best_y;
+    rect.width = width;
+    rect.height = height;
+
+    // Raise the skyline under the new rectangle and trim the segments it covers.
+    skyline_.insert(skyline_.begin() + static_cast<std::ptrdiff_t>(best_index), Node{ rect.x, rect.y + height, width });
+    for(auto i = best_index + 1; i < skyline_.size(); )
+    {
+        auto& node = skyline_[i];
+        const auto& prev = skyline_[i - 1];
+        const auto prev_right = prev.x + prev.width;
+        if(node.x >= prev_right)
+            break;
+
+        const auto shrink = prev_right - node.x;
+        if(node.width <= shrink)
+        {
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(i));
+            continue;
+        }
+        node.x += shrink;
+        node.width -= shrink;
+        break;
+    }
+
+    // Merge neighbouring segments at the same height.
+    for(std::size_t i = 0; i + 1 < skyline_.size(); )
+    {
+        if(skyline_[i].y == skyline_[i + 1].y)
+        {
+            skyline_[i].width += skyline_[i + 1].width;
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(i + 1));
+        }
+        else
+        {
+            i++;
+        }
+    }
+    return true;
+}
+
+void SkylinePacker::Clear()
+{
+    skyline_.assign(1, Node{ 0, 0, width_ });
+}
+
+float SkylinePacker::GetOccupancy() const
+{
+    std::uint64_t area = 0;
+    for(const auto& node : skyline_)
+        area += static_cast<std::uint64_t>(node.width) * node.y;
+    return static_cast<float>(area) / (static_cast<float>(width_) * static_cast<float>(height_));
+}
+
+bool SkylinePacker::fit(std::size_t index, std::uint32_t width, std::uint32_t height, std::uint32_t& y) const
+{
+    const auto x = skyline_[index].x;
+    if(x + width > width_)
+        return false;
+
+    // The rectangle rests on the highest segment it spans.
+    y = 0;
+    auto remaining = static_cast<std::int64_t>(width);
+    for(auto i = index; remaining > 0; i++)
+    {
+        if(i == skyline_.size())
+            return false;
+        y = std::max(y, skyline_[i].y);
+        if(y + height > height_)
+            return false;
+        remaining -= skyline_[i].width;
+    }
+    return true;
+}
+
+}   // namespace common::render::text
\ No newline at end of file
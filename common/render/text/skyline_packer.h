@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace common::render::text
+{
+
+/*!
+ * @class SkylinePacker
+ * @brief Packs rectangles into a fixed size area with the skyline bottom-left heuristic.
+ *
+ * Rectangles cannot be freed individually; Clear() releases the whole area.
+ */
+class SkylinePacker final
+{
+public:
+    struct Rect
+    {
+        std::uint32_t x = 0;
+        std::uint32_t y = 0;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+    };
+
+public:
+    SkylinePacker(std::uint32_t width, std::uint32_t height);
+    ~SkylinePacker() = default;
+
+    SkylinePacker(const SkylinePacker&) = default;
+    SkylinePacker& operator = (const SkylinePacker&) = default;
+    SkylinePacker(SkylinePacker&&) = default;
+    SkylinePacker& operator = (SkylinePacker&&) = default;
+
+    bool Allocate(std::uint32_t width, std::uint32_t height, Rect& rect);
+    void Clear();
+
+    std::uint32_t GetWidth() const noexcept { return width_; }
+    std::uint32_t GetHeight() const noexcept { return height_; }
+    //! The fraction of the area below the skyline.
+    float GetOccupancy() const;
+
+private:
+    struct Node
+    {
+        std::uint32_t x;
+        std::uint32_t y;
+        std::uint32_t width;
+    };
+
+    bool fit(std::size_t index, std::uint32_t width, std::uint32_t height, std::uint32_t& y) const;
+
+private:
+    std::uint32_t width_;
+    std::uint32_t height_;
+    std::vector<Node> skyline_;
+};
+
+}   // namespace common::render::text
\ No newline at end of file
@@ -1,47 +1,9 @@
-﻿#include <sstream>
-#ifdef _WIN32
-#include <windows.h>
-#endif
-#include <glm/glm.hpp>
+﻿#include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "text.h"
-
-namespace
-{
-#ifdef _WIN32
-//
-//  Convert an UTF8 string to a wide Unicode String
-//  https://stackoverflow.com/questions/215963/how-do-you-properly-use-widechartomultibyte/3999597#3999597
-//
-std::wstring utf8_decode(const std::string& str)
-{
-    if(str.empty())
-        return std::wstring();
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
-    std::wstring wstrTo(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
-    return wstrTo;
-}
-#endif
-
-std::tuple<float, float, float, float>
-ComputeBounds(const common::render::text::Glyph& glyph, float x, float y, float scale)
-{
-    const auto x2 = x + static_cast<float>(std::get<0>(glyph.GetOffset())) * scale;
-    const auto y2 = y + static_cast<float>(std::get<1>(glyph.GetOffset())) * scale;
-    return std::make_tuple(x2, y2, x2 + (static_cast<float>(std::get<0>(glyph.GetSize())) * scale), y2 + (static_cast<float>(std::get<1>(glyph.GetSize())) * scale));
-}
-
-std::tuple<float, float, float, float>
-ComputeTexcoordBounds(const common::render::text::Glyph& glyph, float rcp_width, float rcp_height)
-{
-    const auto tx = (static_cast<float>(std::get<0>(glyph.GetPosition())) + 0.5f) * rcp_width;
-    const auto ty = (static_cast<float>(std::get<1>(glyph.GetPosition())) + 0.5f) * rcp_height;
-    return std::make_tuple(tx, ty, tx + (static_cast<float>(std::get<0>(glyph.GetSize())) * rcp_width), ty + (static_cast<float>(std::get<1>(glyph.GetSize())) * rcp_height));
-}
-
-}   // namespace
+#include "text_layout.h"
+#include "utf8.h"
 
 namespace common::render::text
 {
@@ -53,6 +15,8 @@ Text::Text(const std::shared_ptr<Font>& font, const std::shared_ptr<ITextRendere
 
 void Text::BeginRendering()
 {
+    font->Update();
+
     GLint vp[4];
     glGetIntegerv(GL_VIEWPORT, vp);
 
@@ -65,7 +29,7 @@ void Text::BeginRendering()
     );
     renderer->SetOrthographicProjectionMatrix(glm::value_ptr(proj));
 
-    renderer->BeginRendering(font->GetTexture());
+    renderer->BeginRendering(font->GetTexture(), font->GetDistanceFieldType());
 }
 
 void Text::EndRendering()
@@ -91,80 +55,41 @@ void Text::DrawString(const std::string& s, float x, float y, float scale)
     const auto metrics = font->GetFontMetrics();
     const auto line_height = static_cast<float>(metrics.GetLineHeight()) * scale;
 
-    auto line_no = 1;
+    DecodeUtf8(s, code_points);
 
-    constexpr auto sep = '\n';
-    std::stringstream ss{ s + sep };
-    std::string buf;
-    while(std::getline(ss, buf, sep))
+    auto line_no = 1;
+    const std::u32string_view view(code_points);
+    std::size_t pos = 0;
+    while(pos <= view.size())
     {
-        draw_string(buf, x, y + line_height * static_cast<float>(line_no++), scale);
+        auto end = view.find(U'\n', pos);
+        if(end == std::u32string_view::npos)
+            end = view.size();
+        draw_string(view.substr(pos, end - pos), x, y + line_height * static_cast<float>(line_no++), scale);
+        pos = end + 1;
     }
 }
 
-ITextRenderer* Text::GetRenderer()
+void Text::DrawLayout(TextLayout& layout, float x, float y)
 {
-    return renderer.get();
+    layout.Update();
+    // The cached instances do not look their glyphs up again, so their pages are kept from eviction here.
+    layout.TouchPages();
+    if(layout.GetNumOfGlyphs() > 0)
+        renderer->RenderInstances(layout.GetBuffer(), layout.GetNumOfGlyphs(), x, y);
 }
 
-void Text::draw_string(const std::string& string, float x, float y, float scale)
+ITextRenderer* Text::GetRenderer()
 {
-#ifdef _WIN32
-    // https://stackoverflow.com/a/42734882
-    auto wstr = utf8_decode(string);
-    std::u16string u16str(wstr.begin(), wstr.end());
-    draw_string(u16str, x, y, scale);
-#else
-#error Function not implemented.
-#endif
+    return renderer.get();
 }
 
-void Text::draw_string(const std::u16string& string, float x, float y, float scale)
+void Text::draw_string(std::u32string_view string, float x, float y, float scale)
 {
-    const auto rcp_aw = 1.0f / static_cast<float>(std::get<0>(font->GetTextureSize()));
-    const auto rcp_ah = 1.0f / static_cast<float>(std::get<1>(font->GetTextureSize()));
-    const std::size_t max_buffer_length = renderer->GetMaxBufferLength();
-
-    y -= static_cast<float>(font->GetBase()) * scale;
-
-    char16_t prev_code = 0;
-    std::size_t count = 0;
-    for(auto code : string)
+    LayOutLine(*font, string, x, y, scale, [this](const auto& bounds, const auto& texcoord_bounds, auto page)
     {
-        auto glyph = font->GetGlyph(code);
-        if(!glyph.IsValid())
-            continue;
-
-        // Adjust kerning.
-        const auto amount = static_cast<float>(font->GetKerningAmount(prev_code, code));
-        prev_code = code;
-        x += amount * scale;
-
-        // Skip glyphs that have no pixels.
-        if(glyph.HasPixels())
-        {
-            // Calculate the vertex and texture coordinates.
-            renderer->SetToBuffer(
-                ComputeBounds(glyph, x, y, scale),
-                ComputeTexcoordBounds(glyph, rcp_aw, rcp_ah),
-                glyph.GetPage()
-            );
-            count++;
-            if(count >= max_buffer_length)
-            {
-                count = 0;
-                renderer->Render();
-                renderer->ClearBuffer();
-            }
-        }
-        // Advance the cursor to the start of the next character.
-        x += static_cast<float>(glyph.GetAdvance()) * scale;
-    }
-    if(!renderer->IsBufferEmpty())
-    {
-        renderer->Render();
-        renderer->ClearBuffer();
-    }
+        renderer->SetToBuffer(bounds, texcoord_bounds, page);
+    });
 }
 
 }   // namespace common::text
\ No newline at end of file
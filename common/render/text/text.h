@@ -5,11 +5,27 @@
 * @date 2016/09/26
 */
 #pragma once
+#include <string>
+#include <string_view>
 #include "font.h"
 
 namespace common::render::text
 {
 
+class TextLayout;
+
+/*!
+ * @struct GlyphInstance
+ * @brief Per-glyph vertex data shared by the renderers and TextLayout.
+ */
+struct GlyphInstance
+{
+    GLfloat bounds[4];          // left, top, right, bottom
+    GLfloat texcoord_bounds[4]; // left, top, right, bottom
+    GLubyte color[4];
+    GLfloat layer;
+};
+
 /*!
  * @class ITextRenderer
  * @brief Abstract bitmap font renderer class.
@@ -30,17 +46,20 @@ public:
     ITextRenderer& operator = (ITextRenderer&&) = delete;
 
 protected:
-    virtual void BeginRendering(GLuint texture) = 0;
+    // Glyphs are batched between BeginRendering() and EndRendering(), which draws whatever is still buffered.
+    virtual void BeginRendering(GLuint texture, DistanceFieldType type) = 0;
     virtual void EndRendering() = 0;
     virtual void Render() = 0;
 
     virtual void SetOrthographicProjectionMatrix(const GLfloat* m) = 0;
+    // Applies to the glyphs buffered after this call.
     virtual void SetColor(const GLfloat* color) = 0;
 
-    virtual std::size_t GetMaxBufferLength() = 0;
     virtual bool IsBufferEmpty() = 0;
     virtual void SetToBuffer(const Rect& bounds, const Rect& texcoord_bounds, std::uint16_t page) = 0;
-    virtual void ClearBuffer() = 0;
+
+    // Draws `count` instances of `GlyphInstance` stored in `buffer`, translated by (x, y).
+    virtual void RenderInstances(GLuint buffer, std::size_t count, GLfloat x, GLfloat y) = 0;
 };
 
 /*!
@@ -66,15 +85,16 @@ public:
     const Font& GetFont() const;
 
     void DrawString(const std::string& string, float x = 0.0f, float y = 0.0f, float scale = 1.0f);
+    void DrawLayout(TextLayout& layout, float x = 0.0f, float y = 0.0f);
 
 protected:
     ITextRenderer* GetRenderer();
-    void draw_string(const std::string& string, float x, float y, float scale);
-    void draw_string(const std::u16string& string, float x, float y, float scale);
+    void draw_string(std::u32string_view string, float x, float y, float scale);
 
 private:
-    std::shared_ptr<const Font> font;
+    std::shared_ptr<Font> font;
     std::shared_ptr<ITextRenderer> renderer;
+    std::u32string code_points; // Reused across calls to avoid an allocation per string.
 };
 
 }   // namespace common::text
\ No newline at end of file
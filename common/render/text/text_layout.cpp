@@ -0,0 +1,176 @@
+#include <algorithm>
+#include "text_layout.h"
+#include "utf8.h"
+
+namespace common::render::text
+{
+
+TextLayout::TextLayout(const std::shared_ptr<const Font>& font, float scale)
+    : font(font), scale(scale), width(0.0f), current_color{{255, 255, 255, 255}}, dirty_offset(0), generation(font->GetGeneration()), buffer(0), capacity(0)
+{
+    line_height = static_cast<float>(font->GetFontMetrics().GetLineHeight()) * scale;
+}
+
+TextLayout::~TextLayout()
+{
+    if(glIsBuffer(buffer))
+        glDeleteBuffers(1, &buffer);
+}
+
+void TextLayout::SetColor(const GLfloat* color)
+{
+    std::array<GLubyte, 4> c;
+    for(std::size_t i = 0; i < c.size(); i++)
+        c[i] = static_cast<GLubyte>(std::clamp(color[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+    if(c == current_color)
+        return;
+
+    current_color = c;
+    for(auto& line : lines)
+    {
+        for(auto& instance : line.instances)
+            std::copy(c.cbegin(), c.cend(), instance.color);
+    }
+    for(auto& instance : instances)
+        std::copy(c.cbegin(), c.cend(), instance.color);
+    dirty_offset = 0;
+}
+
+bool TextLayout::SetText(std::string_view string)
+{
+    constexpr auto npos = std::string_view::npos;
+
+    auto first_changed = npos;
+    std::size_t line_no = 0;
+    std::size_t pos = 0;
+    while(pos <= string.size())
+    {
+        auto end = string.find('\n', pos);
+        if(end == npos)
+            end = string.size();
+        const auto source = string.substr(pos, end - pos);
+        pos = end + 1;
+
+        if(line_no == lines.size())
+            lines.emplace_back();
+        else if(lines[line_no].source == source)
+        {
+            line_no++;
+            continue;
+        }
+
+        auto& line = lines[line_no];
+        line.source = source;
+        LayOut(line, line_no);
+        first_changed = std::min(first_changed, line_no);
+        line_no++;
+    }
+    if(line_no < lines.size())
+    {
+        first_changed = std::min(first_changed, line_no);
+        lines.resize(line_no);
+    }
+    if(first_changed == npos)
+        return false;
+
+    // Re-pack the runs from the first changed line onwards.
+    std::size_t offset = 0;
+    for(std::size_t i = 0; i < first_changed; i++)
+        offset += lines[i].instances.size();
+    instances.resize(offset);
+    for(auto i = first_changed; i < lines.size(); i++)
+        instances.insert(instances.cend(), lines[i].instances.cbegin(), lines[i].instances.cend());
+    dirty_offset = std::min(dirty_offset, offset);
+
+    width = 0.0f;
+    for(const auto& line : lines)
+        width = std::max(width, line.width);
+    CollectPages();
+
+    return true;
+}
+
+void TextLayout::Update()
+{
+    if(generation != font->GetGeneration())
+    {
+        generation = font->GetGeneration();
+        instances.clear();
+        width = 0.0f;
+        for(std::size_t i = 0; i < lines.size(); i++)
+        {
+            LayOut(lines[i], i);
+            instances.insert(instances.cend(), lines[i].instances.cbegin(), lines[i].instances.cend());
+            width = std::max(width, lines[i].width);
+        }
+        CollectPages();
+        dirty_offset = 0;
+    }
+
+    if(dirty_offset >= instances.size())
+    {
+        dirty_offset = instances.size();
+        return;
+    }
+
+    if(buffer == 0)
+        glGenBuffers(1, &buffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    if(instances.size() > capacity)
+    {
+        capacity = std::max(instances.size(), capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(GlyphInstance) * capacity), nullptr, GL_DYNAMIC_DRAW);
+        dirty_offset = 0;
+    }
+    glBufferSubData(
+        GL_ARRAY_BUFFER,
+        static_cast<GLintptr>(sizeof(GlyphInstance) * dirty_offset),
+        static_cast<GLsizeiptr>(sizeof(GlyphInstance) * (instances.size() - dirty_offset)),
+        &instances[dirty_offset]
+    );
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    dirty_offset = instances.size();
+}
+
+void TextLayout::LayOut(Line& line, std::size_t line_no)
+{
+    DecodeUtf8(line.source, code_points);
+
+    line.instances.clear();
+    line.pages.clear();
+    const auto y = line_height * static_cast<float>(line_no + 1);
+    line.width = LayOutLine(*font, code_points, 0.0f, y, scale, [&](const auto& bounds, const auto& texcoord_bounds, auto page)
+    {
+        GlyphInstance instance;
+        instance.bounds[0] = std::get<0>(bounds);
+        instance.bounds[1] = std::get<1>(bounds);
+        instance.bounds[2] = std::get<2>(bounds);
+        instance.bounds[3] = std::get<3>(bounds);
+        instance.texcoord_bounds[0] = std::get<0>(texcoord_bounds);
+        instance.texcoord_bounds[1] = std::get<1>(texcoord_bounds);
+        instance.texcoord_bounds[2] = std::get<2>(texcoord_bounds);
+        instance.texcoord_bounds[3] = std::get<3>(texcoord_bounds);
+        std::copy(current_color.cbegin(), current_color.cend(), instance.color);
+        instance.layer = static_cast<GLfloat>(page);
+        line.instances.push_back(instance);
+        if(std::find(line.pages.cbegin(), line.pages.cend(), page) == line.pages.cend())
+            line.pages.push_back(page);
+    });
+}
+
+void TextLayout::CollectPages()
+{
+    pages.clear();
+    for(const auto& line : lines)
+    {
+        for(auto page : line.pages)
+        {
+            if(std::find(pages.cbegin(), pages.cend(), page) == pages.cend())
+                pages.push_back(page);
+        }
+    }
+}
+
+}   // namespace common::render::text
\ No newline at end of file
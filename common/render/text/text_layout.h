@@ -0,0 +1,131 @@
+/*!
+* @file text_layout.h
+* @brief Cached glyph runs for static and mostly-static strings.
+*/
+#pragma once
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "text.h"
+
+namespace common::render::text
+{
+
+/*!
+ * Lays out a single line, the top of the line is at `y`.
+ * `func(bounds, texcoord_bounds, page)` is called for each glyph that has pixels.
+ * @return the pen position after the last glyph.
+ */
+template<typename Func>
+float LayOutLine(const Font& font, std::u32string_view string, float x, float y, float scale, Func&& func)
+{
+    const auto rcp_aw = 1.0f / static_cast<float>(std::get<0>(font.GetTextureSize()));
+    const auto rcp_ah = 1.0f / static_cast<float>(std::get<1>(font.GetTextureSize()));
+
+    y -= static_cast<float>(font.GetBase()) * scale;
+
+    char32_t prev_code = 0;
+    for(auto code : string)
+    {
+        const auto& glyph = font.GetGlyph(code);
+        if(!glyph.IsValid())
+            continue;
+
+        // Adjust kerning.
+        const auto amount = static_cast<float>(font.GetKerningAmount(prev_code, code));
+        prev_code = code;
+        x += amount * scale;
+
+        // Skip glyphs that have no pixels.
+        if(glyph.HasPixels())
+        {
+            // Calculate the vertex and texture coordinates.
+            const auto left = x + static_cast<float>(std::get<0>(glyph.GetOffset())) * scale;
+            const auto top = y + static_cast<float>(std::get<1>(glyph.GetOffset())) * scale;
+            const auto width = static_cast<float>(std::get<0>(glyph.GetSize()));
+            const auto height = static_cast<float>(std::get<1>(glyph.GetSize()));
+            const auto s = (static_cast<float>(std::get<0>(glyph.GetPosition())) + 0.5f) * rcp_aw;
+            const auto t = (static_cast<float>(std::get<1>(glyph.GetPosition())) + 0.5f) * rcp_ah;
+            func(
+                ITextRenderer::Rect(left, top, left + width * scale, top + height * scale),
+                ITextRenderer::Rect(s, t, s + width * rcp_aw, t + height * rcp_ah),
+                glyph.GetPage()
+            );
+        }
+        // Advance the cursor to the start of the next character.
+        x += static_cast<float>(glyph.GetAdvance()) * scale;
+    }
+    return x;
+}
+
+/*!
+ * @class TextLayout
+ * @brief A string laid out once into a GPU-resident glyph run.
+ *
+ * Each line is cached along with its source text. SetText() only lays out the lines that changed,
+ * and Update() only uploads the instances from the first changed line onwards.
+ */
+class TextLayout final
+{
+public:
+    explicit TextLayout(const std::shared_ptr<const Font>& font, float scale = 1.0f);
+    ~TextLayout();
+
+    TextLayout(const TextLayout&) = delete;
+    TextLayout& operator = (const TextLayout&) = delete;
+    TextLayout(TextLayout&&) = delete;
+    TextLayout& operator = (TextLayout&&) = delete;
+
+    void SetColor(const GLfloat* color);
+
+    /*!
+     * @param string UTF-8 text, lines are separated by '\n'.
+     * @return true if the layout has changed.
+     */
+    bool SetText(std::string_view string);
+
+    float GetWidth() const { return width; }
+    float GetHeight() const { return static_cast<float>(lines.size()) * line_height; }
+
+    /*!
+     * Uploads the pending changes, must be called on the thread that owns the GL context.
+     * All lines are laid out again if the glyphs of the font have changed since.
+     */
+    void Update();
+
+    GLuint GetBuffer() const { return buffer; }
+    std::size_t GetNumOfGlyphs() const { return instances.size(); }
+
+    //! Marks the glyph pages the layout draws from as used by the current frame, so that they are not evicted.
+    void TouchPages() const { font->TouchPages(pages); }
+
+private:
+    struct Line
+    {
+        std::string source;
+        std::vector<GlyphInstance> instances;
+        std::vector<std::uint16_t> pages;
+        float width;
+    };
+
+    void LayOut(Line& line, std::size_t line_no);
+    void CollectPages();
+
+private:
+    std::shared_ptr<const Font> font;
+    float scale;
+    float line_height;
+    float width;
+    std::array<GLubyte, 4> current_color;
+    std::vector<Line> lines;
+    std::vector<GlyphInstance> instances;
+    std::vector<std::uint16_t> pages;   // Of the glyph cache, used by any line.
+    std::u32string code_points;
+    std::size_t dirty_offset;   // First instance that has not been uploaded yet.
+    std::uint64_t generation;   // Of the font when the lines were laid out.
+    GLuint buffer;
+    std::size_t capacity;
+};
+
+}   // namespace common::render::text
\ No newline at end of file
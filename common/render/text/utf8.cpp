@@ -0,0 +1,163 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define USE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <cstdint>
+#include "utf8.h"
+
+namespace
+{
+
+using common::render::text::replacement_character;
+
+unsigned int count_trailing_zeros(std::uint32_t x)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return static_cast<unsigned int>(index);
+#else
+    return static_cast<unsigned int>(__builtin_ctz(x));
+#endif
+}
+
+/*!
+ * Widens the ASCII prefix of [src, last) into dst.
+ * dst must have room for the remaining input, whole blocks are stored even if they end in a non-ASCII byte.
+ * @return the number of ASCII bytes.
+ */
+std::size_t widen_ascii(const std::uint8_t* src, const std::uint8_t* last, char32_t* dst)
+{
+    const auto first = src;
+#if defined(USE_AVX2)
+    while(last - src >= 32)
+    {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+        for(int i = 0; i < 4; i++)
+        {
+            const auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i * 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 8), _mm256_cvtepu8_epi32(bytes));
+        }
+        if(mask != 0)
+            return static_cast<std::size_t>(src - first) + count_trailing_zeros(mask);
+        src += 32;
+        dst += 32;
+    }
+#elif defined(USE_SSE2)
+    const auto zero = _mm_setzero_si128();
+    while(last - src >= 16)
+    {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(v));
+        const auto lo = _mm_unpacklo_epi8(v, zero);
+        const auto hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 0), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 12), _mm_unpackhi_epi16(hi, zero));
+        if(mask != 0)
+            return static_cast<std::size_t>(src - first) + count_trailing_zeros(mask);
+        src += 16;
+        dst += 16;
+    }
+#endif
+    while((src != last) && (*src < 0x80))
+        *dst++ = *src++;
+    return static_cast<std::size_t>(src - first);
+}
+
+/*!
+ * Decodes a single sequence whose lead byte is not ASCII.
+ * Follows the well-formed byte sequences of Unicode Table 3-7.
+ */
+char32_t decode_sequence(const std::uint8_t*& src, const std::uint8_t* last, bool& valid)
+{
+    const auto lead = *src++;
+    std::size_t num_of_trails;
+    char32_t code;
+    std::uint8_t lower = 0x80;
+    std::uint8_t upper = 0xBF;
+    if((lead >= 0xC2) && (lead <= 0xDF))
+    {
+        num_of_trails = 1;
+        code = lead & 0x1Fu;
+    }
+    else if((lead >= 0xE0) && (lead <= 0xEF))
+    {
+        num_of_trails = 2;
+        code = lead & 0x0Fu;
+        if(lead == 0xE0)
+            lower = 0xA0;
+        else if(lead == 0xED)
+            upper = 0x9F;   // Surrogates.
+    }
+    else if((lead >= 0xF0) && (lead <= 0xF4))
+    {
+        num_of_trails = 3;
+        code = lead & 0x07u;
+        if(lead == 0xF0)
+            lower = 0x90;
+        else if(lead == 0xF4)
+            upper = 0x8F;   // Beyond U+10FFFF.
+    }
+    else
+    {
+        valid = false;
+        return replacement_character;
+    }
+
+    for(std::size_t i = 0; i < num_of_trails; i++)
+    {
+        if((src == last) || (*src < lower) || (*src > upper))
+        {
+            valid = false;
+            return replacement_character;
+        }
+        code = (code << 6) | (*src++ & 0x3Fu);
+        lower = 0x80;
+        upper = 0xBF;
+    }
+    return code;
+}
+
+}   // namespace
+
+namespace common::render::text
+{
+
+bool DecodeUtf8(std::string_view src, std::u32string& dst)
+{
+    // Never produces more code points than bytes.
+    dst.resize(src.size());
+
+    auto first = reinterpret_cast<const std::uint8_t*>(src.data());
+    const auto last = first + src.size();
+    auto out = &dst[0];
+    bool valid = true;
+    while(first != last)
+    {
+        const auto count = widen_ascii(first, last, out);
+        first += count;
+        out += count;
+        if(first != last)
+            *out++ = decode_sequence(first, last, valid);
+    }
+    dst.resize(static_cast<std::size_t>(out - dst.data()));
+    return valid;
+}
+
+std::u32string DecodeUtf8(std::string_view src)
+{
+    std::u32string dst;
+    DecodeUtf8(src, dst);
+    return dst;
+}
+
+}   // namespace common::render::text
\ No newline at end of file
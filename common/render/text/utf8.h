@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace common::render::text
+{
+
+constexpr char32_t replacement_character = U'\uFFFD';
+
+/*!
+ * Decodes an UTF-8 string into code points.
+ * Runs of ASCII are validated and widened with SSE2 or AVX2 when available.
+ * Each maximal ill-formed subsequence is replaced with U+FFFD.
+ * @param dst the decoded code points, the previous contents are discarded.
+ * @return false if the string contained ill-formed sequences.
+ */
+bool DecodeUtf8(std::string_view src, std::u32string& dst);
+
+std::u32string DecodeUtf8(std::string_view src);
+
+}   // namespace common::render::text
\ No newline at end of file
@@ -1,8 +1,14 @@
 ﻿#include <stdexcept>
+#include <chrono>
+#include <cstring>
 #include <functional>
 #include <hasenpfote/assert.h>
 #include "../logger.h"
+#include "../system.h"
+#include "compression/ktx2.h"
 #include "image.h"
+#include "mipmap_generator.h"
+#include "texture_uploader.h"
 #include "texture.h"
 
 namespace
@@ -30,78 +36,172 @@ bool ends_with_ignore_case(const std::string& s, const std::string& suffix)
     );
 }
 
+GLenum to_internal_format(const common::render::compression::Ktx2Image& image)
+{
+    using common::render::compression::BlockFormat;
+
+    switch(image.GetBlockFormat())
+    {
+    case BlockFormat::BC1:
+        return image.IsSRGB() ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3:
+        return image.IsSRGB() ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::BC4:
+        return GL_COMPRESSED_RED_RGTC1;
+    case BlockFormat::BC5:
+        return GL_COMPRESSED_RG_RGTC2;
+    case BlockFormat::BC6H:
+        return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+    case BlockFormat::BC7:
+        return image.IsSRGB() ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default:
+        HASENPFOTE_ASSERT(false);
+        return GL_NONE;
+    }
 }
 
-namespace common::render
+// Builds the levels below the base level on the CPU, filtering sRGB texels in linear space.
+std::vector<std::vector<std::uint8_t>> generate_mipmaps(const common::render::Image& image, ColorSpace color_space, std::size_t num_of_levels)
 {
+    using common::render::Image;
+    using common::render::MipmapGenerator;
+    using common::render::compression::FloatToHalf;
+    using common::render::compression::HalfToFloat;
 
-Texture::Texture(GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
-    : texture_(0)
+    const MipmapGenerator generator;
+    const auto width = image.GetWidth();
+    const auto height = image.GetHeight();
+    const auto num_of_channels = static_cast<std::size_t>(image.GetColorFormat());
+
+    std::vector<std::vector<std::uint8_t>> levels;
+    if(image.GetPixelType() == Image::PixelType::UnsignedByte)
+    {
+        // Only RGB(A) textures are created with an sRGB format.
+        const auto srgb = (color_space == ColorSpace::SRGB) && (num_of_channels >= 3);
+        for(auto& level : generator.Generate(image.GetData(), width, height, num_of_channels, srgb, num_of_levels))
+            levels.push_back(std::move(level.texels));
+        return levels;
+    }
+
+    const auto is_half = (image.GetPixelType() == Image::PixelType::Half);
+    const auto num_of_texels = width * height * num_of_channels;
+    std::vector<float> texels(num_of_texels);
+    if(is_half)
+    {
+        for(std::size_t i = 0; i < num_of_texels; i++)
+        {
+            std::uint16_t h;
+            std::memcpy(&h, image.GetData() + i * sizeof(h), sizeof(h));
+            texels[i] = HalfToFloat(h);
+        }
+    }
+    else
+    {
+        std::memcpy(texels.data(), image.GetData(), num_of_texels * sizeof(float));
+    }
+
+    for(const auto& level : generator.Generate(texels.data(), width, height, num_of_channels, num_of_levels))
+    {
+        std::vector<std::uint8_t> bytes(level.texels.size() * (is_half ? sizeof(std::uint16_t) : sizeof(float)));
+        if(is_half)
+        {
+            for(std::size_t i = 0; i < level.texels.size(); i++)
+            {
+                const auto h = FloatToHalf(level.texels[i]);
+                std::memcpy(&bytes[i * sizeof(h)], &h, sizeof(h));
+            }
+        }
+        else
+        {
+            std::memcpy(bytes.data(), level.texels.data(), bytes.size());
+        }
+        levels.push_back(std::move(bytes));
+    }
+    return levels;
+}
+
+// Allocates the storage on the GL thread, ahead of the copies submitted after it.
+void post_storage(common::render::TextureUploader& uploader, GLuint texture, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
 {
-    HASENPFOTE_ASSERT(levels > 0);
+    uploader.Post(
+        [texture, levels, internal_format, width, height]()
+        {
+            glTextureStorage2D(texture, levels, internal_format, width, height);
+            glTextureParameteri(texture, GL_TEXTURE_BASE_LEVEL, 0);
+            glTextureParameteri(texture, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        }
+    );
+}
 
-    LOG_I("Creating texture.");
+// Runs on a loader thread. Returns false if the file could not be loaded.
+bool stream_ktx2_file(common::render::TextureUploader& uploader, GLuint texture, const std::filesystem::path& filepath, bool generate_mipmap, const std::atomic<bool>& is_cancelled)
+{
+    common::render::compression::Ktx2Image image;
+    if(!image.LoadFromFile(filepath))
+        return false;
 
-    GLuint texture = 0;
-    GLenum target = GL_TEXTURE_2D;
+    // Compressed textures cannot be mipmapped by the driver, so only the stored levels are used.
+    const auto num_of_levels = generate_mipmap ? image.GetNumOfLevels() : 1;
+    if(generate_mipmap && (num_of_levels == 1))
+        LOG_W("`" << filepath.string() << "` has no mipmap levels.");
 
-    glGenTextures(1, &texture);
-    glBindTexture(target, texture);
-    glTexStorage2D(target, levels, internal_format, width, height);
-#if 0
-    // Poor filtering
-    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-#endif
-    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    const auto internal_format = to_internal_format(image);
+    const auto width = static_cast<GLsizei>(image.GetWidth());
+    const auto height = static_cast<GLsizei>(image.GetHeight());
+    const auto levels = static_cast<GLsizei>(num_of_levels);
 
-    glBindTexture(target, 0);
+    post_storage(uploader, texture, levels, internal_format, width, height);
 
-    LOG_I("Texture created successfully. [id=" << texture << "]");
+    for(GLsizei level = 0; (level < levels) && !is_cancelled; level++)
+    {
+        const auto& data = image.GetLevel(static_cast<std::size_t>(level));
 
-    texture_ = texture;
-}
+        common::render::TextureUploader::Region region;
+        region.texture = texture;
+        region.target = GL_TEXTURE_2D;
+        region.level = level;
+        region.width = std::max(1, width >> level);
+        region.height = std::max(1, height >> level);
+        region.format = internal_format;
+        region.image_size = static_cast<GLsizei>(data.size());
 
-Texture::Texture(GLenum internal_format, GLsizei width, GLsizei height)
-    : Texture(1, internal_format, width, height)
-{
+        uploader.Stream(region, data.data(), static_cast<GLsizeiptr>(data.size()));
+    }
+
+    return true;
 }
 
-Texture::Texture(const std::filesystem::path& filepath, bool generate_mipmap)
-    : texture_(0)
+// Runs on a loader thread. Returns false if the file could not be loaded.
+bool stream_image_file(common::render::TextureUploader& uploader, GLuint texture, const std::filesystem::path& filepath, bool generate_mipmap, const std::atomic<bool>& is_cancelled)
 {
-    LOG_I("Creating texture from file `" << filepath.string() << "`.");
+    using common::render::Image;
+    using common::render::Texture;
+    using common::render::TextureUploader;
 
     Image image;
     if(!image.LoadFromFile(filepath))
-    {
-        LOG_E("Failed to load image from file `" << filepath.string() << "`.");
-        throw std::runtime_error("");
-    }
+        return false;
 
     ColorSpace color_space =
         (ends_with_ignore_case(filepath.stem().string(), "_linear")) ? ColorSpace::Linear : ColorSpace::SRGB;
 
-    GLuint texture = 0;
-    GLenum target = GL_TEXTURE_2D;
     GLenum format;
-    GLint internal_format;
+    GLenum internal_format;
     GLenum type;
     GLint alignment;
 
     if(image.GetColorFormat() == Image::ColorFormat::R)
     {
-        internal_format = GL_RED;
+        internal_format = GL_R8;
         format = GL_RED;
+        type = GL_UNSIGNED_BYTE;
         alignment = 1;
     }
     else if(image.GetColorFormat() == Image::ColorFormat::RG)
     {
-        internal_format = GL_RG;
+        internal_format = GL_RG8;
         format = GL_RG;
+        type = GL_UNSIGNED_BYTE;
         alignment = 2;
     }
     else if(image.GetColorFormat() == Image::ColorFormat::RGB)
@@ -110,7 +210,7 @@ Texture::Texture(const std::filesystem::path& filepath, bool generate_mipmap)
         if(image.GetPixelType() == Image::PixelType::UnsignedByte)
         {
             internal_format =
-                (color_space == ColorSpace::Linear) ? GL_RGB : GL_SRGB8;
+                (color_space == ColorSpace::Linear) ? GL_RGB8 : GL_SRGB8;
             type = GL_UNSIGNED_BYTE;
             alignment = 1;
         }
@@ -137,7 +237,7 @@ Texture::Texture(const std::filesystem::path& filepath, bool generate_mipmap)
         if(image.GetPixelType() == Image::PixelType::UnsignedByte)
         {
             internal_format =
-                (color_space == ColorSpace::Linear) ? GL_RGBA : GL_SRGB8_ALPHA8;
+                (color_space == ColorSpace::Linear) ? GL_RGBA8 : GL_SRGB8_ALPHA8;
             type = GL_UNSIGNED_BYTE;
             alignment = 4;
         }
@@ -163,21 +263,66 @@ Texture::Texture(const std::filesystem::path& filepath, bool generate_mipmap)
         HASENPFOTE_ASSERT(false);
     }
 
-    glGenTextures(1, &texture);
-    glBindTexture(target, texture);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
-    glTexImage2D(target, 0, internal_format, image.GetWidth(), image.GetHeight(), 0, format, type, image.GetData());
+    const auto width = static_cast<GLsizei>(image.GetWidth());
+    const auto height = static_cast<GLsizei>(image.GetHeight());
+    const GLsizei levels = generate_mipmap ? Texture::CalcNumOfMipmapLevels(width, height) : 1;
+
+    post_storage(uploader, texture, levels, internal_format, width, height);
+
+    TextureUploader::Region region;
+    region.texture = texture;
+    region.target = GL_TEXTURE_2D;
+    region.width = width;
+    region.height = height;
+    region.format = format;
+    region.type = type;
+    region.unpack_alignment = alignment;
 
-    GLsizei levels = 1;
-    if(generate_mipmap)
+    uploader.Stream(region, image.GetData(), static_cast<GLsizeiptr>(image.GetDataSize()));
+
+    // The mipmap levels are filtered on the CPU rather than by glGenerateMipmap,
+    // whose filter is driver-defined and may not be gamma-correct for sRGB formats.
+    if((levels > 1) && !is_cancelled)
     {
+        const auto mipmaps = generate_mipmaps(image, color_space, static_cast<std::size_t>(levels));
+        for(std::size_t i = 0; (i < mipmaps.size()) && !is_cancelled; i++)
+        {
+            const auto level = static_cast<GLint>(i + 1);
+            region.level = level;
+            region.width = std::max(1, width >> level);
+            region.height = std::max(1, height >> level);
+            uploader.Stream(region, mipmaps[i].data(), static_cast<GLsizeiptr>(mipmaps[i].size()));
+        }
+    }
+
+    return true;
+}
+
+}
+
+namespace common::render
+{
+
+Texture::Texture(GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height)
+    : texture_(0), load_state_(LoadState::Loaded), uploader_(nullptr), is_cancelled_(false)
+{
+    HASENPFOTE_ASSERT(levels > 0);
+
+    LOG_I("Creating texture.");
+
+    GLuint texture = 0;
+    GLenum target = GL_TEXTURE_2D;
+
+    glGenTextures(1, &texture);
+    glBindTexture(target, texture);
+    glTexStorage2D(target, levels, internal_format, width, height);
 #if 0
-        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    // Poor filtering
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 #endif
-        glGenerateMipmap(target);
-        levels = CalcNumOfMipmapLevels(image.GetWidth(), image.GetHeight());
-    }
     glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
     glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
 
@@ -188,8 +333,102 @@ Texture::Texture(const std::filesystem::path& filepath, bool generate_mipmap)
     texture_ = texture;
 }
 
+Texture::Texture(GLenum internal_format, GLsizei width, GLsizei height)
+    : Texture(1, internal_format, width, height)
+{
+}
+
+Texture::Texture(const Texture& origin, GLuint min_level, GLuint num_of_levels)
+    : texture_(0), load_state_(LoadState::Loaded), uploader_(nullptr), is_cancelled_(false)
+{
+    LOG_I("Creating texture view. [origin=" << origin.texture_ << ", level=" << min_level << "]");
+
+    GLint internal_format;
+    glGetTextureLevelParameteriv(origin.texture_, static_cast<GLint>(min_level), GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+
+    // The name must not have been bound yet.
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glTextureView(texture, GL_TEXTURE_2D, origin.texture_, static_cast<GLenum>(internal_format), min_level, num_of_levels, 0, 1);
+
+    LOG_I("Texture created successfully. [id=" << texture << "]");
+
+    texture_ = texture;
+}
+
+Texture::Texture(const std::filesystem::path& filepath, bool generate_mipmap)
+    : texture_(0), load_state_(LoadState::Loading), uploader_(nullptr), is_cancelled_(false)
+{
+    LOG_I("Creating texture from file `" << filepath.string() << "`.");
+
+    // Prefer the block-compressed version built offline by TextureCompressor.
+    auto ktx2_filepath = filepath;
+    ktx2_filepath.replace_extension(".ktx2");
+    const auto has_ktx2 = std::filesystem::exists(ktx2_filepath);
+    if(!has_ktx2 && !std::filesystem::exists(filepath))
+    {
+        LOG_E("Failed to load image from file `" << filepath.string() << "`.");
+        throw std::runtime_error("");
+    }
+
+    // Only the name is created here, the loader posts the storage allocation ahead of its copies.
+    GLuint texture = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+
+    // The uploader is created on first use, which needs the GL context of this thread.
+    // It is kept so that the destructor never has to create one.
+    uploader_ = &System::GetMutableInstance().GetTextureUploader();
+    loading_ = std::async(
+        std::launch::async,
+        [this, texture, filepath, ktx2_filepath, has_ktx2, generate_mipmap]()
+        {
+            auto load = [&]()
+            {
+                if(has_ktx2)
+                {
+                    if(stream_ktx2_file(*uploader_, texture, ktx2_filepath, generate_mipmap, is_cancelled_))
+                    {
+                        LOG_I("Texture loaded successfully from `" << ktx2_filepath.string() << "`. [id=" << texture << "]");
+                        return true;
+                    }
+                    LOG_W("Falling back to `" << filepath.string() << "`.");
+                }
+                if(!stream_image_file(*uploader_, texture, filepath, generate_mipmap, is_cancelled_))
+                {
+                    LOG_E("Failed to load image from file `" << filepath.string() << "`.");
+                    return false;
+                }
+                LOG_I("Texture loaded successfully. [id=" << texture << "]");
+                return true;
+            };
+            const auto is_loaded = load();
+            // Runs after the copies of the texture, the future is ready by then or is about to be.
+            uploader_->Post(
+                [this]()
+                {
+                    load_state_ = loading_.get() ? LoadState::Loaded : LoadState::Failed;
+                }
+            );
+            return is_loaded;
+        }
+    );
+
+    texture_ = texture;
+}
+
 Texture::~Texture()
 {
+    // The future is consumed once the copies have been issued, until then the loader is cancelled.
+    if(loading_.valid())
+    {
+        // The loader may be waiting for ring space, which only the GL thread returns.
+        is_cancelled_ = true;
+        while(loading_.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+            uploader_->Finish();
+        // Issue what has been submitted for the texture before its name can be reused.
+        uploader_->Flush();
+    }
+
     if(glIsTexture(texture_))
         glDeleteTextures(1, &texture_);
 }
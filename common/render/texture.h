@@ -1,18 +1,36 @@
 ﻿#pragma once
+#include <atomic>
 #include <filesystem>
+#include <future>
 #include <GL/glew.h>
 #include "../resource.h"
 
 namespace common::render
 {
 
+class TextureUploader;
+
 class Texture final : public Resource<Texture>
 {
     friend Resource<Texture>;
+public:
+    enum class LoadState
+    {
+        Loading,
+        Loaded,
+        Failed
+    };
+
 public:
     Texture(GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height);
     Texture(GLenum internal_format, GLsizei width, GLsizei height);
+    /*!
+     * Decodes the file on a loader thread and streams it through the TextureUploader.
+     * The texture has no storage until the GL thread has flushed the uploader.
+     */
     Texture(const std::filesystem::path& filepath, bool generate_mipmap = true);
+    //! Creates a view of `num_of_levels` levels of `origin` starting at `min_level`. The origin must have immutable storage.
+    Texture(const Texture& origin, GLuint min_level, GLuint num_of_levels = 1);
     ~Texture();
 
     Texture(const Texture&) = delete;
@@ -21,6 +39,11 @@ public:
     Texture& operator = (Texture&&) = delete;
 
     GLuint GetTexture() const noexcept { return texture_; };
+    /*!
+     * Textures created from a file are Loaded once their copies have been issued on the GL thread,
+     * or Failed if the file could not be decoded. Others are always Loaded.
+     */
+    LoadState GetLoadState() const noexcept { return load_state_; }
 
     static GLsizei CalcNumOfMipmapLevels(GLsizei width);
     static GLsizei CalcNumOfMipmapLevels(GLsizei width, GLsizei height);
@@ -34,6 +57,10 @@ private:
 
 private:
     GLuint texture_;
+    LoadState load_state_;
+    TextureUploader* uploader_;
+    std::atomic<bool> is_cancelled_;
+    std::future<bool> loading_;
 };
 
 }   // namespace common::render
\ No newline at end of file
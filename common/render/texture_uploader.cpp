@@ -0,0 +1,345 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <hasenpfote/assert.h>
+#include "../logger.h"
+#include "texture_uploader.h"
+
+namespace
+{
+
+bool is_3d_target(GLenum target)
+{
+    return (target == GL_TEXTURE_2D_ARRAY)
+        || (target == GL_TEXTURE_3D)
+        || (target == GL_TEXTURE_CUBE_MAP_ARRAY);
+}
+
+GLsizeiptr align_size(GLsizeiptr size, GLsizeiptr alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+}
+
+namespace common::render
+{
+
+TextureUploader::TextureUploader(GLsizeiptr capacity)
+    : buffer_(0), capacity_(capacity), mapped_(nullptr), head_(0)
+{
+    HASENPFOTE_ASSERT(capacity > 0);
+
+    LOG_I("Creating texture upload buffer. [capacity=" << capacity << "]");
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity_, nullptr, flags);
+    mapped_ = static_cast<std::uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity_, flags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if(mapped_ == nullptr)
+    {
+        LOG_E("Failed to map the texture upload buffer.");
+        glDeleteBuffers(1, &buffer_);
+        throw std::runtime_error("");
+    }
+
+    LOG_I("Texture upload buffer created successfully. [id=" << buffer_ << "]");
+}
+
+TextureUploader::~TextureUploader()
+{
+    blocks_.clear();
+    if(glIsBuffer(buffer_))
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &buffer_);
+    }
+}
+
+bool TextureUploader::TryAllocate(GLsizeiptr size, Staging& staging)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocate(size, staging);
+}
+
+TextureUploader::Staging TextureUploader::Allocate(GLsizeiptr size)
+{
+    if(align_size(size, alignment) > capacity_)
+    {
+        LOG_E("Requested staging size exceeds the capacity. [size=" << size << ", capacity=" << capacity_ << "]");
+        throw std::runtime_error("");
+    }
+
+    Staging staging;
+    std::unique_lock<std::mutex> lock(mutex_);
+    retired_.wait(lock, [&](){ return allocate(size, staging); });
+    return staging;
+}
+
+void TextureUploader::Submit(const Staging& staging, const Region& region, const Callback& callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = std::find_if(
+        blocks_.rbegin(),
+        blocks_.rend(),
+        [&](const Block& block){ return block.begin == staging.offset; }
+    );
+    HASENPFOTE_ASSERT_MSG(it != blocks_.rend(), "Unknown staging memory.");
+
+    requests_.push_back({ staging, region, callback, nullptr });
+}
+
+void TextureUploader::Post(const Callback& task)
+{
+    HASENPFOTE_ASSERT(task);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests_.push_back({ Staging(), Region(), nullptr, task });
+}
+
+void TextureUploader::Stream(const Region& region, const void* pixels, GLsizeiptr size, const Callback& callback)
+{
+    if(align_size(size, alignment) > capacity_)
+    {
+        // Too large for the ring, the GL thread copies from client memory instead.
+        LOG_W("Uploading texture from client memory. [size=" << size << "]");
+        const auto begin = static_cast<const std::uint8_t*>(pixels);
+        auto texels = std::make_shared<std::vector<std::uint8_t>>(begin, begin + size);
+        Post(
+            [region, texels, callback]()
+            {
+                copy(region, texels->data());
+                if(callback)
+                    callback();
+            }
+        );
+        return;
+    }
+
+    auto staging = Allocate(size);
+    std::memcpy(staging.data, pixels, static_cast<std::size_t>(size));
+    Submit(staging, region, callback);
+}
+
+void TextureUploader::Upload(const Region& region, const void* pixels, GLsizeiptr size, const Callback& callback)
+{
+    Staging staging;
+    if(TryAllocate(size, staging))
+    {
+        std::memcpy(staging.data, pixels, static_cast<std::size_t>(size));
+        Submit(staging, region, callback);
+        return;
+    }
+
+    // Waiting for the copies in flight to make room would stall the GL thread,
+    // so the texels are copied from client memory, after the copies already submitted.
+    LOG_W("Uploading texture from client memory. [size=" << size << "]");
+    Flush();
+    copy(region, pixels);
+    if(callback)
+        callback();
+}
+
+void TextureUploader::Flush()
+{
+    std::vector<Request> requests;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests.swap(requests_);
+    }
+
+    if(!requests.empty())
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+        for(const auto& request : requests)
+        {
+            if(request.task)
+            {
+                // Tasks may copy from client memory, which needs the unpack buffer unbound.
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                request.task();
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+                continue;
+            }
+            copy(request.region, reinterpret_cast<const void*>(request.staging.offset));
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        Fence fence(
+            glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+            [](GLsync sync){ glDeleteSync(sync); }
+        );
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for(const auto& request : requests)
+            {
+                if(request.task)
+                    continue;
+                for(auto& block : blocks_)
+                {
+                    if(block.begin == request.staging.offset)
+                    {
+                        block.fence = fence;
+                        break;
+                    }
+                }
+            }
+        }
+
+        for(const auto& request : requests)
+        {
+            if(request.callback)
+                request.callback();
+        }
+    }
+
+    retire(false);
+}
+
+void TextureUploader::Finish()
+{
+    Flush();
+    retire(true);
+}
+
+bool TextureUploader::allocate(GLsizeiptr size, Staging& staging)
+{
+    HASENPFOTE_ASSERT(size > 0);
+
+    const auto aligned = align_size(size, alignment);
+    if(aligned > capacity_)
+        return false;
+
+    GLintptr begin = 0;
+    if(blocks_.empty())
+    {
+        // Everything has been retired, so restart from the beginning.
+        head_ = 0;
+    }
+    else
+    {
+        const auto tail = blocks_.front().begin;
+        if(head_ > tail)
+        {
+            if(head_ + aligned <= capacity_)
+                begin = head_;
+            else if(aligned <= tail)
+                begin = 0;
+            else
+                return false;
+        }
+        else if(head_ < tail)
+        {
+            if(head_ + aligned <= tail)
+                begin = head_;
+            else
+                return false;
+        }
+        else
+        {
+            return false;   // full
+        }
+    }
+
+    head_ = begin + aligned;
+    blocks_.push_back({ begin, head_, nullptr });
+
+    staging.offset = begin;
+    staging.size = size;
+    staging.data = mapped_ + begin;
+
+    return true;
+}
+
+void TextureUploader::retire(bool wait)
+{
+    constexpr GLuint64 timeout = 1000000000; // 1 sec.
+
+    bool has_retired = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while(!blocks_.empty() && blocks_.front().fence)
+        {
+            auto fence = blocks_.front().fence;
+
+            lock.unlock();
+            GLenum result;
+            do
+            {
+                result = glClientWaitSync(fence.get(), GL_SYNC_FLUSH_COMMANDS_BIT, wait ? timeout : 0);
+            }
+            while(wait && (result == GL_TIMEOUT_EXPIRED));
+            lock.lock();
+
+            if((result != GL_ALREADY_SIGNALED) && (result != GL_CONDITION_SATISFIED))
+                break;
+
+            while(!blocks_.empty() && (blocks_.front().fence == fence))
+            {
+                blocks_.pop_front();
+            }
+            has_retired = true;
+        }
+    }
+
+    if(has_retired)
+        retired_.notify_all();
+}
+
+void TextureUploader::copy(const Region& region, const void* pixels)
+{
+    GLint prev_alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, region.unpack_alignment);
+    glBindTexture(region.target, region.texture);
+    if(region.image_size > 0)
+    {
+        if(is_3d_target(region.target))
+        {
+            glCompressedTexSubImage3D(
+                region.target, region.level,
+                region.xoffset, region.yoffset, region.zoffset,
+                region.width, region.height, region.depth,
+                region.format, region.image_size, pixels
+            );
+        }
+        else
+        {
+            glCompressedTexSubImage2D(
+                region.target, region.level,
+                region.xoffset, region.yoffset,
+                region.width, region.height,
+                region.format, region.image_size, pixels
+            );
+        }
+    }
+    else if(is_3d_target(region.target))
+    {
+        glTexSubImage3D(
+            region.target, region.level,
+            region.xoffset, region.yoffset, region.zoffset,
+            region.width, region.height, region.depth,
+            region.format, region.type, pixels
+        );
+    }
+    else
+    {
+        glTexSubImage2D(
+            region.target, region.level,
+            region.xoffset, region.yoffset,
+            region.width, region.height,
+            region.format, region.type, pixels
+        );
+    }
+    glBindTexture(region.target, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, prev_alignment);
+}
+
+}   // namespace common::render
\ No newline at end of file
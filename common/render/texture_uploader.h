@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <type_traits>
+#include <GL/glew.h>
+
+namespace common::render
+{
+
+/*!
+ * @class TextureUploader
+ * @brief Streams texel data to textures through a persistent-mapped pixel unpack ring buffer.
+ *
+ * Loader threads decode straight into staging memory from Allocate() and Submit() the copies, or Stream() texels
+ * they already hold. The GL thread only issues the submitted copies in Flush(), once a frame.
+ * Upload(), Flush() and Finish() must be called on the thread that owns the GL context, nothing there waits for space.
+ */
+class TextureUploader final
+{
+public:
+    static constexpr GLsizeiptr default_capacity = 32 * 1024 * 1024;
+    static constexpr GLsizeiptr alignment = 16;
+
+    struct Staging
+    {
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;
+        std::uint8_t* data = nullptr;
+    };
+
+    struct Region
+    {
+        GLuint texture = 0;
+        GLenum target = GL_TEXTURE_2D;
+        GLint level = 0;
+        GLint xoffset = 0;
+        GLint yoffset = 0;
+        GLint zoffset = 0;
+        GLsizei width = 0;
+        GLsizei height = 0;
+        GLsizei depth = 1;
+        GLenum format = GL_RGBA;
+        GLenum type = GL_UNSIGNED_BYTE;
+        GLint unpack_alignment = 4;
+        GLsizei image_size = 0;     // Non-zero for block-compressed data, `format` then holds the internal format.
+    };
+
+    // Called on the GL thread, right after the copy has been issued or in order with the copies for posted tasks.
+    using Callback = std::function<void()>;
+
+public:
+    explicit TextureUploader(GLsizeiptr capacity = default_capacity);
+    ~TextureUploader();
+
+    TextureUploader(const TextureUploader&) = delete;
+    TextureUploader& operator = (const TextureUploader&) = delete;
+    TextureUploader(TextureUploader&&) = delete;
+    TextureUploader& operator = (TextureUploader&&) = delete;
+
+    GLsizeiptr GetCapacity() const noexcept { return capacity_; }
+
+    bool TryAllocate(GLsizeiptr size, Staging& staging);
+    //! Waits until the GL thread has returned enough space, so this must not be called from there.
+    Staging Allocate(GLsizeiptr size);
+    void Submit(const Staging& staging, const Region& region, const Callback& callback = nullptr);
+    //! Runs `task` on the GL thread in order with the submitted copies, e.g. to allocate the storage they copy to.
+    void Post(const Callback& task);
+
+    //! Copies `pixels` through the ring from a loader thread. Texels too large for the ring are copied from client memory by the GL thread.
+    void Stream(const Region& region, const void* pixels, GLsizeiptr size, const Callback& callback = nullptr);
+    //! Copies `pixels` through the ring from the GL thread, or from client memory while the ring is full.
+    void Upload(const Region& region, const void* pixels, GLsizeiptr size, const Callback& callback = nullptr);
+
+    void Flush();
+    void Finish();
+
+private:
+    using Fence = std::shared_ptr<std::remove_pointer_t<GLsync>>;
+
+    struct Block
+    {
+        GLintptr begin;
+        GLintptr end;
+        Fence fence;
+    };
+
+    struct Request
+    {
+        Staging staging;
+        Region region;
+        Callback callback;
+        Callback task;
+    };
+
+    bool allocate(GLsizeiptr size, Staging& staging);
+    void retire(bool wait);
+    static void copy(const Region& region, const void* pixels);
+
+private:
+    GLuint buffer_;
+    GLsizeiptr capacity_;
+    std::uint8_t* mapped_;
+
+    std::mutex mutex_;
+    std::condition_variable retired_;
+    GLintptr head_;
+    std::deque<Block> blocks_;
+    std::vector<Request> requests_;
+};
+
+}   // namespace common::render
\ No newline at end of file
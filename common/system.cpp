@@ -19,4 +19,28 @@ System::~System()
     LOG_D(__func__);
 }
 
+common::render::TextureUploader& System::GetTextureUploader()
+{
+    // Created on first use since it requires a current GL context.
+    if(!texture_uploader_)
+        texture_uploader_ = std::make_unique<common::render::TextureUploader>();
+    return *texture_uploader_;
+}
+
+common::render::Readback& System::GetReadback()
+{
+    if(!readback_)
+        readback_ = std::make_unique<common::render::Readback>();
+    return *readback_;
+}
+
+void System::ReleaseGraphicsResources()
+{
+    LOG_D(__func__);
+    // Textures still loading flush the uploader, so it goes after them.
+    rm_->RemoveAllResources();
+    texture_uploader_.reset();
+    readback_.reset();
+}
+
 }   // namespace common
\ No newline at end of file
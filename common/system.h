@@ -3,6 +3,8 @@
 #include "singleton.h"
 #include "resource.h"
 #include "render/simple_camera.h"
+#include "render/texture_uploader.h"
+#include "render/readback.h"
 
 namespace common
 {
@@ -23,7 +25,16 @@ public:
     common::render::SimpleCamera& GetCamera(){ return *camera_; }
     const common::render::SimpleCamera& GetCamera() const { return *camera_; }
 
+    common::render::TextureUploader& GetTextureUploader();
+    common::render::Readback& GetReadback();
+
+    //! Destroys everything that owns GL objects, while the context is still current.
+    void ReleaseGraphicsResources();
+
 private:
+    // Declared ahead of the resources, which may still use them while being destroyed.
+    std::unique_ptr<common::render::TextureUploader> texture_uploader_;
+    std::unique_ptr<common::render::Readback> readback_;
     std::unique_ptr<common::DefaultResourceManager> rm_;
     std::unique_ptr<common::render::SimpleCamera> camera_;
 };
@@ -9,6 +9,7 @@
 #include "../common/imgui/imgui_impl_glfw.h"
 #endif
 #include "logger.h"
+#include "system.h"
 #include "window.h"
 
 #define STRINGIFY(value) #value
@@ -97,6 +98,9 @@ Window::Window()
 
 Window::~Window()
 {
+    // The System singleton outlives the window, its GL objects must go before the context does.
+    if(window)
+        System::GetMutableInstance().ReleaseGraphicsResources();
 #if defined(USE_IMGUI)
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -235,6 +239,11 @@ void Window::MainLoop()
             lag -= update_period;
             update_count++;
         }
+        // Issue the texture copies submitted by loader threads.
+        System::GetMutableInstance().GetTextureUploader().Flush();
+        // Deliver the GPU results that have arrived since the last frame.
+        System::GetMutableInstance().GetReadback().Update();
+
         if(!has_iconified)
         {
             OnRender();
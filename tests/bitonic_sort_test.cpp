@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../BitonicSort/src/bitonic_sort.h"
+#include "check.h"
+
+// Built once per lane width, each build is checked against the same network, so the widths agree with each other.
+
+namespace
+{
+
+// The network of bitonic_sort_local.cs and bitonic_sort_global.cs, one stage and one pair at a time.
+void compute_sort(std::vector<std::uint32_t>& keys, std::vector<std::uint32_t>& values)
+{
+    const auto N = keys.size();
+    for(std::size_t seq_size = 2; seq_size <= N; seq_size <<= 1)
+    {
+        for(auto offset = seq_size / 2; offset > 0; offset >>= 1)
+        {
+            for(std::size_t i = 0; i < N; i++)
+            {
+                if(i & offset)
+                    continue;
+                const auto j = i + offset;
+                const auto ascending = (i & seq_size) == 0;
+                if(ascending ? (keys[j] < keys[i]) : (keys[i] < keys[j]))
+                {
+                    std::swap(keys[i], keys[j]);
+                    std::swap(values[i], values[j]);
+                }
+            }
+        }
+    }
+}
+
+void test(std::size_t N, std::uint32_t max_key, unsigned int num_of_threads, std::mt19937& engine)
+{
+    // Keys above 2^31 check the bias of the signed compares, a small range gives many ties.
+    std::uniform_int_distribution<std::uint32_t> distribution(0, max_key);
+    std::vector<std::uint32_t> keys(N);
+    std::vector<std::uint32_t> values(N);
+    for(std::size_t i = 0; i < N; i++)
+    {
+        keys[i] = distribution(engine);
+        values[i] = static_cast<std::uint32_t>(i);
+    }
+
+    auto expected_keys = keys;
+    auto expected_values = values;
+    compute_sort(expected_keys, expected_values);
+
+    bitonic_sort::sort(keys.data(), values.data(), N, num_of_threads);
+    CHECK(keys == expected_keys);
+    CHECK(values == expected_values);
+}
+
+}
+
+int main()
+{
+#if defined(BITONIC_SORT_TEST_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    // ctest reports the test as skipped.
+    if(!__builtin_cpu_supports("avx2"))
+        return 77;
+#endif
+
+    std::mt19937 engine(12345);
+    // Below a register, a register, within a block, and a merge across blocks with several threads.
+    const std::size_t sizes[] = { 1, 2, 4, 8, 16, 64, 1 << 12, 1 << 17 };
+    for(auto N : sizes)
+    {
+        for(auto max_key : { 7u, 0xFFFFFFFFu })
+            test(N, max_key, 4, engine);
+    }
+
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "../common/render/compression/block_compression.h"
+#include "check.h"
+
+namespace
+{
+
+using namespace common::render::compression;
+
+// The decoders follow the format specifications rather than the encoders, only the modes the encoders emit are handled.
+
+class BitReader final
+{
+public:
+    explicit BitReader(const std::uint8_t* src)
+        : src_(src), pos_(0)
+    {
+    }
+
+    std::uint32_t Get(std::size_t bits)
+    {
+        std::uint32_t value = 0;
+        for(std::size_t i = 0; i < bits; i++)
+        {
+            value |= static_cast<std::uint32_t>((src_[pos_ >> 3] >> (pos_ & 7)) & 1u) << i;
+            pos_++;
+        }
+        return value;
+    }
+
+private:
+    const std::uint8_t* src_;
+    std::size_t pos_;
+};
+
+constexpr std::array<int, 16> weights4 = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+int interpolate(int a, int b, int w)
+{
+    return ((64 - w) * a + w * b + 32) >> 6;
+}
+
+void decode_bc1(const std::uint8_t* src, std::uint8_t* rgba)
+{
+    BitReader reader(src);
+    const auto c0 = reader.Get(16);
+    const auto c1 = reader.Get(16);
+    auto expand = [](std::uint32_t c)
+    {
+        const auto r = static_cast<int>((c >> 11) & 0x1F);
+        const auto g = static_cast<int>((c >> 5) & 0x3F);
+        const auto b = static_cast<int>(c & 0x1F);
+        return std::array<int, 3>{ (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+    };
+    const auto p0 = expand(c0);
+    const auto p1 = expand(c1);
+
+    std::array<std::array<int, 4>, 4> palette;
+    for(std::size_t c = 0; c < 3; c++)
+    {
+        palette[0][c] = p0[c];
+        palette[1][c] = p1[c];
+        if(c0 > c1)
+        {
+            palette[2][c] = (2 * p0[c] + p1[c]) / 3;
+            palette[3][c] = (p0[c] + 2 * p1[c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (p0[c] + p1[c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = (c0 > c1) ? 255 : 0;
+
+    for(std::size_t i = 0; i < texels_per_block; i++)
+    {
+        const auto& p = palette[reader.Get(2)];
+        for(std::size_t c = 0; c < 4; c++)
+            rgba[i * 4 + c] = static_cast<std::uint8_t>(p[c]);
+    }
+}
+
+void decode_bc4(const std::uint8_t* src, std::size_t channel, std::uint8_t* rgba)
+{
+    BitReader reader(src);
+    const auto a0 = static_cast<int>(reader.Get(8));
+    const auto a1 = static_cast<int>(reader.Get(8));
+
+    std::array<int, 8> palette;
+    palette[0] = a0;
+    palette[1] = a1;
+    if(a0 > a1)
+    {
+        for(int i = 2; i < 8; i++)
+            palette[static_cast<std::size_t>(i)] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+    }
+    else
+    {
+        for(int i = 2; i < 6; i++)
+            palette[static_cast<std::size_t>(i)] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    for(std::size_t i = 0; i < texels_per_block; i++)
+        rgba[i * 4 + channel] = static_cast<std::uint8_t>(palette[reader.Get(3)]);
+}
+
+// Mode 11 only.
+void decode_bc6h(const std::uint8_t* src, float* rgb)
+{
+    BitReader reader(src);
+    CHECK(reader.Get(5) == 0x03);
+
+    std::array<std::array<int, 3>, 2> e;
+    for(auto& endpoint : e)
+    {
+        for(auto& q : endpoint)
+        {
+            q = static_cast<int>(reader.Get(10));
+            q = (q == 0) ? 0 : (q == 1023) ? 0xFFFF : ((q << 16) + 0x8000) >> 10;
+        }
+    }
+
+    for(std::size_t i = 0; i < texels_per_block; i++)
+    {
+        const auto index = reader.Get((i == 0) ? 3 : 4);
+        for(std::size_t c = 0; c < 3; c++)
+        {
+            const auto h = (interpolate(e[0][c], e[1][c], weights4[index]) * 31) >> 6;
+            rgb[i * 3 + c] = HalfToFloat(static_cast<std::uint16_t>(h));
+        }
+    }
+}
+
+// Mode 6 only.
+void decode_bc7(const std::uint8_t* src, std::uint8_t* rgba)
+{
+    BitReader reader(src);
+    CHECK(reader.Get(7) == (1u << 6));
+
+    std::array<std::array<int, 4>, 2> e;
+    for(std::size_t c = 0; c < 4; c++)
+    {
+        e[0][c] = static_cast<int>(reader.Get(7));
+        e[1][c] = static_cast<int>(reader.Get(7));
+    }
+    const auto p0 = static_cast<int>(reader.Get(1));
+    const auto p1 = static_cast<int>(reader.Get(1));
+    for(std::size_t c = 0; c < 4; c++)
+    {
+        e[0][c] = (e[0][c] << 1) | p0;
+        e[1][c] = (e[1][c] << 1) | p1;
+    }
+
+    for(std::size_t i = 0; i < texels_per_block; i++)
+    {
+        const auto index = reader.Get((i == 0) ? 3 : 4);
+        for(std::size_t c = 0; c < 4; c++)
+            rgba[i * 4 + c] = static_cast<std::uint8_t>(interpolate(e[0][c], e[1][c], weights4[index]));
+    }
+}
+
+template<typename T, typename Decoder>
+std::vector<T> decompress(const std::vector<std::uint8_t>& blocks, std::size_t bytes_per_block, std::size_t channels, std::size_t width, std::size_t height, Decoder decoder)
+{
+    const auto blocks_x = (width + block_width - 1) / block_width;
+    const auto blocks_y = (height + block_height - 1) / block_height;
+    CHECK(blocks.size() == blocks_x * blocks_y * bytes_per_block);
+
+    std::vector<T> image(width * height * channels);
+    std::array<T, texels_per_block * 4> block{};
+    for(std::size_t by = 0; by < blocks_y; by++)
+    {
+        for(std::size_t bx = 0; bx < blocks_x; bx++)
+        {
+            decoder(&blocks[(by * blocks_x + bx) * bytes_per_block], block.data());
+            for(std::size_t y = 0; (y < block_height) && (by * block_height + y < height); y++)
+            {
+                for(std::size_t x = 0; (x < block_width) && (bx * block_width + x < width); x++)
+                {
+                    const auto s = &block[(y * block_width + x) * channels];
+                    std::copy(s, s + channels, &image[((by * block_height + y) * width + bx * block_width + x) * channels]);
+                }
+            }
+        }
+    }
+    return image;
+}
+
+// Smooth gradients with some noise, which is what the encoders are tuned for.
+std::vector<std::uint8_t> make_rgba(std::size_t width, std::size_t height)
+{
+    std::mt19937 engine(12345);
+    std::uniform_int_distribution<int> noise(-4, 4);
+
+    std::vector<std::uint8_t> rgba(width * height * 4);
+    for(std::size_t y = 0; y < height; y++)
+    {
+        for(std::size_t x = 0; x < width; x++)
+        {
+            const auto u = static_cast<float>(x) / static_cast<float>(width);
+            const auto v = static_cast<float>(y) / static_cast<float>(height);
+            const std::array<float, 4> value = { 255.0f * u, 255.0f * v, 128.0f + 100.0f * std::sin(6.0f * (u + v)), 255.0f * (1.0f - u * v) };
+            for(std::size_t c = 0; c < 4; c++)
+                rgba[(y * width + x) * 4 + c] = static_cast<std::uint8_t>(std::clamp(static_cast<int>(value[c]) + noise(engine), 0, 255));
+        }
+    }
+    return rgba;
+}
+
+std::vector<float> make_rgb(std::size_t width, std::size_t height)
+{
+    std::vector<float> rgb(width * height * 3);
+    for(std::size_t y = 0; y < height; y++)
+    {
+        for(std::size_t x = 0; x < width; x++)
+        {
+            const auto u = static_cast<float>(x) / static_cast<float>(width);
+            const auto v = static_cast<float>(y) / static_cast<float>(height);
+            rgb[(y * width + x) * 3 + 0] = 0.01f + 4.0f * u;
+            rgb[(y * width + x) * 3 + 1] = 0.5f + 0.5f * std::sin(6.0f * v);
+            rgb[(y * width + x) * 3 + 2] = 100.0f * u * v;
+        }
+    }
+    return rgb;
+}
+
+double rmse(const std::vector<std::uint8_t>& a, const std::vector<std::uint8_t>& b, std::size_t channels, std::size_t channel)
+{
+    double sum = 0.0;
+    std::size_t count = 0;
+    for(auto i = channel; i < a.size(); i += channels)
+    {
+        const auto d = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+        sum += d * d;
+        count++;
+    }
+    return std::sqrt(sum / static_cast<double>(count));
+}
+
+// Odd sizes, so the partial blocks at the edges are covered.
+// Large enough for the gradients to be nearly linear within a block.
+constexpr std::size_t width = 133;
+constexpr std::size_t height = 77;
+
+void test_ldr()
+{
+    const auto rgba = make_rgba(width, height);
+
+    // The output must not depend on how the rows of blocks are split among the threads.
+    for(auto format : { BlockFormat::BC1, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7 })
+        CHECK(Compress(format, rgba.data(), width, height, 1) == Compress(format, rgba.data(), width, height, 4));
+
+    {
+        const auto blocks = Compress(BlockFormat::BC1, rgba.data(), width, height);
+        const auto decoded = decompress<std::uint8_t>(blocks, 8, 4, width, height, decode_bc1);
+        for(std::size_t c = 0; c < 3; c++)
+            CHECK(rmse(rgba, decoded, 4, c) < 5.0);
+    }
+    {
+        const auto blocks = Compress(BlockFormat::BC4, rgba.data(), width, height);
+        const auto decoded = decompress<std::uint8_t>(blocks, 8, 4, width, height, [](const std::uint8_t* src, std::uint8_t* dst){ decode_bc4(src, 0, dst); });
+        CHECK(rmse(rgba, decoded, 4, 0) < 1.5);
+    }
+    {
+        const auto blocks = Compress(BlockFormat::BC5, rgba.data(), width, height);
+        const auto decoded = decompress<std::uint8_t>(blocks, 16, 4, width, height,
+            [](const std::uint8_t* src, std::uint8_t* dst)
+            {
+                decode_bc4(src, 0, dst);
+                decode_bc4(src + 8, 1, dst);
+            }
+        );
+        CHECK(rmse(rgba, decoded, 4, 0) < 1.5);
+        CHECK(rmse(rgba, decoded, 4, 1) < 1.5);
+    }
+    {
+        const auto blocks = Compress(BlockFormat::BC7, rgba.data(), width, height);
+        const auto decoded = decompress<std::uint8_t>(blocks, 16, 4, width, height, decode_bc7);
+        for(std::size_t c = 0; c < 4; c++)
+            CHECK(rmse(rgba, decoded, 4, c) < 4.0);
+    }
+
+    // A uniform block is reproduced closely by every format.
+    std::array<std::uint8_t, texels_per_block * 4> solid;
+    for(std::size_t i = 0; i < texels_per_block; i++)
+    {
+        solid[i * 4 + 0] = 200;
+        solid[i * 4 + 1] = 100;
+        solid[i * 4 + 2] = 50;
+        solid[i * 4 + 3] = 255;
+    }
+    std::array<std::uint8_t, 16> block;
+    std::array<std::uint8_t, texels_per_block * 4> decoded;
+    EncodeBC1Block(solid.data(), block.data());
+    decode_bc1(block.data(), decoded.data());
+    for(std::size_t i = 0; i < decoded.size(); i++)
+        CHECK(std::abs(decoded[i] - solid[i]) <= 4);
+    EncodeBC4Block(solid.data(), 1, block.data());
+    decode_bc4(block.data(), 1, decoded.data());
+    for(std::size_t i = 0; i < texels_per_block; i++)
+        CHECK(decoded[i * 4 + 1] == solid[i * 4 + 1]);
+    EncodeBC7Block(solid.data(), block.data());
+    decode_bc7(block.data(), decoded.data());
+    for(std::size_t i = 0; i < decoded.size(); i++)
+        CHECK(std::abs(decoded[i] - solid[i]) <= 1);
+}
+
+void test_hdr()
+{
+    const auto rgb = make_rgb(width, height);
+
+    CHECK(Compress(BlockFormat::BC6H, rgb.data(), width, height, 1) == Compress(BlockFormat::BC6H, rgb.data(), width, height, 4));
+
+    const auto blocks = Compress(BlockFormat::BC6H, rgb.data(), width, height);
+    const auto decoded = decompress<float>(blocks, 16, 3, width, height, decode_bc6h);
+
+    // BC6H interpolates the half float bit patterns, so the error is relative to the magnitude.
+    double sum = 0.0;
+    for(std::size_t i = 0; i < rgb.size(); i++)
+    {
+        const auto d = std::log2(1.0 + static_cast<double>(decoded[i])) - std::log2(1.0 + static_cast<double>(rgb[i]));
+        sum += d * d;
+    }
+    CHECK(std::sqrt(sum / static_cast<double>(rgb.size())) < 0.05);
+
+    // Values outside the half float range are clamped rather than wrapped.
+    std::array<float, texels_per_block * 3> out_of_range;
+    out_of_range.fill(1.0e6f);
+    std::array<std::uint8_t, 16> block;
+    std::array<float, texels_per_block * 3> texels;
+    EncodeBC6HBlock(out_of_range.data(), block.data());
+    decode_bc6h(block.data(), texels.data());
+    for(auto texel : texels)
+        CHECK(texel > 60000.0f);
+}
+
+}
+
+int main()
+{
+    test_ldr();
+    test_hdr();
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdlib>
+#include <iostream>
+
+// Unlike assert, the checks stay enabled in Release builds, which is the default configuration.
+#define CHECK(condition) check_impl((condition), #condition, __FILE__, __LINE__)
+
+inline void check_impl(bool condition, const char* expression, const char* file, int line)
+{
+    if(condition)
+        return;
+    std::cerr << file << "(" << line << "): CHECK(" << expression << ") failed." << std::endl;
+    std::exit(EXIT_FAILURE);
+}
\ No newline at end of file
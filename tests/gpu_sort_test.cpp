@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../common/render/gpu_sort.h"
+#include "check.h"
+
+namespace
+{
+
+using common::render::GpuSort;
+
+using Pairs = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+std::uint32_t to_bits(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float to_float(std::uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// -0 sorts before +0, otherwise the usual order of the values.
+bool float_less(std::uint32_t a, std::uint32_t b)
+{
+    const auto fa = to_float(a);
+    const auto fb = to_float(b);
+    return (fa < fb) || ((fa == fb) && std::signbit(fa) && !std::signbit(fb));
+}
+
+void expected_sort(Pairs::iterator first, Pairs::iterator last, GpuSort::KeyType key_type)
+{
+    if(key_type == GpuSort::KeyType::Uint)
+        std::stable_sort(first, last, [](const auto& a, const auto& b){ return a.first < b.first; });
+    else
+        std::stable_sort(first, last, [](const auto& a, const auto& b){ return float_less(a.first, b.first); });
+}
+
+// The values are the original positions, so any instability shows up in them.
+Pairs make_pairs(const std::vector<std::uint32_t>& keys)
+{
+    Pairs pairs;
+    for(std::size_t i = 0; i < keys.size(); i++)
+        pairs.emplace_back(keys[i], static_cast<std::uint32_t>(i));
+    return pairs;
+}
+
+void check_equal(const std::vector<std::uint32_t>& keys, const std::vector<std::uint32_t>& values, const Pairs& expected)
+{
+    CHECK(keys.size() == expected.size());
+    CHECK(values.size() == expected.size());
+    for(std::size_t i = 0; i < expected.size(); i++)
+    {
+        CHECK(keys[i] == expected[i].first);
+        CHECK(values[i] == expected[i].second);
+    }
+}
+
+std::vector<std::uint32_t> make_uint_keys(std::size_t count, std::mt19937& engine)
+{
+    // Half of the keys come from a small range, so there are many ties.
+    std::uniform_int_distribution<std::uint32_t> any;
+    std::uniform_int_distribution<std::uint32_t> small(0, 15);
+    std::vector<std::uint32_t> keys(count);
+    for(std::size_t i = 0; i < count; i++)
+        keys[i] = (i % 2 == 0) ? any(engine) : small(engine);
+    return keys;
+}
+
+std::vector<std::uint32_t> make_float_keys(std::size_t count, std::mt19937& engine)
+{
+    const float specials[] = { 0.0f, -0.0f, 1.0f, -1.0f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::denorm_min() };
+    std::uniform_real_distribution<float> any(-1000.0f, 1000.0f);
+    std::uniform_int_distribution<std::size_t> special(0, std::size(specials) - 1);
+    std::vector<std::uint32_t> keys(count);
+    for(std::size_t i = 0; i < count; i++)
+        keys[i] = to_bits((i % 3 == 0) ? specials[special(engine)] : any(engine));
+    return keys;
+}
+
+void test_sort_pairs(const std::vector<std::uint32_t>& keys, GpuSort::KeyType key_type)
+{
+    auto expected = make_pairs(keys);
+    expected_sort(expected.begin(), expected.end(), key_type);
+
+    for(unsigned int num_of_threads : { 1u, 4u })
+    {
+        auto sorted_keys = keys;
+        std::vector<std::uint32_t> values(keys.size());
+        for(std::size_t i = 0; i < values.size(); i++)
+            values[i] = static_cast<std::uint32_t>(i);
+        GpuSort::SortPairs(sorted_keys, values, key_type, num_of_threads);
+        check_equal(sorted_keys, values, expected);
+    }
+}
+
+void test_sort_segments(const std::vector<std::uint32_t>& keys, const std::vector<std::uint32_t>& offsets, GpuSort::KeyType key_type)
+{
+    auto expected = make_pairs(keys);
+    for(std::size_t i = 0; i + 1 < offsets.size(); i++)
+        expected_sort(expected.begin() + offsets[i], expected.begin() + offsets[i + 1], key_type);
+
+    auto sorted_keys = keys;
+    std::vector<std::uint32_t> values(keys.size());
+    for(std::size_t i = 0; i < values.size(); i++)
+        values[i] = static_cast<std::uint32_t>(i);
+    GpuSort::SortSegments(sorted_keys, values, offsets, key_type, 4);
+    check_equal(sorted_keys, values, expected);
+}
+
+}
+
+int main()
+{
+    std::mt19937 engine(12345);
+
+    // More than one chunk of the CPU radix sort.
+    constexpr std::size_t count = 200000;
+    test_sort_pairs(make_uint_keys(count, engine), GpuSort::KeyType::Uint);
+    test_sort_pairs(make_float_keys(count, engine), GpuSort::KeyType::Float);
+    test_sort_pairs({}, GpuSort::KeyType::Uint);
+    test_sort_pairs({ 7 }, GpuSort::KeyType::Uint);
+
+    // Empty segments at the front, in the middle and at the back.
+    const std::vector<std::uint32_t> offsets = { 0, 0, 10, 10, 10, 1000, 1001, 5000, 5000 };
+    test_sort_segments(make_uint_keys(5000, engine), offsets, GpuSort::KeyType::Uint);
+    test_sort_segments(make_float_keys(5000, engine), offsets, GpuSort::KeyType::Float);
+    test_sort_segments({}, { 0 }, GpuSort::KeyType::Uint);
+    test_sort_segments({}, { 0, 0, 0 }, GpuSort::KeyType::Float);
+
+    std::cout << "OK" << std::endl;
+    return EXIT_SUCCESS;
+}
\ No newline at end of file